@@ -12,10 +12,11 @@
 #include <Server/Components/Fixes/fixes.hpp>
 #include <netcode.hpp>
 #include <sdk.hpp>
+#include <allocations.hpp>
 
 using namespace Impl;
 
-struct PlayerActorData final : IExtension
+struct PlayerActorData final : IExtension, TrackedAllocation<PlayerActorData>
 {
 	PROVIDE_EXT_UID(0xd1bb1d1f96c7e572)
 	uint8_t numStreamed = 0;
@@ -9,8 +9,9 @@
 #include "actor.hpp"
 #include <Server/Components/Fixes/fixes.hpp>
 #include <utils.hpp>
+#include <allocations.hpp>
 
-class ActorsComponent final : public IActorsComponent, public PlayerConnectEventHandler, public PlayerUpdateEventHandler, public PoolEventHandler<IPlayer>
+class ActorsComponent final : public IActorsComponent, public PlayerConnectEventHandler, public PlayerUpdateEventHandler, public PoolEventHandler<IPlayer>, public TrackedAllocation<ActorsComponent>
 {
 private:
 	ICore* core = nullptr;
@@ -248,6 +249,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new ActorsComponent();
@@ -10,6 +10,7 @@
 
 #include <Server/Components/Checkpoints/checkpoints.hpp>
 #include <netcode.hpp>
+#include <allocations.hpp>
 
 template <class T>
 struct CheckpointDataBase : public T
@@ -177,7 +178,7 @@ public:
 	}
 };
 
-class PlayerCheckpointData final : public IPlayerCheckpointData
+class PlayerCheckpointData final : public IPlayerCheckpointData, public TrackedAllocation<PlayerCheckpointData>
 {
 private:
 	RaceCheckpointData raceCheckpoint;
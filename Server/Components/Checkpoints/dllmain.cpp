@@ -9,10 +9,11 @@
 #include "checkpoint.hpp"
 #include <Impl/events_impl.hpp>
 #include <sdk.hpp>
+#include <allocations.hpp>
 
 using namespace Impl;
 
-class CheckpointsComponent final : public ICheckpointsComponent, public PlayerConnectEventHandler
+class CheckpointsComponent final : public ICheckpointsComponent, public PlayerConnectEventHandler, public TrackedAllocation<CheckpointsComponent>
 {
 private:
 	DefaultEventDispatcher<PlayerCheckpointEventHandler> eventDispatcher;
@@ -159,6 +160,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new CheckpointsComponent();
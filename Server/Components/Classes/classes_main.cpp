@@ -10,6 +10,7 @@
 #include <Server/Components/Classes/classes.hpp>
 #include <Server/Components/CustomModels/custommodels.hpp>
 #include <netcode.hpp>
+#include <allocations.hpp>
 
 using namespace Impl;
 
@@ -22,7 +23,7 @@ static const struct DefaultClass final : public PlayerClass
 	}
 } defClass;
 
-class PlayerClassData final : public IPlayerClassData
+class PlayerClassData final : public IPlayerClassData, public TrackedAllocation<PlayerClassData>
 {
 private:
 	IPlayer& player;
@@ -123,7 +124,7 @@ public:
 	}
 };
 
-class ClassesComponent final : public IClassesComponent, public PlayerConnectEventHandler
+class ClassesComponent final : public IClassesComponent, public PlayerConnectEventHandler, public TrackedAllocation<ClassesComponent>
 {
 private:
 	MarkedPoolStorage<Class, IClass, 0, CLASS_POOL_SIZE> storage;
@@ -371,6 +372,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new ClassesComponent();
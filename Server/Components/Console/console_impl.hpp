@@ -19,11 +19,12 @@
 #include <netcode.hpp>
 #include <network.hpp>
 #include <sdk.hpp>
+#include <allocations.hpp>
 #include <thread>
 
 using namespace Impl;
 
-class PlayerConsoleData final : public IPlayerConsoleData
+class PlayerConsoleData final : public IPlayerConsoleData, public TrackedAllocation<PlayerConsoleData>
 {
 private:
 	bool hasAccess = false;
@@ -49,7 +50,7 @@ public:
 	}
 };
 
-class ConsoleComponent final : public IConsoleComponent, public CoreEventHandler, public ConsoleEventHandler, public PlayerConnectEventHandler
+class ConsoleComponent final : public IConsoleComponent, public CoreEventHandler, public ConsoleEventHandler, public PlayerConnectEventHandler, public TrackedAllocation<ConsoleComponent>
 {
 private:
 	struct ThreadProcData
@@ -20,6 +20,8 @@ bool ConsoleComponent::onConsoleText(StringView command, StringView parameters,
 	return false;
 }
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new ConsoleComponent();
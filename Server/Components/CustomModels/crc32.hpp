@@ -1,3 +1,8 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+
 static uint32_t crc32Table[] = {
 	0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA,
 	0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
@@ -65,13 +70,55 @@ static uint32_t crc32Table[] = {
 	0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
 };
 
-static uint32_t CRC32(uint32_t checksum, uint8_t* buffer, int length)
+/// The table above extended to slicing-by-8, which works through eight bytes per step
+struct CRC32Tables
+{
+	uint32_t table[8][256];
+
+	CRC32Tables()
+	{
+		for (int i = 0; i != 256; ++i)
+		{
+			table[0][i] = crc32Table[i];
+		}
+		for (int i = 0; i != 256; ++i)
+		{
+			for (int k = 1; k != 8; ++k)
+			{
+				table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+			}
+		}
+	}
+};
+
+static const CRC32Tables& GetCRC32Tables()
+{
+	static const CRC32Tables tables;
+	return tables;
+}
+
+static uint32_t CRC32(uint32_t checksum, const uint8_t* buffer, size_t length)
 {
+	const uint32_t(&table)[8][256] = GetCRC32Tables().table;
 	checksum = ~checksum;
 
+	// Little endian only, like the rest of the server.
+	while (length >= 8)
+	{
+		uint32_t low;
+		uint32_t high;
+		std::memcpy(&low, buffer, sizeof(low));
+		std::memcpy(&high, buffer + 4, sizeof(high));
+		low ^= checksum;
+		checksum = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^ table[5][(low >> 16) & 0xff] ^ table[4][low >> 24]
+			^ table[3][high & 0xff] ^ table[2][(high >> 8) & 0xff] ^ table[1][(high >> 16) & 0xff] ^ table[0][high >> 24];
+		buffer += 8;
+		length -= 8;
+	}
+
 	while (length--)
 	{
-		checksum = crc32Table[(checksum ^ *buffer++) & 0xff] ^ (checksum >> 8);
+		checksum = table[0][(checksum ^ *buffer++) & 0xff] ^ (checksum >> 8);
 	}
 	return ~checksum;
 }
@@ -87,13 +134,15 @@ static size_t GetFileCRC32Checksum(StringView filename, uint32_t& checksum)
 		return 0;
 	}
 
-	uint8_t buf[1024];
+	// Large reads, model files are usually hundreds of kilobytes.
+	static constexpr size_t BufferSize = 64 * 1024;
+	std::unique_ptr<uint8_t[]> buf(new uint8_t[BufferSize]);
 	size_t file_size = 0;
+	size_t read;
 
-	while (!feof(f))
+	while ((read = fread(buf.get(), 1, BufferSize, f)) != 0)
 	{
-		auto read = fread(buf, 1, 1024, f);
-		checksum = CRC32(checksum, buf, read);
+		checksum = CRC32(checksum, buf.get(), read);
 		file_size += read;
 	}
 
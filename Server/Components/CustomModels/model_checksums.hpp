@@ -0,0 +1,246 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+#include <ghc/filesystem.hpp>
+#include "crc32.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <fstream>
+#include <thread>
+
+/// Checksums of model files.  They are kept in `model_checksums.cache` by name, size and modification
+/// time, so files that haven't changed aren't read again on the next start.  The cache lives in the
+/// server's folder with its other data files, as everything in the models folder can be downloaded.
+class ModelChecksums
+{
+private:
+	struct Entry
+	{
+		uint32_t checksum;
+		size_t size;
+		int64_t modified;
+	};
+
+	/// What `stat` says about a file
+	struct FileInfo
+	{
+		bool exists = false;
+		size_t size = 0;
+		int64_t modified = 0;
+	};
+
+	String modelsPath_;
+	FlatHashMap<String, Entry> entries_;
+	bool loaded_ = false;
+	bool dirty_ = false;
+
+	/// Most threads files are read on at once
+	static constexpr unsigned MaxThreads = 16;
+
+	String getPath(StringView fileName) const
+	{
+		return modelsPath_ + "/" + String(fileName);
+	}
+
+	static constexpr const char* CacheFileName = "model_checksums.cache";
+
+	FileInfo stat(StringView fileName) const
+	{
+		FileInfo info;
+		std::error_code ec;
+		const ghc::filesystem::path path(getPath(fileName));
+		const auto size = ghc::filesystem::file_size(path, ec);
+		if (ec)
+		{
+			return info;
+		}
+		const auto modified = ghc::filesystem::last_write_time(path, ec);
+		if (ec)
+		{
+			return info;
+		}
+		info.exists = true;
+		info.size = static_cast<size_t>(size);
+		info.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+		return info;
+	}
+
+	/// Finds the cached checksum of a file that hasn't changed
+	const Entry* find(const String& fileName, const FileInfo& info) const
+	{
+		auto it = entries_.find(fileName);
+		if (it == entries_.end() || it->second.size != info.size || it->second.modified != info.modified)
+		{
+			return nullptr;
+		}
+		return &it->second;
+	}
+
+	void load()
+	{
+		loaded_ = true;
+		std::ifstream file(CacheFileName);
+		if (!file.is_open())
+		{
+			return;
+		}
+
+		// The models folder first, the names are only meaningful in the one they were read from.
+		std::string line;
+		if (!std::getline(file, line) || line != modelsPath_)
+		{
+			return;
+		}
+
+		// Then one file per line: checksum, size, modification time and name.
+		while (std::getline(file, line))
+		{
+			uint32_t checksum;
+			uint64_t size;
+			int64_t modified;
+			int name = 0;
+			if (sscanf(line.c_str(), "%" SCNx32 " %" SCNu64 " %" SCNd64 " %n", &checksum, &size, &modified, &name) == 3 && name != 0 && static_cast<size_t>(name) < line.size())
+			{
+				entries_[String(line.substr(name))] = Entry { checksum, static_cast<size_t>(size), modified };
+			}
+		}
+	}
+
+public:
+	/// Sets the folder the files are in, reading the cache there if it's a different one
+	void setModelsPath(StringView modelsPath)
+	{
+		if (loaded_ && modelsPath_ == modelsPath)
+		{
+			return;
+		}
+		save();
+		modelsPath_ = String(modelsPath);
+		entries_.clear();
+		load();
+	}
+
+	/// Writes the cache out if anything was added
+	void save()
+	{
+		if (!dirty_)
+		{
+			return;
+		}
+		dirty_ = false;
+
+		std::ofstream file(CacheFileName, std::ios::trunc);
+		if (!file.is_open())
+		{
+			return;
+		}
+		file << modelsPath_ << '\n';
+		char line[64];
+		for (const auto& entry : entries_)
+		{
+			snprintf(line, sizeof(line), "%08" PRIx32 " %" PRIu64 " %" PRId64 " ", entry.second.checksum, static_cast<uint64_t>(entry.second.size), entry.second.modified);
+			file << line << entry.first << '\n';
+		}
+	}
+
+	/// Gets a file's checksum, from the cache if the file hasn't changed
+	/// @returns The file's size, 0 if it doesn't exist
+	size_t get(StringView fileName, uint32_t& checksum)
+	{
+		const String name(fileName);
+		const FileInfo info = stat(name);
+		if (!info.exists)
+		{
+			checksum = 0;
+			return 0;
+		}
+
+		if (const Entry* entry = find(name, info))
+		{
+			checksum = entry->checksum;
+			return entry->size;
+		}
+
+		const size_t size = GetFileCRC32Checksum(getPath(name), checksum);
+		if (size == info.size)
+		{
+			entries_[name] = Entry { checksum, size, info.modified };
+			dirty_ = true;
+		}
+		return size;
+	}
+
+	/// Works out the checksums of many files at once, spread over a few threads, so they can be
+	/// looked up with `get` straight after
+	void prepare(const DynamicArray<String>& fileNames)
+	{
+		struct Job
+		{
+			String name;
+			FileInfo info;
+			uint32_t checksum = 0;
+			size_t size = 0;
+		};
+
+		DynamicArray<Job> jobs;
+		FlatHashSet<String> seen;
+		for (const String& name : fileNames)
+		{
+			if (!seen.insert(name).second)
+			{
+				continue;
+			}
+			const FileInfo info = stat(name);
+			if (info.exists && !find(name, info))
+			{
+				jobs.push_back(Job { name, info });
+			}
+		}
+
+		if (jobs.empty())
+		{
+			return;
+		}
+
+		// Each thread takes the next file nobody has started on yet.
+		std::atomic<size_t> next { 0 };
+		auto work = [this, &jobs, &next]()
+		{
+			for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < jobs.size();)
+			{
+				jobs[i].size = GetFileCRC32Checksum(getPath(jobs[i].name), jobs[i].checksum);
+			}
+		};
+
+		const unsigned threadCount = static_cast<unsigned>(std::min<size_t>({ std::max(std::thread::hardware_concurrency(), 1u), MaxThreads, jobs.size() }));
+		DynamicArray<std::thread> threads;
+		for (unsigned i = 1; i < threadCount; ++i)
+		{
+			threads.emplace_back(work);
+		}
+		work();
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		for (const Job& job : jobs)
+		{
+			// Changed while being read, it'll be read again when it's used.
+			if (job.size == job.info.size)
+			{
+				entries_[job.name] = Entry { job.checksum, job.size, job.info.modified };
+				dirty_ = true;
+			}
+		}
+	}
+};
@@ -9,10 +9,11 @@
 #include <Impl/pool_impl.hpp>
 #include <Server/Components/CustomModels/custommodels.hpp>
 #include <sdk.hpp>
+#include <allocations.hpp>
 #include <netcode.hpp>
 #include <httplib.h>
 #include <ghc/filesystem.hpp>
-#include "crc32.hpp"
+#include "model_checksums.hpp"
 #include <regex>
 #include <shared_mutex>
 #include "utils.hpp"
@@ -30,9 +31,9 @@ struct ModelFile
 	uint32_t checksum;
 	size_t size;
 
-	ModelFile(StringView modelsPath, StringView fileName)
+	ModelFile(ModelChecksums& checksums, StringView fileName)
 		: name(fileName)
-		, size(GetFileCRC32Checksum(String(modelsPath) + "/" + String(fileName), checksum))
+		, size(checksums.get(fileName, checksum))
 	{
 	}
 };
@@ -231,7 +232,7 @@ public:
 	}
 };
 
-class PlayerCustomModelsData final : public IPlayerCustomModelsData
+class PlayerCustomModelsData final : public IPlayerCustomModelsData, public TrackedAllocation<PlayerCustomModelsData>
 {
 private:
 	IPlayer& player;
@@ -283,7 +284,7 @@ public:
 	}
 };
 
-class CustomModelsComponent final : public ICustomModelsComponent, public PlayerConnectEventHandler
+class CustomModelsComponent final : public ICustomModelsComponent, public PlayerConnectEventHandler, public TrackedAllocation<CustomModelsComponent>
 {
 private:
 	ICore* core = nullptr;
@@ -294,6 +295,7 @@ private:
 	std::vector<ModelInfo*> storage;
 	FlatHashMap<uint32_t, uint16_t> baseModels;
 	FlatHashMap<uint32_t, std::pair<ModelDownloadType, ModelInfo*>> checksums;
+	ModelChecksums fileChecksums;
 
 	bool enabled = true;
 	uint16_t modelsPort = 7777;
@@ -401,6 +403,7 @@ public:
 		NetCode::RPC::RequestDFF::removeEventHandler(*core, &requestDownloadLinkHandler);
 		NetCode::RPC::FinishDownload::removeEventHandler(*core, &finishDownloadHandler);
 		players->getPlayerConnectDispatcher().removeEventHandler(this);
+		fileChecksums.save();
 
 		if (webServer)
 		{
@@ -486,6 +489,7 @@ public:
 			return;
 		}
 
+		fileChecksums.setModelsPath(modelsPath);
 		loadArtConfig();
 
 		if (!cdn.empty())
@@ -507,28 +511,64 @@ public:
 
 	void loadArtConfig()
 	{
+		if (!enabled)
+		{
+			return;
+		}
+
 		std::ifstream artconfig { modelsPath + "/artconfig.txt" };
 
 		if (artconfig.is_open())
 		{
 			core->logLn(LogLevel::Message, "[artwork:info] Loading artconfig.txt");
+
+			struct ArtConfigModel
+			{
+				ModelType type;
+				int32_t id;
+				int32_t baseId;
+				String dffName;
+				String txdName;
+				int32_t virtualWorld = -1;
+				uint8_t timeOn = 0;
+				uint8_t timeOff = 0;
+			};
+
+			DynamicArray<ArtConfigModel> models;
 			std::string line;
 			std::smatch match;
 			while (std::getline(artconfig, line))
 			{
 				if (std::regex_match(line, match, rAddCharModel))
 				{
-					addCustomModel(ModelType::Skin, std::atoi(match[2].str().c_str()), std::atoi(match[1].str().c_str()), match[3].str(), match[4].str());
+					models.push_back({ ModelType::Skin, std::atoi(match[2].str().c_str()), std::atoi(match[1].str().c_str()), match[3].str(), match[4].str() });
 				}
 				else if (std::regex_match(line, match, rAddSimpleModel))
 				{
-					addCustomModel(ModelType::Object, std::atoi(match[3].str().c_str()), std::atoi(match[2].str().c_str()), match[4].str(), match[5].str(), std::atoi(match[1].str().c_str()));
+					models.push_back({ ModelType::Object, std::atoi(match[3].str().c_str()), std::atoi(match[2].str().c_str()), match[4].str(), match[5].str(), std::atoi(match[1].str().c_str()) });
 				}
 				else if (std::regex_match(line, match, rAddSimpleModelTimed))
 				{
-					addCustomModel(ModelType::Object, std::atoi(match[3].str().c_str()), std::atoi(match[2].str().c_str()), match[4].str(), match[5].str(), std::atoi(match[1].str().c_str()), std::atoi(match[6].str().c_str()), std::atoi(match[7].str().c_str()));
+					models.push_back({ ModelType::Object, std::atoi(match[3].str().c_str()), std::atoi(match[2].str().c_str()), match[4].str(), match[5].str(), std::atoi(match[1].str().c_str()), static_cast<uint8_t>(std::atoi(match[6].str().c_str())), static_cast<uint8_t>(std::atoi(match[7].str().c_str())) });
 				}
 			}
+
+			// Read every file that isn't in the checksum cache up front, on several threads, rather
+			// than one at a time as each model is added.
+			DynamicArray<String> fileNames;
+			fileNames.reserve(models.size() * 2);
+			for (const ArtConfigModel& model : models)
+			{
+				fileNames.push_back(model.dffName);
+				fileNames.push_back(model.txdName);
+			}
+			fileChecksums.prepare(fileNames);
+
+			for (const ArtConfigModel& model : models)
+			{
+				addCustomModel(model.type, model.id, model.baseId, model.dffName, model.txdName, model.virtualWorld, model.timeOn, model.timeOff);
+			}
+			fileChecksums.save();
 		}
 	}
 
@@ -608,8 +648,8 @@ public:
 			return false;
 		}
 
-		ModelFile dff(modelsPath, dffName);
-		ModelFile txd(modelsPath, txdName);
+		ModelFile dff(fileChecksums, dffName);
+		ModelFile txd(fileChecksums, txdName);
 
 		if (!dff.size)
 		{
@@ -755,6 +795,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new CustomModelsComponent();
@@ -0,0 +1,133 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#include "database_checkpointer.hpp"
+#include <algorithm>
+
+DatabaseCheckpointer::~DatabaseCheckpointer()
+{
+	if (worker.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(entriesMutex);
+			stopping = true;
+		}
+		entriesSignal.notify_all();
+		worker.join();
+	}
+}
+
+/// Starts checkpointing a file, or checkpoints it more often if it already is
+/// @param path Database file path
+/// @param interval Time between checkpoints
+void DatabaseCheckpointer::add(StringView path, Milliseconds interval)
+{
+	{
+		std::lock_guard<std::mutex> lock(entriesMutex);
+		auto entry(std::find_if(entries.begin(), entries.end(), [path](const Entry& entry)
+			{
+				return StringView(entry.path) == path;
+			}));
+		if (entry == entries.end())
+		{
+			entries.push_back(Entry { String(path), interval, Time::now() + interval, 1 });
+		}
+		else
+		{
+			entry->interval = std::min(entry->interval, interval);
+			entry->due = std::min(entry->due, Time::now() + interval);
+			++entry->connections;
+		}
+	}
+	if (!worker.joinable())
+	{
+		worker = std::thread(&DatabaseCheckpointer::run, this);
+	}
+	entriesSignal.notify_one();
+}
+
+/// Stops checkpointing a file for one connection, the last one to go stops it for good
+/// @param path Database file path
+void DatabaseCheckpointer::remove(StringView path)
+{
+	{
+		std::lock_guard<std::mutex> lock(entriesMutex);
+		auto entry(std::find_if(entries.begin(), entries.end(), [path](const Entry& entry)
+			{
+				return StringView(entry.path) == path;
+			}));
+		if (entry == entries.end() || --entry->connections != 0)
+		{
+			return;
+		}
+		entries.erase(entry);
+	}
+	// Wake the worker so it closes its own handle to the file now, rather than on its next wake up.
+	entriesSignal.notify_one();
+}
+
+/// Runs checkpoints until stopped
+void DatabaseCheckpointer::run()
+{
+	// The worker's own connections, by file path.
+	FlatHashMap<String, sqlite3*> handles;
+	DynamicArray<String> due;
+	std::unique_lock<std::mutex> lock(entriesMutex);
+	while (!stopping)
+	{
+		const TimePoint now(Time::now());
+		TimePoint wake(now + Seconds(1));
+		due.clear();
+		for (Entry& entry : entries)
+		{
+			if (entry.due <= now)
+			{
+				due.push_back(entry.path);
+				entry.due = now + entry.interval;
+			}
+			wake = std::min(wake, entry.due);
+		}
+		for (auto handle(handles.begin()); handle != handles.end();)
+		{
+			const bool wanted(std::any_of(entries.begin(), entries.end(), [&handle](const Entry& entry)
+				{
+					return entry.path == handle->first;
+				}));
+			if (wanted)
+			{
+				++handle;
+			}
+			else
+			{
+				sqlite3_close_v2(handle->second);
+				handle = handles.erase(handle);
+			}
+		}
+		lock.unlock();
+
+		for (const String& path : due)
+		{
+			sqlite3*& handle(handles[path]);
+			if (handle == nullptr && sqlite3_open_v2(path.c_str(), &handle, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK)
+			{
+				// Tried again next time, the file may have been locked or moved for a moment.
+				sqlite3_close_v2(handle);
+				handles.erase(path);
+				continue;
+			}
+			sqlite3_wal_checkpoint_v2(handle, nullptr, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+		}
+
+		lock.lock();
+		entriesSignal.wait_until(lock, wake);
+	}
+	for (auto& handle : handles)
+	{
+		sqlite3_close_v2(handle.second);
+	}
+}
@@ -0,0 +1,63 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sqlite3.h>
+
+#include <sdk.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/// Checkpoints WAL databases from a worker thread.  The worker opens its own connection to each
+/// file and runs passive checkpoints, which never wait for readers or writers, so the connections
+/// used by the server are never held up.
+class DatabaseCheckpointer final : public NoCopy
+{
+private:
+	/// A database file to checkpoint
+	struct Entry
+	{
+		String path;
+		Milliseconds interval;
+		TimePoint due;
+		/// Number of connections to this file asking for checkpoints
+		unsigned int connections;
+	};
+
+	/// Worker thread, started by the first file
+	std::thread worker;
+
+	/// Guards "entries" and "stopping"
+	std::mutex entriesMutex;
+
+	/// Wakes the worker thread up
+	std::condition_variable entriesSignal;
+
+	/// Files to checkpoint
+	DynamicArray<Entry> entries;
+
+	/// Set when the worker should exit
+	bool stopping = false;
+
+	/// Runs checkpoints until stopped
+	void run();
+
+public:
+	~DatabaseCheckpointer();
+
+	/// Starts checkpointing a file, or checkpoints it more often if it already is
+	/// @param path Database file path
+	/// @param interval Time between checkpoints
+	void add(StringView path, Milliseconds interval);
+
+	/// Stops checkpointing a file for one connection, the last one to go stops it for good
+	/// @param path Database file path
+	void remove(StringView path);
+};
@@ -7,6 +7,51 @@
  */
 
 #include "databases_component.hpp"
+#include <algorithm>
+#include <cctype>
+
+/// Reads the next word of a statement, upper-cased, skipping the whitespace before it
+/// @param sql SQL text
+/// @param pos Where to start reading, moved past the word
+/// @returns The word, empty if there isn't one
+static String nextWord(StringView sql, std::size_t& pos)
+{
+	while (pos < sql.length() && std::isspace(static_cast<unsigned char>(sql[pos])))
+	{
+		++pos;
+	}
+	String word;
+	while (pos < sql.length() && (std::isalnum(static_cast<unsigned char>(sql[pos])) || sql[pos] == '_'))
+	{
+		word += static_cast<char>(std::toupper(static_cast<unsigned char>(sql[pos])));
+		++pos;
+	}
+	return word;
+}
+
+/// Checks whether the first statement of some SQL starts or ends a transaction, rolling back to a
+/// savepoint doesn't
+/// @param sql SQL text
+/// @returns "true" for "BEGIN", "COMMIT", "END" and "ROLLBACK", otherwise "false"
+static bool isTransactionStatement(StringView sql)
+{
+	std::size_t pos(0);
+	const String word(nextWord(sql, pos));
+	if (word == "BEGIN" || word == "COMMIT" || word == "END")
+	{
+		return true;
+	}
+	if (word != "ROLLBACK")
+	{
+		return false;
+	}
+	String next(nextWord(sql, pos));
+	if (next == "TRANSACTION")
+	{
+		next = nextWord(sql, pos);
+	}
+	return next != "TO";
+}
 
 DatabaseConnection::DatabaseConnection(DatabasesComponent* parentDatabasesComponent, sqlite3* databaseConnectionHandle)
 	: parentDatabasesComponent(parentDatabasesComponent)
@@ -14,6 +59,11 @@ DatabaseConnection::DatabaseConnection(DatabasesComponent* parentDatabasesCompon
 {
 }
 
+DatabaseConnection::~DatabaseConnection()
+{
+	close();
+}
+
 /// Gets its pool element ID
 /// @return Pool element ID
 int DatabaseConnection::getID() const
@@ -25,6 +75,32 @@ int DatabaseConnection::getID() const
 /// @returns "true" if connection has been successfully closed, otherwise "false"
 bool DatabaseConnection::close()
 {
+	if (asyncQueryWorker.joinable())
+	{
+		// Let the worker finish what has been queued, nothing that was sent should be lost.
+		{
+			std::lock_guard<std::mutex> lock(asyncQueriesMutex);
+			stoppingAsyncQueries = true;
+		}
+		asyncQueriesSignal.notify_all();
+		asyncQueryWorker.join();
+	}
+	if (groupTransactionOpen)
+	{
+		groupCommit = false;
+		flushGroupCommit();
+	}
+	if (!checkpointPath.empty())
+	{
+		parentDatabasesComponent->getCheckpointer().remove(checkpointPath);
+		checkpointPath.clear();
+	}
+	for (auto& cached : statementCache)
+	{
+		sqlite3_finalize(cached.second);
+	}
+	statementCache.clear();
+	statementCacheLookup.clear();
 	bool ret(databaseConnectionHandle != nullptr);
 	if (ret)
 	{
@@ -44,6 +120,7 @@ IDatabaseResultSet* DatabaseConnection::executeQuery(StringView query)
 	{
 		// TODO: Properly handle errors
 		parentDatabasesComponent->logQuery("[log_sqlite_queries]: %.*s", PRINT_VIEW(query));
+		beforeStatement(query);
 		if (sqlite3_exec(databaseConnectionHandle, query.data(), queryStepExecuted, ret, nullptr) != SQLITE_OK)
 		{
 			parentDatabasesComponent->log(LogLevel::Error, "[log_sqlite]: Error executing query.");
@@ -58,6 +135,266 @@ IDatabaseResultSet* DatabaseConnection::executeQuery(StringView query)
 	return ret;
 }
 
+/// Queues the specified query for the worker thread
+/// @param query Query to execute
+/// @param handler Gets the result on the main thread
+/// @returns "true" if the query has been queued, otherwise "false"
+bool DatabaseConnection::executeQueryAsync(StringView query, IDatabaseQueryHandler& handler)
+{
+	if (databaseConnectionHandle == nullptr)
+	{
+		return false;
+	}
+	// The worker would run it inside the transaction collecting the tick's writes, see "beforeStatement".
+	if (groupCommit && isTransactionStatement(query))
+	{
+		parentDatabasesComponent->log(LogLevel::Error, "[log_sqlite]: Transactions can't be started or ended asynchronously with group commit on.");
+		return false;
+	}
+	parentDatabasesComponent->logQuery("[log_sqlite_queries]: %.*s", PRINT_VIEW(query));
+	{
+		std::lock_guard<std::mutex> lock(asyncQueriesMutex);
+		asyncQueries.push_back(AsyncQuery { String(query), &handler });
+	}
+	if (!asyncQueryWorker.joinable())
+	{
+		asyncQueryWorker = std::thread(&DatabaseConnection::runAsyncQueries, this);
+	}
+	asyncQueriesSignal.notify_one();
+	return true;
+}
+
+/// Takes a statement from the cache, or compiles it if it isn't there
+/// @param sql SQL text of the statement
+/// @returns Statement handle, or "nullptr" if it didn't compile
+sqlite3_stmt* DatabaseConnection::acquireStatement(StringView sql)
+{
+	if (databaseConnectionHandle == nullptr)
+	{
+		return nullptr;
+	}
+	auto cached(statementCacheLookup.find(String(sql)));
+	if (cached != statementCacheLookup.end())
+	{
+		sqlite3_stmt* ret(cached->second->second);
+		statementCache.erase(cached->second);
+		statementCacheLookup.erase(cached);
+		return ret;
+	}
+	parentDatabasesComponent->logQuery("[log_sqlite_queries]: Preparing %.*s", PRINT_VIEW(sql));
+	sqlite3_stmt* ret(nullptr);
+	// Persistent tells SQLite the statement will be around for a while and used many times.
+	if (sqlite3_prepare_v3(databaseConnectionHandle, sql.data(), static_cast<int>(sql.length()), SQLITE_PREPARE_PERSISTENT, &ret, nullptr) != SQLITE_OK)
+	{
+		logError("Error preparing statement");
+		return nullptr;
+	}
+	// Only whitespace or a comment compiles to nothing.
+	return ret;
+}
+
+/// Resets a statement and puts it in the cache, finalizing the least recently used one if full
+/// @param sql SQL text of the statement
+/// @param statementHandle Statement handle
+void DatabaseConnection::releaseStatement(String sql, sqlite3_stmt* statementHandle)
+{
+	sqlite3_reset(statementHandle);
+	sqlite3_clear_bindings(statementHandle);
+	// The same SQL may have been prepared twice at once, one copy is enough.
+	if (databaseConnectionHandle == nullptr || statementCacheLookup.find(sql) != statementCacheLookup.end())
+	{
+		sqlite3_finalize(statementHandle);
+		return;
+	}
+	statementCache.emplace_front(sql, statementHandle);
+	statementCacheLookup.emplace(std::move(sql), statementCache.begin());
+	if (statementCache.size() > StatementCacheSize)
+	{
+		auto& oldest(statementCache.back());
+		sqlite3_finalize(oldest.second);
+		statementCacheLookup.erase(oldest.first);
+		statementCache.pop_back();
+	}
+}
+
+/// Logs an error along with SQLite's message for it
+/// @param what What failed
+void DatabaseConnection::logError(const char* what) const
+{
+	parentDatabasesComponent->log(LogLevel::Error, "[log_sqlite]: %s: %s", what, databaseConnectionHandle ? sqlite3_errmsg(databaseConnectionHandle) : "connection closed");
+}
+
+/// Changes how the connection talks to its file
+/// @param settings New settings
+/// @returns "true" if every setting has been applied, otherwise "false"
+bool DatabaseConnection::configure(const DatabaseSettings& settings)
+{
+	if (databaseConnectionHandle == nullptr)
+	{
+		return false;
+	}
+	// Pragma values can't be bound, so only plain words are let through.
+	const auto isWord = [](StringView value)
+	{
+		return std::all_of(value.begin(), value.end(), [](char c)
+			{
+				return std::isalnum(static_cast<unsigned char>(c)) != 0;
+			});
+	};
+	bool ret(true);
+	if (!settings.journalMode.empty())
+	{
+		if (isWord(settings.journalMode))
+		{
+			// The journal mode can't change inside a transaction.
+			if (groupTransactionOpen && exec("COMMIT"))
+			{
+				groupTransactionOpen = false;
+			}
+			ret = exec(("PRAGMA journal_mode = " + String(settings.journalMode)).c_str());
+		}
+		else
+		{
+			ret = false;
+		}
+	}
+	if (!settings.synchronous.empty())
+	{
+		ret = isWord(settings.synchronous) && exec(("PRAGMA synchronous = " + String(settings.synchronous)).c_str()) && ret;
+	}
+	if (settings.cacheSize != 0)
+	{
+		ret = exec(("PRAGMA cache_size = " + std::to_string(settings.cacheSize)).c_str()) && ret;
+	}
+	if (settings.mmapSize >= 0)
+	{
+		ret = exec(("PRAGMA mmap_size = " + std::to_string(settings.mmapSize)).c_str()) && ret;
+	}
+
+	groupCommit = settings.groupCommit;
+	flushGroupCommit();
+
+	// The requested journal mode may not have been possible, so check what it ended up as.
+	String journal_mode;
+	sqlite3_exec(
+		databaseConnectionHandle, "PRAGMA journal_mode", [](void* userData, int fieldCount, char** values, char** fieldNames)
+		{
+			if (fieldCount > 0 && values[0])
+			{
+				*static_cast<String*>(userData) = values[0];
+			}
+			return SQLITE_OK;
+		},
+		&journal_mode, nullptr);
+
+	if (!checkpointPath.empty())
+	{
+		parentDatabasesComponent->getCheckpointer().remove(checkpointPath);
+		checkpointPath.clear();
+	}
+	// In-memory and temporary databases have no file name, and nothing to checkpoint.
+	const char* path(sqlite3_db_filename(databaseConnectionHandle, "main"));
+	if (settings.checkpointInterval.count() > 0 && journal_mode == "wal" && path && *path)
+	{
+		checkpointPath = path;
+		parentDatabasesComponent->getCheckpointer().add(checkpointPath, settings.checkpointInterval);
+	}
+	// Commits stop checkpointing by themselves while the worker does it, 1000 pages is SQLite's default.
+	sqlite3_wal_autocheckpoint(databaseConnectionHandle, checkpointPath.empty() ? 1000 : 0);
+	return ret;
+}
+
+/// Commits the writes collected during the tick and starts collecting again
+void DatabaseConnection::flushGroupCommit()
+{
+	if (databaseConnectionHandle == nullptr)
+	{
+		return;
+	}
+	if (groupTransactionOpen)
+	{
+		// An error may have rolled the transaction back already.
+		if (sqlite3_get_autocommit(databaseConnectionHandle) || exec("COMMIT"))
+		{
+			groupTransactionOpen = false;
+		}
+		else
+		{
+			// Most likely busy because of another process, the writes are kept for the next tick.
+			return;
+		}
+	}
+	// Someone's own transaction is still open, collecting starts again once it has finished.
+	if (groupCommit && sqlite3_get_autocommit(databaseConnectionHandle))
+	{
+		// Deferred, so no lock is taken until the first statement of the tick.
+		groupTransactionOpen = exec("BEGIN");
+	}
+}
+
+/// Called before a statement runs on the main thread, commits the collected writes first if the
+/// statement starts or ends a transaction.  That way a "BEGIN" starts its own transaction, and a
+/// "COMMIT" or "ROLLBACK" without one fails as it would without group commit instead of acting on
+/// the collected writes
+/// @param sql SQL text of the statement
+void DatabaseConnection::beforeStatement(StringView sql)
+{
+	if (!groupTransactionOpen || !isTransactionStatement(sql))
+	{
+		return;
+	}
+	groupTransactionOpen = false;
+	if (!sqlite3_get_autocommit(databaseConnectionHandle))
+	{
+		exec("COMMIT");
+	}
+}
+
+/// Runs a statement that returns nothing useful, logging errors
+/// @param sql SQL text, null terminated
+/// @returns "true" if successful, otherwise "false"
+bool DatabaseConnection::exec(const char* sql)
+{
+	if (sqlite3_exec(databaseConnectionHandle, sql, nullptr, nullptr, nullptr) != SQLITE_OK)
+	{
+		parentDatabasesComponent->log(LogLevel::Error, "[log_sqlite]: Error executing \"%s\": %s", sql, sqlite3_errmsg(databaseConnectionHandle));
+		return false;
+	}
+	return true;
+}
+
+/// Runs queued queries until the connection closes
+void DatabaseConnection::runAsyncQueries()
+{
+	std::unique_lock<std::mutex> lock(asyncQueriesMutex);
+	for (;;)
+	{
+		asyncQueriesSignal.wait(lock, [this]()
+			{
+				return stoppingAsyncQueries || !asyncQueries.empty();
+			});
+		if (asyncQueries.empty())
+		{
+			return;
+		}
+		AsyncQuery query(std::move(asyncQueries.front()));
+		asyncQueries.pop_front();
+		lock.unlock();
+
+		// The rows are collected outside of the pool, which may only be touched on the main thread.
+		// SQLite serialises this against any synchronous queries on the same connection, which wait
+		// on the main thread for as long as this runs.
+		std::unique_ptr<DatabaseResultSet> result(new DatabaseResultSet());
+		if (sqlite3_exec(databaseConnectionHandle, query.query.c_str(), queryStepExecuted, result.get(), nullptr) != SQLITE_OK)
+		{
+			result.reset();
+		}
+		parentDatabasesComponent->completeAsyncQuery(*query.handler, std::move(result));
+
+		lock.lock();
+	}
+}
+
 /// Gets invoked when a query step has been performed
 /// @param userData User data
 /// @param fieldCount Field count
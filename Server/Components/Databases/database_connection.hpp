@@ -13,6 +13,12 @@
 
 #include "database_result_set.hpp"
 #include <Impl/pool_impl.hpp>
+#include <database_ext.hpp>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
 
 using namespace Impl;
 
@@ -27,9 +33,51 @@ private:
 	/// Database connection handle
 	sqlite3* databaseConnectionHandle;
 
+	/// A query waiting for the worker thread
+	struct AsyncQuery
+	{
+		String query;
+		IDatabaseQueryHandler* handler;
+	};
+
+	/// Worker thread running asynchronous queries, started by the first one
+	std::thread asyncQueryWorker;
+
+	/// Guards "asyncQueries" and "stoppingAsyncQueries"
+	std::mutex asyncQueriesMutex;
+
+	/// Wakes the worker thread up
+	std::condition_variable asyncQueriesSignal;
+
+	/// Asynchronous queries in the order they were issued
+	std::deque<AsyncQuery> asyncQueries;
+
+	/// Set when the connection closes, the worker exits once the queue is empty
+	bool stoppingAsyncQueries = false;
+
+	/// Number of freed statements kept for reuse
+	static constexpr std::size_t StatementCacheSize = 64;
+
+	/// Freed statements by SQL text, most recently used first
+	std::list<Pair<String, sqlite3_stmt*>> statementCache;
+
+	/// SQL text to its entry in "statementCache"
+	FlatHashMap<String, std::list<Pair<String, sqlite3_stmt*>>::iterator> statementCacheLookup;
+
+	/// Whether writes are collected into one transaction per tick
+	bool groupCommit = false;
+
+	/// Whether the transaction collecting writes is open
+	bool groupTransactionOpen = false;
+
+	/// File the background checkpoints are run on, empty if they aren't
+	String checkpointPath;
+
 public:
 	DatabaseConnection(DatabasesComponent* parentDatabasesComponent, sqlite3* databaseConnectionHandle);
 
+	~DatabaseConnection();
+
 	/// Gets its pool element ID
 	/// @return Pool element ID
 	int getID() const override;
@@ -44,7 +92,56 @@ public:
 	/// @returns Result set
 	IDatabaseResultSet* executeQuery(StringView query) override;
 
+	/// Queues the specified query for the worker thread
+	/// @param query Query to execute
+	/// @param handler Gets the result on the main thread
+	/// @returns "true" if the query has been queued, otherwise "false"
+	bool executeQueryAsync(StringView query, IDatabaseQueryHandler& handler);
+
+	/// Gets the component the connection belongs to
+	/// @returns Databases component
+	DatabasesComponent* getComponent() const
+	{
+		return parentDatabasesComponent;
+	}
+
+	/// Takes a statement from the cache, or compiles it if it isn't there
+	/// @param sql SQL text of the statement
+	/// @returns Statement handle, or "nullptr" if it didn't compile
+	sqlite3_stmt* acquireStatement(StringView sql);
+
+	/// Resets a statement and puts it in the cache, finalizing the least recently used one if full
+	/// @param sql SQL text of the statement
+	/// @param statementHandle Statement handle
+	void releaseStatement(String sql, sqlite3_stmt* statementHandle);
+
+	/// Logs an error along with SQLite's message for it
+	/// @param what What failed
+	void logError(const char* what) const;
+
+	/// Changes how the connection talks to its file
+	/// @param settings New settings
+	/// @returns "true" if every setting has been applied, otherwise "false"
+	bool configure(const DatabaseSettings& settings);
+
+	/// Commits the writes collected during the tick and starts collecting again
+	void flushGroupCommit();
+
+	/// Called before a statement runs on the main thread, commits the collected writes first if the
+	/// statement starts or ends a transaction
+	/// @param sql SQL text of the statement
+	void beforeStatement(StringView sql);
+
 private:
+	/// Runs a statement that returns nothing useful, logging errors
+	/// @param sql SQL text, null terminated
+	/// @returns "true" if successful, otherwise "false"
+	bool exec(const char* sql);
+
+	/// Runs queued queries until the connection closes
+	void runAsyncQueries();
+
+
 	/// Gets invoked when a query step has been performed
 	/// @param userData User data
 	/// @param fieldCount Field count
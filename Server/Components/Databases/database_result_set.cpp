@@ -6,55 +6,155 @@
  *  The original code is copyright (c) 2022, open.mp team and contributors.
  */
 
-#include "database_result_set.hpp"
+#include "database_connection.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
-/// Adds a row
+/// Gets the index of a field by its name
+/// @param fieldName Field name
+/// @returns Field index, or "fieldNames.size()" if there is no such field
+std::size_t DatabaseResultSet::findField(StringView fieldName) const
+{
+	// Results rarely have more than a handful of fields, a scan beats hashing the name.
+	std::size_t field_index(0);
+	while ((field_index < fieldNames.size()) && (StringView(fieldNames[field_index]) != fieldName))
+	{
+		++field_index;
+	}
+	return field_index;
+}
+
+/// Gets a value of the selected row
+/// @param fieldIndex Field index
+/// @returns The value, or "nullptr" if there is no row or no such field
+const char* DatabaseResultSet::getValue(std::size_t fieldIndex) const
+{
+	return ((currentRow < rowCount) && (fieldIndex < fieldNames.size())) ? (values.data() + valueOffsets[((currentRow - firstStoredRow) * fieldNames.size()) + fieldIndex]) : nullptr;
+}
+
+/// Replaces the stored row of a cursor with the next one from its statement
+/// @returns 1 if there was a row, 0 at the end and -1 on error, the statement is given back unless 1
+int DatabaseResultSet::readCursorRow()
+{
+	// Only one row is ever kept, so a cursor needs the same memory however many rows it reads.
+	values.clear();
+	valueOffsets.clear();
+	firstStoredRow = rowCount;
+	legacyDbResultOutdated = true;
+	int result(sqlite3_step(cursorStatement));
+	if (result == SQLITE_ROW)
+	{
+		const int field_count(sqlite3_column_count(cursorStatement));
+		DynamicArray<char*> row(static_cast<std::size_t>(field_count) * 2);
+		for (int field_index(0); field_index < field_count; field_index++)
+		{
+			row[field_index] = const_cast<char*>(sqlite3_column_name(cursorStatement, field_index));
+			row[field_count + field_index] = const_cast<char*>(reinterpret_cast<const char*>(sqlite3_column_text(cursorStatement, field_index)));
+		}
+		if (addRow(field_count, row.data(), row.data() + field_count))
+		{
+			return 1;
+		}
+		result = SQLITE_ABORT;
+	}
+	if (result != SQLITE_DONE)
+	{
+		cursorConnection->logError("Error reading cursor");
+	}
+	closeCursor();
+	return (result == SQLITE_DONE) ? 0 : -1;
+}
+
+/// Gives the statement of a cursor back to its connection
+void DatabaseResultSet::closeCursor()
+{
+	if (cursorStatement)
+	{
+		cursorConnection->releaseStatement(std::move(cursorSql), cursorStatement);
+		cursorStatement = nullptr;
+	}
+}
+
+/// Gives back the statement of an unfinished cursor
+DatabaseResultSet::~DatabaseResultSet()
+{
+	closeCursor();
+}
+
+/// Turns this empty result set into a cursor and reads the first row
+/// @param connection Connection the statement was prepared on
+/// @param sql SQL text of the statement
+/// @param statementHandle Statement handle, owned by the result set from here on
+/// @returns "true" if the first row or the end has been reached, "false" on error
+bool DatabaseResultSet::openCursor(DatabaseConnection& connection, String sql, sqlite3_stmt* statementHandle)
+{
+	cursorConnection = &connection;
+	cursorSql = std::move(sql);
+	cursorStatement = statementHandle;
+	return readCursorRow() >= 0;
+}
+
+/// Adds a row, the first one decides the field names
 /// @param fieldCount Field count
-/// @param values Field values
 /// @param fieldNames Field names
+/// @param values Field values
 /// @returns "true" if row has been successfully added, otherwise "false"
 bool DatabaseResultSet::addRow(int fieldCount, char** fieldNames, char** values)
 {
 	bool ret((fieldCount <= 0) || (values && fieldNames));
 	if (ret)
 	{
-
-		// First time DatabaseResultSet::addRow being called after query exeuction
-		// so push all field names back to our vector of char* so we are keeping data
-		// for using it in legacy database result structure
-		legacyDbResult.addColumns(fieldCount, fieldNames, values);
-
-		rows.push({});
-		DatabaseResultSetRow* result_set_row(&rows.back());
-		for (int field_index(0); field_index < fieldCount; field_index++)
+		const std::size_t field_count(static_cast<std::size_t>(std::max(fieldCount, 0)));
+		if (rowCount == 0)
 		{
-
-			// Push values in a row back to our vector of char*, keeping them and all rows
-			// in order for using it in legacy database result structure
-			legacyDbResult.addField(values[field_index]);
-
-			if (!result_set_row->addField(fieldNames[field_index], values[field_index] ? values[field_index] : ""))
+			this->fieldNames.clear();
+			this->fieldNames.reserve(field_count);
+			for (std::size_t field_index(0); field_index < field_count; field_index++)
 			{
-				ret = false;
-				break;
+				StringView field_name(fieldNames[field_index]);
+				if (findField(field_name) < this->fieldNames.size())
+				{
+					// Duplicate field names can't be told apart by name, so the result set is rejected.
+					this->fieldNames.clear();
+					return false;
+				}
+				this->fieldNames.emplace_back(field_name);
 			}
 		}
-		if (ret)
+		else if (field_count != this->fieldNames.size())
 		{
-			++rowCount;
+			return false;
 		}
-		else
+		for (std::size_t field_index(0); field_index < field_count; field_index++)
 		{
-			rows.pop();
+			const char* value(values[field_index] ? values[field_index] : "");
+			valueOffsets.push_back(this->values.size());
+			this->values.insert(this->values.end(), value, value + std::strlen(value) + 1);
 		}
-
-		// Now here we are assigning collected results in legacy structure to
-		// our LegacyDBResult::results
-		legacyDbResult.columns = rowCount;
+		++rowCount;
+		legacyDbResultOutdated = true;
 	}
 	return ret;
 }
 
+/// Takes over the rows of a result set that was filled outside of the pool
+/// @param other Result set to take the rows from, left empty
+void DatabaseResultSet::adopt(DatabaseResultSet& other)
+{
+	std::swap(fieldNames, other.fieldNames);
+	std::swap(values, other.values);
+	std::swap(valueOffsets, other.valueOffsets);
+	std::swap(rowCount, other.rowCount);
+	std::swap(currentRow, other.currentRow);
+	std::swap(legacyDbResult, other.legacyDbResult);
+	std::swap(legacyDbResultOutdated, other.legacyDbResultOutdated);
+	std::swap(firstStoredRow, other.firstStoredRow);
+	std::swap(cursorConnection, other.cursorConnection);
+	std::swap(cursorSql, other.cursorSql);
+	std::swap(cursorStatement, other.cursorStatement);
+}
+
 /// Gets its pool element ID
 /// @return Pool element ID
 int DatabaseResultSet::getID() const
@@ -62,7 +162,7 @@ int DatabaseResultSet::getID() const
 	return poolID;
 }
 
-/// Gets the number of rows
+/// Gets the number of rows, for a cursor only those read so far
 /// @returns Number of rows
 std::size_t DatabaseResultSet::getRowCount() const
 {
@@ -73,18 +173,22 @@ std::size_t DatabaseResultSet::getRowCount() const
 /// @returns "true" if next row has been selected successfully, otherwise "false"
 bool DatabaseResultSet::selectNextRow()
 {
-	if (!rows.empty())
+	if (currentRow < rowCount)
+	{
+		++currentRow;
+	}
+	if (cursorStatement && (currentRow == rowCount))
 	{
-		rows.pop();
+		readCursorRow();
 	}
-	return !rows.empty();
+	return currentRow < rowCount;
 }
 
 /// Gets the number of fields
 /// @returns Number of fields
 std::size_t DatabaseResultSet::getFieldCount() const
 {
-	return rows.empty() ? static_cast<std::size_t>(0) : rows.front().getFieldCount();
+	return (currentRow < rowCount) ? fieldNames.size() : static_cast<std::size_t>(0);
 }
 
 /// Is field name available
@@ -92,7 +196,7 @@ std::size_t DatabaseResultSet::getFieldCount() const
 /// @returns "true" if field name is available, otherwise "false"
 bool DatabaseResultSet::isFieldNameAvailable(StringView fieldName) const
 {
-	return !rows.empty() && rows.front().isFieldNameAvailable(fieldName);
+	return (currentRow < rowCount) && (findField(fieldName) < fieldNames.size());
 }
 
 /// Gets the name of the field by the specified field index
@@ -100,7 +204,7 @@ bool DatabaseResultSet::isFieldNameAvailable(StringView fieldName) const
 /// @returns Name of the field
 StringView DatabaseResultSet::getFieldName(std::size_t fieldIndex) const
 {
-	return rows.empty() ? StringView() : rows.front().getFieldName(fieldIndex);
+	return ((currentRow < rowCount) && (fieldIndex < fieldNames.size())) ? StringView(fieldNames[fieldIndex]) : StringView();
 }
 
 /// Gets the string of the field by the specified field index
@@ -108,7 +212,8 @@ StringView DatabaseResultSet::getFieldName(std::size_t fieldIndex) const
 /// @returns String
 StringView DatabaseResultSet::getFieldString(std::size_t fieldIndex) const
 {
-	return rows.empty() ? StringView() : rows.front().getFieldString(fieldIndex);
+	const char* value(getValue(fieldIndex));
+	return value ? StringView(value) : StringView();
 }
 
 /// Gets the integer of the field by the specified field index
@@ -116,7 +221,8 @@ StringView DatabaseResultSet::getFieldString(std::size_t fieldIndex) const
 /// @returns Integer
 long DatabaseResultSet::getFieldInt(std::size_t fieldIndex) const
 {
-	return rows.empty() ? 0L : rows.front().getFieldInt(fieldIndex);
+	const char* value(getValue(fieldIndex));
+	return value ? std::atol(value) : 0L;
 }
 
 /// Gets the floating point number of the field by the specified field index
@@ -124,7 +230,8 @@ long DatabaseResultSet::getFieldInt(std::size_t fieldIndex) const
 /// @returns Floating point number
 double DatabaseResultSet::getFieldFloat(std::size_t fieldIndex) const
 {
-	return rows.empty() ? 0.0 : rows.front().getFieldFloat(fieldIndex);
+	const char* value(getValue(fieldIndex));
+	return value ? std::atof(value) : 0.0;
 }
 
 /// Gets the string of the field by the specified field name
@@ -132,7 +239,7 @@ double DatabaseResultSet::getFieldFloat(std::size_t fieldIndex) const
 /// @returns String
 StringView DatabaseResultSet::getFieldStringByName(StringView fieldName) const
 {
-	return rows.empty() ? StringView() : rows.front().getFieldStringByName(fieldName);
+	return getFieldString(findField(fieldName));
 }
 
 /// Gets the integer of the field by the specified field name
@@ -140,7 +247,7 @@ StringView DatabaseResultSet::getFieldStringByName(StringView fieldName) const
 /// @returns Integer
 long DatabaseResultSet::getFieldIntByName(StringView fieldName) const
 {
-	return rows.empty() ? 0L : rows.front().getFieldIntByName(fieldName);
+	return getFieldInt(findField(fieldName));
 }
 
 /// Gets the floating point number of the field by the specified field name
@@ -148,11 +255,18 @@ long DatabaseResultSet::getFieldIntByName(StringView fieldName) const
 /// @returns Floating point number
 double DatabaseResultSet::getFieldFloatByName(StringView fieldName) const
 {
-	return rows.empty() ? 0.0 : rows.front().getFieldFloatByName(fieldName);
+	return getFieldFloat(findField(fieldName));
 }
 
 /// Gets database results in legacy structure
 LegacyDBResult& DatabaseResultSet::getLegacyDBResult()
 {
+	// Built on demand as the value storage moves while rows are being added; once built, the
+	// pointers stay valid for as long as the result set lives, or until a cursor moves on.
+	if (legacyDbResultOutdated)
+	{
+		legacyDbResult.update(rowCount - firstStoredRow, fieldNames, values, valueOffsets);
+		legacyDbResultOutdated = false;
+	}
 	return legacyDbResult;
 }
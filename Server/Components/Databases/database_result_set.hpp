@@ -8,37 +8,36 @@
 
 #pragma once
 
-#include "database_result_set_row.hpp"
+#include <Server/Components/Databases/databases.hpp>
 #include <Impl/pool_impl.hpp>
-#include <queue>
 
 using namespace Impl;
 
+struct sqlite3_stmt;
+class DatabaseConnection;
+
 class LegacyDBResultImpl : public LegacyDBResult
 {
 private:
 	// Extra members to be used in open.mp code
 	DynamicArray<char*> results_;
-	bool fieldsAreAdded = false;
 
 public:
-	void addColumns(int fieldCount, char** fieldNames, char** values)
+	/// Points the legacy structure at a result set's storage: the field names, then every value
+	/// of every row.  Must be redone whenever that storage may have moved.
+	void update(std::size_t rowCount, const DynamicArray<String>& fieldNames, DynamicArray<char>& values, const DynamicArray<std::size_t>& valueOffsets)
 	{
-		if (!fieldsAreAdded)
+		results_.clear();
+		results_.reserve(fieldNames.size() + valueOffsets.size());
+		for (const String& field_name : fieldNames)
 		{
-			for (int field_index(0); field_index < fieldCount; field_index++)
-			{
-				results_.push_back(fieldNames[field_index]);
-			}
-			columns = fieldCount;
-			fieldsAreAdded = true;
+			results_.push_back(const_cast<char*>(field_name.c_str()));
 		}
-		results = results_.data();
-	}
-
-	void addField(char* value)
-	{
-		results_.push_back(const_cast<char*>(value ? value : ""));
+		for (std::size_t offset : valueOffsets)
+		{
+			results_.push_back(values.data() + offset);
+		}
+		columns = static_cast<int>(rowCount);
 		results = results_.data();
 	}
 };
@@ -46,28 +45,93 @@ public:
 class DatabaseResultSet final : public IDatabaseResultSet, public PoolIDProvider, public NoCopy
 {
 private:
-	/// Rows
-	std::queue<DatabaseResultSetRow> rows;
+	/// Field names, shared by every row
+	DynamicArray<String> fieldNames;
+
+	/// Every value of every row, each one null terminated, one row after the other
+	DynamicArray<char> values;
+
+	/// Where each value starts in "values", "fieldNames.size()" entries per row
+	DynamicArray<std::size_t> valueOffsets;
 
 	/// Number of rows
-	std::size_t rowCount;
+	std::size_t rowCount = 0;
+
+	/// Index of the selected row
+	std::size_t currentRow = 0;
+
+	/// Index of the first row still in "values", rows before it have been dropped by a cursor
+	std::size_t firstStoredRow = 0;
+
+	/// Connection of a cursor, its statement goes back to the connection's cache when done
+	DatabaseConnection* cursorConnection = nullptr;
+
+	/// SQL text of a cursor
+	String cursorSql;
+
+	/// Statement a cursor reads its rows from, "nullptr" once all of them have been read
+	sqlite3_stmt* cursorStatement = nullptr;
 
 	/// Legacy database result to allow libraries access members of this structure from pawn (don't even ask)
 	LegacyDBResultImpl legacyDbResult;
 
+	/// Whether rows have been added since the legacy database result was last built
+	bool legacyDbResultOutdated = false;
+
+	/// Gets the index of a field by its name
+	/// @param fieldName Field name
+	/// @returns Field index, or "fieldNames.size()" if there is no such field
+	std::size_t findField(StringView fieldName) const;
+
+	/// Gets a value of the selected row
+	/// @param fieldIndex Field index
+	/// @returns The value, or "nullptr" if there is no row or no such field
+	const char* getValue(std::size_t fieldIndex) const;
+
+	/// Replaces the stored row of a cursor with the next one from its statement
+	/// @returns 1 if there was a row, 0 at the end and -1 on error, the statement is given back unless 1
+	int readCursorRow();
+
+	/// Gives the statement of a cursor back to its connection
+	void closeCursor();
+
 public:
-	/// Adds a row
+	DatabaseResultSet() = default;
+
+	/// Gives back the statement of an unfinished cursor
+	~DatabaseResultSet();
+
+	/// Turns this empty result set into a cursor and reads the first row
+	/// @param connection Connection the statement was prepared on
+	/// @param sql SQL text of the statement
+	/// @param statementHandle Statement handle, owned by the result set from here on
+	/// @returns "true" if the first row or the end has been reached, "false" on error
+	bool openCursor(DatabaseConnection& connection, String sql, sqlite3_stmt* statementHandle);
+
+	/// Is this result set a cursor that still has rows to read
+	/// @param connection Only if it is reading from this connection, unless "nullptr"
+	/// @returns "true" if it is, otherwise "false"
+	bool isOpenCursor(const DatabaseConnection* connection) const
+	{
+		return cursorStatement && (!connection || (cursorConnection == connection));
+	}
+
+	/// Adds a row, the first one decides the field names
 	/// @param fieldCount Field count
-	/// @param values Field values
 	/// @param fieldNames Field names
+	/// @param values Field values
 	/// @returns "true" if row has been successfully added, otherwise "false"
-	bool addRow(int fieldCount, char** values, char** fieldNames);
+	bool addRow(int fieldCount, char** fieldNames, char** values);
+
+	/// Takes over the rows of a result set that was filled outside of the pool
+	/// @param other Result set to take the rows from, left empty
+	void adopt(DatabaseResultSet& other);
 
 	/// Gets its pool element ID
 	/// @return Pool element ID
 	int getID() const override;
 
-	/// Gets the number of rows
+	/// Gets the number of rows, for a cursor only those read so far
 	/// @returns Number of rows
 	std::size_t getRowCount() const override;
 
@@ -0,0 +1,163 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#include "databases_component.hpp"
+
+DatabaseStatement::DatabaseStatement(DatabaseConnection* connection, String sql, sqlite3_stmt* statementHandle)
+	: connection(connection)
+	, sql(std::move(sql))
+	, statementHandle(statementHandle)
+{
+}
+
+/// Returns the statement to the connection's cache
+DatabaseStatement::~DatabaseStatement()
+{
+	connection->releaseStatement(std::move(sql), statementHandle);
+}
+
+/// Gets its pool element ID
+/// @return Pool element ID
+int DatabaseStatement::getID() const
+{
+	return poolID;
+}
+
+bool DatabaseStatement::bindInt(int index, int64_t value)
+{
+	return sqlite3_bind_int64(statementHandle, index, value) == SQLITE_OK;
+}
+
+bool DatabaseStatement::bindFloat(int index, double value)
+{
+	return sqlite3_bind_double(statementHandle, index, value) == SQLITE_OK;
+}
+
+bool DatabaseStatement::bindText(int index, StringView value)
+{
+	return sqlite3_bind_text(statementHandle, index, value.data(), static_cast<int>(value.length()), SQLITE_TRANSIENT) == SQLITE_OK;
+}
+
+bool DatabaseStatement::bindBlob(int index, Span<const char> value)
+{
+	return sqlite3_bind_blob(statementHandle, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT) == SQLITE_OK;
+}
+
+bool DatabaseStatement::bindNull(int index)
+{
+	return sqlite3_bind_null(statementHandle, index) == SQLITE_OK;
+}
+
+/// Runs the statement up to the next row
+/// @returns 1 if there is a row, 0 once the statement is done, -1 on error
+int DatabaseStatement::step()
+{
+	connection->beforeStatement(sql);
+	switch (sqlite3_step(statementHandle))
+	{
+	case SQLITE_ROW:
+		return 1;
+	case SQLITE_DONE:
+		return 0;
+	default:
+		connection->logError("Error executing statement");
+		return -1;
+	}
+}
+
+/// Rewinds the statement, bound parameters are kept
+/// @returns "true" if the statement has been successfully reset, otherwise "false"
+bool DatabaseStatement::reset()
+{
+	// This returns the error of the last step, which has already been reported.
+	sqlite3_reset(statementHandle);
+	return true;
+}
+
+/// Steps the statement to the end, collecting every row, and resets it
+/// @returns Result set, or "nullptr" on error
+IDatabaseResultSet* DatabaseStatement::execute()
+{
+	DatabasesComponent* component(connection->getComponent());
+	DatabaseResultSet* ret(static_cast<DatabaseResultSet*>(component->createResultSet()));
+	if (!ret)
+	{
+		component->log(LogLevel::Error, "[log_sqlite]: Could not create SQLite result set.");
+		return nullptr;
+	}
+	component->logQuery("[log_sqlite_queries]: %.*s", PRINT_VIEW(sql));
+	connection->beforeStatement(sql);
+	DynamicArray<char*> names;
+	DynamicArray<char*> values;
+	int result;
+	while ((result = sqlite3_step(statementHandle)) == SQLITE_ROW)
+	{
+		const int field_count(sqlite3_column_count(statementHandle));
+		names.resize(field_count);
+		values.resize(field_count);
+		for (int field_index(0); field_index < field_count; field_index++)
+		{
+			names[field_index] = const_cast<char*>(sqlite3_column_name(statementHandle, field_index));
+			values[field_index] = const_cast<char*>(reinterpret_cast<const char*>(sqlite3_column_text(statementHandle, field_index)));
+		}
+		if (!ret->addRow(field_count, names.data(), values.data()))
+		{
+			result = SQLITE_ABORT;
+			break;
+		}
+	}
+	sqlite3_reset(statementHandle);
+	if (result != SQLITE_DONE)
+	{
+		connection->logError("Error executing statement");
+		component->freeResultSet(*ret);
+		ret = nullptr;
+	}
+	return ret;
+}
+
+/// Gets the number of columns in the current row
+/// @returns Number of columns
+int DatabaseStatement::getColumnCount() const
+{
+	return sqlite3_data_count(statementHandle);
+}
+
+/// Gets the name of a column
+/// @param column Column index
+/// @returns Name of the column
+StringView DatabaseStatement::getColumnName(int column) const
+{
+	const char* name(sqlite3_column_name(statementHandle, column));
+	return name ? StringView(name) : StringView();
+}
+
+/// Gets a column of the current row as an integer
+/// @param column Column index
+/// @returns Integer
+int64_t DatabaseStatement::getColumnInt(int column) const
+{
+	return sqlite3_column_int64(statementHandle, column);
+}
+
+/// Gets a column of the current row as a floating point number
+/// @param column Column index
+/// @returns Floating point number
+double DatabaseStatement::getColumnFloat(int column) const
+{
+	return sqlite3_column_double(statementHandle, column);
+}
+
+/// Gets a column of the current row as a string, valid until the statement is stepped again
+/// @param column Column index
+/// @returns String
+StringView DatabaseStatement::getColumnText(int column) const
+{
+	const char* text(reinterpret_cast<const char*>(sqlite3_column_text(statementHandle, column)));
+	return text ? StringView(text, sqlite3_column_bytes(statementHandle, column)) : StringView();
+}
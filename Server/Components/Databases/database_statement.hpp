@@ -0,0 +1,94 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sqlite3.h>
+
+#include <Impl/pool_impl.hpp>
+#include <database_ext.hpp>
+
+using namespace Impl;
+
+class DatabaseConnection;
+
+class DatabaseStatement final : public IDatabaseStatement, public PoolIDProvider, public NoCopy
+{
+private:
+	/// Connection the statement was prepared on, it goes back to its cache when freed
+	DatabaseConnection* connection;
+
+	/// SQL text, the key in the connection's cache
+	String sql;
+
+	/// Statement handle
+	sqlite3_stmt* statementHandle;
+
+public:
+	DatabaseStatement(DatabaseConnection* connection, String sql, sqlite3_stmt* statementHandle);
+
+	/// Returns the statement to the connection's cache
+	~DatabaseStatement();
+
+	/// Gets the connection the statement was prepared on
+	/// @returns Database connection
+	DatabaseConnection* getConnection() const
+	{
+		return connection;
+	}
+
+	/// Gets its pool element ID
+	/// @return Pool element ID
+	int getID() const override;
+
+	bool bindInt(int index, int64_t value) override;
+
+	bool bindFloat(int index, double value) override;
+
+	bool bindText(int index, StringView value) override;
+
+	bool bindBlob(int index, Span<const char> value) override;
+
+	bool bindNull(int index) override;
+
+	/// Runs the statement up to the next row
+	/// @returns 1 if there is a row, 0 once the statement is done, -1 on error
+	int step() override;
+
+	/// Rewinds the statement, bound parameters are kept
+	/// @returns "true" if the statement has been successfully reset, otherwise "false"
+	bool reset() override;
+
+	/// Steps the statement to the end, collecting every row, and resets it
+	/// @returns Result set, or "nullptr" on error
+	IDatabaseResultSet* execute() override;
+
+	/// Gets the number of columns in the current row
+	/// @returns Number of columns
+	int getColumnCount() const override;
+
+	/// Gets the name of a column
+	/// @param column Column index
+	/// @returns Name of the column
+	StringView getColumnName(int column) const override;
+
+	/// Gets a column of the current row as an integer
+	/// @param column Column index
+	/// @returns Integer
+	int64_t getColumnInt(int column) const override;
+
+	/// Gets a column of the current row as a floating point number
+	/// @param column Column index
+	/// @returns Floating point number
+	double getColumnFloat(int column) const override;
+
+	/// Gets a column of the current row as a string, valid until the statement is stepped again
+	/// @param column Column index
+	/// @returns String
+	StringView getColumnText(int column) const override;
+};
@@ -9,9 +9,32 @@
 #include "databases_component.hpp"
 
 DatabasesComponent::DatabasesComponent()
+	: extension(*this)
 {
 }
 
+DatabasesComponent::~DatabasesComponent()
+{
+	if (core_)
+	{
+		core_->getEventDispatcher().removeEventHandler(this);
+	}
+	// Statements have to be finalized before their connections can close.
+	freeStatements(nullptr);
+	freeCursors(nullptr);
+	// Stop the workers while everything they report to is still there.
+	for (IDatabaseConnection* connection : databaseConnections.entries())
+	{
+		connection->close();
+	}
+	// The workers are gone, so nothing more arrives.  Fail what wasn't delivered to free its handler.
+	for (CompletedQuery& completed : completedQueries)
+	{
+		completed.handler->onQueryResult(nullptr);
+	}
+	completedQueries.clear();
+}
+
 /// Creates a  result set
 /// @returns Result set if successful, otherwise "nullptr"
 IDatabaseResultSet* DatabasesComponent::createResultSet()
@@ -28,6 +51,179 @@ void DatabasesComponent::onLoad(ICore* c)
 	core_ = c;
 	logSQLite_ = core_->getConfig().getBool("logging.log_sqlite");
 	logSQLiteQueries_ = core_->getConfig().getBool("logging.log_sqlite_queries");
+	IConfig& config(core_->getConfig());
+	defaultJournalMode = String(config.getString("sqlite.journal_mode"));
+	defaultSynchronous = String(config.getString("sqlite.synchronous"));
+	defaultSettings.journalMode = defaultJournalMode;
+	defaultSettings.synchronous = defaultSynchronous;
+	defaultSettings.cacheSize = *config.getInt("sqlite.cache_size");
+	defaultSettings.mmapSize = *config.getInt("sqlite.mmap_size");
+	defaultSettings.groupCommit = *config.getBool("sqlite.group_commit");
+	defaultSettings.checkpointInterval = Milliseconds(*config.getInt("sqlite.checkpoint_interval"));
+	core_->getEventDispatcher().addEventHandler(this);
+}
+
+/// Fills in the config options of new connections
+void DatabasesComponent::provideConfiguration(ILogger& logger, IEarlyConfig& config, bool defaults)
+{
+	// Everything defaults to leaving SQLite's own settings alone.
+	if (defaults || config.getType("sqlite.journal_mode") == ConfigOptionType_None)
+	{
+		config.setString("sqlite.journal_mode", "");
+	}
+	if (defaults || config.getType("sqlite.synchronous") == ConfigOptionType_None)
+	{
+		config.setString("sqlite.synchronous", "");
+	}
+	if (defaults || config.getType("sqlite.cache_size") == ConfigOptionType_None)
+	{
+		config.setInt("sqlite.cache_size", 0);
+	}
+	if (defaults || config.getType("sqlite.mmap_size") == ConfigOptionType_None)
+	{
+		config.setInt("sqlite.mmap_size", -1);
+	}
+	if (defaults || config.getType("sqlite.group_commit") == ConfigOptionType_None)
+	{
+		config.setBool("sqlite.group_commit", false);
+	}
+	if (defaults || config.getType("sqlite.checkpoint_interval") == ConfigOptionType_None)
+	{
+		config.setInt("sqlite.checkpoint_interval", 0);
+	}
+}
+
+/// Commits the writes collected during the tick and delivers finished asynchronous queries
+void DatabasesComponent::onTick(Microseconds elapsed, TimePoint now)
+{
+	for (IDatabaseConnection* connection : databaseConnections.entries())
+	{
+		static_cast<DatabaseConnection*>(connection)->flushGroupCommit();
+	}
+	{
+		std::lock_guard<std::mutex> lock(completedQueriesMutex);
+		if (completedQueries.empty())
+		{
+			return;
+		}
+		std::swap(completedQueries, deliveredQueries);
+	}
+	for (CompletedQuery& completed : deliveredQueries)
+	{
+		IDatabaseResultSet* ret(nullptr);
+		if (completed.result)
+		{
+			DatabaseResultSet* result_set(static_cast<DatabaseResultSet*>(createResultSet()));
+			if (result_set)
+			{
+				result_set->adopt(*completed.result);
+				ret = result_set;
+			}
+			else
+			{
+				log(LogLevel::Error, "[log_sqlite]: Could not create SQLite result set.");
+			}
+		}
+		else
+		{
+			log(LogLevel::Error, "[log_sqlite]: Error executing query.");
+		}
+		completed.handler->onQueryResult(ret);
+	}
+	deliveredQueries.clear();
+}
+
+/// Hands a finished asynchronous query over to the main thread, may be called from any thread
+/// @param handler Handler of the query
+/// @param result Rows of the query, or "nullptr" if it failed
+void DatabasesComponent::completeAsyncQuery(IDatabaseQueryHandler& handler, std::unique_ptr<DatabaseResultSet> result)
+{
+	std::lock_guard<std::mutex> lock(completedQueriesMutex);
+	completedQueries.push_back(CompletedQuery { &handler, std::move(result) });
+}
+
+/// Prepares a statement on a connection
+/// @param connection Database connection
+/// @param sql SQL text of the statement
+/// @returns Statement if successful, otherwise "nullptr"
+IDatabaseStatement* DatabasesComponent::prepare(DatabaseConnection& connection, StringView sql)
+{
+	sqlite3_stmt* statement_handle(connection.acquireStatement(sql));
+	if (!statement_handle)
+	{
+		return nullptr;
+	}
+	DatabaseStatement* ret(databaseStatements.emplace(&connection, String(sql), statement_handle));
+	if (!ret)
+	{
+		log(LogLevel::Error, "[log_sqlite]: Could not create SQLite statement.");
+		connection.releaseStatement(String(sql), statement_handle);
+	}
+	return ret;
+}
+
+/// Starts a query whose rows are read one at a time as the result set moves on
+/// @param connection Database connection
+/// @param sql SQL text of the query
+/// @returns Result set if successful, otherwise "nullptr"
+IDatabaseResultSet* DatabasesComponent::openCursor(DatabaseConnection& connection, StringView sql)
+{
+	sqlite3_stmt* statement_handle(connection.acquireStatement(sql));
+	if (!statement_handle)
+	{
+		return nullptr;
+	}
+	DatabaseResultSet* ret(static_cast<DatabaseResultSet*>(createResultSet()));
+	if (!ret)
+	{
+		log(LogLevel::Error, "[log_sqlite]: Could not create SQLite result set.");
+		connection.releaseStatement(String(sql), statement_handle);
+		return nullptr;
+	}
+	logQuery("[log_sqlite_queries]: %.*s", PRINT_VIEW(sql));
+	connection.beforeStatement(sql);
+	if (!ret->openCursor(connection, String(sql), statement_handle))
+	{
+		freeResultSet(*ret);
+		ret = nullptr;
+	}
+	return ret;
+}
+
+/// Frees the statements prepared on a connection, or on every connection if "nullptr"
+/// @param connection Database connection
+void DatabasesComponent::freeStatements(DatabaseConnection* connection)
+{
+	DynamicArray<int> ids;
+	for (IDatabaseStatement* statement : databaseStatements.entries())
+	{
+		if (!connection || static_cast<DatabaseStatement*>(statement)->getConnection() == connection)
+		{
+			ids.push_back(statement->getID());
+		}
+	}
+	for (int id : ids)
+	{
+		databaseStatements.remove(id);
+	}
+}
+
+/// Frees the cursors still reading from a connection, or from every connection if "nullptr"
+/// @param connection Database connection
+void DatabasesComponent::freeCursors(DatabaseConnection* connection)
+{
+	DynamicArray<int> ids;
+	for (IDatabaseResultSet* result_set : databaseResultSets.entries())
+	{
+		if (static_cast<DatabaseResultSet*>(result_set)->isOpenCursor(connection))
+		{
+			ids.push_back(result_set->getID());
+		}
+	}
+	for (int id : ids)
+	{
+		databaseResultSets.remove(id);
+	}
 }
 
 /// To optionally log things from connections.
@@ -64,12 +260,18 @@ IDatabaseConnection* DatabasesComponent::open(StringView path, int flags)
 		// Defaults.
 		flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
 	}
+	// Asynchronous queries share the handle with the main thread, which is only safe in serialized mode.
+	flags = (flags & ~SQLITE_OPEN_NOMUTEX) | SQLITE_OPEN_FULLMUTEX;
 	DatabaseConnection* ret(nullptr);
 	sqlite3* database_connection_handle(nullptr);
 	if (sqlite3_open_v2(path.data(), &database_connection_handle, flags, nullptr) == SQLITE_OK)
 	{
 		ret = databaseConnections.emplace(this, database_connection_handle);
-		if (!ret)
+		if (ret)
+		{
+			ret->configure(defaultSettings);
+		}
+		else
 		{
 			sqlite3_close_v2(database_connection_handle);
 		}
@@ -86,6 +288,8 @@ bool DatabasesComponent::close(IDatabaseConnection& connection)
 	DatabaseConnection* res = databaseConnections.get(database_connection_index);
 	if (res)
 	{
+		freeStatements(res);
+		freeCursors(res);
 		res->close();
 		databaseConnections.remove(database_connection_index);
 		return true;
@@ -8,14 +8,70 @@
 
 #pragma once
 
+#include "database_checkpointer.hpp"
 #include "database_connection.hpp"
+#include "database_statement.hpp"
 #include <Impl/pool_impl.hpp>
+#include <memory>
 
 using namespace Impl;
 
-class DatabasesComponent final : public IDatabasesComponent, public NoCopy
+class DatabasesComponent final : public IDatabasesComponent, public CoreEventHandler, public NoCopy
 {
 private:
+	/// Exposes the features that don't fit the SDK interfaces
+	struct Extension final : public IDatabasesExtension
+	{
+		DatabasesComponent& component;
+
+		Extension(DatabasesComponent& component)
+			: component(component)
+		{
+		}
+
+		bool executeQueryAsync(IDatabaseConnection& connection, StringView query, IDatabaseQueryHandler& handler) override
+		{
+			return static_cast<DatabaseConnection&>(connection).executeQueryAsync(query, handler);
+		}
+
+		IDatabaseStatement* prepare(IDatabaseConnection& connection, StringView sql) override
+		{
+			return component.prepare(static_cast<DatabaseConnection&>(connection), sql);
+		}
+
+		IDatabaseStatement* getStatement(int id) override
+		{
+			return component.databaseStatements.get(id);
+		}
+
+		bool freeStatement(IDatabaseStatement& statement) override
+		{
+			return component.databaseStatements.remove(statement.getID()).first;
+		}
+
+		IDatabaseResultSet* executeQueryCursor(IDatabaseConnection& connection, StringView sql) override
+		{
+			return component.openCursor(static_cast<DatabaseConnection&>(connection), sql);
+		}
+
+		bool configure(IDatabaseConnection& connection, const DatabaseSettings& settings) override
+		{
+			return static_cast<DatabaseConnection&>(connection).configure(settings);
+		}
+	};
+
+	/// An asynchronous query that has finished and waits for the main thread
+	struct CompletedQuery
+	{
+		IDatabaseQueryHandler* handler;
+		std::unique_ptr<DatabaseResultSet> result;
+	};
+
+	Extension extension;
+
+	/// Runs WAL checkpoints off the main thread, outlives the connections using it
+	DatabaseCheckpointer checkpointer;
+
 	/// Database connections
 	/// TODO: Replace with a pool type that grows dynamically
 	DynamicPoolStorage<DatabaseConnection, IDatabaseConnection, 1, 1025> databaseConnections;
@@ -24,10 +80,37 @@ private:
 	/// TODO: Replace with a pool type that grows dynamically
 	DynamicPoolStorage<DatabaseResultSet, IDatabaseResultSet, 1, 2049> databaseResultSets;
 
+	/// Prepared statements
+	DynamicPoolStorage<DatabaseStatement, IDatabaseStatement, 1, 4097> databaseStatements;
+
 	bool* logSQLite_;
 	bool* logSQLiteQueries_;
 
-	ICore* core_;
+	ICore* core_ = nullptr;
+
+	/// Settings new connections start with, from the config
+	DatabaseSettings defaultSettings;
+
+	/// Storage for the strings in "defaultSettings"
+	String defaultJournalMode;
+	String defaultSynchronous;
+
+	/// Guards "completedQueries", which is filled by the connections' worker threads
+	std::mutex completedQueriesMutex;
+
+	/// Finished asynchronous queries
+	DynamicArray<CompletedQuery> completedQueries;
+
+	/// Frees the statements prepared on a connection, or on every connection if "nullptr"
+	/// @param connection Database connection
+	void freeStatements(DatabaseConnection* connection);
+
+	/// Frees the cursors still reading from a connection, or from every connection if "nullptr"
+	/// @param connection Database connection
+	void freeCursors(DatabaseConnection* connection);
+
+	/// Completed queries being delivered, kept to reuse its storage
+	DynamicArray<CompletedQuery> deliveredQueries;
 
 public:
 	/// Creates a result set
@@ -36,6 +119,8 @@ public:
 
 	DatabasesComponent();
 
+	~DatabasesComponent();
+
 	/// Gets the component name
 	/// @returns Component name
 	StringView componentName() const override
@@ -62,6 +147,46 @@ public:
 	/// Should NOT be used for interacting with other components as they might not have been initialised yet
 	void onLoad(ICore* c) override;
 
+	/// Fills in the config options of new connections
+	void provideConfiguration(ILogger& logger, IEarlyConfig& config, bool defaults) override;
+
+	/// Commits the writes collected during the tick and delivers finished asynchronous queries
+	void onTick(Microseconds elapsed, TimePoint now) override;
+
+	/// Queries an extension of this component
+	IExtension* getExtension(UID id) override
+	{
+		if (id == IDatabasesExtension::ExtensionIID)
+		{
+			return &extension;
+		}
+		return nullptr;
+	}
+
+	/// Hands a finished asynchronous query over to the main thread, may be called from any thread
+	/// @param handler Handler of the query
+	/// @param result Rows of the query, or "nullptr" if it failed
+	void completeAsyncQuery(IDatabaseQueryHandler& handler, std::unique_ptr<DatabaseResultSet> result);
+
+	/// Gets the background checkpoint runner
+	/// @returns Checkpointer
+	DatabaseCheckpointer& getCheckpointer()
+	{
+		return checkpointer;
+	}
+
+	/// Prepares a statement on a connection
+	/// @param connection Database connection
+	/// @param sql SQL text of the statement
+	/// @returns Statement if successful, otherwise "nullptr"
+	IDatabaseStatement* prepare(DatabaseConnection& connection, StringView sql);
+
+	/// Starts a query whose rows are read one at a time as the result set moves on
+	/// @param connection Database connection
+	/// @param sql SQL text of the query
+	/// @returns Result set if successful, otherwise "nullptr"
+	IDatabaseResultSet* openCursor(DatabaseConnection& connection, StringView sql);
+
 	/// Opens a new database connection
 	/// @param path Path to the database
 	/// @param outDatabaseConnectionID Database connection ID (out)
@@ -55,6 +55,14 @@ struct DatabasesTestComponent final : public IComponent, public NoCopy
 	/// Should be used for interacting with other components or any more complex logic
 	/// @param components Tcomponentgins list to query
 	void onInit(IComponentList* components) override
+	{
+		testDatabase(components);
+		benchmarkLargeResultSet(components);
+	}
+
+	/// Tests the test database, checking every value of its result set
+	/// @param components Component list to query
+	void testDatabase(IComponentList* components)
 	{
 		IDatabasesComponent* databases_component(components->queryComponent<IDatabasesComponent>());
 		if (databases_component)
@@ -272,6 +280,63 @@ struct DatabasesTestComponent final : public IComponent, public NoCopy
 		}
 	}
 
+	/// Builds a large result set in memory and times fetching and reading it
+	/// @param components Component list to query
+	void benchmarkLargeResultSet(IComponentList* components)
+	{
+		IDatabasesComponent* databases_component(components->queryComponent<IDatabasesComponent>());
+		if (!databases_component)
+		{
+			return;
+		}
+		IDatabaseConnection* database_connection(databases_component->open(":memory:"));
+		if (!database_connection)
+		{
+			core->printLn("[ERROR] Failed to open an in-memory database for the benchmark.");
+			return;
+		}
+		IDatabaseResultSet* result_set(database_connection->executeQuery(
+			"CREATE TABLE `bench` (`id` INTEGER PRIMARY KEY, `name` TEXT, `score` REAL, `level` INTEGER, `note` TEXT);"
+			"WITH RECURSIVE `seq`(`n`) AS (SELECT 1 UNION ALL SELECT `n` + 1 FROM `seq` WHERE `n` < "
+			"100000) INSERT INTO `bench` SELECT `n`, 'player_' || `n`, `n` * 0.5, `n` % 100, NULL FROM `seq`;"));
+		if (result_set)
+		{
+			databases_component->freeResultSet(*result_set);
+		}
+		for (int run(0); run < 3; run++)
+		{
+			const TimePoint start(Time::now());
+			result_set = database_connection->executeQuery("SELECT * FROM `bench`");
+			if (!result_set)
+			{
+				core->printLn("[ERROR] Failed to execute the benchmark query.");
+				break;
+			}
+			const TimePoint fetched(Time::now());
+			std::size_t rows(0);
+			long long checksum(0);
+			if (result_set->getRowCount() > 0)
+			{
+				do
+				{
+					checksum += result_set->getFieldIntByName("level");
+					checksum += static_cast<long long>(result_set->getFieldString(1).length());
+					++rows;
+				} while (result_set->selectNextRow());
+			}
+			const TimePoint read(Time::now());
+			LegacyDBResult& legacy_result(result_set->getLegacyDBResult());
+			const TimePoint legacy(Time::now());
+			core->printLn("Large result set benchmark run %d: %zu rows (checksum %lld, legacy columns %d), fetch %lldus, read %lldus, legacy %lldus",
+				run + 1, rows, checksum, legacy_result.columns,
+				static_cast<long long>(duration_cast<Microseconds>(fetched - start).count()),
+				static_cast<long long>(duration_cast<Microseconds>(read - fetched).count()),
+				static_cast<long long>(duration_cast<Microseconds>(legacy - read).count()));
+			databases_component->freeResultSet(*result_set);
+		}
+		databases_component->close(*database_connection);
+	}
+
 	/// Validates field name
 	/// @param databaseResultSet Database result set
 	/// @param fieldIndex Field index
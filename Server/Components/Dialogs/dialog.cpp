@@ -9,6 +9,7 @@
 #include <Impl/events_impl.hpp>
 #include <Server/Components/Dialogs/dialogs.hpp>
 #include <netcode.hpp>
+#include <allocations.hpp>
 
 using namespace Impl;
 
@@ -25,7 +26,7 @@ static const NetCode::RPC::ShowDialog hideDialog = {
 	emptyStringView
 };
 
-class PlayerDialogData final : public IPlayerDialogData
+class PlayerDialogData final : public IPlayerDialogData, public TrackedAllocation<PlayerDialogData>
 {
 private:
 	int activeId = INVALID_DIALOG_ID;
@@ -126,7 +127,7 @@ public:
 	}
 };
 
-class DialogsComponent final : public IDialogsComponent, public PlayerConnectEventHandler
+class DialogsComponent final : public IDialogsComponent, public PlayerConnectEventHandler, public TrackedAllocation<DialogsComponent>
 {
 private:
 	ICore* core = nullptr;
@@ -262,6 +263,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new DialogsComponent();
@@ -14,11 +14,43 @@
 #include <Server/Components/Actors/actors.hpp>
 #include <netcode.hpp>
 #include <queue>
+#include <allocations.hpp>
 
 using namespace Impl;
 
 class PlayerFixesData;
 
+/// The fixes that need doing for a player at some time, or every so often, run from one pass over
+/// compact lists of the players that need them rather than a timer (and handler) per player.
+class PeriodicFixes
+{
+public:
+	static constexpr size_t None = SIZE_MAX;
+
+	// TODO: This must be fixed on client side
+	// 50 gives very good results in terms of not flickering.  100 gives OK results.  80 is
+	// between them to try and balance effect and bandwidth.
+	static constexpr Milliseconds MoneyInterval = Milliseconds(80);
+
+	void startMoney(PlayerFixesData& data);
+	void stopMoney(PlayerFixesData& data);
+	void startGameText(PlayerFixesData& data, int style);
+	void stopGameText(PlayerFixesData& data, int style);
+
+	/// Reset the money of dead players and hide game texts that have run out, called every tick.
+	void process(TimePoint now);
+
+private:
+	struct GameText
+	{
+		PlayerFixesData* data;
+		int style;
+	};
+
+	DynamicArray<PlayerFixesData*> money_;
+	DynamicArray<GameText> gameTexts_;
+};
+
 static bool validateGameText(StringView& message, Milliseconds time, int style)
 {
 	// ALL styles are recreated here, since even native ones are broken.
@@ -80,29 +112,22 @@ struct ReapplyAnimationData
 	ITimer* timer;
 };
 
-class PlayerFixesData final : public IPlayerFixesData
+class PlayerFixesData final : public IPlayerFixesData, public TrackedAllocation<PlayerFixesData>
 {
 private:
 	IPlayer& player_;
-	ITimer* moneyTimer_ = nullptr;
 	ITimersComponent& timers_;
+	PeriodicFixes& periodic_;
 	IPlayerTextDrawData* const tds_;
 	int money_ = 0;
+	size_t moneyIndex_ = PeriodicFixes::None; ///< In the money list while the player is dead
+	TimePoint nextMoney_;
 	StaticArray<IPlayerTextDraw*, MAX_GAMETEXT_STYLES> gts_;
-	StaticArray<ITimer*, MAX_GAMETEXT_STYLES> gtTimers_;
+	StaticArray<size_t, MAX_GAMETEXT_STYLES> gtIndices_; ///< In the game text list while shown
+	StaticArray<Milliseconds, MAX_GAMETEXT_STYLES> gtTimes_;
+	StaticArray<TimePoint, MAX_GAMETEXT_STYLES> gtHideAt_;
 	inline static std::deque<ReapplyAnimationData> animationToReapply_ {};
 
-	void GameTextTimer(int style)
-	{
-		// Hide and destroy the TD.
-		if (gts_[style])
-		{
-			tds_->release(gts_[style]->getID());
-			gts_[style] = nullptr;
-		}
-		gtTimers_[style] = nullptr;
-	}
-
 	// TODO: There are so many ways to make this code smaller and faster.  Thus I've just abstracted
 	// recording which animation libraries are loaded to these two functions.  Feel free to replace
 	// them with a bit map, or string hash, or anything else.  I used a hash anyway, basically free.
@@ -155,12 +180,8 @@ private:
 		animationToReapply_.pop_front();
 	}
 
-	void MoneyTimer()
-	{
-		player_.setMoney(money_);
-	}
-
 	friend class FixesComponent;
+	friend class PeriodicFixes;
 
 public:
 	void freeExtension() override
@@ -168,35 +189,30 @@ public:
 		delete this;
 	}
 
-	PlayerFixesData(IPlayer& player, ITimersComponent& timers)
+	PlayerFixesData(IPlayer& player, ITimersComponent& timers, PeriodicFixes& periodic)
 		: player_(player)
 		, timers_(timers)
+		, periodic_(periodic)
 		, tds_(queryExtension<IPlayerTextDrawData>(player))
 	{
 		gts_.fill(nullptr);
-		gtTimers_.fill(nullptr);
+		gtIndices_.fill(PeriodicFixes::None);
 	}
 
 	void startMoneyTimer()
 	{
-		if (moneyTimer_)
-		{
-			moneyTimer_->kill();
-		}
-		// TODO: This must be fixed on client side
-		// 50 gives very good results in terms of not flickering.  100 gives OK results.  80 is
-		// between them to try and balance effect and bandwidth.
+		// Restarting pushes the first reset back, like replacing the timer used to.
 		money_ = player_.getMoney();
-		moneyTimer_ = timers_.create(new SimpleTimerHandler(std::bind(&PlayerFixesData::MoneyTimer, this)), Milliseconds(80), true);
+		nextMoney_ = Time::now() + PeriodicFixes::MoneyInterval;
+		periodic_.startMoney(*this);
 	}
 
 	void stopMoneyTimer()
 	{
-		if (moneyTimer_)
+		if (moneyIndex_ != PeriodicFixes::None)
 		{
-			moneyTimer_->kill();
+			periodic_.stopMoney(*this);
 			player_.setMoney(player_.getMoney());
-			moneyTimer_ = nullptr;
 		}
 	}
 
@@ -208,11 +224,7 @@ public:
 			tds_->release(gts_[style]->getID());
 			gts_[style] = nullptr;
 		}
-		if (gtTimers_[style])
-		{
-			gtTimers_[style]->kill();
-			gtTimers_[style] = nullptr;
-		}
+		periodic_.stopGameText(*this, style);
 	}
 
 	bool doSendGameText(StringView message, Milliseconds time, int style)
@@ -304,7 +316,6 @@ public:
 		if (td == nullptr)
 		{
 			gts_[style] = nullptr;
-			gtTimers_[style] = nullptr;
 			return false;
 		}
 		// And do the rest of the style.
@@ -537,9 +548,11 @@ public:
 			td->setTextSize({ 230.5, 200.0 });
 			break;
 		}
-		// Show the TD to the player and start a timer to hide it again.
+		// Show the TD to the player and schedule hiding it again.
 		td->show();
-		gtTimers_[style] = timers_.create(new SimpleTimerHandler(std::bind(&PlayerFixesData::doHideGameText, this, style)), time, false);
+		gtTimes_[style] = time;
+		gtHideAt_[style] = Time::now() + time;
+		periodic_.startGameText(*this, style);
 		gts_[style] = td;
 
 		return true;
@@ -572,11 +585,11 @@ public:
 
 	bool getGameText(int style, StringView& message, Milliseconds& time, Milliseconds& remaining) override
 	{
-		if (gts_[style] && gtTimers_[style])
+		if (gts_[style] && gtIndices_[style] != PeriodicFixes::None)
 		{
 			message = gts_[style]->getText();
-			time = gtTimers_[style]->interval();
-			remaining = gtTimers_[style]->remaining();
+			time = gtTimes_[style];
+			remaining = duration_cast<Milliseconds>(gtHideAt_[style] - Time::now());
 			return true;
 		}
 		return false;
@@ -584,19 +597,11 @@ public:
 
 	void reset() override
 	{
-		if (moneyTimer_)
-		{
-			moneyTimer_->kill();
-			moneyTimer_ = nullptr;
-		}
+		periodic_.stopMoney(*this);
 		// Hide all gametexts.
 		for (int style = 0; style != MAX_GAMETEXT_STYLES; ++style)
 		{
-			if (gtTimers_[style])
-			{
-				gtTimers_[style]->kill();
-				gtTimers_[style] = nullptr;
-			}
+			periodic_.stopGameText(*this, style);
 			// Don't destroy the TD, the TD component does that.  Just reset the pointer.
 			gts_[style] = nullptr;
 		}
@@ -635,12 +640,80 @@ public:
 	}
 };
 
-class FixesComponent final : public IFixesComponent, public PlayerConnectEventHandler, public PlayerSpawnEventHandler, public PlayerDamageEventHandler, public ClassEventHandler
+void PeriodicFixes::startMoney(PlayerFixesData& data)
+{
+	if (data.moneyIndex_ == None)
+	{
+		data.moneyIndex_ = money_.size();
+		money_.push_back(&data);
+	}
+}
+
+void PeriodicFixes::stopMoney(PlayerFixesData& data)
+{
+	const size_t index = data.moneyIndex_;
+	if (index != None)
+	{
+		money_[index] = money_.back();
+		money_[index]->moneyIndex_ = index;
+		money_.pop_back();
+		data.moneyIndex_ = None;
+	}
+}
+
+void PeriodicFixes::startGameText(PlayerFixesData& data, int style)
+{
+	if (data.gtIndices_[style] == None)
+	{
+		data.gtIndices_[style] = gameTexts_.size();
+		gameTexts_.push_back({ &data, style });
+	}
+}
+
+void PeriodicFixes::stopGameText(PlayerFixesData& data, int style)
+{
+	const size_t index = data.gtIndices_[style];
+	if (index != None)
+	{
+		gameTexts_[index] = gameTexts_.back();
+		gameTexts_[index].data->gtIndices_[gameTexts_[index].style] = index;
+		gameTexts_.pop_back();
+		data.gtIndices_[style] = None;
+	}
+}
+
+void PeriodicFixes::process(TimePoint now)
+{
+	// Both go backwards, so removing an entry only ever moves one that was already looked at.
+	for (size_t i = money_.size(); i-- != 0;)
+	{
+		PlayerFixesData& data = *money_[i];
+		const Milliseconds diff = duration_cast<Milliseconds>(now - data.nextMoney_);
+		if (diff.count() >= 0)
+		{
+			data.player_.setMoney(data.money_);
+			// Keep to the interval the way a repeating timer would.
+			data.nextMoney_ = now + MoneyInterval - diff;
+		}
+	}
+	for (size_t i = gameTexts_.size(); i-- != 0;)
+	{
+		const GameText gameText = gameTexts_[i];
+		if (gameText.data->gtHideAt_[gameText.style] <= now)
+		{
+			gameText.data->doHideGameText(gameText.style);
+		}
+	}
+}
+
+class FixesComponent final : public IFixesComponent, public CoreEventHandler, public PlayerConnectEventHandler, public PlayerSpawnEventHandler, public PlayerDamageEventHandler, public ClassEventHandler, public TrackedAllocation<FixesComponent>
 {
 private:
+	ICore* core_ = nullptr;
 	IClassesComponent* classes_ = nullptr;
 	IPlayerPool* players_ = nullptr;
 	ITimersComponent* timers_ = nullptr;
+	PeriodicFixes periodic_;
 	Microseconds resetMoney_ = Microseconds(0);
 
 public:
@@ -660,6 +733,10 @@ public:
 
 	~FixesComponent()
 	{
+		if (core_)
+		{
+			core_->getEventDispatcher().removeEventHandler(this);
+		}
 		if (players_)
 		{
 			players_->getPlayerConnectDispatcher().removeEventHandler(this);
@@ -684,6 +761,8 @@ public:
 	void onLoad(ICore* c) override
 	{
 		constexpr event_order_t EventPriority_Fixes = 100;
+		core_ = c;
+		core_->getEventDispatcher().addEventHandler(this);
 		players_ = &c->getPlayers();
 		players_->getPlayerConnectDispatcher().addEventHandler(this, EventPriority_Fixes);
 		players_->getPlayerSpawnDispatcher().addEventHandler(this, EventPriority_Fixes);
@@ -701,6 +780,11 @@ public:
 		timers_ = components->queryComponent<ITimersComponent>();
 	}
 
+	void onTick(Microseconds elapsed, TimePoint now) override
+	{
+		periodic_.process(now);
+	}
+
 	void onPlayerSpawn(IPlayer& player) override
 	{
 		// TODO: This must be fixed on client side
@@ -780,7 +864,7 @@ public:
 	{
 		if (timers_)
 		{
-			player.addExtension(new PlayerFixesData(player, *timers_), true);
+			player.addExtension(new PlayerFixesData(player, *timers_, periodic_), true);
 		}
 	}
 
@@ -842,6 +926,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new FixesComponent();
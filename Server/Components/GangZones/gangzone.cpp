@@ -8,11 +8,12 @@
 
 #include "gangzone.hpp"
 #include <legacy_id_mapper.hpp>
+#include <allocations.hpp>
 
 using namespace Impl;
 
 // TODO: This internal/external IDs mapping code should be extracted for other components to use.
-class PlayerGangZoneData final : public IPlayerGangZoneData
+class PlayerGangZoneData final : public IPlayerGangZoneData, public TrackedAllocation<PlayerGangZoneData>
 {
 private:
 	FiniteLegacyIDMapper<GANG_ZONE_POOL_SIZE>
@@ -91,7 +92,7 @@ public:
 	}
 };
 
-class GangZonesComponent final : public IGangZonesComponent, public PlayerConnectEventHandler, public PlayerClickEventHandler, public PlayerUpdateEventHandler, public PoolEventHandler<IPlayer>
+class GangZonesComponent final : public IGangZonesComponent, public PlayerConnectEventHandler, public PlayerClickEventHandler, public PlayerUpdateEventHandler, public PoolEventHandler<IPlayer>, public TrackedAllocation<GangZonesComponent>
 {
 private:
 	ICore* core = nullptr;
@@ -367,6 +368,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new GangZonesComponent();
@@ -7,10 +7,11 @@
  */
 
 #include "menu.hpp"
+#include <allocations.hpp>
 
 using namespace Impl;
 
-class MenusComponent final : public IMenusComponent, public MenuEventHandler, public PlayerConnectEventHandler, public PoolEventHandler<IPlayer>
+class MenusComponent final : public IMenusComponent, public MenuEventHandler, public PlayerConnectEventHandler, public PoolEventHandler<IPlayer>, public TrackedAllocation<MenusComponent>
 {
 private:
 	ICore* core = nullptr;
@@ -217,6 +218,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new MenusComponent();
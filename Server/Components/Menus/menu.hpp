@@ -10,10 +10,11 @@
 #include <Server/Components/Menus/menus.hpp>
 #include <netcode.hpp>
 #include <sdk.hpp>
+#include <allocations.hpp>
 
 using namespace Impl;
 
-struct PlayerMenuData final : public IPlayerMenuData
+struct PlayerMenuData final : public IPlayerMenuData, public TrackedAllocation<PlayerMenuData>
 {
 private:
 	uint8_t menuId = INVALID_MENU_ID;
@@ -0,0 +1,627 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#include "snapshot.hpp"
+#include <sdk.hpp>
+#include <trace.hpp>
+#include <httplib.h>
+#include <Server/Components/Actors/actors.hpp>
+#include <Server/Components/Classes/classes.hpp>
+#include <Server/Components/GangZones/gangzones.hpp>
+#include <Server/Components/Menus/menus.hpp>
+#include <Server/Components/Objects/objects.hpp>
+#include <Server/Components/Pickups/pickups.hpp>
+#include <Server/Components/TextDraws/textdraws.hpp>
+#include <Server/Components/TextLabels/textlabels.hpp>
+#include <Server/Components/Timers/timers.hpp>
+#include <Server/Components/Vehicles/vehicles.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+/// How often the main thread copies its state out for the scraper.
+static constexpr Milliseconds PublishInterval = Milliseconds(1000);
+
+static void appendValue(std::string& out, const char* name, const char* labels, double value)
+{
+	char buf[64];
+	std::snprintf(buf, sizeof(buf), " %.17g\n", value);
+	out += name;
+	out += labels;
+	out += buf;
+}
+
+static void appendValue(std::string& out, const char* name, const char* labels, uint64_t value)
+{
+	out += name;
+	out += labels;
+	out += ' ';
+	out += std::to_string(value);
+	out += '\n';
+}
+
+static void appendHeader(std::string& out, const char* name, const char* type, const char* help)
+{
+	out += "# HELP ";
+	out += name;
+	out += ' ';
+	out += help;
+	out += "\n# TYPE ";
+	out += name;
+	out += ' ';
+	out += type;
+	out += '\n';
+}
+
+/// Label values are component and public names, escape them anyway.
+static void appendLabel(std::string& out, const char* label, StringView value)
+{
+	out += '{';
+	out += label;
+	out += "=\"";
+	for (char c : value)
+	{
+		if (c == '"' || c == '\\')
+		{
+			out += '\\';
+			out += c;
+		}
+		else if (c == '\n')
+		{
+			out += "\\n";
+		}
+		else
+		{
+			out += c;
+		}
+	}
+	out += "\"}";
+}
+
+static void appendScopes(std::string& out, const char* prefix, const char* label, const char* what, const DynamicArray<ScopeMetric>& scopes)
+{
+	const std::string seconds = std::string(prefix) + "_seconds_total";
+	const std::string calls = std::string(prefix) + "_calls_total";
+	std::string labels;
+	appendHeader(out, seconds.c_str(), "counter", (std::string("Time spent in each ") + what + ".").c_str());
+	for (const ScopeMetric& scope : scopes)
+	{
+		labels.clear();
+		appendLabel(labels, label, scope.name);
+		appendValue(out, seconds.c_str(), labels.c_str(), scope.microseconds / 1000000.0);
+	}
+	appendHeader(out, calls.c_str(), "counter", (std::string("Calls to each ") + what + ".").c_str());
+	for (const ScopeMetric& scope : scopes)
+	{
+		labels.clear();
+		appendLabel(labels, label, scope.name);
+		appendValue(out, calls.c_str(), labels.c_str(), scope.calls);
+	}
+}
+
+static void appendHistogram(std::string& out, const char* name, const char* help, const TickHistogram& histogram)
+{
+	appendHeader(out, name, "histogram", help);
+	const std::string bucket = std::string(name) + "_bucket";
+	char labels[32];
+	uint64_t cumulative = 0;
+	for (size_t i = 0; i != TickHistogramBuckets.size(); ++i)
+	{
+		cumulative += histogram.buckets[i];
+		std::snprintf(labels, sizeof(labels), "{le=\"%g\"}", TickHistogramBuckets[i] / 1000000.0);
+		appendValue(out, bucket.c_str(), labels, cumulative);
+	}
+	cumulative += histogram.buckets.back();
+	appendValue(out, bucket.c_str(), "{le=\"+Inf\"}", cumulative);
+	appendValue(out, (std::string(name) + "_sum").c_str(), "", histogram.sum / 1000000.0);
+	appendValue(out, (std::string(name) + "_count").c_str(), "", histogram.count);
+}
+
+static std::string renderMetrics(const MetricsSnapshot& snapshot)
+{
+	std::string out;
+	out.reserve(4096);
+
+	appendHistogram(out, "omp_tick_duration_seconds", "Time spent processing a single server tick.", snapshot.tickDuration);
+	appendHistogram(out, "omp_tick_interval_seconds", "Time between the starts of consecutive server ticks.", snapshot.tickInterval);
+
+	appendHeader(out, "omp_ticks_per_second", "gauge", "Server ticks processed in the last second.");
+	appendValue(out, "omp_ticks_per_second", "", uint64_t(snapshot.ticksPerSecond));
+
+	appendHeader(out, "omp_players", "gauge", "Connected players, including NPCs.");
+	appendValue(out, "omp_players", "", uint64_t(snapshot.players));
+
+	if (snapshot.hasTimers)
+	{
+		appendHeader(out, "omp_timers_running", "gauge", "Running timers.");
+		appendValue(out, "omp_timers_running", "", snapshot.timers);
+	}
+
+	char labels[64];
+	appendHeader(out, "omp_pool_entries", "gauge", "Entries currently allocated in a component pool.");
+	for (size_t i = 0; i != MetricsPool_End; ++i)
+	{
+		if (snapshot.pools[i].available)
+		{
+			std::snprintf(labels, sizeof(labels), "{pool=\"%s\"}", MetricsPoolNames[i]);
+			appendValue(out, "omp_pool_entries", labels, snapshot.pools[i].count);
+		}
+	}
+	appendHeader(out, "omp_pool_capacity", "gauge", "Maximum number of entries a component pool can hold.");
+	for (size_t i = 0; i != MetricsPool_End; ++i)
+	{
+		if (snapshot.pools[i].available)
+		{
+			std::snprintf(labels, sizeof(labels), "{pool=\"%s\"}", MetricsPoolNames[i]);
+			appendValue(out, "omp_pool_capacity", labels, snapshot.pools[i].capacity);
+		}
+	}
+
+	if (snapshot.hasNetwork)
+	{
+		const NetworkStats& stats = snapshot.network;
+		appendHeader(out, "omp_network_messages_sent_total", "counter", "Messages sent by the legacy network.");
+		appendValue(out, "omp_network_messages_sent_total", "", uint64_t(stats.messagesSent));
+		appendHeader(out, "omp_network_sent_bytes_total", "counter", "Bytes sent by the legacy network.");
+		appendValue(out, "omp_network_sent_bytes_total", "", uint64_t(stats.totalBytesSent));
+		appendHeader(out, "omp_network_messages_received_total", "counter", "Messages received by the legacy network.");
+		appendValue(out, "omp_network_messages_received_total", "", uint64_t(stats.messagesReceived));
+		appendHeader(out, "omp_network_received_bytes_total", "counter", "Bytes received by the legacy network.");
+		appendValue(out, "omp_network_received_bytes_total", "", uint64_t(stats.bytesReceived));
+		appendHeader(out, "omp_network_message_resends_total", "counter", "Messages resent by the legacy network.");
+		appendValue(out, "omp_network_message_resends_total", "", uint64_t(stats.messageResends));
+		appendHeader(out, "omp_network_resent_bytes_total", "counter", "Bytes resent by the legacy network.");
+		appendValue(out, "omp_network_resent_bytes_total", "", uint64_t(stats.messagesTotalBytesResent));
+		appendHeader(out, "omp_network_send_buffer_messages", "gauge", "Messages waiting in the send buffer.");
+		appendValue(out, "omp_network_send_buffer_messages", "", uint64_t(stats.messageSendBuffer));
+		appendHeader(out, "omp_network_resend_queue_messages", "gauge", "Messages waiting for an acknowledgement.");
+		appendValue(out, "omp_network_resend_queue_messages", "", uint64_t(stats.messagesOnResendQueue));
+		appendHeader(out, "omp_network_packet_loss_ratio", "gauge", "Packet loss of the legacy network.");
+		appendValue(out, "omp_network_packet_loss_ratio", "", double(stats.packetloss) / 100.0);
+	}
+
+	appendScopes(out, "omp_handler_tick", "handler", "component's tick handler", snapshot.handlers);
+	appendScopes(out, "omp_pawn_callback", "callback", "Pawn public, summed over all scripts", snapshot.callbacks);
+
+	return out;
+}
+
+class MetricsServer
+{
+private:
+	httplib::Server svr;
+	std::thread thread;
+	/// Set once the listener thread is done, whether or not it ever got as far as running.
+	std::atomic<bool> finished_ { false };
+
+public:
+	MetricsServer(TripleBuffer<MetricsSnapshot>& snapshots, StringView bind, uint16_t port)
+	{
+		// One worker, so there is only ever one consumer of the snapshot buffer.
+		svr.new_task_queue = []
+		{
+			return new httplib::ThreadPool(1);
+		};
+
+		svr.Get("/metrics", [&snapshots](const httplib::Request&, httplib::Response& res)
+			{
+				const MetricsSnapshot& snapshot = snapshots.read();
+				if (!snapshot.valid)
+				{
+					res.status = 503;
+					return;
+				}
+				res.set_content(renderMetrics(snapshot), "text/plain; version=0.0.4");
+			});
+
+		// Bind here so a failure can be reported straight away, the thread only accepts.
+		if (svr.bind_to_port(String(bind).c_str(), port))
+		{
+			thread = std::thread(&MetricsServer::run, this);
+		}
+	}
+
+	~MetricsServer()
+	{
+		if (thread.joinable())
+		{
+			// `stop()` does nothing until the listener is running, so wait for it to get there first.
+			while (!svr.is_running() && !finished_)
+			{
+				std::this_thread::sleep_for(Milliseconds(1));
+			}
+			svr.stop();
+			thread.join();
+		}
+	}
+
+	void run()
+	{
+		svr.listen_after_bind();
+		finished_ = true;
+	}
+
+	bool bound() const
+	{
+		return thread.joinable();
+	}
+};
+
+class MetricsComponent final : public IComponent, public CoreEventHandler
+{
+private:
+	struct ScopeTotals
+	{
+		uint64_t calls = 0;
+		uint64_t microseconds = 0;
+	};
+
+	struct HandlerTotals : ScopeTotals
+	{
+		String name; ///< Demangled once, the first time the handler is seen
+	};
+
+	ICore* core = nullptr;
+	MetricsServer* server = nullptr;
+
+	bool enabled = false;
+	String bindAddress = "127.0.0.1";
+	uint16_t port = 7780;
+
+	IActorsComponent* actors = nullptr;
+	IClassesComponent* classes = nullptr;
+	IGangZonesComponent* gangzones = nullptr;
+	IMenusComponent* menus = nullptr;
+	IObjectsComponent* objects = nullptr;
+	IPickupsComponent* pickups = nullptr;
+	ITextDrawsComponent* textdraws = nullptr;
+	ITextLabelsComponent* textlabels = nullptr;
+	ITimersComponent* timers = nullptr;
+	IVehiclesComponent* vehicles = nullptr;
+
+	TickHistogram tickDuration;
+	TickHistogram tickInterval;
+	TimePoint tickStart;
+	TimePoint lastPublish;
+	TripleBuffer<MetricsSnapshot> snapshots;
+
+	/// Handlers are named by `typeid().name()`, which is static, so its address is key enough.
+	FlatHashMap<const char*, HandlerTotals> handlerTimes;
+	/// Public names only live for the scope, so these are found by value without copying it.
+	std::map<String, ScopeTotals, std::less<>> callbackTimes;
+
+	/// Runs after every other tick handler, so the span since `tickStart` covers the whole tick.
+	struct TickEndHandler : public CoreEventHandler
+	{
+		MetricsComponent& self;
+
+		TickEndHandler(MetricsComponent& component)
+			: self(component)
+		{
+		}
+
+		void onTick(Microseconds elapsed, TimePoint now) override
+		{
+			self.onTickEnd();
+		}
+	} tickEndHandler;
+
+	/// Totals up handler and public timings; only handed to the core while metrics are enabled.
+	struct TimingSink : public ITraceTimingSink
+	{
+		MetricsComponent& self;
+
+		TimingSink(MetricsComponent& component)
+			: self(component)
+		{
+		}
+
+		void onScopeTimed(TraceCategory category, const char* name, Microseconds duration) override
+		{
+			self.onScopeTimed(category, name, duration);
+		}
+
+		void freeExtension() override
+		{
+		}
+
+		void reset() override
+		{
+		}
+	} timingSink;
+
+	static void addTime(ScopeTotals& totals, Microseconds duration)
+	{
+		++totals.calls;
+		totals.microseconds += duration.count() > 0 ? duration.count() : 0;
+	}
+
+	/// Copy `totals`, keyed however, into `out` by name; a name seen twice is summed.
+	template <class Map, class GetName>
+	static void fillScopes(DynamicArray<ScopeMetric>& out, const Map& totals, GetName getName)
+	{
+		out.clear();
+		for (const auto& entry : totals)
+		{
+			const StringView name = getName(entry);
+			auto it = std::find_if(out.begin(), out.end(), [name](const ScopeMetric& scope)
+				{
+					return StringView(scope.name) == name;
+				});
+			if (it == out.end())
+			{
+				out.push_back(ScopeMetric { String(name), 0, 0 });
+				it = out.end() - 1;
+			}
+			it->calls += entry.second.calls;
+			it->microseconds += entry.second.microseconds;
+		}
+	}
+
+	template <class Pool>
+	static void fillPool(PoolMetric& metric, Pool* pool)
+	{
+		metric.available = pool != nullptr;
+		if (pool)
+		{
+			const Pair<size_t, size_t> bounds = pool->bounds();
+			metric.count = pool->count();
+			metric.capacity = bounds.second - bounds.first;
+		}
+	}
+
+	void publish()
+	{
+		MetricsSnapshot& snapshot = snapshots.back();
+		snapshot.valid = true;
+		snapshot.tickDuration = tickDuration;
+		snapshot.tickInterval = tickInterval;
+		snapshot.ticksPerSecond = core->tickRate();
+		snapshot.players = core->getPlayers().entries().size();
+
+		snapshot.hasTimers = timers != nullptr;
+		snapshot.timers = timers ? timers->count() : 0;
+
+		fillPool(snapshot.pools[MetricsPool_Actors], actors);
+		fillPool(snapshot.pools[MetricsPool_Classes], classes);
+		fillPool(snapshot.pools[MetricsPool_GangZones], gangzones);
+		fillPool(snapshot.pools[MetricsPool_Menus], menus);
+		fillPool(snapshot.pools[MetricsPool_Objects], objects);
+		fillPool(snapshot.pools[MetricsPool_Pickups], pickups);
+		fillPool(snapshot.pools[MetricsPool_TextDraws], textdraws);
+		fillPool(snapshot.pools[MetricsPool_TextLabels], textlabels);
+		fillPool(snapshot.pools[MetricsPool_Vehicles], vehicles);
+
+		snapshot.hasNetwork = false;
+		for (INetwork* network : core->getNetworks())
+		{
+			if (network->getNetworkType() == ENetworkType::ENetworkType_RakNetLegacy)
+			{
+				snapshot.network = network->getStatistics();
+				snapshot.hasNetwork = true;
+			}
+		}
+
+		// A handler type can show up at more than one address when components are separate libraries.
+		fillScopes(snapshot.handlers, handlerTimes, [](const auto& entry)
+			{
+				return StringView(entry.second.name);
+			});
+		fillScopes(snapshot.callbacks, callbackTimes, [](const auto& entry)
+			{
+				return StringView(entry.first);
+			});
+
+		snapshots.publish();
+	}
+
+public:
+	MetricsComponent()
+		: tickEndHandler(*this)
+		, timingSink(*this)
+	{
+	}
+
+	IExtension* getExtension(UID id) override
+	{
+		// The core times scopes for as long as there's a sink, don't make it pay for that when disabled.
+		if (id == ITraceTimingSink::ExtensionIID && enabled)
+		{
+			return &timingSink;
+		}
+		return nullptr;
+	}
+
+	UID getUID() override
+	{
+		return 0x3d1f6b0a8e7c4259;
+	}
+
+	StringView componentName() const override
+	{
+		return "Metrics";
+	}
+
+	SemanticVersion componentVersion() const override
+	{
+		return SemanticVersion(OMP_VERSION_MAJOR, OMP_VERSION_MINOR, OMP_VERSION_PATCH, BUILD_NUMBER);
+	}
+
+	void provideConfiguration(ILogger& logger, IEarlyConfig& config, bool defaults) override
+	{
+		if (defaults)
+		{
+			config.setBool("metrics.enable", enabled);
+			config.setString("metrics.bind", bindAddress);
+			config.setInt("metrics.port", port);
+		}
+		else
+		{
+			if (config.getType("metrics.enable") == ConfigOptionType_None)
+			{
+				config.setBool("metrics.enable", enabled);
+			}
+			if (config.getType("metrics.bind") == ConfigOptionType_None)
+			{
+				config.setString("metrics.bind", bindAddress);
+			}
+			if (config.getType("metrics.port") == ConfigOptionType_None)
+			{
+				config.setInt("metrics.port", port);
+			}
+		}
+	}
+
+	void onLoad(ICore* c) override
+	{
+		core = c;
+		enabled = *core->getConfig().getBool("metrics.enable");
+		bindAddress = String(core->getConfig().getString("metrics.bind"));
+		port = *core->getConfig().getInt("metrics.port");
+	}
+
+	void onInit(IComponentList* components) override
+	{
+		if (!enabled)
+		{
+			return;
+		}
+
+		actors = components->queryComponent<IActorsComponent>();
+		classes = components->queryComponent<IClassesComponent>();
+		gangzones = components->queryComponent<IGangZonesComponent>();
+		menus = components->queryComponent<IMenusComponent>();
+		objects = components->queryComponent<IObjectsComponent>();
+		pickups = components->queryComponent<IPickupsComponent>();
+		textdraws = components->queryComponent<ITextDrawsComponent>();
+		textlabels = components->queryComponent<ITextLabelsComponent>();
+		timers = components->queryComponent<ITimersComponent>();
+		vehicles = components->queryComponent<IVehiclesComponent>();
+
+		core->getEventDispatcher().addEventHandler(this, EventPriority_Highest);
+		core->getEventDispatcher().addEventHandler(&tickEndHandler, EventPriority_Lowest);
+
+		server = new MetricsServer(snapshots, bindAddress, port);
+		if (server->bound())
+		{
+			core->logLn(LogLevel::Message, "Metrics are available on http://%.*s:%d/metrics", PRINT_VIEW(bindAddress), port);
+		}
+		else
+		{
+			core->logLn(LogLevel::Error, "Failed to start metrics server on %.*s:%d", PRINT_VIEW(bindAddress), port);
+		}
+	}
+
+	void onFree(IComponent* component) override
+	{
+		if (component == actors)
+		{
+			actors = nullptr;
+		}
+		else if (component == classes)
+		{
+			classes = nullptr;
+		}
+		else if (component == gangzones)
+		{
+			gangzones = nullptr;
+		}
+		else if (component == menus)
+		{
+			menus = nullptr;
+		}
+		else if (component == objects)
+		{
+			objects = nullptr;
+		}
+		else if (component == pickups)
+		{
+			pickups = nullptr;
+		}
+		else if (component == textdraws)
+		{
+			textdraws = nullptr;
+		}
+		else if (component == textlabels)
+		{
+			textlabels = nullptr;
+		}
+		else if (component == timers)
+		{
+			timers = nullptr;
+		}
+		else if (component == vehicles)
+		{
+			vehicles = nullptr;
+		}
+	}
+
+	~MetricsComponent()
+	{
+		if (server)
+		{
+			delete server;
+			core->getEventDispatcher().removeEventHandler(this);
+			core->getEventDispatcher().removeEventHandler(&tickEndHandler);
+		}
+	}
+
+	void onTick(Microseconds elapsed, TimePoint now) override
+	{
+		tickStart = now;
+		tickInterval.record(elapsed);
+	}
+
+	void onScopeTimed(TraceCategory category, const char* name, Microseconds duration)
+	{
+		if (category == TraceCategory::Handler)
+		{
+			auto it = handlerTimes.find(name);
+			if (it == handlerTimes.end())
+			{
+				it = handlerTimes.emplace(name, HandlerTotals()).first;
+				it->second.name = demangleTraceName(name);
+			}
+			addTime(it->second, duration);
+		}
+		else if (category == TraceCategory::Public)
+		{
+			auto it = callbackTimes.find(std::string_view(name));
+			if (it == callbackTimes.end())
+			{
+				it = callbackTimes.emplace(String(name), ScopeTotals()).first;
+			}
+			addTime(it->second, duration);
+		}
+	}
+
+	void onTickEnd()
+	{
+		const TimePoint now = Time::now();
+		tickDuration.record(duration_cast<Microseconds>(now - tickStart));
+		if (now - lastPublish >= PublishInterval)
+		{
+			lastPublish = now;
+			publish();
+		}
+	}
+
+	void free() override
+	{
+		delete this;
+	}
+
+	void reset() override
+	{
+	}
+};
+
+COMPONENT_ENTRY_POINT()
+{
+	return new MetricsComponent();
+}
@@ -0,0 +1,136 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+#include <atomic>
+
+/// Upper bounds of the tick histogram buckets, in microseconds.  The `+Inf` bucket is implicit.
+static constexpr StaticArray<uint64_t, 11> TickHistogramBuckets = {
+	250, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 250000, 1000000
+};
+
+/// A fixed-bucket histogram of durations, only ever written to by the main thread.
+struct TickHistogram
+{
+	StaticArray<uint64_t, TickHistogramBuckets.size() + 1> buckets {};
+	uint64_t sum = 0;
+	uint64_t count = 0;
+
+	void record(Microseconds duration)
+	{
+		const uint64_t us = duration.count() > 0 ? duration.count() : 0;
+		size_t idx = 0;
+		while (idx < TickHistogramBuckets.size() && us > TickHistogramBuckets[idx])
+		{
+			++idx;
+		}
+		++buckets[idx];
+		sum += us;
+		++count;
+	}
+};
+
+enum MetricsPool
+{
+	MetricsPool_Actors,
+	MetricsPool_Classes,
+	MetricsPool_GangZones,
+	MetricsPool_Menus,
+	MetricsPool_Objects,
+	MetricsPool_Pickups,
+	MetricsPool_TextDraws,
+	MetricsPool_TextLabels,
+	MetricsPool_Vehicles,
+
+	MetricsPool_End
+};
+
+static constexpr StaticArray<const char*, MetricsPool_End> MetricsPoolNames = {
+	"actors",
+	"classes",
+	"gangzones",
+	"menus",
+	"objects",
+	"pickups",
+	"textdraws",
+	"textlabels",
+	"vehicles"
+};
+
+struct PoolMetric
+{
+	bool available = false;
+	uint64_t count = 0;
+	uint64_t capacity = 0;
+};
+
+/// Calls to a named scope and the time spent in it, since the server started.
+struct ScopeMetric
+{
+	String name;
+	uint64_t calls = 0;
+	uint64_t microseconds = 0;
+};
+
+/// Everything the scraper needs, copied out of the game state once per publish interval.
+struct MetricsSnapshot
+{
+	bool valid = false;
+	TickHistogram tickDuration;
+	TickHistogram tickInterval;
+	uint32_t ticksPerSecond = 0;
+	uint32_t players = 0;
+	bool hasTimers = false;
+	uint64_t timers = 0;
+	StaticArray<PoolMetric, MetricsPool_End> pools;
+	bool hasNetwork = false;
+	NetworkStats network;
+	DynamicArray<ScopeMetric> handlers; ///< Tick handlers, by type name
+	DynamicArray<ScopeMetric> callbacks; ///< Pawn publics, by name across all scripts
+};
+
+/// Single producer, single consumer triple buffer.  The producer fills `back()` and calls `publish()`,
+/// the consumer calls `read()` and gets the most recently published value.  Neither side ever waits
+/// for the other, so a slow scrape can't stall the game tick and vice versa.
+template <typename T>
+class TripleBuffer
+{
+private:
+	static constexpr uint8_t IndexMask = 0x03;
+	static constexpr uint8_t DirtyBit = 0x04;
+
+	StaticArray<T, 3> buffers_;
+	std::atomic<uint8_t> middle_ { 1 };
+	uint8_t back_ = 0;
+	uint8_t front_ = 2;
+
+public:
+	/// Get the buffer owned by the producer.
+	T& back()
+	{
+		return buffers_[back_];
+	}
+
+	/// Hand the producer's buffer over to the consumer.
+	void publish()
+	{
+		back_ = middle_.exchange(back_ | DirtyBit, std::memory_order_acq_rel) & IndexMask;
+	}
+
+	/// Get the latest published buffer; stays valid until the next call to `read()`.
+	const T& read()
+	{
+		if (middle_.load(std::memory_order_acquire) & DirtyBit)
+		{
+			front_ = middle_.exchange(front_, std::memory_order_acq_rel) & IndexMask;
+		}
+		return buffers_[front_];
+	}
+};
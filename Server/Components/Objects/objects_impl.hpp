@@ -12,8 +12,9 @@
 #include <Server/Components/Vehicles/vehicles.hpp>
 #include <Server/Components/CustomModels/custommodels.hpp>
 #include <netcode.hpp>
+#include <allocations.hpp>
 
-class ObjectComponent final : public IObjectsComponent, public CoreEventHandler, public PlayerConnectEventHandler, public PlayerStreamEventHandler, public PlayerSpawnEventHandler, public PoolEventHandler<IPlayer>, public PlayerModelsEventHandler
+class ObjectComponent final : public IObjectsComponent, public CoreEventHandler, public PlayerConnectEventHandler, public PlayerStreamEventHandler, public PlayerSpawnEventHandler, public PoolEventHandler<IPlayer>, public PlayerModelsEventHandler, public TrackedAllocation<ObjectComponent>
 {
 private:
 	ICore* core = nullptr;
@@ -472,7 +473,7 @@ public:
 	inline FlatPtrHashSet<Object>& getAttachedToPlayers() { return attachedToPlayer; }
 };
 
-class PlayerObjectData final : public IPlayerObjectData
+class PlayerObjectData final : public IPlayerObjectData, public TrackedAllocation<PlayerObjectData>
 {
 private:
 	ObjectComponent& component_;
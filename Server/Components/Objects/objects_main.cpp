@@ -175,6 +175,8 @@ void ObjectComponent::onPoolEntryCreated(IPlayer& player)
 	player.addExtension(playerData, true);
 }
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new ObjectComponent();
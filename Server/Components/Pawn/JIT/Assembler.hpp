@@ -0,0 +1,549 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+#include <cstring>
+
+/// Just enough of an x86 encoder for `PawnJIT`.  Everything is 32-bit arithmetic on the eight
+/// original registers, which encodes the same in 32 and 64-bit mode; only addresses differ, being
+/// the full 64-bit registers on x86-64.  The few pointer-sized instructions say so in their names.
+class X86Assembler
+{
+public:
+#if defined(__x86_64__)
+	static constexpr bool X64 = true;
+#else
+	static constexpr bool X64 = false;
+#endif
+
+	enum Reg : uint8_t
+	{
+		EAX,
+		ECX,
+		EDX,
+		EBX,
+		ESP,
+		EBP,
+		ESI,
+		EDI,
+		NoReg = 0xFF,
+	};
+
+	/// Condition codes, as added to the `Jcc` and `SETcc` opcodes
+	enum Cond : uint8_t
+	{
+		Below = 0x2,
+		AboveEqual = 0x3,
+		Equal = 0x4,
+		NotEqual = 0x5,
+		BelowEqual = 0x6,
+		Above = 0x7,
+		Sign = 0x8,
+		NotSign = 0x9,
+		Less = 0xC,
+		GreaterEqual = 0xD,
+		LessEqual = 0xE,
+		Greater = 0xF,
+	};
+
+	/// `[base + index * (1 << scale) + disp]`
+	struct Mem
+	{
+		Reg base;
+		Reg index;
+		uint8_t scale;
+		int32_t disp;
+
+		Mem(Reg base, int32_t disp = 0)
+			: base(base)
+			, index(NoReg)
+			, scale(0)
+			, disp(disp)
+		{
+		}
+
+		Mem(Reg base, Reg index, uint8_t scale, int32_t disp)
+			: base(base)
+			, index(index)
+			, scale(scale)
+			, disp(disp)
+		{
+		}
+	};
+
+	/// A position in the code, bound once and jumped to any number of times before or after
+	using Label = size_t;
+
+	/// Instruction groups of the ALU opcodes, `op r/m32, r32` is `group * 8 + 1`
+	enum Alu : uint8_t
+	{
+		Add = 0,
+		Or = 1,
+		And = 4,
+		Sub = 5,
+		Xor = 6,
+		Cmp = 7,
+	};
+
+private:
+	DynamicArray<uint8_t> code_;
+	DynamicArray<size_t> labels_;
+	/// Where each forward jump's `rel32` is, and the label it goes to
+	DynamicArray<Pair<size_t, Label>> fixups_;
+
+	static constexpr size_t Unbound = SIZE_MAX;
+
+	static bool isInt8(int32_t value)
+	{
+		return value >= -128 && value <= 127;
+	}
+
+	void put32(int32_t value)
+	{
+		uint8_t bytes[4];
+		memcpy(bytes, &value, 4);
+		code_.insert(code_.end(), bytes, bytes + 4);
+	}
+
+	void put64(uint64_t value)
+	{
+		uint8_t bytes[8];
+		memcpy(bytes, &value, 8);
+		code_.insert(code_.end(), bytes, bytes + 8);
+	}
+
+	void rexW()
+	{
+		if (X64)
+		{
+			byte(0x48);
+		}
+	}
+
+	/// ModRM (and SIB and displacement) for a register operand
+	void modrm(uint8_t reg, Reg rm)
+	{
+		byte(0xC0 | (reg << 3) | rm);
+	}
+
+	/// ModRM (and SIB and displacement) for a memory operand
+	void modrm(uint8_t reg, Mem const& mem)
+	{
+		// EBP as a base always needs a displacement, mod 0 means no base at all for it.
+		const uint8_t mod = (mem.disp == 0 && mem.base != EBP) ? 0 : (isInt8(mem.disp) ? 1 : 2);
+		if (mem.index == NoReg && mem.base != ESP)
+		{
+			byte((mod << 6) | (reg << 3) | mem.base);
+		}
+		else
+		{
+			byte((mod << 6) | (reg << 3) | 4);
+			byte((mem.scale << 6) | ((mem.index == NoReg ? ESP : mem.index) << 3) | mem.base);
+		}
+		if (mod == 1)
+		{
+			byte(static_cast<uint8_t>(mem.disp));
+		}
+		else if (mod == 2)
+		{
+			put32(mem.disp);
+		}
+	}
+
+	void rel32(Label label)
+	{
+		if (labels_[label] == Unbound)
+		{
+			fixups_.emplace_back(code_.size(), label);
+			put32(0);
+		}
+		else
+		{
+			put32(static_cast<int32_t>(labels_[label] - (code_.size() + 4)));
+		}
+	}
+
+public:
+	DynamicArray<uint8_t> const& code() const
+	{
+		return code_;
+	}
+
+	size_t size() const
+	{
+		return code_.size();
+	}
+
+	void byte(uint8_t value)
+	{
+		code_.push_back(value);
+	}
+
+	void bytes(std::initializer_list<uint8_t> values)
+	{
+		code_.insert(code_.end(), values.begin(), values.end());
+	}
+
+	void imm32(int32_t value)
+	{
+		put32(value);
+	}
+
+	void immPtr(const void* value)
+	{
+		if (X64)
+		{
+			put64(reinterpret_cast<uintptr_t>(value));
+		}
+		else
+		{
+			put32(static_cast<int32_t>(reinterpret_cast<uintptr_t>(value)));
+		}
+	}
+
+	Label newLabel()
+	{
+		labels_.push_back(Unbound);
+		return labels_.size() - 1;
+	}
+
+	/// Make `count` labels at once, numbered from the returned one up
+	Label newLabels(size_t count)
+	{
+		const Label first = labels_.size();
+		labels_.resize(first + count, Unbound);
+		return first;
+	}
+
+	void bind(Label label)
+	{
+		labels_[label] = code_.size();
+	}
+
+	bool isBound(Label label) const
+	{
+		return labels_[label] != Unbound;
+	}
+
+	size_t offsetOf(Label label) const
+	{
+		return labels_[label];
+	}
+
+	/// Fill in the jumps to labels that were bound after them
+	/// @returns "false" if a jump goes to a label that was never bound
+	bool resolve()
+	{
+		for (auto const& fixup : fixups_)
+		{
+			if (labels_[fixup.second] == Unbound)
+			{
+				return false;
+			}
+			const int32_t rel = static_cast<int32_t>(labels_[fixup.second] - (fixup.first + 4));
+			memcpy(&code_[fixup.first], &rel, 4);
+		}
+		fixups_.clear();
+		return true;
+	}
+
+	void mov(Reg dst, Reg src)
+	{
+		byte(0x89);
+		modrm(src, dst);
+	}
+
+	void mov(Reg dst, int32_t value)
+	{
+		if (value == 0)
+		{
+			alu(Xor, dst, dst);
+			return;
+		}
+		byte(0xB8 + dst);
+		put32(value);
+	}
+
+	void load(Reg dst, Mem const& src)
+	{
+		byte(0x8B);
+		modrm(dst, src);
+	}
+
+	void store(Mem const& dst, Reg src)
+	{
+		byte(0x89);
+		modrm(src, dst);
+	}
+
+	void store(Mem const& dst, int32_t value)
+	{
+		byte(0xC7);
+		modrm(0, dst);
+		put32(value);
+	}
+
+	/// Store the low byte of EAX, ECX, EDX or EBX
+	void store8(Mem const& dst, Reg src)
+	{
+		byte(0x88);
+		modrm(src, dst);
+	}
+
+	void store16(Mem const& dst, Reg src)
+	{
+		byte(0x66);
+		byte(0x89);
+		modrm(src, dst);
+	}
+
+	void loadZX8(Reg dst, Mem const& src)
+	{
+		bytes({ 0x0F, 0xB6 });
+		modrm(dst, src);
+	}
+
+	void loadZX16(Reg dst, Mem const& src)
+	{
+		bytes({ 0x0F, 0xB7 });
+		modrm(dst, src);
+	}
+
+	/// Load a pointer-sized value
+	void loadPtr(Reg dst, Mem const& src)
+	{
+		rexW();
+		load(dst, src);
+	}
+
+	/// Compare a pointer-sized value with a small constant
+	void cmpPtr(Mem const& mem, int8_t value)
+	{
+		rexW();
+		byte(0x83);
+		modrm(Cmp, mem);
+		byte(static_cast<uint8_t>(value));
+	}
+
+	/// Copy a pointer-sized register
+	void movPtr(Reg dst, Reg src)
+	{
+		rexW();
+		mov(dst, src);
+	}
+
+	/// Sign extend a 32-bit register to the full address width, for addresses the script computed
+	/// and nothing checked, which wrap around in the interpreter
+	void address(Reg dst, Reg src)
+	{
+		if (X64)
+		{
+			bytes({ 0x48, 0x63 });
+			modrm(dst, src);
+		}
+		else if (dst != src)
+		{
+			mov(dst, src);
+		}
+	}
+
+	void lea(Reg dst, Mem const& src)
+	{
+		byte(0x8D);
+		modrm(dst, src);
+	}
+
+	void alu(Alu op, Reg dst, Reg src)
+	{
+		byte(op * 8 + 1);
+		modrm(src, dst);
+	}
+
+	void alu(Alu op, Reg dst, Mem const& src)
+	{
+		byte(op * 8 + 3);
+		modrm(dst, src);
+	}
+
+	void alu(Alu op, Mem const& dst, Reg src)
+	{
+		byte(op * 8 + 1);
+		modrm(src, dst);
+	}
+
+	void alu(Alu op, Reg dst, int32_t value)
+	{
+		if (isInt8(value))
+		{
+			byte(0x83);
+			modrm(op, dst);
+			byte(static_cast<uint8_t>(value));
+		}
+		else
+		{
+			byte(0x81);
+			modrm(op, dst);
+			put32(value);
+		}
+	}
+
+	void alu(Alu op, Mem const& dst, int32_t value)
+	{
+		if (isInt8(value))
+		{
+			byte(0x83);
+			modrm(op, dst);
+			byte(static_cast<uint8_t>(value));
+		}
+		else
+		{
+			byte(0x81);
+			modrm(op, dst);
+			put32(value);
+		}
+	}
+
+	void test(Reg a, Reg b)
+	{
+		byte(0x85);
+		modrm(b, a);
+	}
+
+	/// Test the low byte of EAX, ECX, EDX or EBX
+	void test8(Reg reg, uint8_t value)
+	{
+		byte(0xF6);
+		modrm(0, reg);
+		byte(value);
+	}
+
+	void imul(Reg dst, Reg src)
+	{
+		bytes({ 0x0F, 0xAF });
+		modrm(dst, src);
+	}
+
+	void imul(Reg dst, Reg src, int32_t value)
+	{
+		byte(0x69);
+		modrm(dst, src);
+		put32(value);
+	}
+
+	/// EDX:EAX / reg, signed
+	void idiv(Reg reg)
+	{
+		byte(0xF7);
+		modrm(7, reg);
+	}
+
+	/// EDX:EAX / reg, unsigned
+	void div(Reg reg)
+	{
+		byte(0xF7);
+		modrm(6, reg);
+	}
+
+	/// Sign extend EAX into EDX
+	void cdq()
+	{
+		byte(0x99);
+	}
+
+	void neg(Reg reg)
+	{
+		byte(0xF7);
+		modrm(3, reg);
+	}
+
+	void not_(Reg reg)
+	{
+		byte(0xF7);
+		modrm(2, reg);
+	}
+
+	void xchgEaxEcx()
+	{
+		byte(0x91);
+	}
+
+	/// Shift by CL: `ext` is 4 for SHL, 5 for SHR and 7 for SAR
+	void shiftCl(uint8_t ext, Reg reg)
+	{
+		byte(0xD3);
+		modrm(ext, reg);
+	}
+
+	void shift(uint8_t ext, Reg reg, uint8_t count)
+	{
+		byte(0xC1);
+		modrm(ext, reg);
+		byte(count);
+	}
+
+	/// Set the low byte of EAX, ECX, EDX or EBX to a condition
+	void set(Cond cond, Reg reg)
+	{
+		bytes({ 0x0F, static_cast<uint8_t>(0x90 + cond) });
+		modrm(0, reg);
+	}
+
+	void jmp(Label label)
+	{
+		byte(0xE9);
+		rel32(label);
+	}
+
+	void j(Cond cond, Label label)
+	{
+		bytes({ 0x0F, static_cast<uint8_t>(0x80 + cond) });
+		rel32(label);
+	}
+
+	/// A short forward jump, over at most 127 bytes, finished with `land`
+	size_t jShort(Cond cond)
+	{
+		bytes({ static_cast<uint8_t>(0x70 + cond), 0 });
+		return code_.size();
+	}
+
+	size_t jmpShort()
+	{
+		bytes({ 0xEB, 0 });
+		return code_.size();
+	}
+
+	void land(size_t jump)
+	{
+		code_[jump - 1] = static_cast<uint8_t>(code_.size() - jump);
+	}
+
+	/// Call a function at an absolute address, through EAX (RAX) on x86-64 and EDX otherwise
+	void call(const void* function)
+	{
+		if (X64)
+		{
+			bytes({ 0x48, 0xB8 });
+			immPtr(function);
+			bytes({ 0xFF, 0xD0 });
+		}
+		else
+		{
+			byte(0xB8 + EDX);
+			immPtr(function);
+			bytes({ 0xFF, 0xD2 });
+		}
+	}
+
+	void ret()
+	{
+		byte(0xC3);
+	}
+};
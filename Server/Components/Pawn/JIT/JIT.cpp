@@ -0,0 +1,1600 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#include "JIT.hpp"
+#include "Assembler.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// The 32-bit code is only built for jit-check (Tools/jit-check) until it has passed there on an x86
+// build, define PAWN_JIT_X86 to build it.
+#if defined(__linux__) && (defined(__x86_64__) || (defined(__i386__) && defined(PAWN_JIT_X86)))
+#define PAWN_JIT_SUPPORTED
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+/// The AMX instruction set, numbered as in the file format
+enum class Op : cell
+{
+	NONE,
+	LOAD_PRI,
+	LOAD_ALT,
+	LOAD_S_PRI,
+	LOAD_S_ALT,
+	LREF_PRI,
+	LREF_ALT,
+	LREF_S_PRI,
+	LREF_S_ALT,
+	LOAD_I,
+	LODB_I,
+	CONST_PRI,
+	CONST_ALT,
+	ADDR_PRI,
+	ADDR_ALT,
+	STOR_PRI,
+	STOR_ALT,
+	STOR_S_PRI,
+	STOR_S_ALT,
+	SREF_PRI,
+	SREF_ALT,
+	SREF_S_PRI,
+	SREF_S_ALT,
+	STOR_I,
+	STRB_I,
+	LIDX,
+	LIDX_B,
+	IDXADDR,
+	IDXADDR_B,
+	ALIGN_PRI,
+	ALIGN_ALT,
+	LCTRL,
+	SCTRL,
+	MOVE_PRI,
+	MOVE_ALT,
+	XCHG,
+	PUSH_PRI,
+	PUSH_ALT,
+	PUSH_R,
+	PUSH_C,
+	PUSH,
+	PUSH_S,
+	POP_PRI,
+	POP_ALT,
+	STACK,
+	HEAP,
+	PROC,
+	RET,
+	RETN,
+	CALL,
+	CALL_PRI,
+	JUMP,
+	JREL,
+	JZER,
+	JNZ,
+	JEQ,
+	JNEQ,
+	JLESS,
+	JLEQ,
+	JGRTR,
+	JGEQ,
+	JSLESS,
+	JSLEQ,
+	JSGRTR,
+	JSGEQ,
+	SHL,
+	SHR,
+	SSHR,
+	SHL_C_PRI,
+	SHL_C_ALT,
+	SHR_C_PRI,
+	SHR_C_ALT,
+	SMUL,
+	SDIV,
+	SDIV_ALT,
+	UMUL,
+	UDIV,
+	UDIV_ALT,
+	ADD,
+	SUB,
+	SUB_ALT,
+	AND,
+	OR,
+	XOR,
+	NOT,
+	NEG,
+	INVERT,
+	ADD_C,
+	SMUL_C,
+	ZERO_PRI,
+	ZERO_ALT,
+	ZERO,
+	ZERO_S,
+	SIGN_PRI,
+	SIGN_ALT,
+	EQ,
+	NEQ,
+	LESS,
+	LEQ,
+	GRTR,
+	GEQ,
+	SLESS,
+	SLEQ,
+	SGRTR,
+	SGEQ,
+	EQ_C_PRI,
+	EQ_C_ALT,
+	INC_PRI,
+	INC_ALT,
+	INC,
+	INC_S,
+	INC_I,
+	DEC_PRI,
+	DEC_ALT,
+	DEC,
+	DEC_S,
+	DEC_I,
+	MOVS,
+	CMPS,
+	FILL,
+	HALT,
+	BOUNDS,
+	SYSREQ_PRI,
+	SYSREQ_C,
+	FILE,
+	LINE,
+	SYMBOL,
+	SRANGE,
+	JUMP_PRI,
+	SWITCH,
+	CASETBL,
+	SWAP_PRI,
+	SWAP_ALT,
+	PUSH_ADR,
+	NOP,
+	SYSREQ_N,
+	SYMTAG,
+	BREAK,
+	End,
+};
+
+/// Operands after the opcode, -1 for the instructions that don't have a fixed length
+int operandCount(Op op)
+{
+	switch (op)
+	{
+	case Op::LOAD_PRI:
+	case Op::LOAD_ALT:
+	case Op::LOAD_S_PRI:
+	case Op::LOAD_S_ALT:
+	case Op::LREF_PRI:
+	case Op::LREF_ALT:
+	case Op::LREF_S_PRI:
+	case Op::LREF_S_ALT:
+	case Op::LODB_I:
+	case Op::CONST_PRI:
+	case Op::CONST_ALT:
+	case Op::ADDR_PRI:
+	case Op::ADDR_ALT:
+	case Op::STOR_PRI:
+	case Op::STOR_ALT:
+	case Op::STOR_S_PRI:
+	case Op::STOR_S_ALT:
+	case Op::SREF_PRI:
+	case Op::SREF_ALT:
+	case Op::SREF_S_PRI:
+	case Op::SREF_S_ALT:
+	case Op::STRB_I:
+	case Op::LIDX_B:
+	case Op::IDXADDR_B:
+	case Op::ALIGN_PRI:
+	case Op::ALIGN_ALT:
+	case Op::LCTRL:
+	case Op::SCTRL:
+	case Op::PUSH_R:
+	case Op::PUSH_C:
+	case Op::PUSH:
+	case Op::PUSH_S:
+	case Op::STACK:
+	case Op::HEAP:
+	case Op::CALL:
+	case Op::JUMP:
+	case Op::JREL:
+	case Op::JZER:
+	case Op::JNZ:
+	case Op::JEQ:
+	case Op::JNEQ:
+	case Op::JLESS:
+	case Op::JLEQ:
+	case Op::JGRTR:
+	case Op::JGEQ:
+	case Op::JSLESS:
+	case Op::JSLEQ:
+	case Op::JSGRTR:
+	case Op::JSGEQ:
+	case Op::SHL_C_PRI:
+	case Op::SHL_C_ALT:
+	case Op::SHR_C_PRI:
+	case Op::SHR_C_ALT:
+	case Op::ADD_C:
+	case Op::SMUL_C:
+	case Op::ZERO:
+	case Op::ZERO_S:
+	case Op::EQ_C_PRI:
+	case Op::EQ_C_ALT:
+	case Op::INC:
+	case Op::INC_S:
+	case Op::DEC:
+	case Op::DEC_S:
+	case Op::MOVS:
+	case Op::CMPS:
+	case Op::FILL:
+	case Op::HALT:
+	case Op::BOUNDS:
+	case Op::SYSREQ_C:
+	case Op::SWITCH:
+	case Op::PUSH_ADR:
+	case Op::SYMTAG:
+		return 1;
+	case Op::LINE:
+	case Op::SRANGE:
+	case Op::SYSREQ_N:
+		return 2;
+	case Op::FILE:
+	case Op::SYMBOL:
+	case Op::CASETBL:
+		return -1;
+	default:
+		return 0;
+	}
+}
+
+/// The instructions left to the interpreter, by name for the log
+const char* unsupportedName(Op op, cell operand)
+{
+	switch (op)
+	{
+	case Op::NONE:
+		return "an invalid instruction";
+	case Op::PUSH_R:
+		return "PUSH.R";
+	case Op::CALL_PRI:
+		return "CALL.pri";
+	case Op::JREL:
+		return "JREL";
+	case Op::FILE:
+		return "FILE";
+	case Op::SYMBOL:
+		return "SYMBOL";
+	case Op::JUMP_PRI:
+		return "JUMP.pri";
+	case Op::LCTRL:
+		// COD and DAT are only any use for finding the code from the data, to change it.
+		return (operand >= 2 && operand <= 6) ? nullptr : "LCTRL with COD, DAT or an unknown register";
+	case Op::SCTRL:
+		return (operand >= 0 && operand <= 5) ? nullptr : "SCTRL with CIP or an unknown register";
+	default:
+		return (op < Op::NONE || op >= Op::End) ? "an unknown instruction" : nullptr;
+	}
+}
+
+/// Room the interpreter keeps between the heap and the stack
+constexpr cell StackMargin = 16 * sizeof(cell);
+
+/// The registers while the generated code is running, on the native stack of `exec`.  The AMX
+/// registers are only written here around calls out, the rest of the time they live in native
+/// registers, except HEA.
+struct Context
+{
+	AMX* amx;
+	unsigned char* data;
+	const void* const* addresses;
+	cell* retval;
+	cell pri;
+	cell alt;
+	cell frm;
+	cell stk;
+	cell hea;
+	cell hlw;
+	cell stp;
+	cell reset_stk;
+	cell reset_hea;
+	/// The instruction after a call out, for `amx->cip`
+	cell cip;
+	/// A second operand for the calls out that need one, or a spare register
+	cell scratch;
+	/// What `exec` returns, once a call out says to stop
+	int result;
+};
+
+/// Everything the generated code calls returns 0 to carry on and anything else to return `result`
+using Helper = int (*)(Context* ctx, cell operand);
+
+/// The interpreter's `ABORT`: put the stack and heap back as they were when it was called
+int abortWith(Context* ctx, cell error)
+{
+	ctx->amx->stk = ctx->reset_stk;
+	ctx->amx->hea = ctx->reset_hea;
+	ctx->result = error;
+	return 1;
+}
+
+/// Stop without touching the AMX, as the interpreter does for a stack or heap overflow
+int failWith(Context* ctx, cell error)
+{
+	ctx->result = error;
+	return 1;
+}
+
+/// Stop so `AMX_EXEC_CONT` can carry on from here, once `cip`, `frm`, `stk` and `hea` are stored
+int sleepWith(Context* ctx, int error)
+{
+	AMX* amx = ctx->amx;
+	amx->pri = ctx->pri;
+	amx->alt = ctx->alt;
+	amx->reset_stk = ctx->reset_stk;
+	amx->reset_hea = ctx->reset_hea;
+	ctx->result = error;
+	return 1;
+}
+
+/// Call a native, with its parameters already on the stack and `pop` bytes of them to remove after
+int callNative(Context* ctx, cell index, cell pop)
+{
+	AMX* amx = ctx->amx;
+	amx->cip = ctx->cip;
+	amx->hea = ctx->hea;
+	amx->frm = ctx->frm;
+	amx->stk = ctx->stk;
+	const int error = amx->callback(amx, index, &ctx->pri, reinterpret_cast<cell*>(ctx->data + ctx->stk));
+	ctx->stk += pop;
+	if (error == AMX_ERR_NONE)
+	{
+		return 0;
+	}
+	if (error == AMX_ERR_SLEEP)
+	{
+		amx->stk = ctx->stk;
+		return sleepWith(ctx, error);
+	}
+	return abortWith(ctx, error);
+}
+
+/// `SYSREQ.C`
+int sysreq(Context* ctx, cell index)
+{
+	return callNative(ctx, index, 0);
+}
+
+/// `SYSREQ.pri`
+int sysreqPri(Context* ctx, cell)
+{
+	return callNative(ctx, ctx->pri, 0);
+}
+
+/// `SYSREQ.N`, with the size of the parameters in `scratch`
+int sysreqN(Context* ctx, cell index)
+{
+	return callNative(ctx, index, ctx->scratch + sizeof(cell));
+}
+
+/// `BREAK`, only called when there is a debug hook
+int debugBreak(Context* ctx, cell)
+{
+	AMX* amx = ctx->amx;
+	if (amx->debug == nullptr)
+	{
+		return 0;
+	}
+	amx->frm = ctx->frm;
+	amx->stk = ctx->stk;
+	amx->hea = ctx->hea;
+	amx->cip = ctx->cip;
+	const int error = amx->debug(amx);
+	if (error == AMX_ERR_NONE)
+	{
+		return 0;
+	}
+	if (error == AMX_ERR_SLEEP)
+	{
+		return sleepWith(ctx, error);
+	}
+	return abortWith(ctx, error);
+}
+
+/// `HALT`, which always stops
+int halt(Context* ctx, cell error)
+{
+	AMX* amx = ctx->amx;
+	if (ctx->retval)
+	{
+		*ctx->retval = ctx->pri;
+	}
+	amx->frm = ctx->frm;
+	amx->pri = ctx->pri;
+	amx->alt = ctx->alt;
+	amx->cip = ctx->cip;
+	if (error == AMX_ERR_SLEEP)
+	{
+		amx->stk = ctx->stk;
+		amx->hea = ctx->hea;
+		amx->reset_stk = ctx->reset_stk;
+		amx->reset_hea = ctx->reset_hea;
+		ctx->result = error;
+		return 1;
+	}
+	return abortWith(ctx, error);
+}
+
+/// The interpreter's checks on a block of memory for `MOVS`, `CMPS` and `FILL`
+bool badBlock(Context const* ctx, cell address, cell size)
+{
+	const cell end = static_cast<cell>(static_cast<ucell>(address) + static_cast<ucell>(size));
+	return size < 0
+		|| (address >= ctx->hea && address < ctx->stk) || static_cast<ucell>(address) >= static_cast<ucell>(ctx->stp)
+		|| (end > ctx->hea && end < ctx->stk) || static_cast<ucell>(end) > static_cast<ucell>(ctx->stp);
+}
+
+int movs(Context* ctx, cell size)
+{
+	if (badBlock(ctx, ctx->pri, size) || badBlock(ctx, ctx->alt, size))
+	{
+		return abortWith(ctx, AMX_ERR_MEMACCESS);
+	}
+	memmove(ctx->data + ctx->alt, ctx->data + ctx->pri, size);
+	return 0;
+}
+
+int cmps(Context* ctx, cell size)
+{
+	if (badBlock(ctx, ctx->pri, size) || badBlock(ctx, ctx->alt, size))
+	{
+		return abortWith(ctx, AMX_ERR_MEMACCESS);
+	}
+	ctx->pri = memcmp(ctx->data + ctx->alt, ctx->data + ctx->pri, size);
+	return 0;
+}
+
+int fill(Context* ctx, cell size)
+{
+	if (badBlock(ctx, ctx->alt, size))
+	{
+		return abortWith(ctx, AMX_ERR_MEMACCESS);
+	}
+	for (cell offset = ctx->alt; size >= cell(sizeof(cell)); offset += sizeof(cell), size -= sizeof(cell))
+	{
+		memcpy(ctx->data + offset, &ctx->pri, sizeof(cell));
+	}
+	return 0;
+}
+
+/// Turns the AMX code into native code, one instruction at a time.  The AMX registers live in
+/// native ones: PRI in EAX, ALT in ECX, STK in ESI and FRM in EDI, with EBX pointing at the data and
+/// EBP at the `Context`.  On x86-64 R12 points at the `addresses` table too.
+class Translator
+{
+private:
+	using A = X86Assembler;
+	using Reg = A::Reg;
+	using Mem = A::Mem;
+	using Label = A::Label;
+
+	static constexpr Reg PRI = A::EAX;
+	static constexpr Reg ALT = A::ECX;
+	static constexpr Reg TMP = A::EDX;
+	static constexpr Reg DAT = A::EBX;
+	static constexpr Reg CTX = A::EBP;
+	static constexpr Reg STK = A::ESI;
+	static constexpr Reg FRM = A::EDI;
+
+	/// Outgoing arguments and padding to keep the stack aligned on x86
+	static constexpr int32_t FrameSize = 28;
+
+	A a_;
+	const cell* code_;
+	size_t cells_;
+	const void* const* table_;
+	/// Which cells an instruction starts at
+	DynamicArray<bool> starts_;
+
+	Label cellLabels_;
+	Label exit_;
+	Label memoryError_;
+	Label stackError_;
+	Label stackLow_;
+	Label heapLow_;
+	Label boundsError_;
+	Label divideError_;
+	Label invalid_;
+
+	static Mem global(cell address)
+	{
+		return Mem(DAT, address);
+	}
+
+	static Mem local(cell offset)
+	{
+		return Mem(DAT, FRM, 0, offset);
+	}
+
+	static Mem top(cell offset = 0)
+	{
+		return Mem(DAT, STK, 0, offset);
+	}
+
+	static Mem at(Reg address)
+	{
+		return Mem(DAT, address, 0, 0);
+	}
+
+	static Mem field(size_t offset)
+	{
+		return Mem(CTX, static_cast<int32_t>(offset));
+	}
+
+	Label label(cell address) const
+	{
+		return cellLabels_ + address / sizeof(cell);
+	}
+
+	/// Whether a jump target is the start of an instruction
+	bool isTarget(cell address) const
+	{
+		return address >= 0 && static_cast<size_t>(address) < cells_ * sizeof(cell) && address % sizeof(cell) == 0 && starts_[address / sizeof(cell)];
+	}
+
+	void push(Reg reg)
+	{
+		a_.alu(A::Sub, STK, 4);
+		a_.store(top(), reg);
+	}
+
+	void pushValue(cell value)
+	{
+		a_.alu(A::Sub, STK, 4);
+		a_.store(top(), value);
+	}
+
+	void pop(Reg reg)
+	{
+		a_.load(reg, top());
+		a_.alu(A::Add, STK, 4);
+	}
+
+	/// The interpreter's check on addresses the script computed: in the data, heap or stack, but
+	/// not the unused space between the heap and the stack
+	void check(Reg address)
+	{
+		a_.alu(A::Cmp, address, field(offsetof(Context, stp)));
+		a_.j(A::AboveEqual, memoryError_);
+		a_.alu(A::Cmp, address, field(offsetof(Context, hea)));
+		const size_t below = a_.jShort(A::Less);
+		a_.alu(A::Cmp, address, STK);
+		a_.j(A::Less, memoryError_);
+		a_.land(below);
+	}
+
+	/// Fail when the heap and the stack have got too close
+	void checkMargin()
+	{
+		a_.load(TMP, field(offsetof(Context, hea)));
+		a_.alu(A::Add, TMP, StackMargin);
+		a_.alu(A::Cmp, TMP, STK);
+		a_.j(A::Greater, stackError_);
+	}
+
+	/// Store the registers, call out and pick them up again, stopping if the helper says so
+	void callHelper(Helper helper, cell operand)
+	{
+		a_.store(field(offsetof(Context, pri)), PRI);
+		a_.store(field(offsetof(Context, alt)), ALT);
+		a_.store(field(offsetof(Context, frm)), FRM);
+		a_.store(field(offsetof(Context, stk)), STK);
+		if (A::X64)
+		{
+			a_.movPtr(A::EDI, CTX);
+			a_.mov(A::ESI, operand);
+		}
+		else
+		{
+			a_.store(Mem(A::ESP, 0), CTX);
+			a_.store(Mem(A::ESP, 4), operand);
+		}
+		a_.call(reinterpret_cast<const void*>(helper));
+		a_.test(A::EAX, A::EAX);
+		a_.j(A::NotEqual, exit_);
+		a_.load(PRI, field(offsetof(Context, pri)));
+		a_.load(ALT, field(offsetof(Context, alt)));
+		a_.load(FRM, field(offsetof(Context, frm)));
+		a_.load(STK, field(offsetof(Context, stk)));
+	}
+
+	/// Jump to a code address in TMP, for returns
+	void jumpTo()
+	{
+		a_.alu(A::Cmp, TMP, static_cast<int32_t>(cells_ * sizeof(cell)));
+		a_.j(A::AboveEqual, memoryError_);
+		a_.test8(TMP, sizeof(cell) - 1);
+		a_.j(A::NotEqual, memoryError_);
+		if (A::X64)
+		{
+			// jmp [r12 + rdx * 2]
+			a_.bytes({ 0x41, 0xFF, 0x24, 0x54 });
+		}
+		else
+		{
+			// jmp [edx + table]
+			a_.bytes({ 0xFF, 0xA2 });
+			a_.immPtr(table_);
+		}
+	}
+
+	/// Floored division of EAX by ECX, leaving the quotient in PRI and the remainder in ALT
+	void divide(bool isSigned)
+	{
+		a_.test(ALT, ALT);
+		a_.j(A::Equal, divideError_);
+		if (!isSigned)
+		{
+			a_.mov(TMP, 0);
+			a_.div(ALT);
+			a_.mov(ALT, TMP);
+			return;
+		}
+		// -1 separately, `INT_MIN / -1` traps.
+		a_.alu(A::Cmp, ALT, -1);
+		const size_t divisor = a_.jShort(A::NotEqual);
+		a_.neg(PRI);
+		a_.mov(TMP, 0);
+		const size_t negated = a_.jmpShort();
+		a_.land(divisor);
+		a_.cdq();
+		a_.idiv(ALT);
+		// Rounded towards zero, round down instead when the signs differ.
+		a_.test(TMP, TMP);
+		const size_t exact = a_.jShort(A::Equal);
+		a_.store(field(offsetof(Context, scratch)), TMP);
+		a_.alu(A::Xor, TMP, ALT);
+		a_.load(TMP, field(offsetof(Context, scratch)));
+		const size_t sameSign = a_.jShort(A::NotSign);
+		a_.alu(A::Add, TMP, ALT);
+		a_.alu(A::Sub, PRI, 1);
+		a_.land(exact);
+		a_.land(sameSign);
+		a_.land(negated);
+		a_.mov(ALT, TMP);
+	}
+
+	/// PRI = PRI `cond` ALT
+	void compare(A::Cond cond)
+	{
+		a_.mov(TMP, 0);
+		a_.alu(A::Cmp, PRI, ALT);
+		a_.set(cond, TMP);
+		a_.mov(PRI, TMP);
+	}
+
+	void prologue()
+	{
+		if (A::X64)
+		{
+			// push rbp; push rbx; push r12, which leaves the stack aligned.
+			a_.bytes({ 0x55, 0x53, 0x41, 0x54 });
+			a_.movPtr(CTX, A::EDI);
+			// mov r12, [rbp + addresses]
+			a_.bytes({ 0x4C, 0x8B, 0x65, static_cast<uint8_t>(offsetof(Context, addresses)) });
+			a_.movPtr(TMP, A::ESI);
+		}
+		else
+		{
+			// push ebp; push ebx; push esi; push edi
+			a_.bytes({ 0x55, 0x53, 0x56, 0x57 });
+			a_.alu(A::Sub, A::ESP, FrameSize);
+			a_.load(CTX, Mem(A::ESP, FrameSize + 16 + 4));
+			a_.load(TMP, Mem(A::ESP, FrameSize + 16 + 8));
+		}
+		a_.loadPtr(DAT, field(offsetof(Context, data)));
+		a_.load(PRI, field(offsetof(Context, pri)));
+		a_.load(ALT, field(offsetof(Context, alt)));
+		a_.load(FRM, field(offsetof(Context, frm)));
+		a_.load(STK, field(offsetof(Context, stk)));
+		// jmp edx
+		a_.bytes({ 0xFF, 0xE2 });
+	}
+
+	void epilogue()
+	{
+		a_.bind(exit_);
+		a_.load(A::EAX, field(offsetof(Context, result)));
+		if (A::X64)
+		{
+			// pop r12; pop rbx; pop rbp
+			a_.bytes({ 0x41, 0x5C, 0x5B, 0x5D });
+		}
+		else
+		{
+			a_.alu(A::Add, A::ESP, FrameSize);
+			// pop edi; pop esi; pop ebx; pop ebp
+			a_.bytes({ 0x5F, 0x5E, 0x5B, 0x5D });
+		}
+		a_.ret();
+	}
+
+	void stub(Label at, Helper helper, cell error)
+	{
+		a_.bind(at);
+		callHelper(helper, error);
+		a_.jmp(exit_);
+	}
+
+	/// Translate the instruction at `pos`
+	void translate(size_t pos)
+	{
+		const Op op = static_cast<Op>(code_[pos]);
+		const cell p = operandCount(op) > 0 ? code_[pos + 1] : 0;
+		const cell next = static_cast<cell>((pos + 1 + std::max(operandCount(op), 0)) * sizeof(cell));
+		switch (op)
+		{
+		case Op::LOAD_PRI:
+			a_.load(PRI, global(p));
+			break;
+		case Op::LOAD_ALT:
+			a_.load(ALT, global(p));
+			break;
+		case Op::LOAD_S_PRI:
+			a_.load(PRI, local(p));
+			break;
+		case Op::LOAD_S_ALT:
+			a_.load(ALT, local(p));
+			break;
+		case Op::LREF_PRI:
+		case Op::LREF_ALT:
+			a_.load(TMP, global(p));
+			a_.address(TMP, TMP);
+			a_.load(op == Op::LREF_PRI ? PRI : ALT, at(TMP));
+			break;
+		case Op::LREF_S_PRI:
+		case Op::LREF_S_ALT:
+			a_.load(TMP, local(p));
+			a_.address(TMP, TMP);
+			a_.load(op == Op::LREF_S_PRI ? PRI : ALT, at(TMP));
+			break;
+		case Op::LOAD_I:
+			check(PRI);
+			a_.load(PRI, at(PRI));
+			break;
+		case Op::LODB_I:
+			check(PRI);
+			if (p == 1)
+			{
+				a_.loadZX8(PRI, at(PRI));
+			}
+			else if (p == 2)
+			{
+				a_.loadZX16(PRI, at(PRI));
+			}
+			else if (p == 4)
+			{
+				a_.load(PRI, at(PRI));
+			}
+			break;
+		case Op::CONST_PRI:
+			a_.mov(PRI, p);
+			break;
+		case Op::CONST_ALT:
+			a_.mov(ALT, p);
+			break;
+		case Op::ADDR_PRI:
+			a_.lea(PRI, Mem(FRM, p));
+			break;
+		case Op::ADDR_ALT:
+			a_.lea(ALT, Mem(FRM, p));
+			break;
+		case Op::STOR_PRI:
+			a_.store(global(p), PRI);
+			break;
+		case Op::STOR_ALT:
+			a_.store(global(p), ALT);
+			break;
+		case Op::STOR_S_PRI:
+			a_.store(local(p), PRI);
+			break;
+		case Op::STOR_S_ALT:
+			a_.store(local(p), ALT);
+			break;
+		case Op::SREF_PRI:
+		case Op::SREF_ALT:
+			a_.load(TMP, global(p));
+			a_.address(TMP, TMP);
+			a_.store(at(TMP), op == Op::SREF_PRI ? PRI : ALT);
+			break;
+		case Op::SREF_S_PRI:
+		case Op::SREF_S_ALT:
+			a_.load(TMP, local(p));
+			a_.address(TMP, TMP);
+			a_.store(at(TMP), op == Op::SREF_S_PRI ? PRI : ALT);
+			break;
+		case Op::STOR_I:
+			check(ALT);
+			a_.store(at(ALT), PRI);
+			break;
+		case Op::STRB_I:
+			check(ALT);
+			if (p == 1)
+			{
+				a_.store8(at(ALT), PRI);
+			}
+			else if (p == 2)
+			{
+				a_.store16(at(ALT), PRI);
+			}
+			else if (p == 4)
+			{
+				a_.store(at(ALT), PRI);
+			}
+			break;
+		case Op::LIDX:
+			a_.lea(TMP, Mem(ALT, PRI, 2, 0));
+			check(TMP);
+			a_.load(PRI, at(TMP));
+			break;
+		case Op::LIDX_B:
+			a_.mov(TMP, PRI);
+			a_.shift(4, TMP, static_cast<uint8_t>(p));
+			a_.alu(A::Add, TMP, ALT);
+			check(TMP);
+			a_.load(PRI, at(TMP));
+			break;
+		case Op::IDXADDR:
+			a_.lea(PRI, Mem(ALT, PRI, 2, 0));
+			break;
+		case Op::IDXADDR_B:
+			a_.shift(4, PRI, static_cast<uint8_t>(p));
+			a_.alu(A::Add, PRI, ALT);
+			break;
+		case Op::ALIGN_PRI:
+		case Op::ALIGN_ALT:
+			if (p < cell(sizeof(cell)))
+			{
+				a_.alu(A::Xor, op == Op::ALIGN_PRI ? PRI : ALT, static_cast<int32_t>(sizeof(cell) - p));
+			}
+			break;
+		case Op::LCTRL:
+			switch (p)
+			{
+			case 2:
+				a_.load(PRI, field(offsetof(Context, hea)));
+				break;
+			case 3:
+				a_.load(PRI, field(offsetof(Context, stp)));
+				break;
+			case 4:
+				a_.mov(PRI, STK);
+				break;
+			case 5:
+				a_.mov(PRI, FRM);
+				break;
+			case 6:
+				a_.mov(PRI, next);
+				break;
+			}
+			break;
+		case Op::SCTRL:
+			// COD, DAT and STP can't be changed.
+			switch (p)
+			{
+			case 2:
+				a_.store(field(offsetof(Context, hea)), PRI);
+				break;
+			case 4:
+				a_.mov(STK, PRI);
+				break;
+			case 5:
+				a_.mov(FRM, PRI);
+				break;
+			}
+			break;
+		case Op::MOVE_PRI:
+			a_.mov(PRI, ALT);
+			break;
+		case Op::MOVE_ALT:
+			a_.mov(ALT, PRI);
+			break;
+		case Op::XCHG:
+			a_.xchgEaxEcx();
+			break;
+		case Op::PUSH_PRI:
+			push(PRI);
+			break;
+		case Op::PUSH_ALT:
+			push(ALT);
+			break;
+		case Op::PUSH_C:
+			pushValue(p);
+			break;
+		case Op::PUSH:
+			a_.load(TMP, global(p));
+			push(TMP);
+			break;
+		case Op::PUSH_S:
+			a_.load(TMP, local(p));
+			push(TMP);
+			break;
+		case Op::PUSH_ADR:
+			a_.lea(TMP, Mem(FRM, p));
+			push(TMP);
+			break;
+		case Op::POP_PRI:
+			pop(PRI);
+			break;
+		case Op::POP_ALT:
+			pop(ALT);
+			break;
+		case Op::STACK:
+			a_.mov(ALT, STK);
+			a_.alu(A::Add, STK, p);
+			checkMargin();
+			a_.alu(A::Cmp, STK, field(offsetof(Context, stp)));
+			a_.j(A::Greater, stackLow_);
+			break;
+		case Op::HEAP:
+			a_.load(ALT, field(offsetof(Context, hea)));
+			a_.alu(A::Add, field(offsetof(Context, hea)), p);
+			checkMargin();
+			a_.load(TMP, field(offsetof(Context, hea)));
+			a_.alu(A::Cmp, TMP, field(offsetof(Context, hlw)));
+			a_.j(A::Less, heapLow_);
+			break;
+		case Op::PROC:
+			push(FRM);
+			a_.mov(FRM, STK);
+			checkMargin();
+			break;
+		case Op::RET:
+			pop(FRM);
+			pop(TMP);
+			jumpTo();
+			break;
+		case Op::RETN:
+			pop(FRM);
+			pop(TMP);
+			// Remove the arguments, and the count of them.
+			a_.alu(A::Add, STK, top());
+			a_.alu(A::Add, STK, 4);
+			jumpTo();
+			break;
+		case Op::CALL:
+			pushValue(next);
+			a_.jmp(label(p));
+			break;
+		case Op::JUMP:
+			a_.jmp(label(p));
+			break;
+		case Op::JZER:
+		case Op::JNZ:
+			a_.test(PRI, PRI);
+			a_.j(op == Op::JZER ? A::Equal : A::NotEqual, label(p));
+			break;
+		case Op::JEQ:
+		case Op::JNEQ:
+		case Op::JLESS:
+		case Op::JLEQ:
+		case Op::JGRTR:
+		case Op::JGEQ:
+		case Op::JSLESS:
+		case Op::JSLEQ:
+		case Op::JSGRTR:
+		case Op::JSGEQ:
+		{
+			static const A::Cond conditions[] = {
+				A::Equal, A::NotEqual, A::Below, A::BelowEqual, A::Above, A::AboveEqual,
+				A::Less, A::LessEqual, A::Greater, A::GreaterEqual
+			};
+			a_.alu(A::Cmp, PRI, ALT);
+			a_.j(conditions[static_cast<cell>(op) - static_cast<cell>(Op::JEQ)], label(p));
+			break;
+		}
+		case Op::SHL:
+			a_.shiftCl(4, PRI);
+			break;
+		case Op::SHR:
+			a_.shiftCl(5, PRI);
+			break;
+		case Op::SSHR:
+			a_.shiftCl(7, PRI);
+			break;
+		case Op::SHL_C_PRI:
+			a_.shift(4, PRI, static_cast<uint8_t>(p));
+			break;
+		case Op::SHL_C_ALT:
+			a_.shift(4, ALT, static_cast<uint8_t>(p));
+			break;
+		case Op::SHR_C_PRI:
+			a_.shift(5, PRI, static_cast<uint8_t>(p));
+			break;
+		case Op::SHR_C_ALT:
+			a_.shift(5, ALT, static_cast<uint8_t>(p));
+			break;
+		case Op::SMUL:
+		case Op::UMUL:
+			a_.imul(PRI, ALT);
+			break;
+		case Op::SDIV:
+			divide(true);
+			break;
+		case Op::SDIV_ALT:
+			a_.xchgEaxEcx();
+			divide(true);
+			break;
+		case Op::UDIV:
+			divide(false);
+			break;
+		case Op::UDIV_ALT:
+			a_.xchgEaxEcx();
+			divide(false);
+			break;
+		case Op::ADD:
+			a_.alu(A::Add, PRI, ALT);
+			break;
+		case Op::SUB:
+			a_.alu(A::Sub, PRI, ALT);
+			break;
+		case Op::SUB_ALT:
+			a_.neg(PRI);
+			a_.alu(A::Add, PRI, ALT);
+			break;
+		case Op::AND:
+			a_.alu(A::And, PRI, ALT);
+			break;
+		case Op::OR:
+			a_.alu(A::Or, PRI, ALT);
+			break;
+		case Op::XOR:
+			a_.alu(A::Xor, PRI, ALT);
+			break;
+		case Op::NOT:
+			a_.mov(TMP, 0);
+			a_.test(PRI, PRI);
+			a_.set(A::Equal, TMP);
+			a_.mov(PRI, TMP);
+			break;
+		case Op::NEG:
+			a_.neg(PRI);
+			break;
+		case Op::INVERT:
+			a_.not_(PRI);
+			break;
+		case Op::ADD_C:
+			a_.alu(A::Add, PRI, p);
+			break;
+		case Op::SMUL_C:
+			a_.imul(PRI, PRI, p);
+			break;
+		case Op::ZERO_PRI:
+			a_.mov(PRI, 0);
+			break;
+		case Op::ZERO_ALT:
+			a_.mov(ALT, 0);
+			break;
+		case Op::ZERO:
+			a_.store(global(p), 0);
+			break;
+		case Op::ZERO_S:
+			a_.store(local(p), 0);
+			break;
+		case Op::SIGN_PRI:
+		case Op::SIGN_ALT:
+		{
+			const Reg reg = op == Op::SIGN_PRI ? PRI : ALT;
+			a_.test8(reg, 0x80);
+			const size_t positive = a_.jShort(A::Equal);
+			a_.alu(A::Or, reg, ~0xFF);
+			a_.land(positive);
+			break;
+		}
+		case Op::EQ:
+			compare(A::Equal);
+			break;
+		case Op::NEQ:
+			compare(A::NotEqual);
+			break;
+		case Op::LESS:
+			compare(A::Below);
+			break;
+		case Op::LEQ:
+			compare(A::BelowEqual);
+			break;
+		case Op::GRTR:
+			compare(A::Above);
+			break;
+		case Op::GEQ:
+			compare(A::AboveEqual);
+			break;
+		case Op::SLESS:
+			compare(A::Less);
+			break;
+		case Op::SLEQ:
+			compare(A::LessEqual);
+			break;
+		case Op::SGRTR:
+			compare(A::Greater);
+			break;
+		case Op::SGEQ:
+			compare(A::GreaterEqual);
+			break;
+		case Op::EQ_C_PRI:
+		case Op::EQ_C_ALT:
+			a_.mov(TMP, 0);
+			a_.alu(A::Cmp, op == Op::EQ_C_PRI ? PRI : ALT, p);
+			a_.set(A::Equal, TMP);
+			a_.mov(PRI, TMP);
+			break;
+		case Op::INC_PRI:
+			a_.alu(A::Add, PRI, 1);
+			break;
+		case Op::INC_ALT:
+			a_.alu(A::Add, ALT, 1);
+			break;
+		case Op::INC:
+			a_.alu(A::Add, global(p), 1);
+			break;
+		case Op::INC_S:
+			a_.alu(A::Add, local(p), 1);
+			break;
+		case Op::INC_I:
+			a_.address(TMP, PRI);
+			a_.alu(A::Add, at(TMP), 1);
+			break;
+		case Op::DEC_PRI:
+			a_.alu(A::Sub, PRI, 1);
+			break;
+		case Op::DEC_ALT:
+			a_.alu(A::Sub, ALT, 1);
+			break;
+		case Op::DEC:
+			a_.alu(A::Sub, global(p), 1);
+			break;
+		case Op::DEC_S:
+			a_.alu(A::Sub, local(p), 1);
+			break;
+		case Op::DEC_I:
+			a_.address(TMP, PRI);
+			a_.alu(A::Sub, at(TMP), 1);
+			break;
+		case Op::MOVS:
+			callHelper(&movs, p);
+			break;
+		case Op::CMPS:
+			callHelper(&cmps, p);
+			break;
+		case Op::FILL:
+			callHelper(&fill, p);
+			break;
+		case Op::HALT:
+			a_.store(field(offsetof(Context, cip)), next);
+			callHelper(&halt, p);
+			break;
+		case Op::BOUNDS:
+			a_.alu(A::Cmp, PRI, p);
+			a_.j(A::Above, boundsError_);
+			break;
+		case Op::SYSREQ_PRI:
+			a_.store(field(offsetof(Context, cip)), next);
+			callHelper(&sysreqPri, 0);
+			break;
+		case Op::SYSREQ_C:
+			a_.store(field(offsetof(Context, cip)), next);
+			callHelper(&sysreq, p);
+			break;
+		case Op::SYSREQ_N:
+			pushValue(code_[pos + 2]);
+			a_.store(field(offsetof(Context, cip)), next);
+			a_.store(field(offsetof(Context, scratch)), code_[pos + 2]);
+			callHelper(&sysreqN, p);
+			break;
+		case Op::SWITCH:
+		{
+			// Searched in order like the interpreter does, so the first of any repeated cases wins.
+			const size_t table = p / sizeof(cell);
+			const cell count = code_[table + 1];
+			for (cell i = 0; i != count; ++i)
+			{
+				a_.alu(A::Cmp, PRI, code_[table + 3 + i * 2]);
+				a_.j(A::Equal, label(code_[table + 4 + i * 2]));
+			}
+			a_.jmp(label(code_[table + 2]));
+			break;
+		}
+		case Op::CASETBL:
+			// Only data, nothing valid runs in to it.
+			a_.jmp(invalid_);
+			break;
+		case Op::SWAP_PRI:
+		case Op::SWAP_ALT:
+		{
+			const Reg reg = op == Op::SWAP_PRI ? PRI : ALT;
+			a_.load(TMP, top());
+			a_.store(top(), reg);
+			a_.mov(reg, TMP);
+			break;
+		}
+		case Op::BREAK:
+			// Only call out when there's a debug hook, usually the profiler.
+			a_.loadPtr(TMP, field(offsetof(Context, amx)));
+			a_.cmpPtr(Mem(TMP, offsetof(AMX, debug)), 0);
+			{
+				const size_t none = a_.jShort(A::Equal);
+				a_.store(field(offsetof(Context, cip)), next);
+				callHelper(&debugBreak, 0);
+				a_.land(none);
+			}
+			break;
+		default:
+			// NOP and the obsolete debugging instructions.
+			break;
+		}
+	}
+
+public:
+	Translator(const cell* code, size_t cells, const void* const* table)
+		: code_(code)
+		, cells_(cells)
+		, table_(table)
+		, starts_(cells, false)
+	{
+	}
+
+	/// Find the instructions, check everything can be translated and every jump goes to one
+	/// @returns "false" with the reason in `error` if not
+	bool scan(String& error)
+	{
+		char buf[128];
+		DynamicArray<Pair<size_t, cell>> targets;
+		for (size_t pos = 0; pos < cells_;)
+		{
+			const Op op = static_cast<Op>(code_[pos]);
+			int operands = operandCount(op);
+			if (op == Op::CASETBL && pos + 1 < cells_ && code_[pos + 1] >= 0 && size_t(code_[pos + 1]) < cells_)
+			{
+				operands = 2 + 2 * code_[pos + 1];
+			}
+			const cell p = (operands > 0 && pos + 1 < cells_) ? code_[pos + 1] : 0;
+			if (const char* name = unsupportedName(op, p))
+			{
+				snprintf(buf, sizeof(buf), "it uses %s, at 0x%zx", name, pos * sizeof(cell));
+				error = buf;
+				return false;
+			}
+			if (operands < 0 || pos + 1 + operands > cells_)
+			{
+				snprintf(buf, sizeof(buf), "the code ends in the middle of an instruction, at 0x%zx", pos * sizeof(cell));
+				error = buf;
+				return false;
+			}
+			starts_[pos] = true;
+			switch (op)
+			{
+			case Op::CALL:
+			case Op::JUMP:
+			case Op::JZER:
+			case Op::JNZ:
+			case Op::JEQ:
+			case Op::JNEQ:
+			case Op::JLESS:
+			case Op::JLEQ:
+			case Op::JGRTR:
+			case Op::JGEQ:
+			case Op::JSLESS:
+			case Op::JSLEQ:
+			case Op::JSGRTR:
+			case Op::JSGEQ:
+			case Op::SWITCH:
+				targets.emplace_back(pos, p);
+				break;
+			case Op::CASETBL:
+				targets.emplace_back(pos, code_[pos + 2]);
+				for (cell i = 0; i != code_[pos + 1]; ++i)
+				{
+					targets.emplace_back(pos, code_[pos + 4 + i * 2]);
+				}
+				break;
+			default:
+				break;
+			}
+			pos += 1 + operands;
+		}
+
+		for (auto const& target : targets)
+		{
+			const bool isSwitch = static_cast<Op>(code_[target.first]) == Op::SWITCH;
+			if (!isTarget(target.second) || (isSwitch && static_cast<Op>(code_[target.second / sizeof(cell)]) != Op::CASETBL))
+			{
+				snprintf(buf, sizeof(buf), "it jumps in to the middle of an instruction, at 0x%zx", target.first * sizeof(cell));
+				error = buf;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void emit()
+	{
+		cellLabels_ = a_.newLabels(cells_);
+		exit_ = a_.newLabel();
+		memoryError_ = a_.newLabel();
+		stackError_ = a_.newLabel();
+		stackLow_ = a_.newLabel();
+		heapLow_ = a_.newLabel();
+		boundsError_ = a_.newLabel();
+		divideError_ = a_.newLabel();
+		invalid_ = a_.newLabel();
+
+		prologue();
+		for (size_t pos = 0; pos != cells_; ++pos)
+		{
+			if (starts_[pos])
+			{
+				a_.bind(cellLabels_ + pos);
+				translate(pos);
+			}
+		}
+		// Running off the end of the code.
+		a_.jmp(invalid_);
+
+		epilogue();
+		stub(memoryError_, &abortWith, AMX_ERR_MEMACCESS);
+		stub(stackError_, &failWith, AMX_ERR_STACKERR);
+		stub(stackLow_, &failWith, AMX_ERR_STACKLOW);
+		stub(heapLow_, &failWith, AMX_ERR_HEAPLOW);
+		stub(boundsError_, &abortWith, AMX_ERR_BOUNDS);
+		stub(divideError_, &abortWith, AMX_ERR_DIVIDE);
+		stub(invalid_, &abortWith, AMX_ERR_INVINSTR);
+	}
+
+	bool resolve()
+	{
+		return a_.resolve();
+	}
+
+	DynamicArray<uint8_t> const& code() const
+	{
+		return a_.code();
+	}
+
+	/// Where the code for a cell is, relative to the start, or the invalid instruction handler
+	size_t offsetOf(size_t pos) const
+	{
+		return a_.offsetOf(starts_[pos] ? cellLabels_ + pos : invalid_);
+	}
+};
+
+/// Read the code and data of a program from its file, expanding them if they are compressed
+bool readImage(std::string const& path, AMX_HEADER const& loaded, DynamicArray<cell>& image, String& error)
+{
+	std::ifstream file(path, std::ios::binary);
+	const DynamicArray<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	AMX_HEADER header;
+	if (bytes.size() < sizeof(header))
+	{
+		error = "the file can't be read again";
+		return false;
+	}
+	memcpy(&header, bytes.data(), sizeof(header));
+	if (header.magic != loaded.magic || header.cod != loaded.cod || header.dat != loaded.dat || header.hea != loaded.hea
+		|| header.cod < cell(sizeof(header)) || header.cod > header.dat || header.dat > header.hea
+		|| header.size < header.cod || size_t(header.size) > bytes.size())
+	{
+		error = "the file changed after it was loaded";
+		return false;
+	}
+
+	image.resize((header.hea - header.cod) / sizeof(cell));
+	if ((header.flags & AMX_FLAG_COMPACT) == 0)
+	{
+		if (header.hea > header.size)
+		{
+			error = "the file is cut short";
+			return false;
+		}
+		memcpy(image.data(), bytes.data() + header.cod, image.size() * sizeof(cell));
+		return true;
+	}
+
+	// Each cell is stored as 7 bits a byte, high bits first, the top bit set on all but the last
+	// byte.  Bit 6 of the first byte is the sign.
+	size_t pos = header.cod;
+	const size_t end = header.size;
+	for (cell& value : image)
+	{
+		if (pos == end)
+		{
+			error = "the file is cut short";
+			return false;
+		}
+		ucell c = (bytes[pos] & 0x40) ? ~ucell(0) : 0;
+		uint8_t byte;
+		do
+		{
+			byte = bytes[pos++];
+			c = (c << 7) | (byte & 0x7F);
+		} while ((byte & 0x80) && pos != end);
+		value = static_cast<cell>(c);
+	}
+	return true;
+}
+}
+
+bool PawnJIT::supported()
+{
+#ifdef PAWN_JIT_SUPPORTED
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::unique_ptr<PawnJIT> PawnJIT::compile(AMX const& amx, std::string const& path, String& error)
+{
+#ifndef PAWN_JIT_SUPPORTED
+	error = "this build has no JIT, it is only for Linux on x86-64";
+	return nullptr;
+#else
+	AMX_HEADER const* hdr = reinterpret_cast<AMX_HEADER const*>(amx.base);
+	DynamicArray<cell> image;
+	if (!readImage(path, *hdr, image, error))
+	{
+		return nullptr;
+	}
+
+	// Nothing has run yet, so the data is still as in the file.  If it isn't the file was changed.
+	const size_t cells = (hdr->dat - hdr->cod) / sizeof(cell);
+	const unsigned char* data = amx.data ? amx.data : amx.base + hdr->dat;
+	if (memcmp(data, image.data() + cells, (image.size() - cells) * sizeof(cell)) != 0)
+	{
+		error = "the file changed after it was loaded";
+		return nullptr;
+	}
+
+	std::unique_ptr<PawnJIT> jit(new PawnJIT());
+	jit->addresses_.resize(cells);
+	Translator translator(image.data(), cells, jit->addresses_.data());
+	if (!translator.scan(error))
+	{
+		return nullptr;
+	}
+	translator.emit();
+	if (!translator.resolve())
+	{
+		error = "it couldn't be translated";
+		return nullptr;
+	}
+
+	DynamicArray<uint8_t> const& code = translator.code();
+	void* memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+	{
+		error = "there is no memory for the code";
+		return nullptr;
+	}
+	memcpy(memory, code.data(), code.size());
+	if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0)
+	{
+		munmap(memory, code.size());
+		error = "the code can't be made executable";
+		return nullptr;
+	}
+	jit->memory_ = memory;
+	jit->size_ = code.size();
+	// The prologue is first.
+	jit->entry_ = reinterpret_cast<Entry>(memory);
+	for (size_t pos = 0; pos != cells; ++pos)
+	{
+		jit->addresses_[pos] = static_cast<uint8_t*>(memory) + translator.offsetOf(pos);
+	}
+	return jit;
+#endif
+}
+
+PawnJIT::~PawnJIT()
+{
+#ifdef PAWN_JIT_SUPPORTED
+	if (memory_)
+	{
+		munmap(memory_, size_);
+	}
+#endif
+}
+
+int PawnJIT::exec(AMX* amx, cell* retval, int index) const
+{
+	if ((amx->flags & AMX_FLAG_NTVREG) == 0)
+	{
+		// Let the interpreter report the missing natives.
+		return amx_Exec(amx, retval, index);
+	}
+
+	AMX_HEADER* hdr = reinterpret_cast<AMX_HEADER*>(amx->base);
+	Context ctx;
+	ctx.amx = amx;
+	ctx.data = amx->data ? amx->data : amx->base + hdr->dat;
+	ctx.addresses = addresses_.data();
+	ctx.retval = retval;
+	ctx.pri = 0;
+	ctx.alt = 0;
+	ctx.frm = 0;
+	ctx.stk = amx->stk;
+	ctx.hea = amx->hea;
+	ctx.hlw = amx->hlw;
+	ctx.stp = amx->stp;
+	ctx.reset_stk = ctx.stk;
+	ctx.reset_hea = ctx.hea;
+	ctx.cip = 0;
+	ctx.scratch = 0;
+	ctx.result = AMX_ERR_NONE;
+
+	cell cip;
+	if (index == AMX_EXEC_MAIN)
+	{
+		if (hdr->cip < 0)
+		{
+			return AMX_ERR_INDEX;
+		}
+		cip = hdr->cip;
+	}
+	else if (index == AMX_EXEC_CONT)
+	{
+		ctx.pri = amx->pri;
+		ctx.alt = amx->alt;
+		ctx.frm = amx->frm;
+		ctx.reset_stk = amx->reset_stk;
+		ctx.reset_hea = amx->reset_hea;
+		cip = amx->cip;
+	}
+	else if (index < 0 || index >= (cell)NUMENTRIES(hdr, publics, natives))
+	{
+		return AMX_ERR_INDEX;
+	}
+	else
+	{
+		AMX_FUNCSTUB* func = GETENTRY(hdr, publics, index);
+		cip = func->address;
+	}
+
+	if (ctx.stk > ctx.stp)
+	{
+		return AMX_ERR_STACKLOW;
+	}
+	if (ctx.hea < ctx.hlw)
+	{
+		return AMX_ERR_HEAPLOW;
+	}
+	if (static_cast<ucell>(cip) >= addresses_.size() * sizeof(cell) || cip % sizeof(cell) != 0)
+	{
+		return AMX_ERR_MEMACCESS;
+	}
+
+	if (index != AMX_EXEC_CONT)
+	{
+		// The parameters pushed with `amx_Push`, then a return address of 0, which is a `HALT 0`.
+		ctx.reset_stk += amx->paramcount * sizeof(cell);
+		ctx.stk -= 2 * sizeof(cell);
+		const cell frame[2] = { 0, static_cast<cell>(amx->paramcount * sizeof(cell)) };
+		memcpy(ctx.data + ctx.stk, frame, sizeof(frame));
+		amx->paramcount = 0;
+	}
+	if (ctx.hea + StackMargin > ctx.stk)
+	{
+		return AMX_ERR_STACKERR;
+	}
+	return entry_(&ctx, addresses_[cip / sizeof(cell)]);
+}
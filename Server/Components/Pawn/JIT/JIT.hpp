@@ -0,0 +1,61 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+#include <amx/amx.h>
+#include <memory>
+#include <string>
+
+/// Native x86 and x86-64 code for a script, translated from its AMX code when it is loaded, for
+/// the scripts listed in `pawn.jit_scripts`.  `exec` is a drop-in `amx_Exec`: all the state lives
+/// in the `AMX` as usual, stored back before every native call, `BREAK` and `HALT`, so natives,
+/// the debug hook, `sleep` and `AMX_EXEC_CONT` behave as in the interpreter, and the interpreter
+/// can carry on from anything the JIT started and the other way round.
+///
+/// Scripts using anything it doesn't translate keep running in the interpreter.  That includes
+/// the old debugging opcodes, computed jumps and calls, and reading the `COD` and `DAT` registers,
+/// which is how scripts find and rewrite their own code: the JIT works from the file and wouldn't
+/// see the changes.
+class PawnJIT
+{
+public:
+	/// Whether this build can translate at all, Linux on x86-64 only
+	static bool supported();
+
+	/// Translate a script that has just been loaded from `path`.  The code is read from the file
+	/// again, the copy in memory having been relocated for the interpreter already.
+	/// @param error Why not, when it returns null
+	static std::unique_ptr<PawnJIT> compile(AMX const& amx, std::string const& path, String& error);
+
+	PawnJIT(PawnJIT const&) = delete;
+	PawnJIT& operator=(PawnJIT const&) = delete;
+	~PawnJIT();
+
+	/// Run a public, `main` or a `sleep` continuation, like `amx_Exec`
+	int exec(AMX* amx, cell* retval, int index) const;
+
+	/// Bytes of native code
+	size_t size() const
+	{
+		return size_;
+	}
+
+private:
+	using Entry = int (*)(void* context, const void* target);
+
+	PawnJIT() = default;
+
+	void* memory_ = nullptr;
+	size_t size_ = 0;
+	Entry entry_ = nullptr;
+	/// The native code of each cell of the AMX code, for returns and continuations.  Cells in the
+	/// middle of an instruction abort with `AMX_ERR_INVINSTR`.
+	DynamicArray<const void*> addresses_;
+};
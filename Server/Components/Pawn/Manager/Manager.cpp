@@ -14,6 +14,7 @@
 #include "Manager.hpp"
 #include "../PluginManager/PluginManager.hpp"
 #include "../utils.hpp"
+#include "../profiler.hpp"
 #include <utils.hpp>
 
 #ifdef WIN32
@@ -21,6 +22,7 @@
 #endif // WIN32
 #include <iostream>
 #include <charconv>
+#include <sstream>
 
 #include <pawn-natives/NativeFunc.hpp>
 #include <pawn-natives/NativesMain.hpp>
@@ -59,8 +61,8 @@ PawnManager::~PawnManager()
 {
 	if (mainScript_)
 	{
-		mainScript_->Call("OnGameModeExit", DefaultReturnValue_False);
-		CallInSides("OnGameModeExit", DefaultReturnValue_False);
+		CallIn(mainScript_, PawnCallback_OnGameModeExit, DefaultReturnValue_False);
+		CallInSides(PawnCallback_OnGameModeExit, DefaultReturnValue_False);
 		PawnTimerImpl::Get()->killTimers(mainScript_->GetAMX());
 		pluginManager.AmxUnload(mainScript_->GetAMX());
 		eventDispatcher.dispatch(&PawnEventHandler::onAmxUnload, *mainScript_);
@@ -68,11 +70,15 @@ PawnManager::~PawnManager()
 	for (IPawnScript* cur : scripts_)
 	{
 		IPawnScript& script = *cur;
-		script.Call("OnFilterScriptExit", DefaultReturnValue_False);
+		CallIn(&script, PawnCallback_OnFilterScriptExit, DefaultReturnValue_False);
 		PawnTimerImpl::Get()->killTimers(script.GetAMX());
 		pluginManager.AmxUnload(script.GetAMX());
 		eventDispatcher.dispatch(&PawnEventHandler::onAmxUnload, script);
 	}
+	for (PendingLoad& load : pendingLoads_)
+	{
+		delete load.script.get();
+	}
 }
 
 void PawnManager::OnServerCommandList(FlatHashSet<StringView>& commands)
@@ -85,21 +91,53 @@ void PawnManager::OnServerCommandList(FlatHashSet<StringView>& commands)
 	commands.emplace("loadscript");
 	commands.emplace("unloadscript");
 	commands.emplace("reloadscript");
+	commands.emplace("benchpublic");
+	commands.emplace("benchformat");
+	commands.emplace("profile");
+	commands.emplace("plugintimes");
 }
 
-bool PawnManager::OnServerCommand(const ConsoleCommandSenderData& sender, std::string const& cmd, std::string const& args)
+void PawnManager::loadCommand(const ConsoleCommandSenderData& sender, std::string const& name, bool reload, String const& label)
 {
-	// Legacy commands.
-	if (cmd == "loadfs")
+	if (scriptCommands_ != 0)
 	{
-		if (!Load("filterscripts/" + args))
+		// Sent by a script with `SendRconCommand`, which expects to use the script straight after.
+		if (reload ? Reload(name) : Load(name))
 		{
-			console->sendMessage(sender, "Filterscript '" + args + "' load failed.");
+			console->sendMessage(sender, label + (reload ? " reloaded." : " loaded."));
 		}
 		else
 		{
-			console->sendMessage(sender, "Filterscript '" + args + "' loaded.");
+			console->sendMessage(sender, label + (reload ? " reload failed." : " load failed."));
 		}
+	}
+	// The result is printed when the background load is done.
+	else if (!LoadAsync(name, reload, label))
+	{
+		console->sendMessage(sender, label + (reload ? " reload failed." : " load failed."));
+	}
+	else
+	{
+		console->sendMessage(sender, label + (reload ? " reloading." : " loading."));
+	}
+}
+
+void PawnManager::SendScriptCommand(StringView command)
+{
+	if (console)
+	{
+		++scriptCommands_;
+		console->send(command);
+		--scriptCommands_;
+	}
+}
+
+bool PawnManager::OnServerCommand(const ConsoleCommandSenderData& sender, std::string const& cmd, std::string const& args)
+{
+	// Legacy commands.
+	if (cmd == "loadfs")
+	{
+		loadCommand(sender, "filterscripts/" + args, false, "Filterscript '" + args + "'");
 		return true;
 	}
 	else if (cmd == "unloadfs")
@@ -116,14 +154,7 @@ bool PawnManager::OnServerCommand(const ConsoleCommandSenderData& sender, std::s
 	}
 	else if (cmd == "reloadfs")
 	{
-		if (!Reload("filterscripts/" + args))
-		{
-			console->sendMessage(sender, "Filterscript '" + args + "' reload failed.");
-		}
-		else
-		{
-			console->sendMessage(sender, "Filterscript '" + args + "' reloaded.");
-		}
+		loadCommand(sender, "filterscripts/" + args, true, "Filterscript '" + args + "'");
 		return true;
 	}
 	else if (cmd == "gmx")
@@ -146,14 +177,7 @@ bool PawnManager::OnServerCommand(const ConsoleCommandSenderData& sender, std::s
 	// New commands.
 	else if (cmd == "loadscript")
 	{
-		if (!Load(args))
-		{
-			console->sendMessage(sender, "Script '" + args + "' load failed.");
-		}
-		else
-		{
-			console->sendMessage(sender, "Script '" + args + "' loaded.");
-		}
+		loadCommand(sender, args, false, "Script '" + args + "'");
 		return true;
 	}
 	else if (cmd == "unloadscript")
@@ -170,19 +194,208 @@ bool PawnManager::OnServerCommand(const ConsoleCommandSenderData& sender, std::s
 	}
 	else if (cmd == "reloadscript")
 	{
-		if (!Reload(args))
+		loadCommand(sender, args, true, "Script '" + args + "'");
+		return true;
+	}
+	else if (cmd == "plugintimes")
+	{
+		pluginTimes(sender, args);
+		return true;
+	}
+	else if (cmd == "benchpublic")
+	{
+		benchmarkPublic(sender, args);
+		return true;
+	}
+	else if (cmd == "benchformat")
+	{
+		const int iterations = std::clamp(args.empty() ? 100000 : std::atoi(args.c_str()), 1, 10000000);
+		IPawnScript* script = mainScript_ ? mainScript_ : (scripts_.empty() ? nullptr : scripts_.front());
+		if (!script)
 		{
-			console->sendMessage(sender, "Script '" + args + "' reload failed.");
+			console->sendMessage(sender, "A script needs to be loaded to run the format benchmark in.");
+			return true;
 		}
-		else
+		for (const String& line : BenchmarkFormats(script->GetAMX(), iterations))
 		{
-			console->sendMessage(sender, "Script '" + args + "' reloaded.");
+			console->sendMessage(sender, line);
 		}
 		return true;
 	}
+	else if (cmd == "profile")
+	{
+		profile(sender, args);
+		return true;
+	}
 	return false;
 }
 
+void PawnManager::benchmarkPublic(const ConsoleCommandSenderData& sender, std::string const& args)
+{
+	static constexpr int MaxIterations = 10000000;
+
+	std::istringstream stream(args);
+	std::string name;
+	int iterations = 10000;
+	DynamicArray<cell> params;
+	int value;
+	stream >> name;
+	if (stream >> value)
+	{
+		iterations = value;
+		for (cell param; stream >> param;)
+		{
+			params.push_back(param);
+		}
+	}
+	if (name.empty() || !stream.eof())
+	{
+		console->sendMessage(sender, "Usage: benchpublic <public> [iterations] [integer arguments...]");
+		return;
+	}
+	iterations = std::clamp(iterations, 1, MaxIterations);
+
+	// Run it in the first script that has it, the game mode first.
+	PawnScript* script = nullptr;
+	int index = 0;
+	if (mainScript_ && mainScript_->FindPublic(name.c_str(), &index) == AMX_ERR_NONE)
+	{
+		script = mainScript_;
+	}
+	for (auto it = scripts_.begin(); !script && it != scripts_.end(); ++it)
+	{
+		if ((*it)->FindPublic(name.c_str(), &index) == AMX_ERR_NONE)
+		{
+			script = static_cast<PawnScript*>(*it);
+		}
+	}
+	if (!script)
+	{
+		console->sendMessage(sender, "No loaded script has a public called '" + name + "'.");
+		return;
+	}
+
+	// The calls are real, so whatever the public does (sending messages, changing state) happens
+	// `iterations` times over, twice for a script with native code: once in the interpreter and
+	// once in the JIT's code.  Neither is profiled or traced, so the two compare fairly.
+	auto run = [&](bool jit, std::chrono::nanoseconds& elapsed, cell& retval)
+	{
+		int err = AMX_ERR_NONE;
+		const TimePoint start = Time::now();
+		for (int i = 0; i != iterations && err == AMX_ERR_NONE; ++i)
+		{
+			for (auto param = params.rbegin(); param != params.rend(); ++param)
+			{
+				script->Push(*param);
+			}
+			err = jit ? script->execProgram(&retval, index) : amx_Exec(script->GetAMX(), &retval, index);
+		}
+		elapsed = duration_cast<std::chrono::nanoseconds>(Time::now() - start);
+		return err;
+	};
+
+	std::chrono::nanoseconds elapsed;
+	cell retval = 0;
+	int err = run(false, elapsed, retval);
+	if (err != AMX_ERR_NONE)
+	{
+		console->sendMessage(sender, "'" + name + "' failed: " + aux_StrError(err));
+		return;
+	}
+	char buf[256];
+	snprintf(buf, sizeof(buf), "%s: %d calls in %.3fms, %.0fns per call in the interpreter", name.c_str(), iterations, elapsed.count() / 1000000.0, double(elapsed.count()) / iterations);
+	console->sendMessage(sender, buf);
+
+	if (!script->getJIT())
+	{
+		console->sendMessage(sender, script->jitError_.empty() ? "The script has no native code, it isn't in pawn.jit_scripts." : "The script has no native code, " + script->jitError_ + ".");
+		return;
+	}
+	std::chrono::nanoseconds jitElapsed;
+	cell jitRetval = 0;
+	err = run(true, jitElapsed, jitRetval);
+	if (err != AMX_ERR_NONE)
+	{
+		console->sendMessage(sender, "'" + name + "' failed in native code: " + aux_StrError(err));
+		return;
+	}
+	snprintf(buf, sizeof(buf), "%s: %d calls in %.3fms, %.0fns per call in native code, %.2f times as fast", name.c_str(), iterations, jitElapsed.count() / 1000000.0, double(jitElapsed.count()) / iterations, double(elapsed.count()) / std::max<double>(jitElapsed.count(), 1));
+	console->sendMessage(sender, buf);
+	if (jitRetval != retval)
+	{
+		snprintf(buf, sizeof(buf), "%s returned %d in the interpreter but %d in native code", name.c_str(), retval, jitRetval);
+		console->sendMessage(sender, buf);
+	}
+}
+
+void PawnManager::profile(const ConsoleCommandSenderData& sender, std::string const& args)
+{
+	PawnProfiler* profiler = PawnProfiler::Get();
+	std::istringstream stream(args);
+	std::string action;
+	std::string name;
+	stream >> action >> name;
+	if (action == "start")
+	{
+		if (profiler->active())
+		{
+			console->sendMessage(sender, "The profiler is already running.");
+			return;
+		}
+		profiler->start();
+		if (mainScript_)
+		{
+			profiler->attach(mainScript_->GetAMX(), mainScript_->name_, mainScript_->path_);
+		}
+		for (IPawnScript* cur : scripts_)
+		{
+			PawnScript* script = static_cast<PawnScript*>(cur);
+			profiler->attach(script->GetAMX(), script->name_, script->path_);
+		}
+		console->sendMessage(sender, "Profiling all scripts.  Use `profile stop [name]` to write the results.");
+	}
+	else if (action == "stop")
+	{
+		for (const String& line : profiler->stop(name.empty() ? "pawn_profile" : name))
+		{
+			console->sendMessage(sender, line);
+		}
+	}
+	else
+	{
+		console->sendMessage(sender, "Usage: profile start | profile stop [name]");
+	}
+}
+
+void PawnManager::pluginTimes(const ConsoleCommandSenderData& sender, std::string const& args)
+{
+	if (args == "reset")
+	{
+		pluginManager.ResetTickStats();
+		console->sendMessage(sender, "Legacy plugin tick times reset.");
+		return;
+	}
+	if (pluginManager.tickStats_.empty())
+	{
+		console->sendMessage(sender, "No legacy plugins are loaded.");
+		return;
+	}
+	char line[256];
+	if (pluginManager.tickBudget.count() > 0)
+	{
+		snprintf(line, sizeof(line), "Tick budget: %.2fms", pluginManager.tickBudget.count() / 1000.0);
+		console->sendMessage(sender, line);
+	}
+	for (auto const& cur : pluginManager.tickStats_)
+	{
+		const PluginTickStats& stats = cur.second;
+		snprintf(line, sizeof(line), "%s: last %.2fms, average %.2fms, worst %.2fms, %llu of %llu ticks over budget",
+			cur.first.c_str(), stats.last.count() / 1000.0, stats.average / 1000.0, stats.worst.count() / 1000.0,
+			static_cast<unsigned long long>(stats.overBudget), static_cast<unsigned long long>(stats.calls));
+		console->sendMessage(sender, line);
+	}
+}
+
 AMX* PawnManager::AMXFromID(int id) const
 {
 	if (mainScript_ && mainScript_->GetID() == id)
@@ -304,6 +517,9 @@ encountered.  This could be caused by many things:
 	unloadNextTick_ = true;
 	nextScriptName_ = normal_script_name;
 
+	// Read the new mode while the old one is shutting down and the restart delay runs.
+	startLoad(normal_script_name, PendingLoad::Preload);
+
 	return true;
 }
 
@@ -363,7 +579,9 @@ void PawnManager::ProcessTick(Microseconds elapsed, TimePoint now)
 		unloadNextTick_ = false;
 		nextScriptName_ = "";
 	}
-	if (nextRestart_ != TimePoint::min() && nextRestart_ <= now)
+	processLoads();
+	// If the next GM is still being read in the background wait for it, rather than stalling the tick.
+	if (nextRestart_ != TimePoint::min() && nextRestart_ <= now && !isLoading(mainName_))
 	{
 		// Reloading a script.  Restart is in the past, load the next GM.
 		Load(mainName_, true, true);
@@ -479,11 +697,14 @@ void PawnManager::openAMX(PawnScript& script, bool isEntryScript, bool restartin
 	}
 
 	CheckNatives(script);
+	script.resolveCallbacks();
+	updateCallbackUsage();
+	PawnProfiler::Get()->attach(script.GetAMX(), script.name_, script.path_);
 
 	if (isEntryScript)
 	{
-		script.Call("OnGameModeInit", DefaultReturnValue_False);
-		CallInSides("OnGameModeInit", DefaultReturnValue_False);
+		CallIn(&script, PawnCallback_OnGameModeInit, DefaultReturnValue_False);
+		CallInSides(PawnCallback_OnGameModeInit, DefaultReturnValue_False);
 
 		// We're calling reloadAll after mode initialisation because we want to send
 		// updated settings to clients in PlayerInit RPC (such as available classes count)
@@ -527,7 +748,7 @@ void PawnManager::openAMX(PawnScript& script, bool isEntryScript, bool restartin
 	}
 	else
 	{
-		script.Call("OnFilterScriptInit", DefaultReturnValue_False);
+		CallIn(&script, PawnCallback_OnFilterScriptInit, DefaultReturnValue_False);
 		script.cache_.inited = true;
 	}
 
@@ -537,14 +758,14 @@ void PawnManager::openAMX(PawnScript& script, bool isEntryScript, bool restartin
 		// Make use of this callback for resetting variables, or initializing anything player related.
 		// First paramter is obviously player ID, and second parameter is a boolean determining whether it's
 		// An entry script (main script) or a side script
-		script.Call("OnScriptLoadPlayer", DefaultReturnValue_True, p->getID(), isEntryScript);
+		CallIn(&script, PawnCallback_OnScriptLoadPlayer, DefaultReturnValue_True, p->getID(), isEntryScript);
 
 		// If it's entry script and it's restarting, after loading we call OnPlayerConnect in all scripts
 		// Regardless of their types, as if players have rejoined the server. This is also what SA-MP does.
 		if (isEntryScript && restarting)
 		{
-			script.Call("OnPlayerConnect", DefaultReturnValue_True, p->getID());
-			CallInSides("OnPlayerConnect", DefaultReturnValue_True, p->getID());
+			CallIn(&script, PawnCallback_OnPlayerConnect, DefaultReturnValue_True, p->getID());
+			CallInSides(PawnCallback_OnPlayerConnect, DefaultReturnValue_True, p->getID());
 		}
 	}
 }
@@ -569,13 +790,22 @@ bool PawnManager::Load(std::string const& name, bool isEntryScript, bool restart
 		}
 	}
 
-	std::string canon_path;
-	utils::Canonicalise(basePath_ + scriptPath_ + normal_script_name, canon_path);
-	PawnScript* ptr = new PawnScript(++id_, canon_path, core);
+	PawnScript* ptr = takeLoaded(normal_script_name);
+	if (ptr)
+	{
+		ptr->finishLoad();
+	}
+	else
+	{
+		std::string canon_path;
+		utils::Canonicalise(basePath_ + scriptPath_ + normal_script_name, canon_path);
+		ptr = new PawnScript(++id_, canon_path, core, wantsJIT(normal_script_name));
+	}
 
-	if (!ptr || !ptr->IsLoaded())
+	if (!ptr->IsLoaded())
 	{
 		// core->logLn(LogLevel::Error, "Unable to load script %s\n\n", name.c_str());
+		delete ptr;
 		return false;
 	}
 	ptr->name_ = normal_script_name;
@@ -608,7 +838,7 @@ void PawnManager::closeAMX(PawnScript& script, bool isEntryScript)
 	{
 		for (auto const p : players->entries())
 		{
-			PawnManager::Get()->CallInEntry("OnPlayerDisconnect", DefaultReturnValue_True, p->getID(), PeerDisconnectReason_Quit);
+			PawnManager::Get()->CallInEntry(PawnCallback_OnPlayerDisconnect, DefaultReturnValue_True, p->getID(), PeerDisconnectReason_Quit);
 		}
 	}
 
@@ -618,20 +848,23 @@ void PawnManager::closeAMX(PawnScript& script, bool isEntryScript)
 	// An entry script (main script) or a side script
 	for (auto const p : players->entries())
 	{
-		script.Call("OnScriptUnloadPlayer", DefaultReturnValue_True, p->getID(), isEntryScript);
+		CallIn(&script, PawnCallback_OnScriptUnloadPlayer, DefaultReturnValue_True, p->getID(), isEntryScript);
 	}
 
 	if (isEntryScript)
 	{
-		script.Call("OnGameModeExit", DefaultReturnValue_False);
-		CallInSides("OnGameModeExit", DefaultReturnValue_False);
+		CallIn(&script, PawnCallback_OnGameModeExit, DefaultReturnValue_False);
+		CallInSides(PawnCallback_OnGameModeExit, DefaultReturnValue_False);
 	}
 	else
 	{
-		script.Call("OnFilterScriptExit", DefaultReturnValue_False);
+		CallIn(&script, PawnCallback_OnFilterScriptExit, DefaultReturnValue_False);
 	}
 
 	PawnTimerImpl::Get()->killTimers(script.GetAMX());
+	PawnQueryImpl::Get()->cancelQueries(script.GetAMX());
+	PawnQueryImpl::Get()->freeCursors(script.GetAMX());
+	PawnProfiler::Get()->detach(script.GetAMX());
 	pluginManager.AmxUnload(script.GetAMX());
 	eventDispatcher.dispatch(&PawnEventHandler::onAmxUnload, script);
 	amxToScript_.erase(script.GetAMX());
@@ -653,15 +886,136 @@ bool PawnManager::Reload(std::string const& name)
 		return false;
 	}
 	PawnScript& script = *reinterpret_cast<PawnScript*>(*pos);
+	PawnScript* loaded = takeLoaded(normal_script_name);
 	closeAMX(script, false);
-	std::string canon_path;
-	utils::Canonicalise(basePath_ + scriptPath_ + normal_script_name, canon_path);
-	script.tryLoad(canon_path);
+	if (loaded)
+	{
+		script.takeProgram(*loaded);
+		delete loaded;
+		script.finishLoad();
+	}
+	else
+	{
+		std::string canon_path;
+		utils::Canonicalise(basePath_ + scriptPath_ + normal_script_name, canon_path);
+		script.tryLoad(canon_path, wantsJIT(normal_script_name));
+	}
 	openAMX(script, false);
 	amxToScript_.emplace(script.GetAMX(), &script);
 	return true;
 }
 
+bool PawnManager::LoadAsync(std::string const& name, bool reload, String const& message)
+{
+	std::string normal_script_name;
+	utils::NormaliseScriptName(name, normal_script_name);
+
+	// The same checks as `Load` and `Reload`, so obvious mistakes are reported straight away.
+	if (mainName_ == normal_script_name)
+	{
+		if (reload || mainScript_)
+		{
+			return false;
+		}
+	}
+	else if ((findScript(normal_script_name) != scripts_.end()) != reload)
+	{
+		return false;
+	}
+	startLoad(normal_script_name, reload ? PendingLoad::Reload : PendingLoad::Load, message);
+	return true;
+}
+
+void PawnManager::startLoad(std::string const& normal_script_name, PendingLoad::Action action, String const& message)
+{
+	for (PendingLoad& load : pendingLoads_)
+	{
+		if (load.discard)
+		{
+			continue;
+		}
+		if (load.name == normal_script_name)
+		{
+			load.action = action;
+			load.message = message;
+			return;
+		}
+		if (action == PendingLoad::Preload && load.action == PendingLoad::Preload)
+		{
+			// The mode was changed again before the restart.
+			load.discard = true;
+		}
+	}
+
+	std::string canon_path;
+	utils::Canonicalise(basePath_ + scriptPath_ + normal_script_name, canon_path);
+	const int id = ++id_;
+	const bool jit = wantsJIT(normal_script_name);
+	ICore* const serverCore = core;
+	PendingLoad& load = pendingLoads_.emplace_back();
+	load.name = normal_script_name;
+	load.action = action;
+	load.message = message;
+	load.script = std::async(std::launch::async, [id, canon_path, jit, serverCore]()
+		{
+			PawnScript* script = new PawnScript(id, serverCore);
+			script->prepareLoad(canon_path, jit);
+			return script;
+		});
+}
+
+bool PawnManager::isLoading(std::string const& normal_script_name) const
+{
+	return std::any_of(pendingLoads_.begin(), pendingLoads_.end(), [&normal_script_name](PendingLoad const& load)
+		{
+			return !load.discard && load.name == normal_script_name && load.script.wait_for(Seconds(0)) != std::future_status::ready;
+		});
+}
+
+PawnScript* PawnManager::takeLoaded(std::string const& normal_script_name)
+{
+	for (auto it = pendingLoads_.begin(); it != pendingLoads_.end(); ++it)
+	{
+		if (it->name == normal_script_name && it->script.wait_for(Seconds(0)) == std::future_status::ready)
+		{
+			PawnScript* script = it->script.get();
+			pendingLoads_.erase(it);
+			return script;
+		}
+	}
+	return nullptr;
+}
+
+void PawnManager::processLoads()
+{
+	for (size_t i = 0; i != pendingLoads_.size();)
+	{
+		PendingLoad& load = pendingLoads_[i];
+		if ((load.action == PendingLoad::Preload && !load.discard) || load.script.wait_for(Seconds(0)) != std::future_status::ready)
+		{
+			++i;
+			continue;
+		}
+		if (load.discard)
+		{
+			delete load.script.get();
+			pendingLoads_.erase(pendingLoads_.begin() + i);
+			continue;
+		}
+
+		// `Load` and `Reload` take the prepared script out of the list themselves.  If they refuse
+		// it (the script was loaded some other way in the meantime) it is freed on the next pass.
+		const std::string name = load.name;
+		const String message = load.message;
+		const bool reload = load.action == PendingLoad::Reload;
+		load.discard = true;
+		const bool done = reload ? Reload(name) : Load(name);
+		core->printLn("%s %s.", message.c_str(), done ? (reload ? "reloaded" : "loaded") : (reload ? "reload failed" : "load failed"));
+		// The script's init callbacks may have changed the list.
+		i = 0;
+	}
+}
+
 bool PawnManager::Unload(std::string const& name)
 {
 	std::string normal_script_name;
@@ -698,10 +1052,31 @@ bool PawnManager::Unload(std::string const& name)
 		delete reinterpret_cast<PawnScript*>(*pos);
 		scripts_.erase(pos);
 	}
+	updateCallbackUsage();
 
 	return true;
 }
 
+void PawnManager::updateCallbackUsage()
+{
+	callbackUsed_.fill(false);
+	auto track = [this](IPawnScript* script)
+	{
+		for (int i = 0; i != PawnCallback_End; ++i)
+		{
+			callbackUsed_[i] = callbackUsed_[i] || static_cast<PawnScript*>(script)->getCallback(PawnCallback(i)) != INT_MAX;
+		}
+	};
+	if (mainScript_)
+	{
+		track(mainScript_);
+	}
+	for (IPawnScript* cur : scripts_)
+	{
+		track(cur);
+	}
+}
+
 void PawnManager::SetBasePath(std::string const& path)
 {
 	if (path.length() == 0)
@@ -733,3 +1108,43 @@ void PawnManager::SetScriptPath(std::string const& path)
 		scriptPath_ = path + '/';
 	}
 }
+
+void PawnManager::SetJITScripts(DynamicArray<StringView> const& names)
+{
+	jitScripts_.clear();
+	jitAll_ = false;
+	if (!PawnJIT::supported())
+	{
+		if (!names.empty())
+		{
+			core->logLn(LogLevel::Warning, "pawn.jit_scripts is ignored, this build has no JIT");
+		}
+		return;
+	}
+	for (StringView name : names)
+	{
+		name = trim(name);
+		if (name == "*")
+		{
+			jitAll_ = true;
+		}
+		else if (!name.empty())
+		{
+			std::string normal_script_name;
+			utils::NormaliseScriptName(std::string(name), normal_script_name);
+			jitScripts_.emplace(normal_script_name);
+		}
+	}
+}
+
+void PawnManager::SetTraceRecorder(ITraceRecorder* recorder)
+{
+	trace = recorder;
+	pluginManager.trace = recorder;
+	// The watchdog alone would pay for a scope on every native call, it only has to see publics.
+	traceNatives_ = recorder != nullptr && recorder->capturing();
+	for (auto& pair : amxToScript_)
+	{
+		pair.second->traceNatives(traceNatives_);
+	}
+}
@@ -35,6 +35,7 @@
 #include <sdk.hpp>
 
 #include <algorithm>
+#include <future>
 #include <map>
 #include <memory>
 #include <vector>
@@ -46,6 +47,9 @@
 
 using namespace Impl;
 
+/// Resolves the native names recorded by the traced native dispatcher, see `Script.cpp`.
+const char* PawnTraceNameResolver(TraceCategory category, const void* context, int index);
+
 class PawnManager : public Singleton<PawnManager>, public PawnLookup
 {
 public:
@@ -55,8 +59,12 @@ public:
 	FlatHashMap<AMX*, PawnScript*> amxToScript_;
 	DefaultEventDispatcher<PawnEventHandler> eventDispatcher;
 	PawnPluginManager pluginManager;
+	ITraceRecorder* trace = nullptr;
 
 private:
+	/// Whether loaded scripts send their natives through the traced dispatcher, see `Script.cpp`
+	bool traceNatives_ = false;
+
 	int gamemodeIndex_ = 0;
 	int gamemodeRepeat_ = 1;
 	DynamicArray<String> gamemodes_;
@@ -64,6 +72,9 @@ private:
 	TimePoint nextRestart_;
 	Milliseconds restartDelay_;
 	bool reloading_ = false;
+	/// Normalised names of the scripts to run in native code, from `pawn.jit_scripts`
+	FlatHashSet<String> jitScripts_;
+	bool jitAll_ = false;
 	TimePoint nextSleep_;
 	bool unloadNextTick_ = false;
 	String nextScriptName_ = "";
@@ -89,8 +100,55 @@ private:
 			});
 	}
 
+	/// A script being read and relocated on a worker thread, see `PawnScript::prepareLoad()`.  The
+	/// rest of the load (natives, plugins, init callbacks) happens on the main thread once it's done.
+	struct PendingLoad
+	{
+		enum Action
+		{
+			Preload, ///< For `Changemode`, picked up by `Load` when the restart delay is over
+			Load,
+			Reload,
+		};
+
+		std::string name; ///< Normalised
+		Action action;
+		String message; ///< What to call the script when reporting the result
+		std::future<PawnScript*> script;
+		bool discard = false; ///< Nothing wants it any more, free it once it's ready
+	};
+	DynamicArray<PendingLoad> pendingLoads_;
+
+	/// Whether a script should be translated to native code when it's loaded.
+	bool wantsJIT(std::string const& normal_script_name) const
+	{
+		return jitAll_ || jitScripts_.find(String(normal_script_name)) != jitScripts_.end();
+	}
+
+	/// Start reading a script in the background, unless that is already happening.
+	void startLoad(std::string const& normal_script_name, PendingLoad::Action action, String const& message = "");
+	/// Whether the script is being read in the background and isn't done yet.
+	bool isLoading(std::string const& normal_script_name) const;
+	/// Take a finished background load of the script, or null if there isn't one.
+	PawnScript* takeLoaded(std::string const& normal_script_name);
+	/// Finish the background loads that are ready, called every tick.
+	void processLoads();
+
+	/// Whether any loaded script implements each callback, so events nobody handles can be skipped.
+	StaticArray<bool, PawnCallback_End> callbackUsed_ {};
+
+	void updateCallbackUsage();
 	void openAMX(PawnScript& script, bool isEntryScript, bool restarting = false);
 	void closeAMX(PawnScript& script, bool isEntryScript);
+	/// Commands being run for scripts by `SendRconCommand`, whose script loads aren't done in the
+	/// background.
+	int scriptCommands_ = 0;
+
+	/// Runs a load or reload command, in the background unless a script sent it
+	void loadCommand(const ConsoleCommandSenderData& sender, std::string const& name, bool reload, String const& label);
+	void benchmarkPublic(const ConsoleCommandSenderData& sender, std::string const& args);
+	void profile(const ConsoleCommandSenderData& sender, std::string const& args);
+	void pluginTimes(const ConsoleCommandSenderData& sender, std::string const& args);
 
 public:
 	PawnManager();
@@ -103,11 +161,38 @@ public:
 
 	void SetBasePath(std::string const& path);
 	void SetScriptPath(std::string const& path);
+	/// The scripts to translate to native code from now on, by name as in `pawn.main_scripts`, or
+	/// `*` for all of them.  Ignored where `PawnJIT` isn't supported.
+	void SetJITScripts(DynamicArray<StringView> const& names);
+
+	/// Take the server's trace recorder, or null when nothing wants scopes entered.  Natives are
+	/// only hooked into it while it is capturing.
+	void SetTraceRecorder(ITraceRecorder* recorder);
+
+	/// Whether scripts should trace their natives, for scripts loaded from now on.
+	bool TracesNatives() const
+	{
+		return traceNatives_;
+	}
+
+	/// `amx_Exec` for the server's own calls into scripts, in the script's native code when it has
+	/// some.  AMXs that aren't scripts, such as clones made by plugins, use the interpreter.
+	int Exec(AMX* amx, cell* retval, int index)
+	{
+		auto script = amxToScript_.find(amx);
+		return script == amxToScript_.end() ? amx_Exec(amx, retval, index) : script->second->execProgram(retval, index);
+	}
 
 	bool Load(std::string const& name, bool primary = false, bool restarting = false);
 	bool Load(DynamicArray<StringView> const& mainScripts);
 	bool Reload(std::string const& name);
+	/// Load or reload a script with the file work done on a worker thread.  The result is printed
+	/// when it's done, in a later tick.
+	/// @returns False if the load couldn't be started at all
+	bool LoadAsync(std::string const& name, bool reload, String const& message);
 	bool Unload(std::string const& name);
+	/// Runs a console command for a script
+	void SendScriptCommand(StringView command);
 	bool Changemode(std::string const& name);
 	void EndMainScript();
 
@@ -131,42 +216,54 @@ public:
 		}
 	}
 
+	/// Call a server callback in one script through its pre-resolved public index.
 	template <typename... T>
-	cell CallAllInSidesFirst(char const* name, DefaultReturnValue defaultRetValue, T... args)
+	static cell CallIn(IPawnScript* script, PawnCallback callback, DefaultReturnValue defaultRetValue, T... args)
+	{
+		const int index = static_cast<PawnScript*>(script)->getCallback(callback);
+		if (index == INT_MAX)
+		{
+			return static_cast<cell>(defaultRetValue);
+		}
+		return script->Call(index, defaultRetValue, args...);
+	}
+
+	template <typename... T>
+	cell CallAllInSidesFirst(PawnCallback callback, DefaultReturnValue defaultRetValue, T... args)
 	{
 		cell ret = static_cast<cell>(defaultRetValue);
 
 		for (IPawnScript* cur : scripts_)
 		{
-			ret = cur->Call(name, defaultRetValue, args...);
+			ret = CallIn(cur, callback, defaultRetValue, args...);
 		}
 		if (mainScript_)
 		{
-			ret = mainScript_->Call(name, defaultRetValue, args...);
+			ret = CallIn(mainScript_, callback, defaultRetValue, args...);
 		}
 
 		return ret;
 	}
 
 	template <typename... T>
-	cell CallAllInEntryFirst(char const* name, DefaultReturnValue defaultRetValue, T... args)
+	cell CallAllInEntryFirst(PawnCallback callback, DefaultReturnValue defaultRetValue, T... args)
 	{
 		cell ret = static_cast<cell>(defaultRetValue);
 
 		if (mainScript_)
 		{
-			ret = mainScript_->Call(name, defaultRetValue, args...);
+			ret = CallIn(mainScript_, callback, defaultRetValue, args...);
 		}
 		for (IPawnScript* cur : scripts_)
 		{
-			ret = cur->Call(name, defaultRetValue, args...);
+			ret = CallIn(cur, callback, defaultRetValue, args...);
 		}
 
 		return ret;
 	}
 
 	template <typename... T>
-	cell CallInSidesWhile0(char const* name, T... args)
+	cell CallInSidesWhile0(PawnCallback callback, T... args)
 	{
 		cell
 			ret
@@ -174,7 +271,7 @@ public:
 
 		for (IPawnScript* cur : scripts_)
 		{
-			ret = cur->Call(name, DefaultReturnValue_False, args...);
+			ret = CallIn(cur, callback, DefaultReturnValue_False, args...);
 			if (ret)
 			{
 				break;
@@ -185,7 +282,7 @@ public:
 	}
 
 	template <typename... T>
-	cell CallInSidesWhile1(char const* name, T... args)
+	cell CallInSidesWhile1(PawnCallback callback, T... args)
 	{
 		cell
 			ret
@@ -193,7 +290,7 @@ public:
 
 		for (IPawnScript* cur : scripts_)
 		{
-			ret = cur->Call(name, DefaultReturnValue_True, args...);
+			ret = CallIn(cur, callback, DefaultReturnValue_True, args...);
 			if (!ret)
 			{
 				break;
@@ -204,44 +301,44 @@ public:
 	}
 
 	template <typename... T>
-	cell CallInSides(char const* name, DefaultReturnValue defaultRetValue, T... args)
+	cell CallInSides(PawnCallback callback, DefaultReturnValue defaultRetValue, T... args)
 	{
 		cell ret = static_cast<cell>(defaultRetValue);
 
 		for (IPawnScript* cur : scripts_)
 		{
-			ret = cur->Call(name, defaultRetValue, args...);
+			ret = CallIn(cur, callback, defaultRetValue, args...);
 		}
 
 		return ret;
 	}
 
 	template <typename... T>
-	cell CallInEntry(char const* name, DefaultReturnValue defaultRetValue, T... args)
+	cell CallInEntry(PawnCallback callback, DefaultReturnValue defaultRetValue, T... args)
 	{
 		cell ret = static_cast<cell>(defaultRetValue);
 
 		if (mainScript_)
 		{
-			ret = mainScript_->Call(name, defaultRetValue, args...);
+			ret = CallIn(mainScript_, callback, defaultRetValue, args...);
 		}
 
 		return ret;
 	}
 
 	template <typename... T>
-	cell CallAll(char const* name, T... args)
+	cell CallAll(PawnCallback callback, T... args)
 	{
 		cell
 			ret
 			= 0;
 		if (mainScript_)
 		{
-			ret = mainScript_->Call(name, DefaultReturnValue_False, args...);
+			ret = CallIn(mainScript_, callback, DefaultReturnValue_False, args...);
 		}
 		for (IPawnScript* cur : scripts_)
 		{
-			ret = cur->Call(name, DefaultReturnValue_False, args...);
+			ret = CallIn(cur, callback, DefaultReturnValue_False, args...);
 		}
 		return ret;
 	}
@@ -264,20 +361,20 @@ public:
 	}
 
 	template <typename... T>
-	cell CallWhile0(char const* name, T... args)
+	cell CallWhile0(PawnCallback callback, T... args)
 	{
 		cell
 			ret
 			= 0;
 		if (mainScript_)
 		{
-			ret = mainScript_->Call(name, DefaultReturnValue_False, args...);
+			ret = CallIn(mainScript_, callback, DefaultReturnValue_False, args...);
 			if (ret)
 				return ret;
 		}
 		for (IPawnScript* cur : scripts_)
 		{
-			ret = cur->Call(name, DefaultReturnValue_False, args...);
+			ret = CallIn(cur, callback, DefaultReturnValue_False, args...);
 			if (ret)
 				return ret;
 		}
@@ -304,19 +401,19 @@ public:
 	}
 
 	template <typename... T>
-	cell CallWhile1(char const* name, T... args)
+	cell CallWhile1(PawnCallback callback, T... args)
 	{
 		cell ret = static_cast<cell>(DefaultReturnValue_True);
 
 		if (mainScript_)
 		{
-			ret = mainScript_->Call(name, DefaultReturnValue_True, args...);
+			ret = CallIn(mainScript_, callback, DefaultReturnValue_True, args...);
 			if (!ret)
 				return ret;
 		}
 		for (IPawnScript* cur : scripts_)
 		{
-			ret = cur->Call(name, DefaultReturnValue_True, args...);
+			ret = CallIn(cur, callback, DefaultReturnValue_True, args...);
 			if (!ret)
 				return ret;
 		}
@@ -343,6 +440,11 @@ public:
 		return ret;
 	}
 
+	bool isCallbackUsed(PawnCallback callback) const
+	{
+		return callbackUsed_[callback];
+	}
+
 	AMX* AMXFromID(int id) const;
 	int IDFromAMX(AMX*) const;
 
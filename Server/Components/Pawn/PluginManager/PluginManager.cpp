@@ -6,6 +6,7 @@
  *  The original code is copyright (c) 2022, open.mp team and contributors.
  */
 
+#include <algorithm>
 #include <ghc/filesystem.hpp>
 #include "PluginManager.hpp"
 #include "../utils.hpp"
@@ -94,6 +95,7 @@ void PawnPluginManager::Unload(std::string const& name)
 	auto& plugin = *pos->second;
 	plugin.Unload();
 	plugins_.erase(pos);
+	tickStats_.erase(name);
 }
 
 void PawnPluginManager::Spawn(std::string const& name)
@@ -149,12 +151,45 @@ void PawnPluginManager::AmxUnload(AMX* amx)
 
 void PawnPluginManager::ProcessTick()
 {
+	// Slow plugins are reported at most this often, with a count of how many ticks went over since.
+	static constexpr Seconds WarningInterval = Seconds(10);
+
 	for (auto& cur : plugins_)
 	{
-		cur.second->ProcessTick();
+		const TimePoint start = Time::now();
+		{
+			OMP_TRACE_SCOPE(trace, TraceCategory::Plugin, cur.first.c_str());
+			cur.second->ProcessTick();
+		}
+		const TimePoint end = Time::now();
+		const Microseconds taken = duration_cast<Microseconds>(end - start);
+
+		PluginTickStats& stats = tickStats_[cur.first];
+		stats.last = taken;
+		stats.average = stats.calls == 0 ? float(taken.count()) : stats.average + (float(taken.count()) - stats.average) / 32.0f;
+		stats.worst = std::max(stats.worst, taken);
+		++stats.calls;
+
+		if (tickBudget.count() > 0 && taken > tickBudget)
+		{
+			++stats.overBudget;
+			++stats.unreported;
+			if (end - stats.lastWarning >= WarningInterval)
+			{
+				core->logLn(LogLevel::Warning, "Legacy plugin '%s' took %.2fms in ProcessTick, %.2fms over the %.2fms budget (%llu times since the last warning, average %.2fms).",
+					cur.first.c_str(), taken.count() / 1000.0, (taken - tickBudget).count() / 1000.0, tickBudget.count() / 1000.0, static_cast<unsigned long long>(stats.unreported), stats.average / 1000.0);
+				stats.unreported = 0;
+				stats.lastWarning = end;
+			}
+		}
 	}
 }
 
+void PawnPluginManager::ResetTickStats()
+{
+	tickStats_.clear();
+}
+
 void PawnPluginManager::SetBasePath(std::string const& path)
 {
 	if (path.length() == 0)
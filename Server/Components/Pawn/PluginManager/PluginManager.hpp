@@ -14,14 +14,31 @@
 
 #include "../Plugin/Plugin.h"
 #include "../Singleton.hpp"
+#include <trace.hpp>
 
 using namespace Impl;
 
+/// How long a legacy plugin's `ProcessTick` takes, measured every tick.
+struct PluginTickStats
+{
+	uint64_t calls = 0;
+	Microseconds last { 0 };
+	float average = 0.0f; ///< Microseconds, exponential moving average
+	Microseconds worst { 0 };
+	uint64_t overBudget = 0; ///< Ticks that took longer than the budget
+	uint64_t unreported = 0; ///< Ticks over budget since the last warning
+	TimePoint lastWarning;
+};
+
 class PawnPluginManager
 {
 public:
 	FlatHashMap<String, std::unique_ptr<PawnPlugin>> plugins_;
+	FlatHashMap<String, PluginTickStats> tickStats_;
 	ICore* core = nullptr;
+	ITraceRecorder* trace = nullptr;
+	/// A warning is logged when a plugin's `ProcessTick` takes longer than this, zero disables it.
+	Microseconds tickBudget { 0 };
 
 	PawnPluginManager();
 	~PawnPluginManager();
@@ -37,6 +54,9 @@ public:
 
 	void ProcessTick();
 
+	/// Forget the recorded times, the budget is kept.
+	void ResetTickStats();
+
 private:
 	std::string
 		pluginPath_,
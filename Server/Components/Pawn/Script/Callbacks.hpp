@@ -0,0 +1,162 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include "sdk.hpp"
+
+/// Every public the server itself calls.  Each script resolves all of them to public indices once,
+/// when it is loaded, so events don't have to look names up on every call.
+enum PawnCallback
+{
+	PawnCallback_OnActorStreamIn,
+	PawnCallback_OnActorStreamOut,
+	PawnCallback_OnClientCheckResponse,
+	PawnCallback_OnDialogResponse,
+	PawnCallback_OnEnterExitModShop,
+	PawnCallback_OnFilterScriptExit,
+	PawnCallback_OnFilterScriptInit,
+	PawnCallback_OnGameModeExit,
+	PawnCallback_OnGameModeInit,
+	PawnCallback_OnIncomingConnection,
+	PawnCallback_OnObjectMoved,
+	PawnCallback_OnPlayerClickGangZone,
+	PawnCallback_OnPlayerClickMap,
+	PawnCallback_OnPlayerClickPlayer,
+	PawnCallback_OnPlayerClickPlayerGangZone,
+	PawnCallback_OnPlayerClickPlayerTextDraw,
+	PawnCallback_OnPlayerClickTextDraw,
+	PawnCallback_OnPlayerCommandText,
+	PawnCallback_OnPlayerConnect,
+	PawnCallback_OnPlayerDeath,
+	PawnCallback_OnPlayerDisconnect,
+	PawnCallback_OnPlayerEditAttachedObject,
+	PawnCallback_OnPlayerEditObject,
+	PawnCallback_OnPlayerEnterCheckpoint,
+	PawnCallback_OnPlayerEnterGangZone,
+	PawnCallback_OnPlayerEnterPlayerGangZone,
+	PawnCallback_OnPlayerEnterRaceCheckpoint,
+	PawnCallback_OnPlayerEnterVehicle,
+	PawnCallback_OnPlayerExitVehicle,
+	PawnCallback_OnPlayerExitedMenu,
+	PawnCallback_OnPlayerFinishedDownloading,
+	PawnCallback_OnPlayerGiveDamage,
+	PawnCallback_OnPlayerGiveDamageActor,
+	PawnCallback_OnPlayerInteriorChange,
+	PawnCallback_OnPlayerKeyStateChange,
+	PawnCallback_OnPlayerLeaveCheckpoint,
+	PawnCallback_OnPlayerLeaveGangZone,
+	PawnCallback_OnPlayerLeavePlayerGangZone,
+	PawnCallback_OnPlayerLeaveRaceCheckpoint,
+	PawnCallback_OnPlayerObjectMoved,
+	PawnCallback_OnPlayerPickUpPickup,
+	PawnCallback_OnPlayerPickUpPlayerPickup,
+	PawnCallback_OnPlayerRequestClass,
+	PawnCallback_OnPlayerRequestDownload,
+	PawnCallback_OnPlayerRequestSpawn,
+	PawnCallback_OnPlayerSelectObject,
+	PawnCallback_OnPlayerSelectedMenuRow,
+	PawnCallback_OnPlayerSpawn,
+	PawnCallback_OnPlayerStateChange,
+	PawnCallback_OnPlayerStreamIn,
+	PawnCallback_OnPlayerStreamOut,
+	PawnCallback_OnPlayerTakeDamage,
+	PawnCallback_OnPlayerText,
+	PawnCallback_OnPlayerUpdate,
+	PawnCallback_OnPlayerWeaponShot,
+	PawnCallback_OnRconCommand,
+	PawnCallback_OnRconLoginAttempt,
+	PawnCallback_OnScriptLoadPlayer,
+	PawnCallback_OnScriptUnloadPlayer,
+	PawnCallback_OnTrailerUpdate,
+	PawnCallback_OnUnoccupiedVehicleUpdate,
+	PawnCallback_OnVehicleDamageStatusUpdate,
+	PawnCallback_OnVehicleDeath,
+	PawnCallback_OnVehicleMod,
+	PawnCallback_OnVehiclePaintjob,
+	PawnCallback_OnVehicleRespray,
+	PawnCallback_OnVehicleSirenStateChange,
+	PawnCallback_OnVehicleSpawn,
+	PawnCallback_OnVehicleStreamIn,
+	PawnCallback_OnVehicleStreamOut,
+
+	PawnCallback_End
+};
+
+static constexpr StaticArray<const char*, PawnCallback_End> PawnCallbackNames = {
+	"OnActorStreamIn",
+	"OnActorStreamOut",
+	"OnClientCheckResponse",
+	"OnDialogResponse",
+	"OnEnterExitModShop",
+	"OnFilterScriptExit",
+	"OnFilterScriptInit",
+	"OnGameModeExit",
+	"OnGameModeInit",
+	"OnIncomingConnection",
+	"OnObjectMoved",
+	"OnPlayerClickGangZone",
+	"OnPlayerClickMap",
+	"OnPlayerClickPlayer",
+	"OnPlayerClickPlayerGangZone",
+	"OnPlayerClickPlayerTextDraw",
+	"OnPlayerClickTextDraw",
+	"OnPlayerCommandText",
+	"OnPlayerConnect",
+	"OnPlayerDeath",
+	"OnPlayerDisconnect",
+	"OnPlayerEditAttachedObject",
+	"OnPlayerEditObject",
+	"OnPlayerEnterCheckpoint",
+	"OnPlayerEnterGangZone",
+	"OnPlayerEnterPlayerGangZone",
+	"OnPlayerEnterRaceCheckpoint",
+	"OnPlayerEnterVehicle",
+	"OnPlayerExitVehicle",
+	"OnPlayerExitedMenu",
+	"OnPlayerFinishedDownloading",
+	"OnPlayerGiveDamage",
+	"OnPlayerGiveDamageActor",
+	"OnPlayerInteriorChange",
+	"OnPlayerKeyStateChange",
+	"OnPlayerLeaveCheckpoint",
+	"OnPlayerLeaveGangZone",
+	"OnPlayerLeavePlayerGangZone",
+	"OnPlayerLeaveRaceCheckpoint",
+	"OnPlayerObjectMoved",
+	"OnPlayerPickUpPickup",
+	"OnPlayerPickUpPlayerPickup",
+	"OnPlayerRequestClass",
+	"OnPlayerRequestDownload",
+	"OnPlayerRequestSpawn",
+	"OnPlayerSelectObject",
+	"OnPlayerSelectedMenuRow",
+	"OnPlayerSpawn",
+	"OnPlayerStateChange",
+	"OnPlayerStreamIn",
+	"OnPlayerStreamOut",
+	"OnPlayerTakeDamage",
+	"OnPlayerText",
+	"OnPlayerUpdate",
+	"OnPlayerWeaponShot",
+	"OnRconCommand",
+	"OnRconLoginAttempt",
+	"OnScriptLoadPlayer",
+	"OnScriptUnloadPlayer",
+	"OnTrailerUpdate",
+	"OnUnoccupiedVehicleUpdate",
+	"OnVehicleDamageStatusUpdate",
+	"OnVehicleDeath",
+	"OnVehicleMod",
+	"OnVehiclePaintjob",
+	"OnVehicleRespray",
+	"OnVehicleSirenStateChange",
+	"OnVehicleSpawn",
+	"OnVehicleStreamIn",
+	"OnVehicleStreamOut"
+};
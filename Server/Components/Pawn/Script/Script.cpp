@@ -18,6 +18,7 @@
 
 #include "Script.hpp"
 #include "../Manager/Manager.hpp"
+#include "../profiler.hpp"
 
 extern "C"
 {
@@ -46,8 +47,31 @@ extern "C"
 /// A map of per-AMX caches
 static FlatHashMap<AMX*, AMXCache*> cache;
 
-void PawnScript::tryLoad(std::string const& path)
+/// Wraps the native dispatcher so natives show up in server traces, installed by
+/// `PawnScript::traceNatives()` only while one is being captured.  The name is only looked up when
+/// needed, see `PawnTraceNameResolver`.
+static int AMXAPI amx_TracedCallback(AMX* amx, cell index, cell* result, const cell* params)
 {
+	PawnManager* manager = PawnManager::Get();
+	OMP_TRACE_SCOPE(manager->TracesNatives() ? manager->trace : nullptr, TraceCategory::Native, nullptr, amx, index);
+	auto const& scripts = manager->amxToScript_;
+	auto it = scripts.find(amx);
+	return (it == scripts.end() ? &amx_Callback : it->second->untracedCallback())(amx, index, result, params);
+}
+
+const char* PawnTraceNameResolver(TraceCategory category, const void* context, int index)
+{
+	AMX_NATIVE_INFO info;
+	if (category == TraceCategory::Native && context && amx_GetNativeByIndex(static_cast<const AMX*>(context), index, &info) == AMX_ERR_NONE)
+	{
+		return info.name;
+	}
+	return nullptr;
+}
+
+void PawnScript::release()
+{
+	callbacks_.fill(INT_MAX);
 	if (loaded_)
 	{
 		amx_FloatCleanup(&amx_);
@@ -59,16 +83,54 @@ void PawnScript::tryLoad(std::string const& path)
 		aux_FreeProgram(&amx_);
 		cache.erase(&amx_);
 	}
+	else if (prepared_ && loadError_ == AMX_ERR_NONE)
+	{
+		aux_FreeProgram(&amx_);
+	}
+	jit_.reset();
+	jitError_.clear();
+	nativesHooked_ = false;
 	loaded_ = false;
-	if (path == "")
+	prepared_ = false;
+}
+
+void PawnScript::prepareLoad(std::string const& path, bool jit)
+{
+	path_ = path;
+	prepared_ = path != "";
+	if (prepared_)
+	{
+		loadError_ = aux_LoadProgram(&amx_, const_cast<char*>(path.c_str()), nullptr);
+		if (loadError_ == AMX_ERR_NONE && jit)
+		{
+			jit_ = PawnJIT::compile(amx_, path, jitError_);
+		}
+	}
+}
+
+void PawnScript::takeProgram(PawnScript& other)
+{
+	release();
+	amx_ = other.amx_;
+	path_ = other.path_;
+	loadError_ = other.loadError_;
+	jit_ = std::move(other.jit_);
+	jitError_ = std::move(other.jitError_);
+	prepared_ = other.prepared_;
+	other.prepared_ = false;
+}
+
+void PawnScript::finishLoad()
+{
+	if (!prepared_)
 	{
 		return;
 	}
-	int err = aux_LoadProgram(&amx_, const_cast<char*>(path.c_str()), nullptr);
-	switch (err)
+	prepared_ = false;
+	switch (loadError_)
 	{
 	case AMX_ERR_NOTFOUND:
-		serverCore->printLn("Could not find:\n\n\t %s %s", path.c_str(),
+		serverCore->printLn("Could not find:\n\n\t %s %s", path_.c_str(),
 			R"(
 While attempting to load a PAWN script, a file-not-found error was
 encountered.  This could be caused by many things:
@@ -86,9 +148,17 @@ encountered.  This could be caused by many things:
 		break;
 	case AMX_ERR_NONE:
 		loaded_ = true;
+		if (jit_)
+		{
+			serverCore->printLn("Compiled %s to %zu bytes of native code", path_.c_str(), jit_->size());
+		}
+		else if (!jitError_.empty())
+		{
+			serverCore->logLn(LogLevel::Warning, "%s will run in the interpreter, %s", path_.c_str(), jitError_.c_str());
+		}
 		break;
 	default:
-		serverCore->printLn("%s", aux_StrError(err));
+		serverCore->printLn("%s", aux_StrError(loadError_));
 		break;
 	}
 	if (loaded_)
@@ -100,15 +170,80 @@ encountered.  This could be caused by many things:
 		amx_TimeInit(&amx_);
 		amx_FloatInit(&amx_);
 		cache.emplace(std::make_pair<AMX*, AMXCache*>(&amx_, &cache_));
+		traceNatives(PawnManager::Get()->TracesNatives());
+	}
+}
+
+void PawnScript::traceNatives(bool trace)
+{
+	if (!OMP_TRACE_ENABLED || !loaded_)
+	{
+		return;
+	}
+	if (trace && !nativesHooked_)
+	{
+		untracedCallback_ = amx_.callback;
+		untracedSysreqD_ = amx_.sysreq_d;
+		// `amx_Callback` patches each call it sees to `SYSREQ.D`, which never calls back again.
+		amx_.sysreq_d = 0;
+		amx_SetCallback(&amx_, &amx_TracedCallback);
+		nativesHooked_ = true;
+	}
+	// Only put things back if nobody chained on to the callback in the meantime, or they'd be
+	// unhooked.  Otherwise it stays, entering no scopes until tracing starts again, and is reused.
+	else if (!trace && nativesHooked_ && amx_.callback == &amx_TracedCallback)
+	{
+		amx_SetCallback(&amx_, untracedCallback_);
+		amx_.sysreq_d = untracedSysreqD_;
+		nativesHooked_ = false;
 	}
 }
 
-PawnScript::PawnScript(int id, std::string const& path, ICore* core)
+void PawnScript::tryLoad(std::string const& path, bool jit)
+{
+	release();
+	prepareLoad(path, jit);
+	finishLoad();
+}
+
+void PawnScript::resolveCallbacks()
+{
+	for (int i = 0; i != PawnCallback_End; ++i)
+	{
+		if (!loaded_ || FindPublic(PawnCallbackNames[i], &callbacks_[i]) != AMX_ERR_NONE)
+		{
+			callbacks_[i] = INT_MAX;
+		}
+	}
+
+	cell amxAddr;
+	cell* rate;
+	playerUpdateInterval_ = TimePoint::duration::zero();
+	if (loaded_ && FindPubVar("__OPEN_MP_PLAYER_UPDATE_RATE", &amxAddr) == AMX_ERR_NONE && GetAddr(amxAddr, &rate) == AMX_ERR_NONE && *rate > 0)
+	{
+		playerUpdateInterval_ = duration_cast<TimePoint::duration>(Seconds(1)) / *rate;
+		lastPlayerUpdate_.assign(PLAYER_POOL_SIZE, TimePoint());
+	}
+	else
+	{
+		lastPlayerUpdate_.clear();
+	}
+}
+
+PawnScript::PawnScript(int id, std::string const& path, ICore* core, bool jit)
 	: serverCore(core)
 	, loaded_(false)
 	, id_(id)
 {
-	tryLoad(path);
+	tryLoad(path, jit);
+}
+
+PawnScript::PawnScript(int id, ICore* core)
+	: serverCore(core)
+	, loaded_(false)
+	, id_(id)
+{
+	callbacks_.fill(INT_MAX);
 }
 
 PawnScript::~PawnScript()
@@ -116,6 +251,35 @@ PawnScript::~PawnScript()
 	tryLoad("");
 }
 
+int PawnScript::Exec(cell* retval, int index)
+{
+	PawnProfiler::PublicScope profile(&amx_, index);
+	if (OMP_TRACE_ENABLED && PawnManager::Get()->trace)
+	{
+		// Unlike natives, public names can be read straight out of the header.
+		const char* name = "";
+		if (index == AMX_EXEC_MAIN)
+		{
+			name = "main";
+		}
+		else if (index == AMX_EXEC_CONT)
+		{
+			name = "main (continued)";
+		}
+		else
+		{
+			AMX_HEADER* hdr = reinterpret_cast<AMX_HEADER*>(amx_.base);
+			if (index >= 0 && index < (cell)NUMENTRIES(hdr, publics, natives))
+			{
+				name = GETENTRYNAME(hdr, GETENTRY(hdr, publics, index));
+			}
+		}
+		OMP_TRACE_SCOPE(PawnManager::Get()->trace, TraceCategory::Public, name);
+		return execProgram(retval, index);
+	}
+	return execProgram(retval, index);
+}
+
 int AMXAPI amx_GetNativeByIndex(AMX const* amx, int index, AMX_NATIVE_INFO* ret)
 {
 	AMX_HEADER*
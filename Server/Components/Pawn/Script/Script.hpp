@@ -17,12 +17,16 @@
 
 #include <array>
 #include <exception>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <amx/amx.h>
 #include <amx/amxaux.h>
 
+#include "Callbacks.hpp"
+#include "../JIT/JIT.hpp"
+
 using namespace Impl;
 
 /// A struct for different AMX caches
@@ -35,7 +39,9 @@ struct AMXCache
 class PawnScript : public IPawnScript
 {
 public:
-	PawnScript(int id, std::string const& path, ICore* core);
+	PawnScript(int id, std::string const& path, ICore* core, bool jit = false);
+	/// An empty script, for `prepareLoad()` on a worker thread.
+	PawnScript(int id, ICore* core);
 	virtual ~PawnScript();
 
 	// Wrap the AMX API.
@@ -43,7 +49,7 @@ public:
 	int Callback(cell index, cell* result, const cell* params) override { return amx_Callback(&amx_, index, result, params); }
 	int Cleanup() override { return amx_Cleanup(&amx_); }
 	int Clone(AMX* amxClone, void* data) const override { return amx_Clone(amxClone, const_cast<AMX*>(&amx_), data); }
-	int Exec(cell* retval, int index) override { return amx_Exec(&amx_, retval, index); }
+	int Exec(cell* retval, int index) override;
 	int FindNative(char const* name, int* index) const override { return amx_FindNative(const_cast<AMX*>(&amx_), name, index); }
 	int FindPublic(char const* funcname, int* index) const override { return amx_FindPublic(const_cast<AMX*>(&amx_), funcname, index); }
 	int FindPubVar(char const* varname, cell* amx_addr) const override { return amx_FindPubVar(const_cast<AMX*>(&amx_), varname, amx_addr); }
@@ -106,14 +112,93 @@ public:
 
 	using IPawnScript::Register;
 
-	void tryLoad(std::string const& path);
+	void tryLoad(std::string const& path, bool jit = false);
+
+	/// The part of `tryLoad()` that may run on any thread: read the file, check the header and
+	/// relocate the code.  Touches nothing but this script, errors are kept for `finishLoad()`.
+	/// @param jit Translate the code to native code as well, see `PawnJIT`
+	void prepareLoad(std::string const& path, bool jit = false);
+
+	/// Take over a program prepared in another (unused) script, for reloads.
+	void takeProgram(PawnScript& other);
+
+	/// The main thread part of `tryLoad()`: report errors and initialise the AMX modules.
+	void finishLoad();
+
+	/// Look up the public index of every `PawnCallback`, once the script is fully registered.  Also
+	/// reads the optional `public __OPEN_MP_PLAYER_UPDATE_RATE = <Hz>;` setting, which limits
+	/// how often `OnPlayerUpdate` is called in this script for each player.
+	void resolveCallbacks();
+
+	/// `amx_Exec` without the profiling and tracing of `Exec`, in native code when the script has some.
+	int execProgram(cell* retval, int index)
+	{
+		return jit_ ? jit_->exec(&amx_, retval, index) : amx_Exec(&amx_, retval, index);
+	}
+
+	/// The native code of the script, or null when it runs in the interpreter.
+	PawnJIT const* getJIT() const { return jit_.get(); }
+
+	/// Send natives through the traced dispatcher, or stop.  Calls the interpreter patched to call
+	/// the native directly (`SYSREQ.D`) before this skip the dispatcher and aren't traced.
+	void traceNatives(bool trace);
+
+	/// The callback the traced dispatcher passes natives on to.
+	AMX_CALLBACK untracedCallback() const { return untracedCallback_; }
+
+	/// The public index of a server callback, or `INT_MAX` when the script doesn't implement it.
+	int getCallback(PawnCallback callback) const { return callbacks_[callback]; }
+
+	/// Whether `OnPlayerUpdate` should be called for this player now, honouring the script's rate limit.
+	bool wantsPlayerUpdate(int playerid, TimePoint now)
+	{
+		if (playerUpdateInterval_ == TimePoint::duration::zero())
+		{
+			return true;
+		}
+		if (playerid < 0 || playerid >= PLAYER_POOL_SIZE)
+		{
+			return false;
+		}
+		TimePoint& last = lastPlayerUpdate_[playerid];
+		if (now - last < playerUpdateInterval_)
+		{
+			return false;
+		}
+		last = now;
+		return true;
+	}
+
+	/// Forget when `OnPlayerUpdate` was last called for a player, so whoever gets the ID next isn't limited by it.
+	void resetPlayerUpdate(int playerid)
+	{
+		if (playerid >= 0 && playerid < int(lastPlayerUpdate_.size()))
+		{
+			lastPlayerUpdate_[playerid] = TimePoint();
+		}
+	}
 
 private:
 	ICore* serverCore;
+
+	/// Unload the program, or free one that was prepared but never finished.
+	void release();
+
 	AMX amx_;
 	AMXCache cache_;
+	StaticArray<int, PawnCallback_End> callbacks_;
+	TimePoint::duration playerUpdateInterval_ = TimePoint::duration::zero();
+	DynamicArray<TimePoint> lastPlayerUpdate_; ///< Only allocated when rate limited
 	bool loaded_;
+	bool prepared_ = false; ///< `prepareLoad()` ran but `finishLoad()` hasn't
+	int loadError_ = AMX_ERR_NONE;
+	std::unique_ptr<PawnJIT> jit_;
+	String jitError_; ///< Why the script wasn't translated, when it was asked to be
+	bool nativesHooked_ = false; ///< `amx_TracedCallback` is in the callback chain
+	AMX_CALLBACK untracedCallback_ = &amx_Callback; ///< Put back when tracing stops
+	cell untracedSysreqD_ = 0; ///< Likewise
 	String name_;
+	String path_;
 
 	int id_;
 
@@ -46,7 +46,7 @@ SCRIPT_API(GetActorVirtualWorld, int(IActor& actor))
 	return actor.getVirtualWorld();
 }
 
-SCRIPT_API(ApplyActorAnimation, bool(IActor& actor, const std::string& animationLibrary, const std::string& animationName, float delta, bool loop, bool lockX, bool lockY, bool freeze, int time))
+SCRIPT_API(ApplyActorAnimation, bool(IActor& actor, AmxStringView animationLibrary, AmxStringView animationName, float delta, bool loop, bool lockX, bool lockY, bool freeze, int time))
 {
 	const AnimationData animationData(delta, loop, lockX, lockY, freeze, time, animationLibrary, animationName);
 	actor.applyAnimation(animationData);
@@ -15,21 +15,21 @@ struct CheckpointEvents : public PlayerCheckpointEventHandler, public Singleton<
 {
 	void onPlayerEnterCheckpoint(IPlayer& player) override
 	{
-		PawnManager::Get()->CallAllInSidesFirst("OnPlayerEnterCheckpoint", DefaultReturnValue_True, player.getID());
+		PawnManager::Get()->CallAllInSidesFirst(PawnCallback_OnPlayerEnterCheckpoint, DefaultReturnValue_True, player.getID());
 	}
 
 	void onPlayerLeaveCheckpoint(IPlayer& player) override
 	{
-		PawnManager::Get()->CallAllInSidesFirst("OnPlayerLeaveCheckpoint", DefaultReturnValue_True, player.getID());
+		PawnManager::Get()->CallAllInSidesFirst(PawnCallback_OnPlayerLeaveCheckpoint, DefaultReturnValue_True, player.getID());
 	}
 
 	void onPlayerEnterRaceCheckpoint(IPlayer& player) override
 	{
-		PawnManager::Get()->CallAllInSidesFirst("OnPlayerEnterRaceCheckpoint", DefaultReturnValue_True, player.getID());
+		PawnManager::Get()->CallAllInSidesFirst(PawnCallback_OnPlayerEnterRaceCheckpoint, DefaultReturnValue_True, player.getID());
 	}
 
 	void onPlayerLeaveRaceCheckpoint(IPlayer& player) override
 	{
-		PawnManager::Get()->CallAllInSidesFirst("OnPlayerLeaveRaceCheckpoint", DefaultReturnValue_True, player.getID());
+		PawnManager::Get()->CallAllInSidesFirst(PawnCallback_OnPlayerLeaveRaceCheckpoint, DefaultReturnValue_True, player.getID());
 	}
 };
@@ -16,6 +16,6 @@ struct ClassEvents : public ClassEventHandler, public Singleton<ClassEvents>
 	bool onPlayerRequestClass(IPlayer& player, unsigned int classId) override
 	{
 		// only return value of the one in entry script (gamdemode) matters
-		return !!PawnManager::Get()->CallAllInSidesFirst("OnPlayerRequestClass", DefaultReturnValue_True, player.getID(), classId);
+		return !!PawnManager::Get()->CallAllInSidesFirst(PawnCallback_OnPlayerRequestClass, DefaultReturnValue_True, player.getID(), classId);
 	}
 };
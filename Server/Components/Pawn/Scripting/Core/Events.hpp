@@ -21,10 +21,10 @@ struct CoreEvents : public ConsoleEventHandler, public Singleton<CoreEvents>
 			fullCommand.append(" ");
 			fullCommand.append(parameters.data());
 		}
-		cell ret = PawnManager::Get()->CallInSides("OnRconCommand", DefaultReturnValue_False, StringView(fullCommand));
+		cell ret = PawnManager::Get()->CallInSides(PawnCallback_OnRconCommand, DefaultReturnValue_False, StringView(fullCommand));
 		if (!ret)
 		{
-			ret = PawnManager::Get()->CallInEntry("OnRconCommand", DefaultReturnValue_False, StringView(fullCommand));
+			ret = PawnManager::Get()->CallInEntry(PawnCallback_OnRconCommand, DefaultReturnValue_False, StringView(fullCommand));
 		}
 		return ret;
 	}
@@ -36,7 +36,7 @@ struct CoreEvents : public ConsoleEventHandler, public Singleton<CoreEvents>
 		PeerAddress::ToString(data.networkID.address, addressString);
 		StringView addressStringView = StringView(addressString.data(), addressString.length());
 
-		PawnManager::Get()->CallInSides("OnRconLoginAttempt", DefaultReturnValue_True, addressStringView, password, success);
-		PawnManager::Get()->CallInEntry("OnRconLoginAttempt", DefaultReturnValue_True, addressStringView, password, success);
+		PawnManager::Get()->CallInSides(PawnCallback_OnRconLoginAttempt, DefaultReturnValue_True, addressStringView, password, success);
+		PawnManager::Get()->CallInEntry(PawnCallback_OnRconLoginAttempt, DefaultReturnValue_True, addressStringView, password, success);
 	}
 };
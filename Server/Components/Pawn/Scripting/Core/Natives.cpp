@@ -8,6 +8,8 @@
 
 #include "sdk.hpp"
 #include <iostream>
+#include <cerrno>
+#include <cstdlib>
 #define _USE_MATH_DEFINES
 #include "../Types.hpp"
 #include "../../format.hpp"
@@ -52,16 +54,17 @@ SCRIPT_API(atan2, float(float y, float x))
 	return std::atan2(y, x) * 180 / M_PI;
 }
 
-SCRIPT_API(floatstr, float(std::string const& string))
+SCRIPT_API(floatstr, float(AmxStringView string))
 {
-	try
-	{
-		return std::stof(string);
-	}
-	catch (std::exception e)
+	// Same results as `std::stof`, which returned 0 for both invalid and out of range input.
+	char* end = nullptr;
+	errno = 0;
+	const float value = std::strtof(string.c_str(), &end);
+	if (end == string.c_str() || errno == ERANGE)
 	{
 		return 0.0f;
 	}
+	return value;
 }
 
 SCRIPT_API(GetPlayerPoolSize, int())
@@ -191,7 +194,7 @@ SCRIPT_API(GetVehicles, int(DynamicArray<int>& outputVehicles))
 	return index + 1;
 }
 
-SCRIPT_API(print, bool(const std::string& text))
+SCRIPT_API(print, bool(AmxStringView text))
 {
 	PawnManager::Get()->core->printLn("%s", text.c_str());
 	return false;
@@ -219,7 +222,7 @@ SCRIPT_API(EnableAllAnimations, bool(bool allow))
 	return true;
 }
 
-SCRIPT_API(IsValidAnimationLibrary, bool(std::string const& name))
+SCRIPT_API(IsValidAnimationLibrary, bool(AmxStringView name))
 {
 	cell* args = GetParams();
 	return animationLibraryValid(name, args[0] == 1 * sizeof(cell) || args[2]);
@@ -342,7 +345,7 @@ SCRIPT_API(GameTextForAllf, bool(int time, int style, cell const* format))
 	return true;
 }
 
-int getConfigOptionAsInt(std::string const& cvar)
+int getConfigOptionAsInt(StringView cvar)
 {
 	IConfig* config = PawnManager::Get()->config;
 	auto res = config->getNameFromAlias(cvar);
@@ -352,7 +355,7 @@ int getConfigOptionAsInt(std::string const& cvar)
 	{
 		if (res.first)
 		{
-			PawnManager::Get()->core->logLn(LogLevel::Warning, "Deprecated console variable \"%s\", use \"%.*s\" instead.", cvar.c_str(), PRINT_VIEW(res.second));
+			PawnManager::Get()->core->logLn(LogLevel::Warning, "Deprecated console variable \"%.*s\", use \"%.*s\" instead.", PRINT_VIEW(cvar), PRINT_VIEW(res.second));
 		}
 		if (!(v1 = config->getInt(res.second)))
 		{
@@ -372,7 +375,7 @@ int getConfigOptionAsInt(std::string const& cvar)
 	}
 	else if (v0)
 	{
-		PawnManager::Get()->core->logLn(LogLevel::Warning, "Boolean console variable \"%s\" retreived as integer.", cvar.c_str());
+		PawnManager::Get()->core->logLn(LogLevel::Warning, "Boolean console variable \"%.*s\" retreived as integer.", PRINT_VIEW(cvar));
 		return *v0;
 	}
 	else
@@ -381,7 +384,7 @@ int getConfigOptionAsInt(std::string const& cvar)
 	}
 }
 
-bool getConfigOptionAsBool(std::string const& cvar)
+bool getConfigOptionAsBool(StringView cvar)
 {
 	IConfig* config = PawnManager::Get()->config;
 	auto res = config->getNameFromAlias(cvar);
@@ -391,7 +394,7 @@ bool getConfigOptionAsBool(std::string const& cvar)
 	{
 		if (res.first)
 		{
-			PawnManager::Get()->core->logLn(LogLevel::Warning, "Deprecated console variable \"%s\", use \"%.*s\" instead.", cvar.c_str(), PRINT_VIEW(res.second));
+			PawnManager::Get()->core->logLn(LogLevel::Warning, "Deprecated console variable \"%.*s\", use \"%.*s\" instead.", PRINT_VIEW(cvar), PRINT_VIEW(res.second));
 		}
 		if (!(v0 = config->getBool(res.second)))
 		{
@@ -411,7 +414,7 @@ bool getConfigOptionAsBool(std::string const& cvar)
 	}
 	else if (v1)
 	{
-		PawnManager::Get()->core->logLn(LogLevel::Warning, "Integer console variable \"%s\" retreived as boolean.", cvar.c_str());
+		PawnManager::Get()->core->logLn(LogLevel::Warning, "Integer console variable \"%.*s\" retreived as boolean.", PRINT_VIEW(cvar));
 		return *v1 != 0;
 	}
 	else
@@ -420,7 +423,7 @@ bool getConfigOptionAsBool(std::string const& cvar)
 	}
 }
 
-float getConfigOptionAsFloat(std::string const& cvar)
+float getConfigOptionAsFloat(StringView cvar)
 {
 	IConfig* config = PawnManager::Get()->config;
 	auto res = config->getNameFromAlias(cvar);
@@ -429,7 +432,7 @@ float getConfigOptionAsFloat(std::string const& cvar)
 	{
 		if (res.first)
 		{
-			PawnManager::Get()->core->logLn(LogLevel::Warning, "Deprecated console variable \"%s\", use \"%.*s\" instead.", cvar.c_str(), PRINT_VIEW(res.second));
+			PawnManager::Get()->core->logLn(LogLevel::Warning, "Deprecated console variable \"%.*s\", use \"%.*s\" instead.", PRINT_VIEW(cvar), PRINT_VIEW(res.second));
 		}
 		var = config->getFloat(res.second);
 	}
@@ -447,7 +450,7 @@ float getConfigOptionAsFloat(std::string const& cvar)
 	}
 }
 
-int getConfigOptionAsString(std::string const& cvar, OutputOnlyString& buffer)
+int getConfigOptionAsString(StringView cvar, OutputOnlyString& buffer)
 {
 	// Special case, converting `gamemode0` to `pawn.main_scripts[0]`.  It is the only string to
 	// array change.
@@ -458,11 +461,11 @@ int getConfigOptionAsString(std::string const& cvar, OutputOnlyString& buffer)
 	{
 		if (res.first)
 		{
-			PawnManager::Get()->core->logLn(LogLevel::Warning, "Deprecated console variable \"%s\", use \"%.*s\" instead.", cvar.c_str(), PRINT_VIEW(res.second));
+			PawnManager::Get()->core->logLn(LogLevel::Warning, "Deprecated console variable \"%.*s\", use \"%.*s\" instead.", PRINT_VIEW(cvar), PRINT_VIEW(res.second));
 		}
 		if (gm)
 		{
-			size_t i = std::stoi("0" + cvar.substr(8));
+			size_t i = std::stoi("0" + String(cvar.substr(8)));
 			DynamicArray<StringView> mainScripts(i + 1);
 			size_t n = config->getStrings(res.second, Span<StringView>(mainScripts.data(), mainScripts.size()));
 			if (i < n)
@@ -482,22 +485,22 @@ int getConfigOptionAsString(std::string const& cvar, OutputOnlyString& buffer)
 	return std::get<StringView>(buffer).length();
 }
 
-SCRIPT_API(GetConsoleVarAsBool, bool(std::string const& cvar))
+SCRIPT_API(GetConsoleVarAsBool, bool(AmxStringView cvar))
 {
 	return getConfigOptionAsBool(cvar);
 }
 
-SCRIPT_API(GetConsoleVarAsInt, int(std::string const& cvar))
+SCRIPT_API(GetConsoleVarAsInt, int(AmxStringView cvar))
 {
 	return getConfigOptionAsInt(cvar);
 }
 
-SCRIPT_API(GetConsoleVarAsFloat, float(std::string const& cvar))
+SCRIPT_API(GetConsoleVarAsFloat, float(AmxStringView cvar))
 {
 	return getConfigOptionAsFloat(cvar);
 }
 
-SCRIPT_API(GetConsoleVarAsString, int(std::string const& cvar, OutputOnlyString& buffer))
+SCRIPT_API(GetConsoleVarAsString, int(AmxStringView cvar, OutputOnlyString& buffer))
 {
 	return getConfigOptionAsString(cvar, buffer);
 }
@@ -539,6 +542,33 @@ SCRIPT_API(GetNetworkStats, bool(OutputOnlyString& output))
 	return true;
 }
 
+SCRIPT_API(GetPluginTickStats, bool(AmxStringView plugin, int& last, int& average, int& worst, int& overBudget))
+{
+	FlatHashMap<String, PluginTickStats> const& stats = PawnManager::Get()->pluginManager.tickStats_;
+	auto it = stats.find(String(plugin));
+	if (it == stats.end())
+	{
+		return false;
+	}
+	// All in microseconds.
+	last = it->second.last.count();
+	average = static_cast<int>(it->second.average);
+	worst = it->second.worst.count();
+	overBudget = static_cast<int>(it->second.overBudget);
+	return true;
+}
+
+SCRIPT_API(GetPluginTickBudget, int())
+{
+	return duration_cast<Milliseconds>(PawnManager::Get()->pluginManager.tickBudget).count();
+}
+
+SCRIPT_API(SetPluginTickBudget, bool(int milliseconds))
+{
+	PawnManager::Get()->pluginManager.tickBudget = Milliseconds(std::max(milliseconds, 0));
+	return true;
+}
+
 SCRIPT_API(GetPlayerNetworkStats, bool(IPlayer& player, OutputOnlyString& output))
 {
 	std::stringstream stream;
@@ -574,22 +604,22 @@ SCRIPT_API(GetServerTickRate, int())
 	return PawnManager::Get()->core->tickRate();
 }
 
-SCRIPT_API(GetServerVarAsBool, bool(std::string const& cvar))
+SCRIPT_API(GetServerVarAsBool, bool(AmxStringView cvar))
 {
 	return getConfigOptionAsBool(cvar);
 }
 
-SCRIPT_API(GetServerVarAsInt, int(std::string const& cvar))
+SCRIPT_API(GetServerVarAsInt, int(AmxStringView cvar))
 {
 	return getConfigOptionAsInt(cvar);
 }
 
-SCRIPT_API(GetServerVarAsFloat, float(std::string const& cvar))
+SCRIPT_API(GetServerVarAsFloat, float(AmxStringView cvar))
 {
 	return getConfigOptionAsFloat(cvar);
 }
 
-SCRIPT_API(GetServerVarAsString, int(std::string const& cvar, OutputOnlyString& buffer))
+SCRIPT_API(GetServerVarAsString, int(AmxStringView cvar, OutputOnlyString& buffer))
 {
 	return getConfigOptionAsString(cvar, buffer);
 }
@@ -694,23 +724,15 @@ SCRIPT_API(SendPlayerMessageToAllf, bool(IPlayer& sender, cell const* format))
 
 SCRIPT_API(SendRconCommand, bool(cell const* format))
 {
-	IConsoleComponent* console = PawnManager::Get()->console;
-	if (console)
-	{
-		AmxStringFormatter command(format, GetAMX(), GetParams(), 1);
-		console->send(command);
-	}
+	AmxStringFormatter command(format, GetAMX(), GetParams(), 1);
+	PawnManager::Get()->SendScriptCommand(command);
 	return true;
 }
 
 SCRIPT_API(SendRconCommandf, bool(cell const* format))
 {
-	IConsoleComponent* console = PawnManager::Get()->console;
-	if (console)
-	{
-		AmxStringFormatter command(format, GetAMX(), GetParams(), 1);
-		console->send(command);
-	}
+	AmxStringFormatter command(format, GetAMX(), GetParams(), 1);
+	PawnManager::Get()->SendScriptCommand(command);
 	return true;
 }
 
@@ -816,7 +838,7 @@ SCRIPT_API(ChatTextReplacementToggled, bool())
 	return *PawnManager::Get()->config->getBool("chat_input_filter");
 }
 
-SCRIPT_API(IsValidNickName, bool(const std::string& name))
+SCRIPT_API(IsValidNickName, bool(AmxStringView name))
 {
 	return PawnManager::Get()->players->isNameValid(name);
 }
@@ -860,7 +882,7 @@ SCRIPT_API(GetWeaponSlot, int(uint8_t weapon))
 	return WeaponSlotData { weapon }.slot();
 }
 
-bool addRule(AMX* amx, cell* params, const std::string& name, cell const* format)
+bool addRule(AMX* amx, cell* params, StringView name, cell const* format)
 {
 	ICore* core = PawnManager::Get()->core;
 	if (!core)
@@ -881,17 +903,17 @@ bool addRule(AMX* amx, cell* params, const std::string& name, cell const* format
 	return false;
 }
 
-SCRIPT_API(AddServerRule, bool(const std::string& name, cell const* format))
+SCRIPT_API(AddServerRule, bool(AmxStringView name, cell const* format))
 {
 	return addRule(GetAMX(), GetParams(), name, format);
 }
 
-SCRIPT_API(SetServerRule, bool(const std::string& name, cell const* format))
+SCRIPT_API(SetServerRule, bool(AmxStringView name, cell const* format))
 {
 	return addRule(GetAMX(), GetParams(), name, format);
 }
 
-SCRIPT_API(IsValidServerRule, bool(const std::string& name))
+SCRIPT_API(IsValidServerRule, bool(AmxStringView name))
 {
 	ICore* core = PawnManager::Get()->core;
 	if (!core)
@@ -911,7 +933,7 @@ SCRIPT_API(IsValidServerRule, bool(const std::string& name))
 	return false;
 }
 
-SCRIPT_API(RemoveServerRule, bool(const std::string& name))
+SCRIPT_API(RemoveServerRule, bool(AmxStringView name))
 {
 	ICore* core = PawnManager::Get()->core;
 	if (!core)
@@ -10,6 +10,7 @@
 #include "sdk.hpp"
 #include <ghc/filesystem.hpp>
 #include "../../format.hpp"
+#include "../../queries.hpp"
 
 static int getFlags(cell* params)
 {
@@ -105,7 +106,9 @@ SCRIPT_API(db_open, int(const std::string& name))
 
 SCRIPT_API(db_close, bool(IDatabaseConnection& db))
 {
-	return PawnManager::Get()->databases->close(db);
+	bool ret = PawnManager::Get()->databases->close(db);
+	PawnQueryImpl::Get()->forgetClosedCursors();
+	return ret;
 }
 
 SCRIPT_API(db_query, int(IDatabaseConnection& db, cell const* format))
@@ -115,8 +118,166 @@ SCRIPT_API(db_query, int(IDatabaseConnection& db, cell const* format))
 	return database_result_set ? database_result_set->getID() : 0;
 }
 
+SCRIPT_API(db_query_async, bool(IDatabaseConnection& db, AmxStringView callback, cell const* format))
+{
+	AmxStringFormatter query(format, GetAMX(), GetParams(), 3);
+	return PawnQueryImpl::Get()->queryAsync(db, callback.c_str(), query, GetAMX());
+}
+
+SCRIPT_API(db_query_cursor, int(IDatabaseConnection& db, cell const* format))
+{
+	AmxStringFormatter query(format, GetAMX(), GetParams(), 2);
+	return PawnQueryImpl::Get()->queryCursor(db, query, GetAMX());
+}
+
+static IDatabasesExtension* getDatabasesExtension()
+{
+	IDatabasesComponent* databases = PawnManager::Get()->databases;
+	return databases ? queryExtension<IDatabasesExtension>(databases) : nullptr;
+}
+
+SCRIPT_API(db_configure, bool(IDatabaseConnection& db, AmxStringView journalMode, AmxStringView synchronous, int cacheSize, int mmapSize, bool groupCommit, int checkpointInterval))
+{
+	IDatabasesExtension* databases = getDatabasesExtension();
+	if (!databases)
+	{
+		return false;
+	}
+	DatabaseSettings settings;
+	settings.journalMode = journalMode;
+	settings.synchronous = synchronous;
+	settings.cacheSize = cacheSize;
+	settings.mmapSize = mmapSize;
+	settings.groupCommit = groupCommit;
+	settings.checkpointInterval = Milliseconds(checkpointInterval);
+	return databases->configure(db, settings);
+}
+
+static IDatabaseStatement* getStatement(int id)
+{
+	IDatabasesExtension* databases = getDatabasesExtension();
+	return databases ? databases->getStatement(id) : nullptr;
+}
+
+SCRIPT_API(db_prepare, int(IDatabaseConnection& db, AmxStringView sql))
+{
+	IDatabasesExtension* databases = getDatabasesExtension();
+	IDatabaseStatement* statement = databases ? databases->prepare(db, sql) : nullptr;
+	return statement ? statement->getID() : 0;
+}
+
+SCRIPT_API(db_stmt_close, bool(int stmt))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	return statement && getDatabasesExtension()->freeStatement(*statement);
+}
+
+SCRIPT_API(db_stmt_bind_int, bool(int stmt, int param, int value))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	return statement && statement->bindInt(param, value);
+}
+
+SCRIPT_API(db_stmt_bind_float, bool(int stmt, int param, float value))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	return statement && statement->bindFloat(param, value);
+}
+
+SCRIPT_API(db_stmt_bind_text, bool(int stmt, int param, AmxStringView value))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	return statement && statement->bindText(param, value);
+}
+
+/// Whether `cells` cells from `data` are all script memory.  Only the first cell of an array
+/// parameter is checked when it is passed in, so this stops a script reading past its heap, or its
+/// stack, with a size it made up.
+static bool isScriptBuffer(AMX* amx, cell const* data, int cells)
+{
+	const AMX_HEADER* hdr = reinterpret_cast<const AMX_HEADER*>(amx->base);
+	const unsigned char* base = amx->data ? amx->data : amx->base + hdr->dat;
+	const intptr_t addr = reinterpret_cast<const unsigned char*>(data) - base;
+	const intptr_t end = addr + intptr_t(cells) * intptr_t(sizeof(cell));
+	// Either all in the data and heap, below `hea`, or all in the stack, between `stk` and `stp`.
+	return cells >= 0 && addr >= 0 && (end <= amx->hea || (addr >= amx->stk && end <= amx->stp));
+}
+
+SCRIPT_API(db_stmt_bind_blob, bool(int stmt, int param, cell const* data, int cells))
+{
+	// The cells are stored as they are, so the script reads back exactly what it wrote.
+	IDatabaseStatement* statement = getStatement(stmt);
+	return statement && isScriptBuffer(GetAMX(), data, cells) && statement->bindBlob(param, Span<const char>(reinterpret_cast<const char*>(data), cells * sizeof(cell)));
+}
+
+SCRIPT_API(db_stmt_bind_null, bool(int stmt, int param))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	return statement && statement->bindNull(param);
+}
+
+SCRIPT_API(db_stmt_step, int(int stmt))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	return statement ? statement->step() : -1;
+}
+
+SCRIPT_API(db_stmt_reset, bool(int stmt))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	return statement && statement->reset();
+}
+
+SCRIPT_API(db_stmt_execute, int(int stmt))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	IDatabaseResultSet* database_result_set(statement ? statement->execute() : nullptr);
+	return database_result_set ? database_result_set->getID() : 0;
+}
+
+SCRIPT_API(db_stmt_num_columns, int(int stmt))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	return statement ? statement->getColumnCount() : 0;
+}
+
+SCRIPT_API(db_stmt_column_name, bool(int stmt, int column, OutputOnlyString& output))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	if (statement && column >= 0 && column < statement->getColumnCount())
+	{
+		output = statement->getColumnName(column);
+		return true;
+	}
+	return false;
+}
+
+SCRIPT_API(db_stmt_column_int, int(int stmt, int column))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	return statement && column >= 0 && column < statement->getColumnCount() ? static_cast<int>(statement->getColumnInt(column)) : 0;
+}
+
+SCRIPT_API(db_stmt_column_float, float(int stmt, int column))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	return statement && column >= 0 && column < statement->getColumnCount() ? static_cast<float>(statement->getColumnFloat(column)) : 0.0f;
+}
+
+SCRIPT_API(db_stmt_column_text, bool(int stmt, int column, OutputOnlyString& output))
+{
+	IDatabaseStatement* statement = getStatement(stmt);
+	if (statement && column >= 0 && column < statement->getColumnCount())
+	{
+		output = statement->getColumnText(column);
+		return true;
+	}
+	return false;
+}
+
 SCRIPT_API(db_free_result, bool(IDatabaseResultSet& result))
 {
+	PawnQueryImpl::Get()->forgetCursor(result.getID());
 	return PawnManager::Get()->databases->freeResultSet(result);
 }
 
@@ -155,7 +316,7 @@ SCRIPT_API(db_get_field, bool(IDatabaseResultSet& result, int field, OutputOnlyS
 	return false;
 }
 
-SCRIPT_API(db_get_field_assoc, bool(IDatabaseResultSet& result, const std::string& field, OutputOnlyString& output))
+SCRIPT_API(db_get_field_assoc, bool(IDatabaseResultSet& result, AmxStringView field, OutputOnlyString& output))
 {
 	if (result.isFieldNameAvailable(field))
 	{
@@ -170,7 +331,7 @@ SCRIPT_API(db_get_field_int, int(IDatabaseResultSet& result, int field))
 	return ((field >= 0) && (field < result.getFieldCount())) ? static_cast<int>(result.getFieldInt(static_cast<std::size_t>(field))) : 0;
 }
 
-SCRIPT_API(db_get_field_assoc_int, int(IDatabaseResultSet& result, const std::string& field))
+SCRIPT_API(db_get_field_assoc_int, int(IDatabaseResultSet& result, AmxStringView field))
 {
 	return result.isFieldNameAvailable(field) ? static_cast<int>(result.getFieldIntByName(field)) : 0;
 }
@@ -180,7 +341,7 @@ SCRIPT_API(db_get_field_float, float(IDatabaseResultSet& result, int field))
 	return ((field >= 0) && (field < result.getFieldCount())) ? static_cast<float>(result.getFieldFloat(static_cast<std::size_t>(field))) : 0.0f;
 }
 
-SCRIPT_API(db_get_field_assoc_float, float(IDatabaseResultSet& result, const std::string& field))
+SCRIPT_API(db_get_field_assoc_float, float(IDatabaseResultSet& result, AmxStringView field))
 {
 	return result.isFieldNameAvailable(field) ? static_cast<float>(result.getFieldFloatByName(field)) : 0.0f;
 }
@@ -219,7 +380,9 @@ SCRIPT_API(DB_Open, int(const std::string& name))
 
 SCRIPT_API(DB_Close, bool(IDatabaseConnection& db))
 {
-	return PawnManager::Get()->databases->close(db);
+	bool ret = PawnManager::Get()->databases->close(db);
+	PawnQueryImpl::Get()->forgetClosedCursors();
+	return ret;
 }
 
 SCRIPT_API(DB_ExecuteQuery, int(IDatabaseConnection& db, cell const* format))
@@ -231,6 +394,7 @@ SCRIPT_API(DB_ExecuteQuery, int(IDatabaseConnection& db, cell const* format))
 
 SCRIPT_API(DB_FreeResultSet, bool(IDatabaseResultSet& result))
 {
+	PawnQueryImpl::Get()->forgetCursor(result.getID());
 	return PawnManager::Get()->databases->freeResultSet(result);
 }
 
@@ -269,7 +433,7 @@ SCRIPT_API(DB_GetFieldString, bool(IDatabaseResultSet& result, int field, Output
 	return false;
 }
 
-SCRIPT_API(DB_GetFieldStringByName, bool(IDatabaseResultSet& result, const std::string& field, OutputOnlyString& output))
+SCRIPT_API(DB_GetFieldStringByName, bool(IDatabaseResultSet& result, AmxStringView field, OutputOnlyString& output))
 {
 	if (result.isFieldNameAvailable(field))
 	{
@@ -284,7 +448,7 @@ SCRIPT_API(DB_GetFieldInt, int(IDatabaseResultSet& result, int field))
 	return ((field >= 0) && (field < result.getFieldCount())) ? static_cast<int>(result.getFieldInt(static_cast<std::size_t>(field))) : 0;
 }
 
-SCRIPT_API(DB_GetFieldIntByName, int(IDatabaseResultSet& result, const std::string& field))
+SCRIPT_API(DB_GetFieldIntByName, int(IDatabaseResultSet& result, AmxStringView field))
 {
 	return result.isFieldNameAvailable(field) ? static_cast<int>(result.getFieldIntByName(field)) : 0;
 }
@@ -294,7 +458,7 @@ SCRIPT_API(DB_GetFieldFloat, float(IDatabaseResultSet& result, int field))
 	return ((field >= 0) && (field < result.getFieldCount())) ? static_cast<float>(result.getFieldFloat(static_cast<std::size_t>(field))) : 0.0f;
 }
 
-SCRIPT_API(DB_GetFieldFloatByName, float(IDatabaseResultSet& result, const std::string& field))
+SCRIPT_API(DB_GetFieldFloatByName, float(IDatabaseResultSet& result, AmxStringView field))
 {
 	return result.isFieldNameAvailable(field) ? static_cast<float>(result.getFieldFloatByName(field)) : 0.0f;
 }
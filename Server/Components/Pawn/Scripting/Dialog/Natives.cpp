@@ -12,7 +12,7 @@
 #include "../../format.hpp"
 #include <iostream>
 
-SCRIPT_API(ShowPlayerDialog, bool(IPlayer& player, int dialog, int style, const std::string& title, cell const* format, const std::string& button1, const std::string& button2))
+SCRIPT_API(ShowPlayerDialog, bool(IPlayer& player, int dialog, int style, AmxStringView title, cell const* format, AmxStringView button1, AmxStringView button2))
 {
 	IPlayerDialogData* data = queryExtension<IPlayerDialogData>(player);
 
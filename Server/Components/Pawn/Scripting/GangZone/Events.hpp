@@ -18,11 +18,11 @@ struct GangZoneEvents : public GangZoneEventHandler, public Singleton<GangZoneEv
 		auto pawn = PawnManager::Get();
 		if (zone.getLegacyPlayer() == nullptr)
 		{
-			pawn->CallAllInEntryFirst("OnPlayerEnterGangZone", DefaultReturnValue_True, player.getID(), pawn->gangzones->toLegacyID(zone.getID()));
+			pawn->CallAllInEntryFirst(PawnCallback_OnPlayerEnterGangZone, DefaultReturnValue_True, player.getID(), pawn->gangzones->toLegacyID(zone.getID()));
 		}
 		else if (auto data = queryExtension<IPlayerGangZoneData>(player))
 		{
-			pawn->CallAllInEntryFirst("OnPlayerEnterPlayerGangZone", DefaultReturnValue_True, player.getID(), data->toLegacyID(zone.getID()));
+			pawn->CallAllInEntryFirst(PawnCallback_OnPlayerEnterPlayerGangZone, DefaultReturnValue_True, player.getID(), data->toLegacyID(zone.getID()));
 		}
 	}
 
@@ -31,11 +31,11 @@ struct GangZoneEvents : public GangZoneEventHandler, public Singleton<GangZoneEv
 		auto pawn = PawnManager::Get();
 		if (zone.getLegacyPlayer() == nullptr)
 		{
-			pawn->CallAllInEntryFirst("OnPlayerLeaveGangZone", DefaultReturnValue_True, player.getID(), pawn->gangzones->toLegacyID(zone.getID()));
+			pawn->CallAllInEntryFirst(PawnCallback_OnPlayerLeaveGangZone, DefaultReturnValue_True, player.getID(), pawn->gangzones->toLegacyID(zone.getID()));
 		}
 		else if (auto data = queryExtension<IPlayerGangZoneData>(player))
 		{
-			pawn->CallAllInEntryFirst("OnPlayerLeavePlayerGangZone", DefaultReturnValue_True, player.getID(), data->toLegacyID(zone.getID()));
+			pawn->CallAllInEntryFirst(PawnCallback_OnPlayerLeavePlayerGangZone, DefaultReturnValue_True, player.getID(), data->toLegacyID(zone.getID()));
 		}
 	}
 
@@ -44,11 +44,11 @@ struct GangZoneEvents : public GangZoneEventHandler, public Singleton<GangZoneEv
 		auto pawn = PawnManager::Get();
 		if (zone.getLegacyPlayer() == nullptr)
 		{
-			pawn->CallAllInEntryFirst("OnPlayerClickGangZone", DefaultReturnValue_True, player.getID(), pawn->gangzones->toLegacyID(zone.getID()));
+			pawn->CallAllInEntryFirst(PawnCallback_OnPlayerClickGangZone, DefaultReturnValue_True, player.getID(), pawn->gangzones->toLegacyID(zone.getID()));
 		}
 		else if (auto data = queryExtension<IPlayerGangZoneData>(player))
 		{
-			pawn->CallAllInEntryFirst("OnPlayerClickPlayerGangZone", DefaultReturnValue_True, player.getID(), data->toLegacyID(zone.getID()));
+			pawn->CallAllInEntryFirst(PawnCallback_OnPlayerClickPlayerGangZone, DefaultReturnValue_True, player.getID(), data->toLegacyID(zone.getID()));
 		}
 	}
 };
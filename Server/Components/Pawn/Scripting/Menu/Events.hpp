@@ -15,11 +15,11 @@ struct MenuEvents : public MenuEventHandler, public Singleton<MenuEvents>
 {
 	void onPlayerSelectedMenuRow(IPlayer& player, MenuRow row) override
 	{
-		PawnManager::Get()->CallAllInEntryFirst("OnPlayerSelectedMenuRow", DefaultReturnValue_True, player.getID(), int(row));
+		PawnManager::Get()->CallAllInEntryFirst(PawnCallback_OnPlayerSelectedMenuRow, DefaultReturnValue_True, player.getID(), int(row));
 	}
 
 	void onPlayerExitedMenu(IPlayer& player) override
 	{
-		PawnManager::Get()->CallAllInEntryFirst("OnPlayerExitedMenu", DefaultReturnValue_True, player.getID());
+		PawnManager::Get()->CallAllInEntryFirst(PawnCallback_OnPlayerExitedMenu, DefaultReturnValue_True, player.getID());
 	}
 };
@@ -15,25 +15,25 @@ struct ObjectEvents : public ObjectEventHandler, public Singleton<ObjectEvents>
 {
 	void onMoved(IObject& object) override
 	{
-		PawnManager::Get()->CallAllInSidesFirst("OnObjectMoved", DefaultReturnValue_True, object.getID());
+		PawnManager::Get()->CallAllInSidesFirst(PawnCallback_OnObjectMoved, DefaultReturnValue_True, object.getID());
 	}
 
 	void onPlayerObjectMoved(IPlayer& player, IPlayerObject& object) override
 	{
-		PawnManager::Get()->CallAllInSidesFirst("OnPlayerObjectMoved", DefaultReturnValue_True, player.getID(), object.getID());
+		PawnManager::Get()->CallAllInSidesFirst(PawnCallback_OnPlayerObjectMoved, DefaultReturnValue_True, player.getID(), object.getID());
 	}
 
 	void onObjectEdited(IPlayer& player, IObject& object, ObjectEditResponse response, Vector3 offset, Vector3 rotation) override
 	{
 		cell ret = PawnManager::Get()->CallInSidesWhile0(
-			"OnPlayerEditObject",
+			PawnCallback_OnPlayerEditObject,
 			player.getID(), 0, object.getID(), int(response),
 			offset.x, offset.y, offset.z,
 			rotation.x, rotation.y, rotation.z);
 		if (!ret)
 		{
 			PawnManager::Get()->CallInEntry(
-				"OnPlayerEditObject",
+				PawnCallback_OnPlayerEditObject,
 				DefaultReturnValue_True,
 				player.getID(), 0, object.getID(), int(response),
 				offset.x, offset.y, offset.z,
@@ -44,14 +44,14 @@ struct ObjectEvents : public ObjectEventHandler, public Singleton<ObjectEvents>
 	void onPlayerObjectEdited(IPlayer& player, IPlayerObject& object, ObjectEditResponse response, Vector3 offset, Vector3 rotation) override
 	{
 		cell ret = PawnManager::Get()->CallInSidesWhile0(
-			"OnPlayerEditObject",
+			PawnCallback_OnPlayerEditObject,
 			player.getID(), 1, object.getID(), int(response),
 			offset.x, offset.y, offset.z,
 			rotation.x, rotation.y, rotation.z);
 		if (!ret)
 		{
 			PawnManager::Get()->CallInEntry(
-				"OnPlayerEditObject",
+				PawnCallback_OnPlayerEditObject,
 				DefaultReturnValue_True,
 				player.getID(), 1, object.getID(), int(response),
 				offset.x, offset.y, offset.z,
@@ -62,7 +62,7 @@ struct ObjectEvents : public ObjectEventHandler, public Singleton<ObjectEvents>
 	void onPlayerAttachedObjectEdited(IPlayer& player, int index, bool saved, const ObjectAttachmentSlotData& data) override
 	{
 		cell ret = PawnManager::Get()->CallInSidesWhile0(
-			"OnPlayerEditAttachedObject",
+			PawnCallback_OnPlayerEditAttachedObject,
 			player.getID(), saved, index, data.model, data.bone,
 			data.offset.x, data.offset.y, data.offset.z,
 			data.rotation.x, data.rotation.y, data.rotation.z,
@@ -70,7 +70,7 @@ struct ObjectEvents : public ObjectEventHandler, public Singleton<ObjectEvents>
 		if (!ret)
 		{
 			PawnManager::Get()->CallInEntry(
-				"OnPlayerEditAttachedObject",
+				PawnCallback_OnPlayerEditAttachedObject,
 				DefaultReturnValue_True,
 				player.getID(), saved, index, data.model, data.bone,
 				data.offset.x, data.offset.y, data.offset.z,
@@ -82,13 +82,13 @@ struct ObjectEvents : public ObjectEventHandler, public Singleton<ObjectEvents>
 	void onObjectSelected(IPlayer& player, IObject& object, int model, Vector3 position) override
 	{
 		cell ret = PawnManager::Get()->CallInSidesWhile0(
-			"OnPlayerSelectObject",
+			PawnCallback_OnPlayerSelectObject,
 			player.getID(), 1, object.getID(), model,
 			position.x, position.y, position.z);
 		if (!ret)
 		{
 			PawnManager::Get()->CallInEntry(
-				"OnPlayerSelectObject",
+				PawnCallback_OnPlayerSelectObject,
 				DefaultReturnValue_True,
 				player.getID(), 1, object.getID(), model,
 				position.x, position.y, position.z);
@@ -98,13 +98,13 @@ struct ObjectEvents : public ObjectEventHandler, public Singleton<ObjectEvents>
 	void onPlayerObjectSelected(IPlayer& player, IPlayerObject& object, int model, Vector3 position) override
 	{
 		cell ret = PawnManager::Get()->CallInSidesWhile0(
-			"OnPlayerSelectObject",
+			PawnCallback_OnPlayerSelectObject,
 			player.getID(), 2, object.getID(), model,
 			position.x, position.y, position.z);
 		if (!ret)
 		{
 			PawnManager::Get()->CallInEntry(
-				"OnPlayerSelectObject",
+				PawnCallback_OnPlayerSelectObject,
 				DefaultReturnValue_True,
 				player.getID(), 2, object.getID(), model,
 				position.x, position.y, position.z);
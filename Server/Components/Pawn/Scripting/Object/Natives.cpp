@@ -170,13 +170,13 @@ SCRIPT_API(EndObjectEditing, bool(IPlayerObjectData& data))
 	return true;
 }
 
-SCRIPT_API(SetObjectMaterial, bool(IObject& object, int materialIndex, int modelId, const std::string& textureLibrary, const std::string& textureName, uint32_t materialColour))
+SCRIPT_API(SetObjectMaterial, bool(IObject& object, int materialIndex, int modelId, AmxStringView textureLibrary, AmxStringView textureName, uint32_t materialColour))
 {
 	object.setMaterial(materialIndex, modelId, textureLibrary, textureName, Colour::FromARGB(materialColour));
 	return true;
 }
 
-SCRIPT_API(SetObjectMaterialText, bool(IObject& object, cell const* format, int materialIndex, int materialSize, const std::string& fontface, int fontsize, bool bold, uint32_t fontColour, uint32_t backgroundColour, int textalignment))
+SCRIPT_API(SetObjectMaterialText, bool(IObject& object, cell const* format, int materialIndex, int materialSize, AmxStringView fontface, int fontsize, bool bold, uint32_t fontColour, uint32_t backgroundColour, int textalignment))
 {
 	AmxStringFormatter text(format, GetAMX(), GetParams(), 10);
 	object.setMaterialText(materialIndex, text, ObjectMaterialSize(materialSize), fontface, fontsize, bold, Colour::FromARGB(fontColour), Colour::FromARGB(backgroundColour), ObjectMaterialTextAlign(textalignment));
@@ -16,69 +16,80 @@ class PlayerEvents : public PlayerSpawnEventHandler, public PlayerConnectEventHa
 public:
 	void onPlayerConnect(IPlayer& player) override
 	{
-		PawnManager::Get()->CallInSidesWhile1("OnPlayerConnect", player.getID());
-		PawnManager::Get()->CallInEntry("OnPlayerConnect", DefaultReturnValue_True, player.getID());
+		PawnManager::Get()->CallInSidesWhile1(PawnCallback_OnPlayerConnect, player.getID());
+		PawnManager::Get()->CallInEntry(PawnCallback_OnPlayerConnect, DefaultReturnValue_True, player.getID());
 	}
 
 	void onPlayerSpawn(IPlayer& player) override
 	{
-		PawnManager::Get()->CallInSidesWhile1("OnPlayerSpawn", player.getID());
-		PawnManager::Get()->CallInEntry("OnPlayerSpawn", DefaultReturnValue_True, player.getID());
+		PawnManager::Get()->CallInSidesWhile1(PawnCallback_OnPlayerSpawn, player.getID());
+		PawnManager::Get()->CallInEntry(PawnCallback_OnPlayerSpawn, DefaultReturnValue_True, player.getID());
 	}
 
 	bool onPlayerCommandText(IPlayer& player, StringView cmdtext) override
 	{
-		cell ret = PawnManager::Get()->CallInSidesWhile0("OnPlayerCommandText", player.getID(), cmdtext);
+		cell ret = PawnManager::Get()->CallInSidesWhile0(PawnCallback_OnPlayerCommandText, player.getID(), cmdtext);
 		if (!ret)
 		{
-			ret = PawnManager::Get()->CallInEntry("OnPlayerCommandText", DefaultReturnValue_False, player.getID(), cmdtext);
+			ret = PawnManager::Get()->CallInEntry(PawnCallback_OnPlayerCommandText, DefaultReturnValue_False, player.getID(), cmdtext);
 		}
 		return !!ret;
 	}
 
 	void onPlayerKeyStateChange(IPlayer& player, uint32_t newKeys, uint32_t oldKeys) override
 	{
-		PawnManager::Get()->CallAllInEntryFirst("OnPlayerKeyStateChange", DefaultReturnValue_True, player.getID(), newKeys, oldKeys);
+		PawnManager::Get()->CallAllInEntryFirst(PawnCallback_OnPlayerKeyStateChange, DefaultReturnValue_True, player.getID(), newKeys, oldKeys);
 	}
 
 	void onIncomingConnection(IPlayer& player, StringView ipAddress, unsigned short port) override
 	{
-		PawnManager::Get()->CallInSidesWhile0("OnIncomingConnection", player.getID(), ipAddress, port);
-		PawnManager::Get()->CallInEntry("OnIncomingConnection", DefaultReturnValue_True, player.getID(), ipAddress, port);
+		PawnManager::Get()->CallInSidesWhile0(PawnCallback_OnIncomingConnection, player.getID(), ipAddress, port);
+		PawnManager::Get()->CallInEntry(PawnCallback_OnIncomingConnection, DefaultReturnValue_True, player.getID(), ipAddress, port);
 	}
 
 	void onPlayerDisconnect(IPlayer& player, PeerDisconnectReason reason) override
 	{
-		PawnManager::Get()->CallInSidesWhile1("OnPlayerDisconnect", player.getID(), int(reason));
-		PawnManager::Get()->CallInEntry("OnPlayerDisconnect", DefaultReturnValue_True, player.getID(), int(reason));
+		PawnManager* mgr = PawnManager::Get();
+		const int playerid = player.getID();
+		mgr->CallInSidesWhile1(PawnCallback_OnPlayerDisconnect, playerid, int(reason));
+		mgr->CallInEntry(PawnCallback_OnPlayerDisconnect, DefaultReturnValue_True, playerid, int(reason));
+
+		for (IPawnScript* cur : mgr->scripts_)
+		{
+			static_cast<PawnScript*>(cur)->resetPlayerUpdate(playerid);
+		}
+		if (mgr->mainScript_)
+		{
+			mgr->mainScript_->resetPlayerUpdate(playerid);
+		}
 	}
 
 	bool onPlayerRequestSpawn(IPlayer& player) override
 	{
-		cell ret = PawnManager::Get()->CallInSidesWhile1("OnPlayerRequestSpawn", player.getID());
+		cell ret = PawnManager::Get()->CallInSidesWhile1(PawnCallback_OnPlayerRequestSpawn, player.getID());
 		if (ret)
 		{
-			ret = PawnManager::Get()->CallInEntry("OnPlayerRequestSpawn", DefaultReturnValue_True, player.getID());
+			ret = PawnManager::Get()->CallInEntry(PawnCallback_OnPlayerRequestSpawn, DefaultReturnValue_True, player.getID());
 		}
 		return !!ret;
 	}
 
 	void onPlayerStreamIn(IPlayer& player, IPlayer& forPlayer) override
 	{
-		PawnManager::Get()->CallAllInSidesFirst("OnPlayerStreamIn", DefaultReturnValue_True, player.getID(), forPlayer.getID());
+		PawnManager::Get()->CallAllInSidesFirst(PawnCallback_OnPlayerStreamIn, DefaultReturnValue_True, player.getID(), forPlayer.getID());
 	}
 
 	void onPlayerStreamOut(IPlayer& player, IPlayer& forPlayer) override
 	{
-		PawnManager::Get()->CallAllInSidesFirst("OnPlayerStreamOut", DefaultReturnValue_True, player.getID(), forPlayer.getID());
+		PawnManager::Get()->CallAllInSidesFirst(PawnCallback_OnPlayerStreamOut, DefaultReturnValue_True, player.getID(), forPlayer.getID());
 	}
 
 	bool onPlayerText(IPlayer& player, StringView message) override
 	{
-		cell ret = PawnManager::Get()->CallInSidesWhile1("OnPlayerText", player.getID(), message);
+		cell ret = PawnManager::Get()->CallInSidesWhile1(PawnCallback_OnPlayerText, player.getID(), message);
 		if (ret)
 		{
-			ret = PawnManager::Get()->CallInEntry("OnPlayerText", DefaultReturnValue_True, player.getID(), message);
+			ret = PawnManager::Get()->CallInEntry(PawnCallback_OnPlayerText, DefaultReturnValue_True, player.getID(), message);
 		}
 		return !!ret;
 	}
@@ -86,14 +97,14 @@ public:
 	bool onPlayerShotMissed(IPlayer& player, const PlayerBulletData& bulletData) override
 	{
 		cell ret = PawnManager::Get()->CallInSidesWhile1(
-			"OnPlayerWeaponShot",
+			PawnCallback_OnPlayerWeaponShot,
 			player.getID(),
 			bulletData.weapon, int(bulletData.hitType), bulletData.hitID,
 			bulletData.offset.x, bulletData.offset.y, bulletData.offset.z);
 		if (ret)
 		{
 			ret = PawnManager::Get()->CallInEntry(
-				"OnPlayerWeaponShot",
+				PawnCallback_OnPlayerWeaponShot,
 				DefaultReturnValue_True,
 				player.getID(),
 				bulletData.weapon, int(bulletData.hitType), bulletData.hitID,
@@ -105,14 +116,14 @@ public:
 	bool onPlayerShotPlayer(IPlayer& player, IPlayer& target, const PlayerBulletData& bulletData) override
 	{
 		cell ret = PawnManager::Get()->CallInSidesWhile1(
-			"OnPlayerWeaponShot",
+			PawnCallback_OnPlayerWeaponShot,
 			player.getID(),
 			bulletData.weapon, int(bulletData.hitType), bulletData.hitID,
 			bulletData.offset.x, bulletData.offset.y, bulletData.offset.z);
 		if (ret)
 		{
 			ret = PawnManager::Get()->CallInEntry(
-				"OnPlayerWeaponShot",
+				PawnCallback_OnPlayerWeaponShot,
 				DefaultReturnValue_True,
 				player.getID(),
 				bulletData.weapon, int(bulletData.hitType), bulletData.hitID,
@@ -124,14 +135,14 @@ public:
 	bool onPlayerShotVehicle(IPlayer& player, IVehicle& target, const PlayerBulletData& bulletData) override
 	{
 		cell ret = PawnManager::Get()->CallInSidesWhile1(
-			"OnPlayerWeaponShot",
+			PawnCallback_OnPlayerWeaponShot,
 			player.getID(),
 			bulletData.weapon, int(bulletData.hitType), bulletData.hitID,
 			bulletData.offset.x, bulletData.offset.y, bulletData.offset.z);
 		if (ret)
 		{
 			ret = PawnManager::Get()->CallInEntry(
-				"OnPlayerWeaponShot",
+				PawnCallback_OnPlayerWeaponShot,
 				DefaultReturnValue_True,
 				player.getID(),
 				bulletData.weapon, int(bulletData.hitType), bulletData.hitID,
@@ -143,14 +154,14 @@ public:
 	bool onPlayerShotObject(IPlayer& player, IObject& target, const PlayerBulletData& bulletData) override
 	{
 		cell ret = PawnManager::Get()->CallInSidesWhile1(
-			"OnPlayerWeaponShot",
+			PawnCallback_OnPlayerWeaponShot,
 			player.getID(),
 			bulletData.weapon, int(bulletData.hitType), bulletData.hitID,
 			bulletData.offset.x, bulletData.offset.y, bulletData.offset.z);
 		if (ret)
 		{
 			ret = PawnManager::Get()->CallInEntry(
-				"OnPlayerWeaponShot",
+				PawnCallback_OnPlayerWeaponShot,
 				DefaultReturnValue_True,
 				player.getID(),
 				bulletData.weapon, int(bulletData.hitType), bulletData.hitID,
@@ -162,14 +173,14 @@ public:
 	bool onPlayerShotPlayerObject(IPlayer& player, IPlayerObject& target, const PlayerBulletData& bulletData) override
 	{
 		cell ret = PawnManager::Get()->CallInSidesWhile1(
-			"OnPlayerWeaponShot",
+			PawnCallback_OnPlayerWeaponShot,
 			player.getID(),
 			bulletData.weapon, int(bulletData.hitType), bulletData.hitID,
 			bulletData.offset.x, bulletData.offset.y, bulletData.offset.z);
 		if (ret)
 		{
 			ret = PawnManager::Get()->CallInEntry(
-				"OnPlayerWeaponShot",
+				PawnCallback_OnPlayerWeaponShot,
 				DefaultReturnValue_True,
 				player.getID(),
 				bulletData.weapon, int(bulletData.hitType), bulletData.hitID,
@@ -180,56 +191,72 @@ public:
 
 	void onPlayerDeath(IPlayer& player, IPlayer* killer, int reason) override
 	{
-		PawnManager::Get()->CallInSidesWhile1("OnPlayerDeath", player.getID(), killer ? killer->getID() : INVALID_PLAYER_ID, reason);
-		PawnManager::Get()->CallInEntry("OnPlayerDeath", DefaultReturnValue_True, player.getID(), killer ? killer->getID() : INVALID_PLAYER_ID, reason);
+		PawnManager::Get()->CallInSidesWhile1(PawnCallback_OnPlayerDeath, player.getID(), killer ? killer->getID() : INVALID_PLAYER_ID, reason);
+		PawnManager::Get()->CallInEntry(PawnCallback_OnPlayerDeath, DefaultReturnValue_True, player.getID(), killer ? killer->getID() : INVALID_PLAYER_ID, reason);
 	}
 
 	void onPlayerTakeDamage(IPlayer& player, IPlayer* from, float amount, unsigned weapon, BodyPart part) override
 	{
-		PawnManager::Get()->CallInSidesWhile0("OnPlayerTakeDamage", player.getID(), from ? from->getID() : INVALID_PLAYER_ID, amount, weapon, int(part));
-		PawnManager::Get()->CallInEntry("OnPlayerTakeDamage", DefaultReturnValue_True, player.getID(), from ? from->getID() : INVALID_PLAYER_ID, amount, weapon, int(part));
+		PawnManager::Get()->CallInSidesWhile0(PawnCallback_OnPlayerTakeDamage, player.getID(), from ? from->getID() : INVALID_PLAYER_ID, amount, weapon, int(part));
+		PawnManager::Get()->CallInEntry(PawnCallback_OnPlayerTakeDamage, DefaultReturnValue_True, player.getID(), from ? from->getID() : INVALID_PLAYER_ID, amount, weapon, int(part));
 	}
 
 	void onPlayerGiveDamage(IPlayer& player, IPlayer& to, float amount, unsigned weapon, BodyPart part) override
 	{
-		PawnManager::Get()->CallInSidesWhile0("OnPlayerGiveDamage", player.getID(), to.getID(), amount, weapon, int(part));
-		PawnManager::Get()->CallInEntry("OnPlayerGiveDamage", DefaultReturnValue_True, player.getID(), to.getID(), amount, weapon, int(part));
+		PawnManager::Get()->CallInSidesWhile0(PawnCallback_OnPlayerGiveDamage, player.getID(), to.getID(), amount, weapon, int(part));
+		PawnManager::Get()->CallInEntry(PawnCallback_OnPlayerGiveDamage, DefaultReturnValue_True, player.getID(), to.getID(), amount, weapon, int(part));
 	}
 
 	void onPlayerInteriorChange(IPlayer& player, unsigned newInterior, unsigned oldInterior) override
 	{
-		PawnManager::Get()->CallAllInEntryFirst("OnPlayerInteriorChange", DefaultReturnValue_True, player.getID(), newInterior, oldInterior);
+		PawnManager::Get()->CallAllInEntryFirst(PawnCallback_OnPlayerInteriorChange, DefaultReturnValue_True, player.getID(), newInterior, oldInterior);
 	}
 
 	void onPlayerStateChange(IPlayer& player, PlayerState newState, PlayerState oldState) override
 	{
-		PawnManager::Get()->CallAllInSidesFirst("OnPlayerStateChange", DefaultReturnValue_True, player.getID(), int(newState), int(oldState));
+		PawnManager::Get()->CallAllInSidesFirst(PawnCallback_OnPlayerStateChange, DefaultReturnValue_True, player.getID(), int(newState), int(oldState));
 	}
 
 	void onPlayerClickMap(IPlayer& player, Vector3 pos) override
 	{
-		PawnManager::Get()->CallInEntry("OnPlayerClickMap", DefaultReturnValue_True, player.getID(), pos.x, pos.y, pos.z);
-		PawnManager::Get()->CallInSidesWhile0("OnPlayerClickMap", player.getID(), pos.x, pos.y, pos.z);
+		PawnManager::Get()->CallInEntry(PawnCallback_OnPlayerClickMap, DefaultReturnValue_True, player.getID(), pos.x, pos.y, pos.z);
+		PawnManager::Get()->CallInSidesWhile0(PawnCallback_OnPlayerClickMap, player.getID(), pos.x, pos.y, pos.z);
 	}
 
 	void onPlayerClickPlayer(IPlayer& player, IPlayer& clicked, PlayerClickSource source) override
 	{
-		PawnManager::Get()->CallInSidesWhile0("OnPlayerClickPlayer", player.getID(), clicked.getID(), int(source));
-		PawnManager::Get()->CallInEntry("OnPlayerClickPlayer", DefaultReturnValue_True, player.getID(), clicked.getID(), int(source));
+		PawnManager::Get()->CallInSidesWhile0(PawnCallback_OnPlayerClickPlayer, player.getID(), clicked.getID(), int(source));
+		PawnManager::Get()->CallInEntry(PawnCallback_OnPlayerClickPlayer, DefaultReturnValue_True, player.getID(), clicked.getID(), int(source));
 	}
 
 	void onClientCheckResponse(IPlayer& player, int actionType, int address, int results) override
 	{
-		PawnManager::Get()->CallAllInSidesFirst("OnClientCheckResponse", DefaultReturnValue_True, player.getID(), actionType, address, results);
+		PawnManager::Get()->CallAllInSidesFirst(PawnCallback_OnClientCheckResponse, DefaultReturnValue_True, player.getID(), actionType, address, results);
 	}
 
 	bool onPlayerUpdate(IPlayer& player, TimePoint now) override
 	{
-		cell ret = PawnManager::Get()->CallInSidesWhile1("OnPlayerUpdate", player.getID());
-		if (ret)
+		PawnManager* mgr = PawnManager::Get();
+		if (!mgr->isCallbackUsed(PawnCallback_OnPlayerUpdate))
 		{
-			ret = PawnManager::Get()->CallInEntry("OnPlayerUpdate", DefaultReturnValue_True, player.getID());
+			return true;
 		}
-		return !!ret;
+
+		// Same order as `CallInSidesWhile1` then `CallInEntry`, but scripts that asked for fewer
+		// updates skip the ones in between and count as having returned 1.
+		const int playerid = player.getID();
+		for (IPawnScript* cur : mgr->scripts_)
+		{
+			PawnScript* script = static_cast<PawnScript*>(cur);
+			if (script->wantsPlayerUpdate(playerid, now) && !PawnManager::CallIn(script, PawnCallback_OnPlayerUpdate, DefaultReturnValue_True, playerid))
+			{
+				return false;
+			}
+		}
+		if (mgr->mainScript_ && mgr->mainScript_->wantsPlayerUpdate(playerid, now))
+		{
+			return !!PawnManager::CallIn(mgr->mainScript_, PawnCallback_OnPlayerUpdate, DefaultReturnValue_True, playerid);
+		}
+		return true;
 	}
 };
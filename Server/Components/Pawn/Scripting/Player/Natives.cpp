@@ -588,7 +588,7 @@ SCRIPT_API(TogglePlayerSpectating, bool(IPlayer& player, bool enable))
 	return true;
 }
 
-SCRIPT_API(ApplyAnimation, bool(IPlayer& player, const std::string& animlib, const std::string& animname, float delta, bool loop, bool lockX, bool lockY, bool freeze, uint32_t time, int sync))
+SCRIPT_API(ApplyAnimation, bool(IPlayer& player, AmxStringView animlib, AmxStringView animname, float delta, bool loop, bool lockX, bool lockY, bool freeze, uint32_t time, int sync))
 {
 	const AnimationData animationData(delta, loop, lockX, lockY, freeze, time, animlib, animname);
 	player.applyAnimation(animationData, PlayerAnimationSyncType(sync));
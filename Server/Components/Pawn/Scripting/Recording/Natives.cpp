@@ -8,6 +8,13 @@
 
 #include "../Types.hpp"
 #include "Server/Components/Recordings/recordings.hpp"
+#include <recordings_ext.hpp>
+
+static IRecordingsExtension* getRecordingsExtension()
+{
+	IRecordingsComponent* recordings = PawnManager::Get()->recordings;
+	return recordings ? queryExtension<IRecordingsExtension>(recordings) : nullptr;
+}
 
 SCRIPT_API(StartRecordingPlayerData, bool(IPlayer& player, int type, std::string const& file))
 {
@@ -30,3 +37,34 @@ SCRIPT_API(StopRecordingPlayerData, bool(IPlayer& player))
 	}
 	return false;
 }
+
+SCRIPT_API(ConnectRecordingBot, int(std::string const& name))
+{
+	IRecordingsExtension* recordings = getRecordingsExtension();
+	IPlayer* bot = recordings ? recordings->connectBot(name) : nullptr;
+	return bot ? bot->getID() : INVALID_PLAYER_ID;
+}
+
+SCRIPT_API(StartRecordingPlayback, bool(IPlayer& player, std::string const& file, bool loop))
+{
+	IRecordingsExtension* recordings = getRecordingsExtension();
+	return recordings && recordings->startPlayback(player, file, loop);
+}
+
+SCRIPT_API(StopRecordingPlayback, bool(IPlayer& player))
+{
+	IRecordingsExtension* recordings = getRecordingsExtension();
+	return recordings && recordings->stopPlayback(player);
+}
+
+SCRIPT_API(IsRecordingPlaybackActive, bool(IPlayer& player))
+{
+	IRecordingsExtension* recordings = getRecordingsExtension();
+	return recordings && recordings->isPlaying(player);
+}
+
+SCRIPT_API(SeekRecordingPlayback, bool(IPlayer& player, int time))
+{
+	IRecordingsExtension* recordings = getRecordingsExtension();
+	return recordings && recordings->seekPlayback(player, Milliseconds(time));
+}
@@ -16,9 +16,145 @@
 #include "Impl.hpp"
 #include "sdk.hpp"
 #include <Server/Components/Pawn/Impl/pawn_natives.hpp>
+#include <algorithm>
+#include <memory>
+
+/// Per-thread bump allocator that string parameters are narrowed into.  Memory is handed out in
+/// blocks that are never moved, so earlier views stay valid while later ones are added, and the
+/// whole arena is rewound once the last parameter using it goes away.  Nested native calls (a
+/// native calling a public calling a native) just stack on top of their caller's strings.
+class StringParamArena
+{
+private:
+	static constexpr size_t BlockSize = 4096;
+
+	struct Block
+	{
+		std::unique_ptr<char[]> data;
+		size_t size;
+	};
+
+	DynamicArray<Block> blocks_;
+	size_t block_ = 0;
+	size_t used_ = 0;
+	size_t users_ = 0;
+
+public:
+	static StringParamArena& get()
+	{
+		thread_local StringParamArena arena;
+		return arena;
+	}
+
+	/// Get `size` bytes that stay valid until the matching `release()`.
+	char* acquire(size_t size)
+	{
+		++users_;
+		while (block_ != blocks_.size() && blocks_[block_].size - used_ < size)
+		{
+			++block_;
+			used_ = 0;
+		}
+		if (block_ == blocks_.size())
+		{
+			const size_t blockSize = std::max(size, BlockSize);
+			blocks_.push_back(Block { std::make_unique<char[]>(blockSize), blockSize });
+			used_ = 0;
+		}
+		char* ret = blocks_[block_].data.get() + used_;
+		used_ += size;
+		return ret;
+	}
+
+	void release()
+	{
+		if (--users_ == 0)
+		{
+			block_ = 0;
+			used_ = 0;
+		}
+	}
+};
+
+/// A read-only string parameter, use in place of `std::string const&` in natives.  The text lives
+/// in `StringParamArena` rather than its own heap allocation, is always null terminated, and is
+/// only valid until the native returns - copy it if it needs to be kept.
+class AmxStringView : public StringView
+{
+public:
+	AmxStringView(const char* data, size_t length)
+		: StringView(data, length)
+	{
+	}
+
+	const char* c_str() const
+	{
+		return data();
+	}
+};
 
 namespace pawn_natives
 {
+template <>
+class ParamCast<AmxStringView>
+{
+public:
+	ParamCast(AMX* amx, cell* params, int idx)
+	{
+		cell* addr = nullptr;
+		int length = 0;
+		if (amx_GetAddr(amx, params[idx], &addr) != AMX_ERR_NONE || amx_StrLen(addr, &length) != AMX_ERR_NONE)
+		{
+			length = 0;
+		}
+		data_ = StringParamArena::get().acquire(length + 1);
+		if (length == 0)
+		{
+			data_[0] = '\0';
+		}
+		else if (static_cast<ucell>(*addr) > UNPACKEDMAX)
+		{
+			// Packed strings are stored big-endian within each cell, so they can't be viewed in
+			// place on the platforms we run on.
+			amx_GetString(data_, addr, false, length + 1);
+		}
+		else
+		{
+			// Plain narrowing loop, left simple so the compiler can vectorise it.
+			for (int i = 0; i != length; ++i)
+			{
+				data_[i] = static_cast<char>(addr[i]);
+			}
+			data_[length] = '\0';
+		}
+		length_ = length;
+	}
+
+	~ParamCast()
+	{
+		StringParamArena::get().release();
+	}
+
+	ParamCast(ParamCast<AmxStringView> const&) = delete;
+	ParamCast(ParamCast<AmxStringView>&&) = delete;
+
+	operator AmxStringView() const
+	{
+		return AmxStringView(data_, length_);
+	}
+
+	bool Error() const
+	{
+		return false;
+	}
+
+	static constexpr int Size = 1;
+
+private:
+	char* data_;
+	size_t length_;
+};
+
 template <>
 class ParamCast<PawnScript&>
 {
@@ -16,7 +16,7 @@
 	if (comp == nullptr)                                  \
 		return ret;
 
-SCRIPT_API(SetSVarInt, bool(const std::string& varname, int value))
+SCRIPT_API(SetSVarInt, bool(AmxStringView varname, int value))
 {
 	if (varname.empty())
 	{
@@ -28,13 +28,13 @@ SCRIPT_API(SetSVarInt, bool(const std::string& varname, int value))
 	return true;
 }
 
-SCRIPT_API(GetSVarInt, int(const std::string& varname))
+SCRIPT_API(GetSVarInt, int(AmxStringView varname))
 {
 	GET_VAR_COMP(component, 0);
 	return component->getInt(varname);
 }
 
-SCRIPT_API(SetSVarString, bool(const std::string& varname, cell const* format))
+SCRIPT_API(SetSVarString, bool(AmxStringView varname, cell const* format))
 {
 	if (varname.empty())
 	{
@@ -47,7 +47,7 @@ SCRIPT_API(SetSVarString, bool(const std::string& varname, cell const* format))
 	return true;
 }
 
-SCRIPT_API(GetSVarString, int(const std::string& varname, OutputOnlyString& output))
+SCRIPT_API(GetSVarString, int(AmxStringView varname, OutputOnlyString& output))
 {
 	GET_VAR_COMP(component, false);
 	// If string is empty, output will not be updated or set to anything and will remain with old data.
@@ -60,7 +60,7 @@ SCRIPT_API(GetSVarString, int(const std::string& varname, OutputOnlyString& outp
 	return std::get<StringView>(output).length();
 }
 
-SCRIPT_API(SetSVarFloat, bool(const std::string& varname, float value))
+SCRIPT_API(SetSVarFloat, bool(AmxStringView varname, float value))
 {
 	if (varname.empty())
 	{
@@ -72,13 +72,13 @@ SCRIPT_API(SetSVarFloat, bool(const std::string& varname, float value))
 	return true;
 }
 
-SCRIPT_API(GetSVarFloat, float(const std::string& varname))
+SCRIPT_API(GetSVarFloat, float(AmxStringView varname))
 {
 	GET_VAR_COMP(component, 0.0f);
 	return component->getFloat(varname);
 }
 
-SCRIPT_API(DeleteSVar, bool(const std::string& varname))
+SCRIPT_API(DeleteSVar, bool(AmxStringView varname))
 {
 	GET_VAR_COMP(component, false);
 	return component->erase(varname);
@@ -102,7 +102,7 @@ SCRIPT_API(GetSVarNameAtIndex, bool(int index, OutputOnlyString& output))
 	return res;
 }
 
-SCRIPT_API(GetSVarType, int(const std::string& varname))
+SCRIPT_API(GetSVarType, int(AmxStringView varname))
 {
 	GET_VAR_COMP(component, 0);
 	return component->getType(varname);
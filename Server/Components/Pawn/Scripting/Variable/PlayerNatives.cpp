@@ -16,20 +16,20 @@
 	if (comp == nullptr)                                                     \
 		return ret;
 
-SCRIPT_API(SetPVarInt, bool(IPlayer& player, const std::string& varname, int value))
+SCRIPT_API(SetPVarInt, bool(IPlayer& player, AmxStringView varname, int value))
 {
 	GET_PLAYER_VAR_COMP(component, false);
 	component->setInt(varname, value);
 	return true;
 }
 
-SCRIPT_API(GetPVarInt, int(IPlayer& player, const std::string& varname))
+SCRIPT_API(GetPVarInt, int(IPlayer& player, AmxStringView varname))
 {
 	GET_PLAYER_VAR_COMP(component, 0);
 	return component->getInt(varname);
 }
 
-SCRIPT_API(SetPVarString, bool(IPlayer& player, const std::string& varname, cell const* format))
+SCRIPT_API(SetPVarString, bool(IPlayer& player, AmxStringView varname, cell const* format))
 {
 	GET_PLAYER_VAR_COMP(component, false);
 	AmxStringFormatter value(format, GetAMX(), GetParams(), 3);
@@ -37,7 +37,7 @@ SCRIPT_API(SetPVarString, bool(IPlayer& player, const std::string& varname, cell
 	return true;
 }
 
-SCRIPT_API(GetPVarString, int(IPlayer& player, const std::string& varname, OutputOnlyString& output))
+SCRIPT_API(GetPVarString, int(IPlayer& player, AmxStringView varname, OutputOnlyString& output))
 {
 	GET_PLAYER_VAR_COMP(component, 0);
 
@@ -51,20 +51,20 @@ SCRIPT_API(GetPVarString, int(IPlayer& player, const std::string& varname, Outpu
 	return std::get<StringView>(output).length();
 }
 
-SCRIPT_API(SetPVarFloat, bool(IPlayer& player, const std::string& varname, float value))
+SCRIPT_API(SetPVarFloat, bool(IPlayer& player, AmxStringView varname, float value))
 {
 	GET_PLAYER_VAR_COMP(component, false);
 	component->setFloat(varname, value);
 	return true;
 }
 
-SCRIPT_API(GetPVarFloat, float(IPlayer& player, const std::string& varname))
+SCRIPT_API(GetPVarFloat, float(IPlayer& player, AmxStringView varname))
 {
 	GET_PLAYER_VAR_COMP(component, 0.0f);
 	return component->getFloat(varname);
 }
 
-SCRIPT_API(DeletePVar, bool(IPlayer& player, const std::string& varname))
+SCRIPT_API(DeletePVar, bool(IPlayer& player, AmxStringView varname))
 {
 	GET_PLAYER_VAR_COMP(component, false);
 	return component->erase(varname);
@@ -88,7 +88,7 @@ SCRIPT_API(GetPVarNameAtIndex, bool(IPlayer& player, int index, OutputOnlyString
 	return res;
 }
 
-SCRIPT_API(GetPVarType, int(IPlayer& player, const std::string& varname))
+SCRIPT_API(GetPVarType, int(IPlayer& player, AmxStringView varname))
 {
 	GET_PLAYER_VAR_COMP(component, 0);
 	return component->getType(varname);
@@ -594,9 +594,690 @@ static inline unsigned char atcadvance(unsigned char const** fmt, bool ispacked)
 	return ret;
 }
 
+/// Write one argument for the conversion `ch`, shared by the interpreting and the compiled paths.
+/// @returns False on an error that should abort the whole format (the error is logged)
+template <typename D, typename S>
+static bool AddArgument(D** buf, size_t& llen, char ch, int flags, int width, int prec, const S* format, AMX* amx, const cell* params, int& arg, int args)
+{
+	cell* cptr;
+	D*& buf_p = *buf;
+	switch (ch)
+	{
+	case 'c':
+		CHECK_ARGS(0);
+		amx_GetAddr(amx, params[arg], &cptr);
+		*buf_p++ = static_cast<D>(cptr ? *cptr : 0);
+		llen--;
+		arg++;
+		break;
+	case 'b':
+		CHECK_ARGS(0);
+		amx_GetAddr(amx, params[arg], &cptr);
+		AddBinary(&buf_p, llen, cptr ? *cptr : 0, width, flags);
+		arg++;
+		break;
+	case 'o':
+		CHECK_ARGS(0);
+		amx_GetAddr(amx, params[arg], &cptr);
+		AddOctal(&buf_p, llen, cptr ? *cptr : 0, width, flags);
+		arg++;
+		break;
+	case 'd':
+	case 'i':
+		CHECK_ARGS(0);
+		amx_GetAddr(amx, params[arg], &cptr);
+		AddInt(&buf_p, llen, cptr ? *cptr : 0, width, flags);
+		arg++;
+		break;
+	case 'u':
+		CHECK_ARGS(0);
+		amx_GetAddr(amx, params[arg], &cptr);
+		AddUInt(&buf_p, llen, static_cast<unsigned int>(cptr ? *cptr : 0), width, flags);
+		arg++;
+		break;
+	case 'f':
+		CHECK_ARGS(0);
+		amx_GetAddr(amx, params[arg], &cptr);
+		AddFloat(&buf_p, llen, cptr ? amx_ctof(*cptr) : 0.0f, width, prec, flags);
+		arg++;
+		break;
+	case 'H':
+	case 'x':
+		CHECK_ARGS(0);
+		flags |= UPPERDIGITS;
+		amx_GetAddr(amx, params[arg], &cptr);
+		AddHex(&buf_p, llen, static_cast<unsigned int>(cptr ? *cptr : 0), width, flags);
+		arg++;
+		break;
+	case 'h':
+		CHECK_ARGS(0);
+		amx_GetAddr(amx, params[arg], &cptr);
+		AddHex(&buf_p, llen, static_cast<unsigned int>(cptr ? *cptr : 0), width, flags);
+		arg++;
+		break;
+	case 'a':
+	{
+		CHECK_ARGS(0);
+		// %a is passed a pointer directly to a cell string.
+		amx_GetAddr(amx, params[arg], &cptr);
+		if (!cptr)
+		{
+			PawnManager::Get()->core->logLn(LogLevel::Error, "Invalid vector string handle provided");
+			return 0;
+		}
+		cell* ptr = reinterpret_cast<cell*>(*cptr);
+		if (!ptr)
+		{
+			PawnManager::Get()->core->logLn(LogLevel::Error, "Invalid vector string handle provided (%d)", *cptr);
+			return 0;
+		}
+
+		AddString(&buf_p, llen, ptr, width, prec, flags);
+		arg++;
+		break;
+	}
+	case 's':
+		CHECK_ARGS(0);
+		amx_GetAddr(amx, params[arg], &cptr);
+		if (cptr)
+		{
+			AddString(&buf_p, llen, cptr, width, prec, flags);
+		}
+		arg++;
+		break;
+	case 'q':
+	{
+		CHECK_ARGS(0);
+
+		int argLen = 0;
+		amx_GetAddr(amx, params[arg], &cptr);
+		if (cptr)
+		{
+			amx_StrLen(cptr, &argLen);
+		}
+		if (argLen > 0)
+		{
+			++argLen;
+			std::string strArg;
+			strArg.resize(argLen);
+
+			amx_GetString((char*)strArg.data(), cptr, false, argLen);
+
+			size_t pos = 0;
+			while ((pos = strArg.find('\'', pos)) != std::string::npos)
+			{
+				strArg.insert(strArg.begin() + pos, '\'');
+				pos += 2;
+			}
+
+			AddString(&buf_p, llen, strArg.c_str(), width, prec, flags);
+		}
+
+		arg++;
+		break;
+	}
+	}
+	return true;
+}
+
+/// Powers of ten a double holds exactly, so they can stand in for `pow(10.0, n)`.
+static constexpr double PowersOf10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static constexpr int MaxPowerOf10 = 22;
+
+/// `AddInt` without flags or a width, writing the digits two at a time.
+template <typename U>
+static inline void AddPlainInt(U** buf_p, size_t& maxlen, int val)
+{
+	static constexpr char pairs[] = "00010203040506070809"
+									"10111213141516171819"
+									"20212223242526272829"
+									"30313233343536373839"
+									"40414243444546474849"
+									"50515253545556575859"
+									"60616263646566676869"
+									"70717273747576777879"
+									"80818283848586878889"
+									"90919293949596979899";
+	char text[12];
+	char* const end = text + sizeof(text);
+	char* start = end;
+	unsigned int unsignedVal = val < 0 ? 0u - static_cast<unsigned int>(val) : static_cast<unsigned int>(val);
+
+	while (unsignedVal >= 100)
+	{
+		const unsigned int pair = (unsignedVal % 100) * 2;
+		unsignedVal /= 100;
+		*--start = pairs[pair + 1];
+		*--start = pairs[pair];
+	}
+	if (unsignedVal >= 10)
+	{
+		*--start = pairs[unsignedVal * 2 + 1];
+		*--start = pairs[unsignedVal * 2];
+	}
+	else
+	{
+		*--start = static_cast<char>('0' + unsignedVal);
+	}
+	if (val < 0)
+	{
+		*--start = '-';
+	}
+
+	const size_t count = std::min<size_t>(end - start, maxlen);
+	U* buf = *buf_p;
+	for (size_t i = 0; i != count; ++i)
+	{
+		buf[i] = static_cast<U>(start[i]);
+	}
+	*buf_p = buf + count;
+	maxlen -= count;
+}
+
+/// `AddFloat` without flags or a width.  The digits come out of the same arithmetic, only the
+/// `log10` and `pow` calls are replaced by lookups, which give the same results for every float
+/// below 1e22.
+/// @returns False for values it can't do that for, with nothing written
+template <typename U>
+static inline bool AddPlainFloat(U** buf_p, size_t& maxlen, double fval, int prec)
+{
+	if (prec < 0)
+	{
+		prec = 6;
+	}
+	if (!(fabs(fval) < PowersOf10[MaxPowerOf10]) || prec > MaxPowerOf10)
+	{
+		// NaN, infinity and huge numbers.
+		return false;
+	}
+	if (maxlen < 3)
+	{
+		return true;
+	}
+
+	U* buf = *buf_p;
+	int significant_digits = 0;
+	const int MAX_SIGNIFICANT_DIGITS = 16;
+
+	if (fval < 0)
+	{
+		fval = -fval;
+		*buf++ = '-';
+		maxlen--;
+	}
+
+	int digits = 1;
+	while (digits <= MaxPowerOf10 && fval >= PowersOf10[digits])
+	{
+		++digits;
+	}
+
+	double tmp = PowersOf10[digits - 1];
+	while ((digits--) && maxlen)
+	{
+		if (++significant_digits > MAX_SIGNIFICANT_DIGITS)
+		{
+			*buf++ = '0';
+		}
+		else
+		{
+			const int val = (int)(fval / tmp);
+			*buf++ = '0' + val;
+			fval -= val * tmp;
+			tmp *= 0.1;
+		}
+		maxlen--;
+	}
+
+	if (maxlen && prec)
+	{
+		*buf++ = '.';
+		maxlen--;
+	}
+
+	tmp = PowersOf10[prec];
+	fval *= tmp;
+	while (prec-- && maxlen)
+	{
+		if (++significant_digits > MAX_SIGNIFICANT_DIGITS)
+		{
+			*buf++ = '0';
+		}
+		else
+		{
+			tmp *= 0.1;
+			const int val = (int)(fval / tmp);
+			*buf++ = '0' + val;
+			fval -= val * tmp;
+		}
+		maxlen--;
+	}
+
+	*buf_p = buf;
+	return true;
+}
+
+/// `AddString` without a width or precision.  Packed strings are unpacked a cell at a time rather
+/// than working out the address of every byte.
+template <typename U>
+static inline void AddPlainString(U** buf_p, size_t& maxlen, const cell* string)
+{
+	// Finds zero bytes in a cell, see "Bit Twiddling Hacks".
+	static constexpr ucell LowBytes = ~ucell(0) / 0xFF;
+	static constexpr ucell HighBits = LowBytes * 0x80;
+	static constexpr int TopShift = (sizeof(cell) - 1) * 8;
+
+	U* buf = *buf_p;
+	size_t left = maxlen;
+	if (*string > UNPACKEDMAX)
+	{
+		// Whole cells without a terminator in them first, the first character is in the top byte.
+		// Characters go through `char`, like in `AddString`, so ones above 127 come out the same.
+		const ucell* cells = reinterpret_cast<const ucell*>(string);
+		ucell packed;
+		while (left >= sizeof(cell) && (((packed = *cells) - LowBytes) & ~packed & HighBits) == 0)
+		{
+			for (size_t i = 0; i != sizeof(cell); ++i)
+			{
+				buf[i] = static_cast<U>(static_cast<char>(packed >> (TopShift - i * 8)));
+			}
+			buf += sizeof(cell);
+			left -= sizeof(cell);
+			++cells;
+		}
+
+		packed = *cells;
+		for (int shift = TopShift; shift >= 0 && left; shift -= 8, --left)
+		{
+			const char ch = static_cast<char>(packed >> shift);
+			if (ch == '\0')
+			{
+				break;
+			}
+			*buf++ = static_cast<U>(ch);
+		}
+	}
+	else
+	{
+		while (*string && left)
+		{
+			*buf++ = static_cast<U>(*string++);
+			--left;
+		}
+	}
+	maxlen = left;
+	*buf_p = buf;
+}
+
+/// The most common specifiers without flags or a width, `%d`, `%i`, `%s`, `%f` and `%.<n>f`, for
+/// the compiled path.  Writes exactly what `AddArgument` would.
+/// @returns False if the specifier isn't one of those, with nothing written and no argument used
+template <typename D>
+static inline bool AddPlainArgument(D** buf_p, size_t& llen, unsigned char ch, int prec, AMX* amx, cell param)
+{
+	cell* cptr;
+	switch (ch)
+	{
+	case 'd':
+	case 'i':
+		amx_GetAddr(amx, param, &cptr);
+		AddPlainInt(buf_p, llen, cptr ? *cptr : 0);
+		return true;
+	case 'f':
+		amx_GetAddr(amx, param, &cptr);
+		return AddPlainFloat(buf_p, llen, cptr ? amx_ctof(*cptr) : 0.0f, prec);
+	case 's':
+		if (prec >= 0)
+		{
+			return false;
+		}
+		amx_GetAddr(amx, param, &cptr);
+		if (cptr)
+		{
+			AddPlainString(buf_p, llen, cptr);
+		}
+		return true;
+	}
+	return false;
+}
+
+/// Most `*` arguments a single compiled specifier may take; longer ones aren't cached.
+static constexpr int MaxFormatStars = 4;
+/// Longest format string, in characters, that gets compiled.
+static constexpr size_t MaxCompiledFormatLength = 1024;
+/// Cached format strings before the cache is flushed.
+static constexpr size_t MaxCachedFormats = 4096;
+/// Times the contents at one address may change before that address stops being cached.  Formats
+/// built at run time in the same buffer would otherwise be recompiled on every call.
+static constexpr int MaxFormatChanges = 4;
+
+/// When false every call goes through the interpreting path, used to compare the two.
+static bool formatCacheEnabled = true;
+
+/// One step of a pre-parsed format string.
+struct FormatOp
+{
+	enum Kind : uint8_t
+	{
+		Literal, ///< Copy `length` characters from `offset` in the literal buffer
+		Char, ///< Write `conversion` itself (`%%`, unknown specifiers, a trailing `%`)
+		Argument ///< Format an argument with `conversion`
+	};
+
+	Kind kind;
+	unsigned char conversion = 0;
+	uint8_t stars = 0; ///< `*` arguments consumed, in order
+	int8_t widthStar = -1; ///< Which `*` argument is the width, or -1 to use `width`
+	int8_t precStar = -1; ///< Which `*` argument is the precision, or -1 to use `prec`
+	int flags = 0;
+	int width = 0;
+	int prec = -1;
+	uint32_t offset = 0;
+	uint32_t length = 0;
+};
+
+/// A format string broken up into literal runs and specifiers.  The parse mirrors the interpreting
+/// loop in `atcprintf` step for step, so the output is identical.
+struct CompiledFormat
+{
+	DynamicArray<cell> source; ///< Every cell the parse looked at, to validate cache hits
+	String literals;
+	DynamicArray<FormatOp> ops;
+	bool valid = false; ///< False if the format couldn't be compiled, interpret it instead
+	int changes = 0;
+
+	template <typename S>
+	bool matches(const S* format) const
+	{
+		// Stop at the first difference so a shorter string is never read past the cell holding
+		// its terminator.
+		for (size_t i = 0; i != source.size(); ++i)
+		{
+			if (source[i] != static_cast<cell>(format[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template <typename S>
+	bool compile(const S* format)
+	{
+		ops.clear();
+		literals.clear();
+		source.clear();
+		valid = false;
+
+		const bool ispacked = sizeof(S) == sizeof(ucell) && (ucell)*format > UNPACKEDMAX;
+		const unsigned char* fmt = ispacked ? (unsigned char*)((intptr_t)format + sizeof(S) - 1) : (unsigned char*)format;
+		size_t cells = 0;
+		auto peek = [&]()
+		{
+			cells = std::max(cells, size_t((uintptr_t(fmt) - uintptr_t(format)) / sizeof(S)) + 1);
+			return *fmt;
+		};
+		auto next = [&]()
+		{
+			peek();
+			return static_cast<unsigned char>(atcadvance<S>(&fmt, ispacked));
+		};
+
+		bool done = false;
+		while (!done)
+		{
+			FormatOp literal { FormatOp::Literal };
+			literal.offset = literals.size();
+			while (peek() != '\0' && *fmt != '%')
+			{
+				if (literals.size() == MaxCompiledFormatLength)
+				{
+					return false;
+				}
+				literals.push_back(next());
+			}
+			literal.length = literals.size() - literal.offset;
+			if (literal.length)
+			{
+				ops.push_back(literal);
+			}
+			if (*fmt == '\0')
+			{
+				break;
+			}
+
+			// skip over the '%'
+			next();
+
+			FormatOp spec { FormatOp::Argument };
+			unsigned char ch;
+			int n;
+
+		rflag:
+			ch = next();
+		reswitch:
+			switch (ch)
+			{
+			case '-':
+				spec.flags |= LADJUST;
+				goto rflag;
+			case '.':
+				ch = peek();
+				if (ch == '*')
+				{
+					if (spec.stars == MaxFormatStars)
+					{
+						return false;
+					}
+					spec.precStar = spec.stars++;
+					next();
+					goto rflag;
+				}
+				else
+				{
+					n = 0;
+					while (is_digit((ch = next())))
+						n = 10 * n + (ch - '0');
+					spec.prec = n < 0 ? -1 : n;
+					spec.precStar = -1;
+					goto reswitch;
+				}
+			case '0':
+				spec.flags |= ZEROPAD;
+				goto rflag;
+			case '1':
+			case '2':
+			case '3':
+			case '4':
+			case '5':
+			case '6':
+			case '7':
+			case '8':
+			case '9':
+				n = 0;
+				do
+				{
+					n = 10 * n + (ch - '0');
+					ch = next();
+				} while (is_digit(ch));
+				spec.width = n;
+				spec.widthStar = -1;
+				goto reswitch;
+			case '*':
+				if (spec.stars == MaxFormatStars)
+				{
+					return false;
+				}
+				spec.widthStar = spec.stars++;
+				goto rflag;
+			case 'c':
+			case 'b':
+			case 'o':
+			case 'd':
+			case 'i':
+			case 'u':
+			case 'f':
+			case 'H':
+			case 'x':
+			case 'h':
+			case 'a':
+			case 's':
+			case 'q':
+				spec.conversion = ch;
+				break;
+			case '\0':
+				spec.kind = FormatOp::Char;
+				spec.conversion = '%';
+				done = true;
+				break;
+			default:
+				spec.kind = FormatOp::Char;
+				spec.conversion = ch;
+				break;
+			}
+			ops.push_back(spec);
+		}
+
+		source.assign(format, format + cells);
+		valid = true;
+		return true;
+	}
+};
+
+/// Compiled format strings keyed by address, checked against their contents on every hit.  Only
+/// used from the main thread.
+template <typename S>
+static const CompiledFormat* findCompiledFormat(const S* format)
+{
+	static FlatHashMap<const S*, CompiledFormat> cache;
+
+	auto it = cache.find(format);
+	if (it != cache.end())
+	{
+		CompiledFormat& compiled = it->second;
+		if (compiled.matches(format))
+		{
+			return compiled.valid ? &compiled : nullptr;
+		}
+		if (compiled.changes == MaxFormatChanges)
+		{
+			return nullptr;
+		}
+		if (++compiled.changes == MaxFormatChanges)
+		{
+			// Keep the entry so the address stays marked as changing, but drop the rest.
+			compiled.valid = false;
+			compiled.ops.clear();
+			compiled.literals.clear();
+			return nullptr;
+		}
+	}
+	else
+	{
+		if (cache.size() >= MaxCachedFormats)
+		{
+			cache.clear();
+		}
+		it = cache.emplace(format, CompiledFormat()).first;
+	}
+
+	CompiledFormat& compiled = it->second;
+	if (!compiled.compile(format))
+	{
+		// Remember what was seen so the next call can skip straight to interpreting.
+		compiled.ops.clear();
+		compiled.literals.clear();
+		int length = 0;
+		amx_StrLen(format, &length);
+		compiled.source.assign(format, format + (sizeof(S) == sizeof(ucell) && (ucell)*format > UNPACKEDMAX ? length / sizeof(S) + 1 : length + 1));
+		return nullptr;
+	}
+	return &compiled;
+}
+
+template <typename D, typename S>
+static size_t atcprintfCompiled(const CompiledFormat& compiled, D* buffer, size_t maxlen, const S* format, AMX* amx, const cell* params, int* param)
+{
+	int args = params[0] / sizeof(cell);
+	int arg = *param;
+	D* buf_p = buffer;
+	size_t llen = maxlen;
+	const unsigned char* literals = reinterpret_cast<const unsigned char*>(compiled.literals.data());
+
+	for (const FormatOp& op : compiled.ops)
+	{
+		// Matches the interpreting loop giving up as soon as the buffer is full.
+		if (!llen)
+		{
+			break;
+		}
+
+		if (op.kind == FormatOp::Literal)
+		{
+			const size_t count = std::min<size_t>(op.length, llen);
+			const unsigned char* src = literals + op.offset;
+			for (size_t i = 0; i != count; ++i)
+			{
+				buf_p[i] = static_cast<D>(src[i]);
+			}
+			buf_p += count;
+			llen -= count;
+			continue;
+		}
+
+		int width = op.width;
+		int prec = op.prec;
+		for (int i = 0; i != op.stars; ++i)
+		{
+			cell* cptr;
+			amx_GetAddr(amx, params[arg], &cptr);
+			const int value = cptr ? *cptr : 0;
+			if (i == op.widthStar)
+			{
+				width = value;
+			}
+			if (i == op.precStar)
+			{
+				prec = value;
+			}
+			arg++;
+		}
+
+		if (op.kind == FormatOp::Char)
+		{
+			*buf_p++ = static_cast<D>(op.conversion);
+			llen--;
+		}
+		else if (op.flags == 0 && width <= 0 && arg <= args && AddPlainArgument(&buf_p, llen, op.conversion, prec, amx, params[arg]))
+		{
+			arg++;
+		}
+		else if (!AddArgument(&buf_p, llen, static_cast<char>(op.conversion), op.flags, width, prec, format, amx, params, arg, args))
+		{
+			return 0;
+		}
+	}
+
+	*buf_p = static_cast<D>(0);
+	*param = arg;
+
+	return maxlen - llen;
+}
+
 template <typename D, typename S>
 size_t atcprintf(D* buffer, size_t maxlen, const S* format, AMX* amx, const cell* params, int* param)
 {
+	if (formatCacheEnabled && format)
+	{
+		if (const CompiledFormat* compiled = findCompiledFormat(format))
+		{
+			return atcprintfCompiled(*compiled, buffer, maxlen, format, amx, params, param);
+		}
+	}
+
 	cell* cptr;
 	int arg;
 	int args = params[0] / sizeof(cell);
@@ -690,118 +1371,23 @@ reswitch:
 			arg++;
 			goto rflag;
 		case 'c':
-			CHECK_ARGS(0);
-			amx_GetAddr(amx, params[arg], &cptr);
-			*buf_p++ = static_cast<D>(cptr ? *cptr : 0);
-			llen--;
-			arg++;
-			break;
 		case 'b':
-			CHECK_ARGS(0);
-			amx_GetAddr(amx, params[arg], &cptr);
-			AddBinary(&buf_p, llen, cptr ? *cptr : 0, width, flags);
-			arg++;
-			break;
 		case 'o':
-			CHECK_ARGS(0);
-			amx_GetAddr(amx, params[arg], &cptr);
-			AddOctal(&buf_p, llen, cptr ? *cptr : 0, width, flags);
-			arg++;
-			break;
 		case 'd':
 		case 'i':
-			CHECK_ARGS(0);
-			amx_GetAddr(amx, params[arg], &cptr);
-			AddInt(&buf_p, llen, cptr ? *cptr : 0, width, flags);
-			arg++;
-			break;
 		case 'u':
-			CHECK_ARGS(0);
-			amx_GetAddr(amx, params[arg], &cptr);
-			AddUInt(&buf_p, llen, static_cast<unsigned int>(cptr ? *cptr : 0), width, flags);
-			arg++;
-			break;
 		case 'f':
-			CHECK_ARGS(0);
-			amx_GetAddr(amx, params[arg], &cptr);
-			AddFloat(&buf_p, llen, cptr ? amx_ctof(*cptr) : 0.0f, width, prec, flags);
-			arg++;
-			break;
 		case 'H':
 		case 'x':
-			CHECK_ARGS(0);
-			flags |= UPPERDIGITS;
-			amx_GetAddr(amx, params[arg], &cptr);
-			AddHex(&buf_p, llen, static_cast<unsigned int>(cptr ? *cptr : 0), width, flags);
-			arg++;
-			break;
 		case 'h':
-			CHECK_ARGS(0);
-			amx_GetAddr(amx, params[arg], &cptr);
-			AddHex(&buf_p, llen, static_cast<unsigned int>(cptr ? *cptr : 0), width, flags);
-			arg++;
-			break;
 		case 'a':
-		{
-			CHECK_ARGS(0);
-			// %a is passed a pointer directly to a cell string.
-			amx_GetAddr(amx, params[arg], &cptr);
-			if (!cptr)
-			{
-				PawnManager::Get()->core->logLn(LogLevel::Error, "Invalid vector string handle provided");
-				return 0;
-			}
-			cell* ptr = reinterpret_cast<cell*>(*cptr);
-			if (!ptr)
-			{
-				PawnManager::Get()->core->logLn(LogLevel::Error, "Invalid vector string handle provided (%d)", *cptr);
-				return 0;
-			}
-
-			AddString(&buf_p, llen, ptr, width, prec, flags);
-			arg++;
-			break;
-		}
 		case 's':
-			CHECK_ARGS(0);
-			amx_GetAddr(amx, params[arg], &cptr);
-			if (cptr)
-			{
-				AddString(&buf_p, llen, cptr, width, prec, flags);
-			}
-			arg++;
-			break;
 		case 'q':
-		{
-			CHECK_ARGS(0);
-
-			int argLen = 0;
-			amx_GetAddr(amx, params[arg], &cptr);
-			if (cptr)
+			if (!AddArgument(&buf_p, llen, static_cast<char>(ch), flags, width, prec, format, amx, params, arg, args))
 			{
-				amx_StrLen(cptr, &argLen);
-			}
-			if (argLen > 0)
-			{
-				++argLen;
-				std::string strArg;
-				strArg.resize(argLen);
-
-				amx_GetString((char*)strArg.data(), cptr, false, argLen);
-
-				size_t pos = 0;
-				while ((pos = strArg.find('\'', pos)) != std::string::npos)
-				{
-					strArg.insert(strArg.begin() + pos, '\'');
-					pos += 2;
-				}
-
-				AddString(&buf_p, llen, strArg.c_str(), width, prec, flags);
+				return 0;
 			}
-
-			arg++;
 			break;
-		}
 		case '%':
 			*buf_p++ = static_cast<D>(ch);
 			if (!llen)
@@ -885,3 +1471,112 @@ AmxStringFormatter::AmxStringFormatter(cell const* format, AMX* amx, cell const*
 		}
 	}
 }
+
+namespace
+{
+struct FormatBenchmark
+{
+	const char* name;
+	const char* format;
+	const char* types; ///< One of `d`, `f` or `s` per argument
+};
+
+// Typical chat, join message and textdraw formats.
+static const FormatBenchmark FormatBenchmarks[] = {
+	{ "chat", "{%06x}%s(%d): {FFFFFF}%s", "dsds" },
+	{ "join", "%s (%d) has joined the server.", "sd" },
+	{ "log", "[%02d:%02d:%02d] %s: %s", "dddss" },
+	{ "money", "~g~$%08d", "d" },
+	{ "speedo", "~w~%.0f ~b~km/h", "f" },
+	{ "stats", "~r~%d~w~/~g~%d kills ~y~%.2f ratio", "ddf" },
+	{ "health", "Health: %.1f%%", "f" },
+};
+
+static const cell FormatBenchmarkInts[] = { 0x33AA33, 1337, 12, 65535 };
+static const float FormatBenchmarkFloats[] = { 87.5f, 1234.567f };
+static const char* const FormatBenchmarkStrings[] = { "Some_Player", "Hello everyone, how is it going?" };
+}
+
+DynamicArray<String> BenchmarkFormats(AMX* amx, int iterations)
+{
+	DynamicArray<String> report;
+	char line[256];
+	report.emplace_back("format        interpreted     compiled");
+
+	for (const FormatBenchmark& bench : FormatBenchmarks)
+	{
+		// Everything goes on the script's heap, where `format` would find its arguments.
+		const cell hea = amx->hea;
+		auto allot = [amx](const char* str, cell value, cell& addr)
+		{
+			cell* phys;
+			const size_t len = str ? strlen(str) + 1 : 1;
+			if (amx_Allot(amx, len, &addr, &phys) != AMX_ERR_NONE)
+			{
+				return false;
+			}
+			if (str)
+			{
+				amx_SetString(phys, str, false, false, len);
+			}
+			else
+			{
+				*phys = value;
+			}
+			return true;
+		};
+
+		cell params[16];
+		int count = 0;
+		cell formatAddr;
+		bool ok = allot(bench.format, 0, formatAddr);
+		for (const char* type = bench.types; ok && *type; ++type)
+		{
+			const int i = count++;
+			switch (*type)
+			{
+			case 'd':
+				ok = allot(nullptr, FormatBenchmarkInts[i % 4], params[count]);
+				break;
+			case 'f':
+				ok = allot(nullptr, amx_ftoc(FormatBenchmarkFloats[i % 2]), params[count]);
+				break;
+			default:
+				ok = allot(FormatBenchmarkStrings[i % 2], 0, params[count]);
+				break;
+			}
+		}
+		params[0] = count * sizeof(cell);
+
+		cell* format;
+		if (!ok || amx_GetAddr(amx, formatAddr, &format) != AMX_ERR_NONE)
+		{
+			amx_Release(amx, hea);
+			report.emplace_back(String(bench.name) + ": not enough heap space in the script.");
+			continue;
+		}
+
+		StaticArray<StaticArray<cell, 256>, 2> output;
+		StaticArray<size_t, 2> length;
+		StaticArray<double, 2> ns;
+		for (int compiled = 0; compiled != 2; ++compiled)
+		{
+			formatCacheEnabled = compiled == 1;
+			const TimePoint start = Time::now();
+			for (int i = 0; i != iterations; ++i)
+			{
+				int param = 1;
+				length[compiled] = atcprintf(output[compiled].data(), output[compiled].size() - 1, format, amx, params, &param);
+			}
+			ns[compiled] = duration_cast<std::chrono::nanoseconds>(Time::now() - start).count() / double(iterations);
+		}
+		formatCacheEnabled = true;
+		amx_Release(amx, hea);
+
+		const bool same = length[0] == length[1] && std::equal(output[0].begin(), output[0].begin() + length[0], output[1].begin());
+		snprintf(line, sizeof(line), "%-10s %12.1fns %10.1fns  %.2fx%s", bench.name, ns[0], ns[1], ns[0] / ns[1], same ? "" : "  (output differs!)");
+		report.emplace_back(line);
+	}
+
+	return report;
+}
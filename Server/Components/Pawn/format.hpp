@@ -25,6 +25,10 @@
 template <typename D, typename S>
 size_t atcprintf(D* buffer, size_t maxlen, const S* format, AMX* amx, cell const* params, int* param);
 
+/// Time `atcprintf` over a set of typical chat and textdraw formats, with and without the compiled
+/// format cache, using `amx`'s heap for the arguments.  Returns one report line per format.
+DynamicArray<String> BenchmarkFormats(AMX* amx, int iterations);
+
 /// Amx string format which can be cast to StringView
 class AmxStringFormatter
 {
@@ -84,13 +84,46 @@ static StaticArray<void*, NUM_AMX_FUNCS> AMX_FUNCTIONS = {
 	reinterpret_cast<void*>(&amx_StrSize),
 };
 
+/// Milliseconds a legacy plugin's `ProcessTick` may take before a warning is logged.
+static constexpr int PluginTickBudgetDefault = 25;
+
 class PawnComponent final : public IPawnComponent, public CoreEventHandler, public ConsoleEventHandler
 {
 private:
 	ICore* core = nullptr;
 	Scripting scriptingInstance;
 
+	struct TraceConsumer final : public ITraceConsumer
+	{
+		void setTraceRecorder(ITraceRecorder* recorder) override
+		{
+			// Null whenever the server isn't capturing or watching, so scopes cost one branch.
+			if (recorder)
+			{
+				recorder->setNameResolver(&PawnTraceNameResolver);
+			}
+			PawnManager::Get()->SetTraceRecorder(recorder);
+		}
+
+		void freeExtension() override
+		{
+		}
+
+		void reset() override
+		{
+		}
+	} traceConsumer;
+
 public:
+	IExtension* getExtension(UID id) override
+	{
+		if (id == ITraceConsumer::ExtensionIID)
+		{
+			return &traceConsumer;
+		}
+		return nullptr;
+	}
+
 	StringView componentName() const override
 	{
 		return "Pawn";
@@ -185,6 +218,7 @@ public:
 		IConfig& config = core->getConfig();
 
 		// load plugins
+		pluginMgr.tickBudget = Milliseconds(*config.getInt("pawn.plugin_tick_budget"));
 		DynamicArray<StringView> plugins(config.getStringsCount("pawn.legacy_plugins"));
 		config.getStrings("pawn.legacy_plugins", Span<StringView>(plugins.data(), plugins.size()));
 		for (auto& plugin : plugins)
@@ -192,6 +226,10 @@ public:
 			pluginMgr.Load(String(plugin));
 		}
 
+		DynamicArray<StringView> jitScripts(config.getStringsCount("pawn.jit_scripts"));
+		config.getStrings("pawn.jit_scripts", Span<StringView>(jitScripts.data(), jitScripts.size()));
+		mgr->SetJITScripts(jitScripts);
+
 		// load scripts
 		DynamicArray<StringView> sideScripts(config.getStringsCount("pawn.side_scripts"));
 		config.getStrings("pawn.side_scripts", Span<StringView>(sideScripts.data(), sideScripts.size()));
@@ -294,6 +332,12 @@ public:
 			config.setStrings("pawn.main_scripts", Span<StringView>(scripts, 1));
 			config.setStrings("pawn.side_scripts", Span<StringView>());
 			config.setStrings("pawn.legacy_plugins", Span<StringView>());
+			config.setInt("pawn.plugin_tick_budget", PluginTickBudgetDefault);
+			config.setStrings("pawn.jit_scripts", Span<StringView>());
+		}
+		else if (config.getType("pawn.plugin_tick_budget") == ConfigOptionType_None)
+		{
+			config.setInt("pawn.plugin_tick_budget", PluginTickBudgetDefault);
 		}
 	}
 
@@ -0,0 +1,411 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#include "profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+/// Symbol kind of functions in the debug information, from the compiler's `sc.h`.
+static constexpr char DebugSymbolFunction = 9;
+
+static uint64_t entryKey(PawnProfiler::Kind kind, uint64_t id)
+{
+	return (uint64_t(kind) << 56) | id;
+}
+
+static const char* kindName(PawnProfiler::Kind kind)
+{
+	switch (kind)
+	{
+	case PawnProfiler::Kind::Public:
+		return "public";
+	case PawnProfiler::Kind::Native:
+		return "native";
+	default:
+		return "function";
+	}
+}
+
+const PawnProfiler::Function* PawnProfiler::Script::findFunction(ucell address) const
+{
+	auto it = std::upper_bound(functions.begin(), functions.end(), address, [](ucell address, const Function& function)
+		{
+			return address < function.start;
+		});
+	if (it == functions.begin())
+	{
+		return nullptr;
+	}
+	--it;
+	return address < it->end ? &*it : nullptr;
+}
+
+void PawnProfiler::start()
+{
+	entries_.clear();
+	edges_.clear();
+	frames_.clear();
+	started_ = Time::now();
+	active_ = true;
+}
+
+void PawnProfiler::attach(AMX* amx, StringView name, StringView path)
+{
+	if (!active_ || scripts_.find(amx) != scripts_.end())
+	{
+		return;
+	}
+	Script& script = scripts_[amx];
+	script.name = String(name);
+
+	// Internal functions can only be told apart with the compiler's debug information (`-d2`).
+	if (FILE* file = ::fopen(String(path).c_str(), "rb"))
+	{
+		if (dbg_LoadInfo(&script.dbg, file) == AMX_ERR_NONE)
+		{
+			script.hasDebug = true;
+			for (int i = 0; i != script.dbg.hdr->symbols; ++i)
+			{
+				const AMX_DBG_SYMBOL* symbol = script.dbg.symboltbl[i];
+				if (symbol->ident == DebugSymbolFunction)
+				{
+					script.functions.push_back(Function { symbol->codestart, symbol->codeend, symbol->name });
+				}
+			}
+			std::sort(script.functions.begin(), script.functions.end(), [](const Function& a, const Function& b)
+				{
+					return a.start < b.start;
+				});
+		}
+		::fclose(file);
+	}
+
+	script.prevCallback = amx->callback;
+	script.prevSysreqD = amx->sysreq_d;
+	// `amx_Callback` patches every call it sees to `SYSREQ.D`, which never comes back through here.
+	amx->sysreq_d = 0;
+	amx_SetCallback(amx, &nativeCallback);
+	if (script.hasDebug)
+	{
+		script.prevDebug = amx->debug;
+		amx_SetDebugHook(amx, &debugHook);
+	}
+}
+
+void PawnProfiler::detach(AMX* amx)
+{
+	auto it = scripts_.find(amx);
+	if (it == scripts_.end())
+	{
+		return;
+	}
+	Script& script = it->second;
+	// Only put things back if nobody replaced the hooks in the meantime.
+	if (amx->callback == &nativeCallback)
+	{
+		amx_SetCallback(amx, script.prevCallback);
+		amx->sysreq_d = script.prevSysreqD;
+	}
+	if (script.hasDebug)
+	{
+		if (amx->debug == &debugHook)
+		{
+			amx_SetDebugHook(amx, script.prevDebug);
+		}
+		dbg_FreeInfo(&script.dbg);
+	}
+	scripts_.erase(it);
+	// Anything still open for this script is never going to see a `BREAK` again.
+	for (Frame& frame : frames_)
+	{
+		if (frame.amx == amx)
+		{
+			frame.amx = nullptr;
+		}
+	}
+}
+
+uint32_t PawnProfiler::getEntry(AMX* amx, Script& script, Kind kind, uint64_t id, const char* name)
+{
+	const uint64_t key = entryKey(kind, id);
+	auto it = script.entries.find(key);
+	if (it != script.entries.end())
+	{
+		return it->second;
+	}
+	AMX_NATIVE_INFO info;
+	if (!name)
+	{
+		name = kind == Kind::Native && amx_GetNativeByIndex(amx, int(id), &info) == AMX_ERR_NONE ? info.name : "?";
+	}
+	// Names are copied now, the script might be gone by the time the report is written.
+	const uint32_t entry = entries_.size();
+	Entry& added = entries_.emplace_back();
+	added.kind = kind;
+	added.script = script.name;
+	added.name = name;
+	script.entries.emplace(key, entry);
+	return entry;
+}
+
+void PawnProfiler::push(uint32_t entry, AMX* amx, cell frm, ucell start, ucell end, bool isPublic, TimePoint now)
+{
+	Entry& callee = entries_[entry];
+	++callee.calls;
+	++callee.open;
+	if (!frames_.empty())
+	{
+		++edges_[(uint64_t(frames_.back().entry) << 32) | entry].calls;
+	}
+	frames_.push_back(Frame { entry, amx, frm, start, end, isPublic, now });
+}
+
+void PawnProfiler::pop(TimePoint now)
+{
+	const Frame frame = frames_.back();
+	frames_.pop_back();
+	const uint64_t elapsed = duration_cast<std::chrono::nanoseconds>(now - frame.begin).count();
+	Entry& entry = entries_[frame.entry];
+	entry.exclusive += elapsed > frame.children ? elapsed - frame.children : 0;
+	if (--entry.open == 0)
+	{
+		entry.inclusive += elapsed;
+	}
+	if (!frames_.empty())
+	{
+		Frame& parent = frames_.back();
+		parent.children += elapsed;
+		edges_[(uint64_t(parent.entry) << 32) | frame.entry].inclusive += elapsed;
+	}
+}
+
+size_t PawnProfiler::enterPublic(AMX* amx, int index)
+{
+	const size_t depth = frames_.size();
+	auto it = scripts_.find(amx);
+	if (it == scripts_.end())
+	{
+		return depth;
+	}
+	Script& script = it->second;
+	AMX_HEADER* hdr = reinterpret_cast<AMX_HEADER*>(amx->base);
+	const char* name = "main";
+	ucell address = hdr->cip;
+	if (index >= 0 && index < (cell)NUMENTRIES(hdr, publics, natives))
+	{
+		AMX_FUNCSTUB* func = GETENTRY(hdr, publics, index);
+		name = GETENTRYNAME(hdr, func);
+		address = func->address;
+	}
+	else if (index == AMX_EXEC_CONT)
+	{
+		name = "main (continued)";
+	}
+
+	ucell start = 0;
+	ucell end = std::numeric_limits<ucell>::max();
+	if (const Function* function = script.findFunction(address))
+	{
+		start = function->start;
+		end = function->end;
+	}
+	push(getEntry(amx, script, Kind::Public, uint32_t(index), name), amx, 0, start, end, true, Time::now());
+	return depth;
+}
+
+void PawnProfiler::leave(size_t depth)
+{
+	// The profiler may have been restarted from inside the call, leaving nothing to close.
+	if (!active_)
+	{
+		return;
+	}
+	const TimePoint now = Time::now();
+	while (frames_.size() > depth)
+	{
+		pop(now);
+	}
+}
+
+void PawnProfiler::onBreak(AMX* amx, Script& script)
+{
+	if (frames_.empty())
+	{
+		return;
+	}
+	const cell frm = amx->frm;
+	const ucell cip = amx->cip;
+	const TimePoint now = Time::now();
+	for (;;)
+	{
+		Frame& top = frames_.back();
+		if (top.amx != amx)
+		{
+			// Called from a native, or through a path that isn't profiled.
+			return;
+		}
+		if (top.frm == 0)
+		{
+			// The first `BREAK` in a public tells us where its frame is.
+			top.frm = frm;
+			return;
+		}
+		// A higher frame, or code outside the current function at the same depth, means it returned.
+		if (frm > top.frm || (frm == top.frm && (cip < top.start || cip >= top.end)))
+		{
+			if (top.isPublic)
+			{
+				return;
+			}
+			pop(now);
+			continue;
+		}
+		break;
+	}
+	if (frm < frames_.back().frm)
+	{
+		if (const Function* function = script.findFunction(cip))
+		{
+			push(getEntry(amx, script, Kind::Function, function->start, function->name), amx, frm, function->start, function->end, false, now);
+		}
+	}
+}
+
+int AMXAPI PawnProfiler::debugHook(AMX* amx)
+{
+	PawnProfiler* profiler = PawnProfiler::Get();
+	auto it = profiler->scripts_.find(amx);
+	if (it == profiler->scripts_.end())
+	{
+		return AMX_ERR_NONE;
+	}
+	const AMX_DEBUG next = it->second.prevDebug;
+	profiler->onBreak(amx, it->second);
+	return next ? next(amx) : AMX_ERR_NONE;
+}
+
+int AMXAPI PawnProfiler::nativeCallback(AMX* amx, cell index, cell* result, const cell* params)
+{
+	PawnProfiler* profiler = PawnProfiler::Get();
+	auto it = profiler->scripts_.find(amx);
+	if (it == profiler->scripts_.end())
+	{
+		return amx_Callback(amx, index, result, params);
+	}
+	// The native may load or unload scripts, so nothing from `it` is used after the call.
+	const AMX_CALLBACK next = it->second.prevCallback ? it->second.prevCallback : &amx_Callback;
+	const size_t depth = profiler->frames_.size();
+	profiler->push(profiler->getEntry(amx, it->second, Kind::Native, uint32_t(index), nullptr), nullptr, 0, 0, 0, false, Time::now());
+	const int ret = next(amx, index, result, params);
+	profiler->leave(depth);
+	return ret;
+}
+
+DynamicArray<String> PawnProfiler::stop(StringView name)
+{
+	DynamicArray<String> summary;
+	if (!active_)
+	{
+		summary.emplace_back("The profiler isn't running.");
+		return summary;
+	}
+	const TimePoint now = Time::now();
+	while (!frames_.empty())
+	{
+		pop(now);
+	}
+	while (!scripts_.empty())
+	{
+		AMX* amx = scripts_.begin()->first;
+		detach(amx);
+	}
+	active_ = false;
+
+	DynamicArray<uint32_t> order(entries_.size());
+	for (uint32_t i = 0; i != order.size(); ++i)
+	{
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+		{
+			return entries_[a].exclusive > entries_[b].exclusive;
+		});
+	uint64_t total = 0;
+	for (const Entry& entry : entries_)
+	{
+		total += entry.exclusive;
+	}
+
+	char line[512];
+	const String reportPath = String(name) + ".txt";
+	const String callgrindPath = "callgrind.out." + String(name);
+	const double seconds = duration_cast<std::chrono::duration<double>>(now - started_).count();
+
+	if (FILE* file = ::fopen(reportPath.c_str(), "w"))
+	{
+		fprintf(file, "Profiled for %.3fs, %.3fms spent in scripts.\n\n", seconds, total / 1000000.0);
+		fprintf(file, "%-9s %-24s %-40s %12s %14s %14s %12s %8s\n", "Type", "Script", "Name", "Calls", "Inclusive ms", "Exclusive ms", "Average us", "Self %");
+		for (uint32_t i : order)
+		{
+			const Entry& entry = entries_[i];
+			fprintf(file, "%-9s %-24s %-40s %12llu %14.3f %14.3f %12.3f %7.2f%%\n", kindName(entry.kind), entry.script.c_str(), entry.name.c_str(), static_cast<unsigned long long>(entry.calls), entry.inclusive / 1000000.0, entry.exclusive / 1000000.0, entry.calls ? entry.inclusive / 1000.0 / entry.calls : 0.0, total ? entry.exclusive * 100.0 / total : 0.0);
+		}
+		fclose(file);
+	}
+	else
+	{
+		summary.emplace_back("Could not write " + reportPath + ".");
+	}
+
+	if (FILE* file = ::fopen(callgrindPath.c_str(), "w"))
+	{
+		// Natives are put in a pseudo-file of their own so they group together in viewers.
+		auto fileName = [](const Entry& entry)
+		{
+			return entry.kind == Kind::Native ? "natives" : entry.script.c_str();
+		};
+		// Sorted by key puts every caller's calls together, in the same order as the entries.
+		DynamicArray<Pair<uint64_t, Edge>> edges(edges_.begin(), edges_.end());
+		std::sort(edges.begin(), edges.end(), [](const Pair<uint64_t, Edge>& a, const Pair<uint64_t, Edge>& b)
+			{
+				return a.first < b.first;
+			});
+		auto edge = edges.cbegin();
+		fprintf(file, "# callgrind format\nversion: 1\ncreator: open.mp pawn profiler\npositions: line\nevents: ns\nsummary: %llu\n", static_cast<unsigned long long>(total));
+		for (uint32_t i = 0; i != entries_.size(); ++i)
+		{
+			const Entry& entry = entries_[i];
+			fprintf(file, "\nfl=%s\nfn=%s %s\n0 %llu\n", fileName(entry), kindName(entry.kind), entry.name.c_str(), static_cast<unsigned long long>(entry.exclusive));
+			for (; edge != edges.cend() && (edge->first >> 32) == i; ++edge)
+			{
+				const Entry& callee = entries_[uint32_t(edge->first)];
+				fprintf(file, "cfl=%s\ncfn=%s %s\ncalls=%llu 0\n0 %llu\n", fileName(callee), kindName(callee.kind), callee.name.c_str(), static_cast<unsigned long long>(edge->second.calls), static_cast<unsigned long long>(edge->second.inclusive));
+			}
+		}
+		fclose(file);
+	}
+	else
+	{
+		summary.emplace_back("Could not write " + callgrindPath + ".");
+	}
+
+	snprintf(line, sizeof(line), "Profiled for %.3fs, %.3fms spent in scripts.  Top entries by exclusive time:", seconds, total / 1000000.0);
+	summary.emplace_back(line);
+	for (size_t i = 0; i != std::min<size_t>(order.size(), 10); ++i)
+	{
+		const Entry& entry = entries_[order[i]];
+		snprintf(line, sizeof(line), "  %6.2f%%  %10.3fms  %8llu calls  %s %s (%s)", total ? entry.exclusive * 100.0 / total : 0.0, entry.exclusive / 1000000.0, static_cast<unsigned long long>(entry.calls), kindName(entry.kind), entry.name.c_str(), entry.script.c_str());
+		summary.emplace_back(line);
+	}
+	summary.emplace_back("Full results written to " + reportPath + " and " + callgrindPath + ".");
+
+	entries_.clear();
+	edges_.clear();
+	return summary;
+}
@@ -0,0 +1,149 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include "Singleton.hpp"
+#include <sdk.hpp>
+#include <amx/amx.h>
+#include <amx/amxdbg.h>
+
+/// Records call counts and inclusive/exclusive time for every public, native and (when the script
+/// was compiled with debug information) internal function.  Nothing is hooked until `start()`, so
+/// while it is off the only cost is the `active()` check where publics are called.
+///
+/// Publics are timed where they are executed, natives by wrapping the AMX callback and internal
+/// functions by following the frame pointer from the AMX debug hook, which runs on every `BREAK`.
+/// Returns are only noticed at the next `BREAK` in the caller, so internal functions are slightly
+/// over-attributed at the expense of their callers.
+class PawnProfiler : public Singleton<PawnProfiler>
+{
+public:
+	enum class Kind : uint8_t
+	{
+		Public,
+		Native,
+		Function,
+	};
+
+	/// Profile a call made through `amx_Exec`, put around every place the server calls a public.
+	class PublicScope
+	{
+	private:
+		size_t depth_;
+
+	public:
+		PublicScope(AMX* amx, int index)
+			: depth_(SIZE_MAX)
+		{
+			PawnProfiler* profiler = PawnProfiler::Get();
+			if (profiler->active())
+			{
+				depth_ = profiler->enterPublic(amx, index);
+			}
+		}
+
+		~PublicScope()
+		{
+			if (depth_ != SIZE_MAX)
+			{
+				PawnProfiler::Get()->leave(depth_);
+			}
+		}
+	};
+
+	bool active() const
+	{
+		return active_;
+	}
+
+	/// Start counting, `attach()` every loaded script after this.
+	void start();
+
+	/// Unhook everything and write `<name>.txt` (a report sorted by exclusive time) and
+	/// `callgrind.out.<name>` (for KCachegrind and friends).
+	/// @returns A short summary for the console
+	DynamicArray<String> stop(StringView name);
+
+	/// Hook a script, either when starting or when it is loaded while the profiler is running.
+	void attach(AMX* amx, StringView name, StringView path);
+
+	/// Unhook a script that is being unloaded.  What was recorded for it is kept.
+	void detach(AMX* amx);
+
+private:
+	struct Function
+	{
+		ucell start;
+		ucell end;
+		const char* name;
+	};
+
+	struct Script
+	{
+		String name;
+		AMX_DBG dbg;
+		bool hasDebug = false;
+		/// Functions from the debug information, sorted by address.
+		DynamicArray<Function> functions;
+		AMX_DEBUG prevDebug = nullptr;
+		AMX_CALLBACK prevCallback = nullptr;
+		cell prevSysreqD = 0;
+		/// `Kind` and index (or address) to entry.
+		FlatHashMap<uint64_t, uint32_t> entries;
+
+		const Function* findFunction(ucell address) const;
+	};
+
+	struct Entry
+	{
+		Kind kind;
+		String script;
+		String name;
+		uint64_t calls = 0;
+		uint64_t inclusive = 0; ///< Nanoseconds, outermost calls only so recursion isn't counted twice
+		uint64_t exclusive = 0; ///< Nanoseconds
+		uint32_t open = 0; ///< Frames of this entry currently on the stack
+	};
+
+	struct Edge
+	{
+		uint64_t calls = 0;
+		uint64_t inclusive = 0;
+	};
+
+	struct Frame
+	{
+		uint32_t entry;
+		AMX* amx; ///< Null for natives, their `BREAK`s can't be told apart from the caller's
+		cell frm; ///< Zero until the first `BREAK` of a public is seen
+		ucell start;
+		ucell end;
+		bool isPublic;
+		TimePoint begin;
+		uint64_t children = 0;
+	};
+
+	bool active_ = false;
+	TimePoint started_;
+	FlatHashMap<AMX*, Script> scripts_;
+	DynamicArray<Entry> entries_;
+	FlatHashMap<uint64_t, Edge> edges_;
+	DynamicArray<Frame> frames_;
+
+	/// Find or add the entry for something in a script.  A null native name is looked up.
+	uint32_t getEntry(AMX* amx, Script& script, Kind kind, uint64_t id, const char* name);
+	void push(uint32_t entry, AMX* amx, cell frm, ucell start, ucell end, bool isPublic, TimePoint now);
+	void pop(TimePoint now);
+	size_t enterPublic(AMX* amx, int index);
+	void leave(size_t depth);
+	void onBreak(AMX* amx, Script& script);
+
+	static int AMXAPI debugHook(AMX* amx);
+	static int AMXAPI nativeCallback(AMX* amx, cell index, cell* result, const cell* params);
+};
@@ -0,0 +1,102 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#include "queries.hpp"
+
+bool PawnQueryImpl::queryAsync(IDatabaseConnection& connection, const char* callback, StringView query, AMX* amx)
+{
+	IDatabasesComponent* databases = PawnManager::Get()->databases;
+	IDatabasesExtension* async = databases ? queryExtension<IDatabasesExtension>(databases) : nullptr;
+	if (!async || !amx)
+	{
+		return false;
+	}
+
+	int callbackId;
+
+	// Also checking the callbackId value because SAMPGDK's FindPublic hook returns AMX_ERR_NONE.
+	if (amx_FindPublic(amx, callback, &callbackId) != AMX_ERR_NONE || callbackId == INT_MAX)
+	{
+		PawnManager::Get()->core->logLn(LogLevel::Warning, "db_query_async: \"public %s\" doesn't exist in your script.", callback);
+		return false;
+	}
+
+	PawnQueryHandler* handler = new PawnQueryHandler(amx, callbackId);
+	if (!async->executeQueryAsync(connection, query, *handler))
+	{
+		delete handler;
+		return false;
+	}
+	pending.insert(handler);
+	return true;
+}
+
+void PawnQueryImpl::cancelQueries(AMX* amx)
+{
+	for (PawnQueryHandler* handler : pending)
+	{
+		if (handler->amx == amx)
+		{
+			handler->amx = nullptr;
+		}
+	}
+}
+
+int PawnQueryImpl::queryCursor(IDatabaseConnection& connection, StringView query, AMX* amx)
+{
+	IDatabasesComponent* databases = PawnManager::Get()->databases;
+	IDatabasesExtension* ext = databases ? queryExtension<IDatabasesExtension>(databases) : nullptr;
+	IDatabaseResultSet* result = ext ? ext->executeQueryCursor(connection, query) : nullptr;
+	if (!result)
+	{
+		return 0;
+	}
+	cursors[result->getID()] = amx;
+	return result->getID();
+}
+
+void PawnQueryImpl::forgetCursor(int id)
+{
+	cursors.erase(id);
+}
+
+void PawnQueryImpl::forgetClosedCursors()
+{
+	IDatabasesComponent* databases = PawnManager::Get()->databases;
+	for (auto it = cursors.begin(); it != cursors.end();)
+	{
+		if (!databases || !databases->isDatabaseResultSetIDValid(it->first))
+		{
+			it = cursors.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void PawnQueryImpl::freeCursors(AMX* amx)
+{
+	IDatabasesComponent* databases = PawnManager::Get()->databases;
+	for (auto it = cursors.begin(); it != cursors.end();)
+	{
+		if (it->second == amx)
+		{
+			if (databases && databases->isDatabaseResultSetIDValid(it->first))
+			{
+				databases->freeResultSet(databases->getDatabaseResultSetByID(it->first));
+			}
+			it = cursors.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
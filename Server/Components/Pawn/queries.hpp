@@ -0,0 +1,78 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include "Manager/Manager.hpp"
+#include <amx/amx.h>
+#include <database_ext.hpp>
+
+struct PawnQueryHandler;
+
+struct PawnQueryImpl : public Singleton<PawnQueryImpl>
+{
+	friend struct PawnQueryHandler;
+
+	/// Run a query off the main thread and call `callback` in the script with the result set.
+	bool queryAsync(IDatabaseConnection& connection, const char* callback, StringView query, AMX* amx);
+
+	/// Drop the callbacks of a script's outstanding queries, their results are freed on arrival.
+	void cancelQueries(AMX* amx);
+
+	/// Run a query as a cursor owned by `amx`, which reads rows as the script asks for them.
+	/// @returns The result set ID, or 0 on error
+	int queryCursor(IDatabaseConnection& connection, StringView query, AMX* amx);
+
+	/// Stop tracking a result set that is about to be freed, if it's a cursor.
+	void forgetCursor(int id);
+
+	/// Stop tracking cursors freed along with a closed connection.
+	void forgetClosedCursors();
+
+	/// Free the cursors a script left open, so their statements don't outlive it.
+	void freeCursors(AMX* amx);
+
+private:
+	FlatHashSet<PawnQueryHandler*> pending;
+	/// Open cursors by result set ID, and the script that opened them.
+	FlatHashMap<int, AMX*> cursors;
+};
+
+struct PawnQueryHandler final : IDatabaseQueryHandler
+{
+	AMX* amx;
+	int callback;
+
+	PawnQueryHandler(AMX* amx, int callback)
+		: amx(amx)
+		, callback(callback)
+	{
+	}
+
+	void onQueryResult(IDatabaseResultSet* result) override
+	{
+		PawnQueryImpl::Get()->pending.erase(this);
+		// Queries left over when the databases component is freed fail with no script to tell, and
+		// the manager may already be destroyed by then.
+		if (amx || result)
+		{
+			PawnManager* mgr = PawnManager::Get();
+			auto script = amx ? mgr->amxToScript_.find(amx) : mgr->amxToScript_.end();
+			if (script != mgr->amxToScript_.end())
+			{
+				// A failed query is reported with an invalid result, the script owns any valid one.
+				script->second->Call(callback, DefaultReturnValue_False, result ? result->getID() : 0);
+			}
+			else if (result && mgr->databases)
+			{
+				mgr->databases->freeResultSet(*result);
+			}
+		}
+		delete this;
+	}
+};
@@ -23,7 +23,7 @@ Pair<size_t, PawnTimerHandler*> PawnTimerImpl::newTimer(const char* callback, Mi
 			return std::make_pair(0u, static_cast<PawnTimerHandler*>(nullptr));
 		}
 
-		PawnTimerHandler* handler = new PawnTimerHandler(callback, amx);
+		PawnTimerHandler* handler = new PawnTimerHandler(callback, callbackId, amx);
 		ITimer* timer = timers->create(handler, interval, repeating);
 		if (timer == nullptr)
 		{
@@ -51,7 +51,6 @@ int PawnTimerImpl::setTimerEx(const char* callback, Milliseconds interval, bool
 	if (res.second)
 	{
 		int err = AMX_ERR_NONE;
-		handler->fmt = fmt;
 
 		cell* data;
 		cell* len1;
@@ -110,6 +109,7 @@ int PawnTimerImpl::setTimerEx(const char* callback, Milliseconds interval, bool
 				break;
 			}
 		}
+		handler->prepare(fmt);
 	}
 	return res.first;
 }
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "Manager/Manager.hpp"
+#include "profiler.hpp"
 #include <Impl/pool_impl.hpp>
 #include <amx/amx.h>
 
@@ -81,18 +82,67 @@ private:
 
 struct PawnTimerHandler final : TimerTimeOutHandler, PoolIDProvider
 {
+	/// Kept between the heap and the stack by `amx_Push`, which we bypass.
+	static constexpr cell StackMargin = 16 * sizeof(cell);
+
 	AMX* amx;
+	/// Public index, resolved once when the timer is made.  Timers die with their script, so it
+	/// can't go stale.
+	int funcidx;
 	HybridString<sNAMEMAX + 1> callback;
-	HybridString<64> fmt;
+	/// Parameters in the order they end up on the stack, first parameter first.
 	DynamicArray<cell> params;
+	/// Indices of `params` holding offsets into `data`, which become heap addresses when called.
+	DynamicArray<uint32_t> relocations;
+	/// Offsets into `data` of reference parameters, copied back after the call.
+	DynamicArray<cell> references;
 	DynamicArray<cell> data;
 
-	PawnTimerHandler(String callback, AMX* amx)
+	PawnTimerHandler(String callback, int funcidx, AMX* amx)
 		: amx(amx)
+		, funcidx(funcidx)
 		, callback(callback)
 	{
 	}
 
+	/// Work out which parameters need fixing up per call, once all of them have been collected.
+	void prepare(const char* fmt)
+	{
+		for (size_t i = 0, len = params.size(); i != len; ++i)
+		{
+			switch (fmt[i])
+			{
+			case 'v':
+				references.push_back(params[i]);
+				// Fallthrough.
+			case 'a':
+			case 's':
+				relocations.push_back(i);
+				break;
+			}
+		}
+	}
+
+	/// Copy the whole parameter block on to the stack at once, instead of one `amx_Push` each.
+	int pushParams(cell heap)
+	{
+		const cell size = params.size() * sizeof(cell);
+		if (amx->hea + StackMargin > amx->stk - size)
+		{
+			return AMX_ERR_STACKERR;
+		}
+		unsigned char* base = amx->data ? amx->data : amx->base + reinterpret_cast<AMX_HEADER*>(amx->base)->dat;
+		amx->stk -= size;
+		amx->paramcount += params.size();
+		cell* stk = reinterpret_cast<cell*>(base + amx->stk);
+		memcpy(stk, params.data(), size);
+		for (uint32_t i : relocations)
+		{
+			stk[i] += heap;
+		}
+		return AMX_ERR_NONE;
+	}
+
 	void timeout(ITimer& timer) override
 	{
 		if (!amx)
@@ -100,7 +150,7 @@ struct PawnTimerHandler final : TimerTimeOutHandler, PoolIDProvider
 			return;
 		}
 
-		const bool hasParams = !fmt.empty();
+		const bool hasParams = !params.empty();
 
 		// Call it.
 		// First copy all the data in to the heap.
@@ -123,40 +173,23 @@ struct PawnTimerHandler final : TimerTimeOutHandler, PoolIDProvider
 				// Push the parameters (many all at once).
 				memcpy(in, data.data(), data.size() * sizeof(cell));
 			}
-			for (size_t i = params.size(); i--;)
+			if ((err = pushParams(out)) != AMX_ERR_NONE)
 			{
-				switch (fmt[i])
-				{
-				case 'a':
-				case 's':
-				case 'v':
-					// Copy the data in to the heap, then push the address relative to DAT.
-					amx_Push(amx, out + params[i]);
-					break;
-				default:
-					// Just push the address.
-					amx_Push(amx, params[i]);
-					break;
-				}
+				PawnManager::Get()->core->logLn(LogLevel::Error, "SetTimer(Ex): Not enough space on stack for %.*s timer: %s", PRINT_VIEW(callback), aux_StrError(err));
+				amx_Release(amx, out);
+				return;
 			}
 		}
 
-		int funcidx;
+		OMP_TRACE_SCOPE(PawnManager::Get()->trace, TraceCategory::Public, callback.data());
+		PawnProfiler::PublicScope profile(amx, funcidx);
 		// Step 4: Call the function.
-		if ((err = amx_FindPublic(amx, callback.data(), &funcidx)) == AMX_ERR_NONE && (err = amx_Exec(amx, &ret, funcidx)) == AMX_ERR_NONE)
+		if ((err = PawnManager::Get()->Exec(amx, &ret, funcidx)) == AMX_ERR_NONE)
 		{
-			if (hasParams)
+			// Step 5: Retrieve reference parameters.
+			for (cell offset : references)
 			{
-				// Step 5: Retrieve reference parameters.
-				for (size_t i = 0, len = params.size(); i != len; ++i)
-				{
-					switch (fmt[i])
-					{
-					case 'v':
-						data[params[i] / sizeof(cell)] = *((char*)in + params[i]);
-						break;
-					}
-				}
+				data[offset / sizeof(cell)] = in[offset / sizeof(cell)];
 			}
 		}
 		else
@@ -14,6 +14,7 @@
 #include <iostream>
 
 #include "format.hpp"
+#include "queries.hpp"
 #include "timers.hpp"
 
 extern "C"
@@ -324,7 +325,7 @@ inline cell AMX_NATIVE_CALL pawn_Script_Call(AMX* amx, cell const* params)
 	cell
 		ret
 		= 0;
-	if (amx_Exec(amx, &ret, index) != AMX_ERR_NONE)
+	if (PawnManager::Get()->Exec(amx, &ret, index) != AMX_ERR_NONE)
 	{
 		ret = 0;
 	}
@@ -393,7 +394,7 @@ inline cell AMX_NATIVE_CALL pawn_Script_CallByIndex(AMX* amx, cell const* params
 	cell
 		ret
 		= 0;
-	if (amx_Exec(amx, &ret, index) != AMX_ERR_NONE)
+	if (PawnManager::Get()->Exec(amx, &ret, index) != AMX_ERR_NONE)
 	{
 		ret = 0;
 	}
@@ -472,7 +473,7 @@ inline cell AMX_NATIVE_CALL pawn_Script_CallOne(AMX* amx, cell const* params)
 	cell
 		ret
 		= 0;
-	if (amx_Exec(amx, &ret, index) != AMX_ERR_NONE)
+	if (PawnManager::Get()->Exec(amx, &ret, index) != AMX_ERR_NONE)
 	{
 		ret = 0;
 	}
@@ -547,7 +548,7 @@ inline cell AMX_NATIVE_CALL pawn_Script_CallOneByIndex(AMX* amx, cell const* par
 	cell
 		ret
 		= 0;
-	if (amx_Exec(amx, &ret, index) != AMX_ERR_NONE)
+	if (PawnManager::Get()->Exec(amx, &ret, index) != AMX_ERR_NONE)
 	{
 		ret = 0;
 	}
@@ -688,7 +689,7 @@ inline cell AMX_NATIVE_CALL pawn_Script_CallAll(AMX* amx, cell const* params)
 				}
 			}
 			// Step 4: Call the function.
-			if (amx_Exec(amx, &ret, index) != AMX_ERR_NONE)
+			if (PawnManager::Get()->Exec(amx, &ret, index) != AMX_ERR_NONE)
 				goto pawn_CallRemoteFunction_gmnext;
 			// Step 5: Copy the reference parameters back out again.
 			for (size_t j = 0; fmat[j]; ++j)
@@ -753,7 +754,7 @@ pawn_CallRemoteFunction_gmnext:
 				}
 			}
 			// Step 4: Call the function.
-			if (amx_Exec(amx, &ret, index) != AMX_ERR_NONE)
+			if (PawnManager::Get()->Exec(amx, &ret, index) != AMX_ERR_NONE)
 				goto pawn_CallRemoteFunction_fsnext;
 			// Step 5: Copy the reference parameters back out again.
 			for (size_t j = 0; fmat[j]; ++j)
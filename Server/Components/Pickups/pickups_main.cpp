@@ -9,11 +9,12 @@
 #include "pickup.hpp"
 #include <Impl/events_impl.hpp>
 #include <legacy_id_mapper.hpp>
+#include <allocations.hpp>
 
 using namespace Impl;
 
 // TODO: This internal/external IDs mapping code should be extracted for other components to use.
-class PlayerPickupData final : public IPlayerPickupData
+class PlayerPickupData final : public IPlayerPickupData, public TrackedAllocation<PlayerPickupData>
 {
 private:
 	FiniteLegacyIDMapper<PICKUP_POOL_SIZE>
@@ -92,7 +93,7 @@ public:
 	}
 };
 
-class PickupsComponent final : public IPickupsComponent, public PlayerConnectEventHandler, public PlayerUpdateEventHandler, public PoolEventHandler<IPlayer>
+class PickupsComponent final : public IPickupsComponent, public PlayerConnectEventHandler, public PlayerUpdateEventHandler, public PoolEventHandler<IPlayer>, public TrackedAllocation<PickupsComponent>
 {
 private:
 	ICore* core = nullptr;
@@ -335,6 +336,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new PickupsComponent();
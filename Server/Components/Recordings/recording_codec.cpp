@@ -0,0 +1,449 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#include "recording_codec.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace RecordingFormat;
+
+namespace
+{
+constexpr FieldKind OnFootKinds[] = {
+	FieldKind::Integer, // leftRight
+	FieldKind::Integer, // upDown
+	FieldKind::Integer, // keys
+	FieldKind::Position, FieldKind::Position, FieldKind::Position,
+	FieldKind::Rotation, FieldKind::Rotation, FieldKind::Rotation, FieldKind::Rotation,
+	FieldKind::Integer, // health
+	FieldKind::Integer, // armour
+	FieldKind::Integer, // weaponAdditionalKey
+	FieldKind::Integer, // specialAction
+	FieldKind::Velocity, FieldKind::Velocity, FieldKind::Velocity,
+	FieldKind::Offset, FieldKind::Offset, FieldKind::Offset,
+	FieldKind::Integer, // surfingID
+	FieldKind::Integer, // animationID
+	FieldKind::Integer, // animationFlags
+};
+
+constexpr FieldKind DriverKinds[] = {
+	FieldKind::Integer, // vehicleID
+	FieldKind::Integer, // leftRight
+	FieldKind::Integer, // upDown
+	FieldKind::Integer, // keys
+	FieldKind::Rotation, FieldKind::Rotation, FieldKind::Rotation, FieldKind::Rotation,
+	FieldKind::Position, FieldKind::Position, FieldKind::Position,
+	FieldKind::Velocity, FieldKind::Velocity, FieldKind::Velocity,
+	FieldKind::Health, // vehicleHealth
+	FieldKind::Integer, // playerHealth
+	FieldKind::Integer, // playerArmour
+	FieldKind::Integer, // additionalKeyWeapon
+	FieldKind::Integer, // siren
+	FieldKind::Integer, // landingGear
+	FieldKind::Integer, // trailerID
+	FieldKind::Integer, // hydraThrustAngle
+};
+
+static_assert(sizeof(OnFootKinds) / sizeof(FieldKind) <= MaxFields, "Too many on foot fields");
+static_assert(sizeof(DriverKinds) / sizeof(FieldKind) <= MaxFields, "Too many driver fields");
+
+const FieldLayout OnFootLayout { OnFootKinds, sizeof(OnFootKinds) / sizeof(FieldKind) };
+const FieldLayout DriverLayout { DriverKinds, sizeof(DriverKinds) / sizeof(FieldKind) };
+
+float getScale(FieldKind kind)
+{
+	switch (kind)
+	{
+	case FieldKind::Position:
+	case FieldKind::Offset:
+		return 1000.0f;
+	case FieldKind::Rotation:
+	case FieldKind::Velocity:
+		return 10000.0f;
+	case FieldKind::Health:
+		return 10.0f;
+	default:
+		return 1.0f;
+	}
+}
+
+int32_t quantize(float value, FieldKind kind)
+{
+	const float scaled = value * getScale(kind);
+	// Also catches NaN, which would otherwise be undefined to convert.
+	if (!(scaled > -2147483520.0f && scaled < 2147483520.0f))
+	{
+		return 0;
+	}
+	return static_cast<int32_t>(std::lround(scaled));
+}
+
+float dequantize(int32_t value, FieldKind kind)
+{
+	return static_cast<float>(value) / getScale(kind);
+}
+
+// Records are packed, so their float arrays are copied rather than referenced.
+void putFloats(const void* values, size_t count, const FieldKind* kinds, int32_t* fields, size_t& i)
+{
+	for (size_t n = 0; n != count; ++n, ++i)
+	{
+		float value;
+		std::memcpy(&value, static_cast<const char*>(values) + n * sizeof(float), sizeof(float));
+		fields[i] = quantize(value, kinds[i]);
+	}
+}
+
+void getFloats(void* values, size_t count, const FieldKind* kinds, const int32_t* fields, size_t& i)
+{
+	for (size_t n = 0; n != count; ++n, ++i)
+	{
+		const float value = dequantize(fields[i], kinds[i]);
+		std::memcpy(static_cast<char*>(values) + n * sizeof(float), &value, sizeof(float));
+	}
+}
+
+/// Value a field is expected to have, differences are worked out with wrapping so nothing overflows
+uint32_t predict(FieldKind kind, int32_t previous, int32_t beforePrevious)
+{
+	if (kind == FieldKind::Position)
+	{
+		return 2u * static_cast<uint32_t>(previous) - static_cast<uint32_t>(beforePrevious);
+	}
+	return static_cast<uint32_t>(previous);
+}
+
+uint32_t zigzag(int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+int32_t unzigzag(uint32_t value)
+{
+	return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1)));
+}
+
+void writeVarint(uint64_t value, uint8_t*& out)
+{
+	while (value >= 0x80)
+	{
+		*out++ = static_cast<uint8_t>(value) | 0x80;
+		value >>= 7;
+	}
+	*out++ = static_cast<uint8_t>(value);
+}
+
+bool readVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (in == end)
+		{
+			return false;
+		}
+		const uint8_t byte = *in++;
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+}
+
+const FieldLayout& FieldLayout::get(PlayerRecordingType type)
+{
+	return type == PlayerRecordingType_Driver ? DriverLayout : OnFootLayout;
+}
+
+void FieldLayout::toFields(const OnFootRecord& record, int32_t* fields)
+{
+	const FieldKind* kinds = OnFootKinds;
+	size_t i = 0;
+	fields[i++] = record.leftRight;
+	fields[i++] = record.upDown;
+	fields[i++] = record.keys;
+	putFloats(record.position, sizeof(record.position) / sizeof(float), kinds, fields, i);
+	putFloats(record.rotation, sizeof(record.rotation) / sizeof(float), kinds, fields, i);
+	fields[i++] = record.health;
+	fields[i++] = record.armour;
+	fields[i++] = record.weaponAdditionalKey;
+	fields[i++] = record.specialAction;
+	putFloats(record.velocity, sizeof(record.velocity) / sizeof(float), kinds, fields, i);
+	putFloats(record.surfingOffset, sizeof(record.surfingOffset) / sizeof(float), kinds, fields, i);
+	fields[i++] = record.surfingID;
+	fields[i++] = record.animationID;
+	fields[i++] = record.animationFlags;
+}
+
+void FieldLayout::toFields(const DriverRecord& record, int32_t* fields)
+{
+	const FieldKind* kinds = DriverKinds;
+	size_t i = 0;
+	fields[i++] = record.vehicleID;
+	fields[i++] = record.leftRight;
+	fields[i++] = record.upDown;
+	fields[i++] = record.keys;
+	putFloats(record.rotation, sizeof(record.rotation) / sizeof(float), kinds, fields, i);
+	putFloats(record.position, sizeof(record.position) / sizeof(float), kinds, fields, i);
+	putFloats(record.velocity, sizeof(record.velocity) / sizeof(float), kinds, fields, i);
+	fields[i] = quantize(record.vehicleHealth, kinds[i]);
+	++i;
+	fields[i++] = record.playerHealth;
+	fields[i++] = record.playerArmour;
+	fields[i++] = record.additionalKeyWeapon;
+	fields[i++] = record.siren;
+	fields[i++] = record.landingGear;
+	fields[i++] = record.trailerID;
+	fields[i++] = static_cast<int32_t>(record.hydraThrustAngle);
+}
+
+void FieldLayout::fromFields(const int32_t* fields, uint32_t time, OnFootRecord& record)
+{
+	const FieldKind* kinds = OnFootKinds;
+	size_t i = 0;
+	record.time = time;
+	record.leftRight = static_cast<uint16_t>(fields[i++]);
+	record.upDown = static_cast<uint16_t>(fields[i++]);
+	record.keys = static_cast<uint16_t>(fields[i++]);
+	getFloats(record.position, sizeof(record.position) / sizeof(float), kinds, fields, i);
+	getFloats(record.rotation, sizeof(record.rotation) / sizeof(float), kinds, fields, i);
+	record.health = static_cast<uint8_t>(fields[i++]);
+	record.armour = static_cast<uint8_t>(fields[i++]);
+	record.weaponAdditionalKey = static_cast<uint8_t>(fields[i++]);
+	record.specialAction = static_cast<uint8_t>(fields[i++]);
+	getFloats(record.velocity, sizeof(record.velocity) / sizeof(float), kinds, fields, i);
+	getFloats(record.surfingOffset, sizeof(record.surfingOffset) / sizeof(float), kinds, fields, i);
+	record.surfingID = static_cast<uint16_t>(fields[i++]);
+	record.animationID = static_cast<uint16_t>(fields[i++]);
+	record.animationFlags = static_cast<uint16_t>(fields[i++]);
+}
+
+void FieldLayout::fromFields(const int32_t* fields, uint32_t time, DriverRecord& record)
+{
+	const FieldKind* kinds = DriverKinds;
+	size_t i = 0;
+	record.time = time;
+	record.vehicleID = static_cast<uint16_t>(fields[i++]);
+	record.leftRight = static_cast<uint16_t>(fields[i++]);
+	record.upDown = static_cast<uint16_t>(fields[i++]);
+	record.keys = static_cast<uint16_t>(fields[i++]);
+	getFloats(record.rotation, sizeof(record.rotation) / sizeof(float), kinds, fields, i);
+	getFloats(record.position, sizeof(record.position) / sizeof(float), kinds, fields, i);
+	getFloats(record.velocity, sizeof(record.velocity) / sizeof(float), kinds, fields, i);
+	record.vehicleHealth = dequantize(fields[i], kinds[i]);
+	++i;
+	record.playerHealth = static_cast<uint8_t>(fields[i++]);
+	record.playerArmour = static_cast<uint8_t>(fields[i++]);
+	record.additionalKeyWeapon = static_cast<uint8_t>(fields[i++]);
+	record.siren = static_cast<uint8_t>(fields[i++]);
+	record.landingGear = static_cast<uint8_t>(fields[i++]);
+	record.trailerID = static_cast<uint16_t>(fields[i++]);
+	record.hydraThrustAngle = static_cast<uint32_t>(fields[i++]);
+}
+
+RecordingEncoder::RecordingEncoder(PlayerRecordingType type)
+	: layout_(FieldLayout::get(type))
+{
+}
+
+size_t RecordingEncoder::encode(const OnFootRecord& record, uint8_t* out)
+{
+	int32_t fields[MaxFields];
+	FieldLayout::toFields(record, fields);
+	return encode(record.time, fields, out);
+}
+
+size_t RecordingEncoder::encode(const DriverRecord& record, uint8_t* out)
+{
+	int32_t fields[MaxFields];
+	FieldLayout::toFields(record, fields);
+	return encode(record.time, fields, out);
+}
+
+size_t RecordingEncoder::encode(uint32_t time, const int32_t* fields, uint8_t* out)
+{
+	uint8_t* const start = out;
+	const bool keyframe = !started_ || time < time_ || time - keyframeTime_ >= KeyframeInterval || framesSinceKeyframe_ >= KeyframeFrames;
+
+	if (keyframe)
+	{
+		writeVarint((static_cast<uint64_t>(time) << 1) | 1, out);
+		for (size_t i = 0; i != layout_.count; ++i)
+		{
+			writeVarint(zigzag(fields[i]), out);
+			previous_[i] = fields[i];
+			beforePrevious_[i] = fields[i];
+		}
+		keyframeTime_ = time;
+		framesSinceKeyframe_ = 0;
+	}
+	else
+	{
+		writeVarint(static_cast<uint64_t>(time - time_) << 1, out);
+
+		uint32_t mask = 0;
+		int32_t residuals[MaxFields];
+		for (size_t i = 0; i != layout_.count; ++i)
+		{
+			residuals[i] = static_cast<int32_t>(static_cast<uint32_t>(fields[i]) - predict(layout_.kinds[i], previous_[i], beforePrevious_[i]));
+			if (residuals[i] != 0)
+			{
+				mask |= 1u << i;
+			}
+		}
+		writeVarint(mask, out);
+		for (size_t i = 0; i != layout_.count; ++i)
+		{
+			if (mask & (1u << i))
+			{
+				writeVarint(zigzag(residuals[i]), out);
+			}
+			beforePrevious_[i] = previous_[i];
+			previous_[i] = fields[i];
+		}
+		++framesSinceKeyframe_;
+	}
+
+	time_ = time;
+	started_ = true;
+	return out - start;
+}
+
+RecordingDecoder::RecordingDecoder(PlayerRecordingType type, const char* data, size_t size)
+	: layout_(FieldLayout::get(type))
+	, begin_(reinterpret_cast<const uint8_t*>(data))
+	, end_(begin_ + size)
+{
+	rewind();
+}
+
+void RecordingDecoder::rewind()
+{
+	state_.position = begin_;
+	state_.time = 0;
+}
+
+bool RecordingDecoder::decode()
+{
+	const uint8_t* in = state_.position;
+	uint64_t header;
+	if (!readVarint(in, end_, header))
+	{
+		return false;
+	}
+
+	// Decoded into copies so a frame cut short by a crash while recording changes nothing.
+	int32_t previous[MaxFields];
+	int32_t beforePrevious[MaxFields];
+	uint32_t time;
+	if (header & 1)
+	{
+		time = static_cast<uint32_t>(header >> 1);
+		for (size_t i = 0; i != layout_.count; ++i)
+		{
+			uint64_t value;
+			if (!readVarint(in, end_, value))
+			{
+				return false;
+			}
+			previous[i] = unzigzag(static_cast<uint32_t>(value));
+			beforePrevious[i] = previous[i];
+		}
+
+		const size_t offset = state_.position - begin_;
+		if (keyframes_.empty() || keyframes_.back().second < offset)
+		{
+			keyframes_.emplace_back(time, offset);
+		}
+	}
+	else
+	{
+		time = state_.time + static_cast<uint32_t>(header >> 1);
+		uint64_t mask;
+		if (!readVarint(in, end_, mask))
+		{
+			return false;
+		}
+		for (size_t i = 0; i != layout_.count; ++i)
+		{
+			uint32_t value = predict(layout_.kinds[i], state_.previous[i], state_.beforePrevious[i]);
+			if (mask & (1u << i))
+			{
+				uint64_t residual;
+				if (!readVarint(in, end_, residual))
+				{
+					return false;
+				}
+				value += static_cast<uint32_t>(unzigzag(static_cast<uint32_t>(residual)));
+			}
+			previous[i] = static_cast<int32_t>(value);
+			beforePrevious[i] = state_.previous[i];
+		}
+	}
+
+	state_.position = in;
+	state_.time = time;
+	std::copy_n(previous, layout_.count, state_.previous);
+	std::copy_n(beforePrevious, layout_.count, state_.beforePrevious);
+	return true;
+}
+
+bool RecordingDecoder::next(OnFootRecord& record)
+{
+	if (!decode())
+	{
+		return false;
+	}
+	FieldLayout::fromFields(state_.previous, state_.time, record);
+	return true;
+}
+
+bool RecordingDecoder::next(DriverRecord& record)
+{
+	if (!decode())
+	{
+		return false;
+	}
+	FieldLayout::fromFields(state_.previous, state_.time, record);
+	return true;
+}
+
+void RecordingDecoder::seek(uint32_t time)
+{
+	auto keyframe = std::upper_bound(keyframes_.begin(), keyframes_.end(), time, [](uint32_t time, const Pair<uint32_t, size_t>& entry)
+		{
+			return time < entry.first;
+		});
+	if (keyframe == keyframes_.begin())
+	{
+		rewind();
+	}
+	else
+	{
+		--keyframe;
+		// Carry on from where it is if that's already past the keyframe and not past the time.
+		const size_t offset = state_.position - begin_;
+		if (offset < keyframe->second || state_.time >= time)
+		{
+			state_.position = begin_ + keyframe->second;
+		}
+	}
+
+	for (;;)
+	{
+		const State saved = state_;
+		if (!decode() || state_.time >= time)
+		{
+			state_ = saved;
+			break;
+		}
+	}
+}
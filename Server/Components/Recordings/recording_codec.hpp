@@ -0,0 +1,130 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include "recording_format.hpp"
+
+/// The compact recording format.  After the usual header, with `CompactVersion` as the version, each
+/// record is a frame:
+///
+/// - A varint of the time shifted left by one, the low bit set for keyframes.  Keyframes hold the
+///   time since the recording started, other frames the time since the previous frame.
+/// - Keyframes then hold every field as a zigzag varint.
+/// - Other frames hold a varint mask of the fields that differ from what was predicted, followed by
+///   each of those differences as a zigzag varint.  Positions are predicted to carry on moving as
+///   they did over the last two frames, everything else to stay the same.
+///
+/// Floats are stored as fixed point: positions and offsets to the millimetre, rotations and
+/// velocities to 1/10000 and vehicle health to 1/10.
+namespace RecordingFormat
+{
+static constexpr uint32_t CompactVersion = 2000;
+
+/// Longest time between keyframes, in milliseconds
+static constexpr uint32_t KeyframeInterval = 1000;
+
+/// Most frames between keyframes
+static constexpr uint32_t KeyframeFrames = 128;
+
+/// Most fields in a record
+static constexpr size_t MaxFields = 23;
+
+/// Largest a frame can get
+static constexpr size_t MaxFrameSize = 10 + 5 + MaxFields * 5;
+
+/// How a field is stored
+enum class FieldKind : uint8_t
+{
+	Integer,
+	Position,
+	Offset,
+	Rotation,
+	Velocity,
+	Health,
+};
+
+/// Turns records into fields and back
+struct FieldLayout
+{
+	const FieldKind* kinds;
+	size_t count;
+
+	static const FieldLayout& get(PlayerRecordingType type);
+
+	static void toFields(const OnFootRecord& record, int32_t* fields);
+	static void toFields(const DriverRecord& record, int32_t* fields);
+	static void fromFields(const int32_t* fields, uint32_t time, OnFootRecord& record);
+	static void fromFields(const int32_t* fields, uint32_t time, DriverRecord& record);
+};
+}
+
+/// Turns records into compact frames, on the main thread as they are recorded
+class RecordingEncoder final
+{
+private:
+	const RecordingFormat::FieldLayout& layout_;
+	int32_t previous_[RecordingFormat::MaxFields] = {};
+	int32_t beforePrevious_[RecordingFormat::MaxFields] = {};
+	uint32_t time_ = 0;
+	uint32_t keyframeTime_ = 0;
+	uint32_t framesSinceKeyframe_ = 0;
+	bool started_ = false;
+
+	size_t encode(uint32_t time, const int32_t* fields, uint8_t* out);
+
+public:
+	explicit RecordingEncoder(PlayerRecordingType type);
+
+	/// Writes a frame
+	/// @param out At least `MaxFrameSize` bytes
+	/// @returns Bytes written
+	size_t encode(const RecordingFormat::OnFootRecord& record, uint8_t* out);
+	size_t encode(const RecordingFormat::DriverRecord& record, uint8_t* out);
+};
+
+/// Reads compact frames back into records
+class RecordingDecoder final
+{
+private:
+	/// Everything needed to carry on decoding from a frame
+	struct State
+	{
+		const uint8_t* position;
+		uint32_t time;
+		int32_t previous[RecordingFormat::MaxFields];
+		int32_t beforePrevious[RecordingFormat::MaxFields];
+	};
+
+	const RecordingFormat::FieldLayout& layout_;
+	const uint8_t* begin_;
+	const uint8_t* end_;
+	State state_;
+
+	/// Times and offsets of the keyframes decoded so far, in order
+	DynamicArray<Pair<uint32_t, size_t>> keyframes_;
+
+	/// Decodes the next frame into `state_`
+	/// @returns "false" at the end of the file or at a broken frame
+	bool decode();
+
+public:
+	RecordingDecoder(PlayerRecordingType type, const char* data, size_t size);
+
+	/// Reads the next record
+	/// @returns "false" once there are none left
+	bool next(RecordingFormat::OnFootRecord& record);
+	bool next(RecordingFormat::DriverRecord& record);
+
+	/// Goes back to the first record
+	void rewind();
+
+	/// Moves on or back so the next record is the first one at or after a time.  Starts from the
+	/// closest keyframe seen so far, so seeking back costs no more than one keyframe interval.
+	void seek(uint32_t time);
+};
@@ -0,0 +1,115 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+#include <netcode.hpp>
+#include <cstring>
+
+/// Layout of `.rec` files, as written by SA-MP.  A header is followed by one record per sync packet,
+/// all little endian and without padding.  `recording_codec.hpp` has the compact format, which shares the
+/// header and stores the same records.
+namespace RecordingFormat
+{
+static constexpr uint32_t Version = 1000;
+
+#pragma pack(push, 1)
+struct Header
+{
+	uint32_t version;
+	uint32_t type;
+};
+
+struct OnFootRecord
+{
+	uint32_t time; ///< Milliseconds since the recording started
+	uint16_t leftRight;
+	uint16_t upDown;
+	uint16_t keys;
+	float position[3];
+	float rotation[4];
+	uint8_t health;
+	uint8_t armour;
+	uint8_t weaponAdditionalKey;
+	uint8_t specialAction;
+	float velocity[3];
+	float surfingOffset[3];
+	uint16_t surfingID;
+	uint16_t animationID;
+	uint16_t animationFlags;
+
+	OnFootRecord() = default;
+
+	OnFootRecord(uint32_t time, const NetCode::Packet::PlayerFootSync& sync)
+		: time(time)
+		, leftRight(sync.LeftRight)
+		, upDown(sync.UpDown)
+		, keys(sync.Keys)
+		, health(static_cast<uint8_t>(sync.HealthArmour.x))
+		, armour(static_cast<uint8_t>(sync.HealthArmour.y))
+		, weaponAdditionalKey(sync.WeaponAdditionalKey)
+		, specialAction(sync.SpecialAction)
+		, surfingID(static_cast<uint16_t>(sync.SurfingData.ID))
+		, animationID(sync.AnimationID)
+		, animationFlags(sync.AnimationFlags)
+	{
+		std::memcpy(position, &sync.Position, sizeof(position));
+		std::memcpy(rotation, &sync.Rotation, sizeof(rotation));
+		std::memcpy(velocity, &sync.Velocity, sizeof(velocity));
+		std::memcpy(surfingOffset, &sync.SurfingData.offset, sizeof(surfingOffset));
+	}
+};
+
+struct DriverRecord
+{
+	uint32_t time; ///< Milliseconds since the recording started
+	uint16_t vehicleID;
+	uint16_t leftRight;
+	uint16_t upDown;
+	uint16_t keys;
+	float rotation[4];
+	float position[3];
+	float velocity[3];
+	float vehicleHealth;
+	uint8_t playerHealth;
+	uint8_t playerArmour;
+	uint8_t additionalKeyWeapon;
+	uint8_t siren;
+	uint8_t landingGear;
+	uint16_t trailerID;
+	uint32_t hydraThrustAngle;
+
+	DriverRecord() = default;
+
+	DriverRecord(uint32_t time, const NetCode::Packet::PlayerVehicleSync& sync)
+		: time(time)
+		, vehicleID(sync.VehicleID)
+		, leftRight(sync.LeftRight)
+		, upDown(sync.UpDown)
+		, keys(sync.Keys)
+		, vehicleHealth(sync.Health)
+		, playerHealth(static_cast<uint8_t>(sync.PlayerHealthArmour.x))
+		, playerArmour(static_cast<uint8_t>(sync.PlayerHealthArmour.y))
+		, additionalKeyWeapon(sync.AdditionalKeyWeapon)
+		, siren(sync.Siren)
+		, landingGear(sync.LandingGear)
+		, trailerID(sync.TrailerID)
+		, hydraThrustAngle(sync.HydraThrustAngle)
+	{
+		std::memcpy(rotation, &sync.Rotation, sizeof(rotation));
+		std::memcpy(position, &sync.Position, sizeof(position));
+		std::memcpy(velocity, &sync.Velocity, sizeof(velocity));
+	}
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 8, "Recording header must not be padded");
+static_assert(sizeof(OnFootRecord) == 72, "On foot records must not be padded");
+static_assert(sizeof(DriverRecord) == 67, "Driver records must not be padded");
+}
@@ -0,0 +1,325 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#include "recording_playback.hpp"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+struct IUnknown;
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::open(const String& path)
+{
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	file_ = file;
+	mapping_ = mapping;
+	size_ = static_cast<size_t>(size.QuadPart);
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+	void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps the file alive on its own.
+	::close(fd);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+	size_ = static_cast<size_t>(info.st_size);
+#endif
+	data_ = static_cast<const char*>(data);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (!data_)
+	{
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(data_);
+	CloseHandle(mapping_);
+	CloseHandle(file_);
+	file_ = nullptr;
+	mapping_ = nullptr;
+#else
+	munmap(const_cast<char*>(data_), size_);
+#endif
+	data_ = nullptr;
+	size_ = 0;
+}
+
+bool RecordingPlayback::open(const String& path, bool loop)
+{
+	if (!file_.open(path) || file_.size() < sizeof(RecordingFormat::Header))
+	{
+		return false;
+	}
+
+	RecordingFormat::Header header;
+	std::memcpy(&header, file_.data(), sizeof(header));
+	if (header.version != RecordingFormat::Version && header.version != RecordingFormat::CompactVersion)
+	{
+		return false;
+	}
+
+	switch (header.type)
+	{
+	case PlayerRecordingType_OnFoot:
+		recordSize_ = sizeof(RecordingFormat::OnFootRecord);
+		break;
+	case PlayerRecordingType_Driver:
+		recordSize_ = sizeof(RecordingFormat::DriverRecord);
+		break;
+	default:
+		return false;
+	}
+
+	type_ = static_cast<PlayerRecordingType>(header.type);
+	if (header.version == RecordingFormat::CompactVersion)
+	{
+		decoder_ = std::make_unique<RecordingDecoder>(type_, file_.data() + sizeof(header), file_.size() - sizeof(header));
+	}
+	else
+	{
+		// A record cut short by a crash while recording is left out.
+		count_ = (file_.size() - sizeof(header)) / recordSize_;
+		next_ = 0;
+	}
+	loop_ = loop;
+	start_ = Time::now();
+	hasPending_ = read(pending_);
+	return hasPending_;
+}
+
+bool RecordingPlayback::read(char* record)
+{
+	if (decoder_)
+	{
+		if (type_ == PlayerRecordingType_OnFoot)
+		{
+			RecordingFormat::OnFootRecord data;
+			if (!decoder_->next(data))
+			{
+				return false;
+			}
+			std::memcpy(record, &data, sizeof(data));
+		}
+		else
+		{
+			RecordingFormat::DriverRecord data;
+			if (!decoder_->next(data))
+			{
+				return false;
+			}
+			std::memcpy(record, &data, sizeof(data));
+		}
+		return true;
+	}
+
+	if (next_ == count_)
+	{
+		return false;
+	}
+	std::memcpy(record, file_.data() + sizeof(RecordingFormat::Header) + next_ * recordSize_, recordSize_);
+	++next_;
+	return true;
+}
+
+void RecordingPlayback::seek(Milliseconds time)
+{
+	const uint32_t target = static_cast<uint32_t>(time.count());
+	if (decoder_)
+	{
+		decoder_->seek(target);
+	}
+	else
+	{
+		// Records are in time order, so the first one due at or after the time is found by halving.
+		const char* const records = file_.data() + sizeof(RecordingFormat::Header);
+		size_t first = 0;
+		size_t count = count_;
+		while (count != 0)
+		{
+			const size_t half = count / 2;
+			uint32_t recordTime;
+			std::memcpy(&recordTime, records + (first + half) * recordSize_, sizeof(recordTime));
+			if (recordTime < target)
+			{
+				first += half + 1;
+				count -= half + 1;
+			}
+			else
+			{
+				count = half;
+			}
+		}
+		next_ = first;
+	}
+	hasPending_ = read(pending_);
+	start_ = Time::now() - time;
+}
+
+bool RecordingPlayback::update(TimePoint now)
+{
+	const uint32_t elapsed = static_cast<uint32_t>(duration_cast<Milliseconds>(now - start_).count());
+
+	// Records are sent at the server's tick rate, so any that are already out of date are skipped.
+	char due[MaxRecordSize];
+	bool isDue = false;
+	while (hasPending_)
+	{
+		uint32_t time;
+		std::memcpy(&time, pending_, sizeof(time));
+		if (time > elapsed)
+		{
+			break;
+		}
+		std::memcpy(due, pending_, recordSize_);
+		isDue = true;
+		hasPending_ = read(pending_);
+	}
+
+	if (isDue)
+	{
+		send(due);
+	}
+
+	if (!hasPending_)
+	{
+		if (!loop_)
+		{
+			return false;
+		}
+		seek(Milliseconds(0));
+		start_ = now;
+	}
+	return true;
+}
+
+void RecordingPlayback::send(const char* record)
+{
+	// Written the way the client sends them, so everything listening sees a normal sync packet.
+	NetworkBitStream bs;
+	uint8_t type;
+	if (type_ == PlayerRecordingType_OnFoot)
+	{
+		RecordingFormat::OnFootRecord data;
+		std::memcpy(&data, record, sizeof(data));
+
+		Vector3 position;
+		GTAQuat rotation;
+		Vector3 velocity;
+		Vector3 surfingOffset;
+		std::memcpy(&position, data.position, sizeof(data.position));
+		std::memcpy(&rotation, data.rotation, sizeof(data.rotation));
+		std::memcpy(&velocity, data.velocity, sizeof(data.velocity));
+		std::memcpy(&surfingOffset, data.surfingOffset, sizeof(data.surfingOffset));
+
+		type = NetCode::Packet::PlayerFootSync::PacketID;
+		bs.writeUINT8(type);
+		bs.writeUINT16(data.leftRight);
+		bs.writeUINT16(data.upDown);
+		bs.writeUINT16(data.keys);
+		bs.writeVEC3(position);
+		bs.writeGTAQuat(rotation);
+		bs.writeCompressedPercentPair(Vector2(data.health, data.armour));
+		bs.writeUINT8(data.weaponAdditionalKey);
+		bs.writeUINT8(data.specialAction);
+		bs.writeVEC3(velocity);
+		bs.writeVEC3(surfingOffset);
+		bs.writeUINT16(data.surfingID);
+		bs.writeUINT16(data.animationID);
+		bs.writeUINT16(data.animationFlags);
+	}
+	else
+	{
+		RecordingFormat::DriverRecord data;
+		std::memcpy(&data, record, sizeof(data));
+
+		GTAQuat rotation;
+		Vector3 position;
+		Vector3 velocity;
+		std::memcpy(&rotation, data.rotation, sizeof(data.rotation));
+		std::memcpy(&position, data.position, sizeof(data.position));
+		std::memcpy(&velocity, data.velocity, sizeof(data.velocity));
+
+		type = NetCode::Packet::PlayerVehicleSync::PacketID;
+		bs.writeUINT8(type);
+		bs.writeUINT16(data.vehicleID);
+		bs.writeUINT16(data.leftRight);
+		bs.writeUINT16(data.upDown);
+		bs.writeUINT16(data.keys);
+		bs.writeGTAQuat(rotation);
+		bs.writeVEC3(position);
+		bs.writeVEC3(velocity);
+		bs.writeFLOAT(data.vehicleHealth);
+		bs.writeCompressedPercentPair(Vector2(data.playerHealth, data.playerArmour));
+		bs.writeUINT8(data.additionalKeyWeapon);
+		bs.writeUINT8(data.siren);
+		bs.writeUINT8(data.landingGear);
+		bs.writeUINT16(data.trailerID);
+		bs.writeUINT32(data.hydraThrustAngle);
+	}
+
+	IPlayer& bot = bot_;
+	const bool res = network_.inEventDispatcher.stopAtFalse([&bot, type, &bs](NetworkInEventHandler* handler)
+		{
+			bs.SetReadOffset(8); // Ignore packet ID
+			return handler->onReceivePacket(bot, type, bs);
+		});
+
+	if (res)
+	{
+		network_.packetInEventDispatcher.stopAtFalse(type, [&bot, &bs](SingleNetworkInEventHandler* handler)
+			{
+				bs.SetReadOffset(8); // Ignore packet ID
+				return handler->onReceive(bot, bs);
+			});
+	}
+}
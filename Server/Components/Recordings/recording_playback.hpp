@@ -0,0 +1,176 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+#include <Impl/network_impl.hpp>
+#include "recording_codec.hpp"
+#include "recording_format.hpp"
+#include <memory>
+
+using namespace Impl;
+
+/// A file mapped into memory read only, so a long recording costs no more than the pages being played
+class MappedFile final : public NoCopy
+{
+private:
+	const char* data_ = nullptr;
+	size_t size_ = 0;
+#ifdef _WIN32
+	void* file_ = nullptr;
+	void* mapping_ = nullptr;
+#endif
+
+public:
+	~MappedFile()
+	{
+		close();
+	}
+
+	/// Maps a whole file, closing anything mapped before
+	/// @returns "true" if the file could be mapped, otherwise "false"
+	bool open(const String& path);
+
+	void close();
+
+	const char* data() const
+	{
+		return data_;
+	}
+
+	size_t size() const
+	{
+		return size_;
+	}
+};
+
+/// Network for bots driven by the server itself.  There is no client at the other end so anything
+/// sent to them is dropped, what they send is made up by `RecordingPlayback` and fed through the
+/// core network's handlers as if it came from a client.
+class RecordingBotNetwork final : public Network
+{
+public:
+	ENetworkType getNetworkType() const override
+	{
+		return ENetworkType_End;
+	}
+
+	void disconnect(const IPlayer& peer) override
+	{
+		// Kicked bots are removed by the player pool on its next tick.
+	}
+
+	bool broadcastPacket(Span<uint8_t> data, int channel, const IPlayer* exceptPeer, bool dispatchEvents) override
+	{
+		return true;
+	}
+
+	bool sendPacket(IPlayer& peer, Span<uint8_t> data, int channel, bool dispatchEvents) override
+	{
+		return true;
+	}
+
+	bool broadcastRPC(int id, Span<uint8_t> data, int channel, const IPlayer* exceptPeer, bool dispatchEvents) override
+	{
+		return true;
+	}
+
+	bool sendRPC(IPlayer& peer, int id, Span<uint8_t> data, int channel, bool dispatchEvents) override
+	{
+		return true;
+	}
+
+	void update() override
+	{
+	}
+
+	NetworkStats getStatistics(IPlayer* player = nullptr) override
+	{
+		return NetworkStats();
+	}
+
+	unsigned getPing(const IPlayer& peer) override
+	{
+		return 0;
+	}
+
+	void ban(const BanEntry& entry, Milliseconds expire = Milliseconds(0)) override
+	{
+	}
+
+	void unban(const BanEntry& entry) override
+	{
+	}
+
+	void reset() override
+	{
+	}
+};
+
+/// Plays a `.rec` file on a bot, one record per tick at most, at the pace it was recorded
+class RecordingPlayback final : public NoCopy
+{
+private:
+	static constexpr size_t MaxRecordSize = sizeof(RecordingFormat::OnFootRecord) > sizeof(RecordingFormat::DriverRecord) ? sizeof(RecordingFormat::OnFootRecord) : sizeof(RecordingFormat::DriverRecord);
+
+	IPlayer& bot_;
+	Network& network_;
+	MappedFile file_;
+	PlayerRecordingType type_ = PlayerRecordingType_None;
+	size_t recordSize_ = 0;
+	bool loop_ = false;
+	TimePoint start_;
+
+	/// Records of a file in the original format, read straight from the mapping
+	size_t count_ = 0;
+	size_t next_ = 0;
+
+	/// Set for a file in the compact format
+	std::unique_ptr<RecordingDecoder> decoder_;
+
+	/// The next record, read ahead to know when it's due
+	char pending_[MaxRecordSize];
+	bool hasPending_ = false;
+
+	/// Reads the next record in the file
+	/// @returns "false" once there are none left
+	bool read(char* record);
+
+	/// Feeds one record to the core network's handlers as the bot's sync packet
+	void send(const char* record);
+
+public:
+	RecordingPlayback(IPlayer& bot, Network& network)
+		: bot_(bot)
+		, network_(network)
+	{
+	}
+
+	/// Maps and checks a recording, playback starts on the next tick
+	/// @returns "true" if the file is a recording this can play, otherwise "false"
+	bool open(const String& path, bool loop);
+
+	/// Jumps to a point in the recording
+	/// @param time Time since the start of the recording
+	void seek(Milliseconds time);
+
+	/// Sends the last record due by now
+	/// @returns "false" once a recording that doesn't loop has ended, otherwise "true"
+	bool update(TimePoint now);
+
+	IPlayer& getBot() const
+	{
+		return bot_;
+	}
+
+	PlayerRecordingType getType() const
+	{
+		return type_;
+	}
+};
@@ -0,0 +1,187 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#include "recording_writer.hpp"
+#include <algorithm>
+#include <cstring>
+
+RecordingStream::RecordingStream(RecordingWriter& writer, String path, size_t capacity)
+	: writer(writer)
+	, path(std::move(path))
+	, file(this->path, std::ios_base::out | std::ios_base::binary)
+	, ring(new char[capacity])
+	, capacity(capacity)
+{
+}
+
+void RecordingStream::append(const void* data, size_t size)
+{
+	const char* bytes = static_cast<const char*>(data);
+	const size_t start = head.load(std::memory_order_relaxed);
+	size_t end = tail.load(std::memory_order_acquire);
+	while (capacity - (start - end) < size)
+	{
+		// The disk can't keep up.  Waiting is better than a corrupt recording, and only happens
+		// after the buffer has taken several seconds of records the writer couldn't get out.
+		++stalls;
+		std::unique_lock<std::mutex> lock(writer.streamsMutex);
+		writer.wake.notify_one();
+		writer.flushed.wait_for(lock, Milliseconds(10));
+		end = tail.load(std::memory_order_acquire);
+	}
+
+	const size_t offset = start % capacity;
+	const size_t first = std::min(size, capacity - offset);
+	std::memcpy(ring.get() + offset, bytes, first);
+	std::memcpy(ring.get(), bytes + first, size - first);
+	head.store(start + size, std::memory_order_release);
+
+	const size_t used = start + size - end;
+	if (used > highWaterMark)
+	{
+		highWaterMark = used;
+		if (used > writer.highWaterMark.load(std::memory_order_relaxed))
+		{
+			writer.highWaterMark.store(used, std::memory_order_relaxed);
+		}
+	}
+	// Only on crossing, so a stream that is behind doesn't wake the writer for every record.
+	if (start - end < RecordingWriter::BlockSize && used >= RecordingWriter::BlockSize)
+	{
+		writer.notify();
+	}
+}
+
+RecordingBufferStats RecordingStream::getStats() const
+{
+	RecordingBufferStats stats;
+	stats.capacity = capacity;
+	stats.used = head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed);
+	stats.highWaterMark = highWaterMark;
+	stats.stalls = stalls;
+	stats.written = written.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void RecordingStream::flush()
+{
+	const size_t start = tail.load(std::memory_order_relaxed);
+	const size_t end = head.load(std::memory_order_acquire);
+	if (start == end)
+	{
+		return;
+	}
+	const size_t offset = start % capacity;
+	const size_t first = std::min(end - start, capacity - offset);
+	file.write(ring.get() + offset, first);
+	file.write(ring.get(), end - start - first);
+	file.flush();
+	written.fetch_add(end - start, std::memory_order_relaxed);
+	tail.store(end, std::memory_order_release);
+}
+
+RecordingWriter::~RecordingWriter()
+{
+	if (worker.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(streamsMutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		worker.join();
+	}
+}
+
+std::shared_ptr<RecordingStream> RecordingWriter::open(const String& path)
+{
+	{
+		std::unique_lock<std::mutex> lock(streamsMutex);
+		auto samePath = [&path](const std::shared_ptr<RecordingStream>& stream)
+		{
+			return stream->path == path;
+		};
+		// Another recording still going to the file would never finish on its own.
+		if (std::any_of(streams.begin(), streams.end(), [&samePath](const std::shared_ptr<RecordingStream>& stream)
+				{
+					return samePath(stream) && !stream->closing.load(std::memory_order_acquire);
+				}))
+		{
+			return nullptr;
+		}
+		// Opening truncates the file, which mustn't happen under a stopped recording's last writes.
+		flushed.wait(lock, [this, &samePath]()
+			{
+				return std::none_of(streams.begin(), streams.end(), samePath);
+			});
+	}
+	std::shared_ptr<RecordingStream> stream = std::make_shared<RecordingStream>(*this, path, BufferSize);
+	if (stream->good())
+	{
+		{
+			std::lock_guard<std::mutex> lock(streamsMutex);
+			streams.push_back(stream);
+		}
+		if (!worker.joinable())
+		{
+			worker = std::thread(&RecordingWriter::run, this);
+		}
+	}
+	return stream;
+}
+
+void RecordingWriter::close(const std::shared_ptr<RecordingStream>& stream)
+{
+	stream->closing.store(true, std::memory_order_release);
+	notify();
+}
+
+void RecordingWriter::notify()
+{
+	std::lock_guard<std::mutex> lock(streamsMutex);
+	wake.notify_one();
+}
+
+void RecordingWriter::run()
+{
+	DynamicArray<std::shared_ptr<RecordingStream>> current;
+	std::unique_lock<std::mutex> lock(streamsMutex);
+	for (;;)
+	{
+		current = streams;
+		const bool stop = stopping;
+		lock.unlock();
+
+		DynamicArray<RecordingStream*> finished;
+		for (const std::shared_ptr<RecordingStream>& stream : current)
+		{
+			// Checked first, anything appended before closing is then sure to be written.
+			const bool closing = stream->closing.load(std::memory_order_acquire);
+			stream->flush();
+			if (closing || stop)
+			{
+				stream->file.close();
+				finished.push_back(stream.get());
+			}
+		}
+		current.clear();
+
+		lock.lock();
+		streams.erase(std::remove_if(streams.begin(), streams.end(), [&finished](const std::shared_ptr<RecordingStream>& stream)
+						  {
+							  return std::find(finished.begin(), finished.end(), stream.get()) != finished.end();
+						  }),
+			streams.end());
+		flushed.notify_all();
+		if (stop)
+		{
+			return;
+		}
+		wake.wait_for(lock, FlushInterval);
+	}
+}
@@ -0,0 +1,136 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+#include <recordings_ext.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+class RecordingWriter;
+
+/// One recording's file and the ring buffer in front of it.  The main thread is the only one
+/// appending and the writer thread the only one taking bytes out, so neither needs a lock.
+class RecordingStream final : public NoCopy
+{
+private:
+	friend class RecordingWriter;
+
+	RecordingWriter& writer;
+	String path;
+	std::ofstream file;
+	std::unique_ptr<char[]> ring;
+	const size_t capacity;
+
+	/// Bytes ever appended, only written by the main thread
+	std::atomic<size_t> head { 0 };
+
+	/// Bytes ever written out, only written by the writer thread
+	std::atomic<size_t> tail { 0 };
+
+	/// Set once nothing more will be appended, the writer closes the file when it has caught up
+	std::atomic<bool> closing { false };
+
+	/// Bytes written to the file so far
+	std::atomic<uint64_t> written { 0 };
+
+	// Main thread only.
+	size_t highWaterMark = 0;
+	size_t stalls = 0;
+
+	/// Writes out everything waiting, on the writer thread
+	void flush();
+
+public:
+	RecordingStream(RecordingWriter& writer, String path, size_t capacity);
+
+	/// Whether the file could be opened
+	bool good() const
+	{
+		return file.is_open();
+	}
+
+	/// Queues bytes for the file, waiting for room if the writer thread is behind
+	void append(const void* data, size_t size);
+
+	/// Queues a record for the file
+	template <typename Record>
+	void append(const Record& record)
+	{
+		append(&record, sizeof(Record));
+	}
+
+	/// Gets how the buffer is coping
+	RecordingBufferStats getStats() const;
+};
+
+/// Writes every recording from one background thread.  Buffers are flushed once a block's worth of
+/// bytes is waiting, and every so often regardless so a recording on disk is never far behind.
+class RecordingWriter final : public NoCopy
+{
+private:
+	friend class RecordingStream;
+
+	std::thread worker;
+
+	/// Guards "streams" and "stopping"
+	std::mutex streamsMutex;
+
+	/// Wakes the writer thread up
+	std::condition_variable wake;
+
+	/// Signalled by the writer thread after each round of writes
+	std::condition_variable flushed;
+
+	/// Recordings being written, and ones that have stopped but still have bytes waiting
+	DynamicArray<std::shared_ptr<RecordingStream>> streams;
+
+	bool stopping = false;
+
+	/// Most bytes ever waiting in any buffer at once
+	std::atomic<size_t> highWaterMark { 0 };
+
+	/// Writes buffers out until stopped
+	void run();
+
+	/// Called by a stream that has a block's worth of bytes waiting, or is full
+	void notify();
+
+public:
+	/// Size of each recording's buffer
+	static constexpr size_t BufferSize = 256 * 1024;
+
+	/// Bytes waiting that make the writer thread write straight away
+	static constexpr size_t BlockSize = 32 * 1024;
+
+	/// Longest bytes wait before being written
+	static constexpr Milliseconds FlushInterval = Milliseconds(250);
+
+	/// Writes what is still waiting and closes every file
+	~RecordingWriter();
+
+	/// Creates a file for a recording, once a stopped recording of the same file has been written out
+	/// @param path File path
+	/// @returns The stream, check `good()` to see whether the file could be created, or null when
+	/// another recording is still being written to the file
+	std::shared_ptr<RecordingStream> open(const String& path);
+
+	/// Stops appending to a stream, the rest of its bytes are written and the file closed in the background
+	void close(const std::shared_ptr<RecordingStream>& stream);
+
+	/// Gets the most bytes that have been waiting in any buffer at once
+	size_t getHighWaterMark() const
+	{
+		return highWaterMark.load(std::memory_order_relaxed);
+	}
+};
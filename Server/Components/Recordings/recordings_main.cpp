@@ -8,21 +8,72 @@
 
 #include <Server/Components/Recordings/recordings.hpp>
 #include <sdk.hpp>
+#include <allocations.hpp>
 #include <netcode.hpp>
 #include <ghc/filesystem.hpp>
+#include "recording_codec.hpp"
+#include "recording_format.hpp"
+#include "recording_playback.hpp"
+#include "recording_writer.hpp"
 
-class PlayerRecordingData final : public IPlayerRecordingData
+class PlayerRecordingData final : public IPlayerRecordingData, public TrackedAllocation<PlayerRecordingData>
 {
 private:
 	PlayerRecordingType type_ = PlayerRecordingType_None;
 	TimePoint start_ = TimePoint();
-	std::ofstream file_;
+	ICore& core_;
+	std::shared_ptr<RecordingWriter> writer_;
+	std::shared_ptr<RecordingStream> stream_;
+	bool compact_;
+
+	/// Set while writing the compact format
+	std::unique_ptr<RecordingEncoder> encoder_;
 
 	friend class RecordingsComponent;
 
+	/// Whether records of a type should be written
+	bool recording(PlayerRecordingType type) const
+	{
+		return type_ == type && stream_;
+	}
+
+	/// Milliseconds since the recording started
+	uint32_t time() const
+	{
+		return static_cast<uint32_t>(duration_cast<Milliseconds>(Time::now() - start_).count());
+	}
+
+	/// Queues a record for the file, in whichever format it's being written in
+	template <typename Record>
+	void write(const Record& record)
+	{
+		if (encoder_)
+		{
+			uint8_t frame[RecordingFormat::MaxFrameSize];
+			stream_->append(frame, encoder_->encode(record, frame));
+		}
+		else
+		{
+			stream_->append(record);
+		}
+	}
+
 public:
+	PlayerRecordingData(ICore& core, std::shared_ptr<RecordingWriter> writer, bool compact)
+		: core_(core)
+		, writer_(std::move(writer))
+		, compact_(compact)
+	{
+	}
+
+	~PlayerRecordingData()
+	{
+		stop();
+	}
+
 	void start(PlayerRecordingType type, StringView file) override
 	{
+		stop();
 		type_ = type;
 		start_ = Time::now();
 
@@ -32,14 +83,25 @@ public:
 			ghc::filesystem::create_directory(scriptfilesPath);
 		}
 		auto filePath = scriptfilesPath / ghc::filesystem::path(std::string(file) + ".rec");
-		file_.open(filePath.string(), std::ios_base::out | std::ios_base::binary);
+		stream_ = writer_->open(filePath.string());
+		if (!stream_)
+		{
+			core_.logLn(LogLevel::Error, "[recordings] Can't record to %s, another recording is still being written to it", filePath.string().c_str());
+			return;
+		}
 
 		// Write recording header
-		if (file_.good())
+		if (stream_->good())
+		{
+			stream_->append(RecordingFormat::Header { compact_ ? RecordingFormat::CompactVersion : RecordingFormat::Version, static_cast<uint32_t>(type_) });
+			if (compact_)
+			{
+				encoder_ = std::make_unique<RecordingEncoder>(type_);
+			}
+		}
+		else
 		{
-			uint32_t version = 1000;
-			file_.write(reinterpret_cast<const char*>(&version), sizeof(uint32_t));
-			file_.write(reinterpret_cast<const char*>(&type_), sizeof(uint32_t));
+			stream_.reset();
 		}
 
 		// To view/edit the recorded data as a CSV, see https://github.com/WoutProvost/samp-rec-to-csv
@@ -56,7 +118,13 @@ public:
 	{
 		type_ = PlayerRecordingType_None;
 		start_ = TimePoint();
-		file_.close();
+		encoder_.reset();
+		if (stream_)
+		{
+			// The rest is written and the file closed by the writer thread.
+			writer_->close(stream_);
+			stream_.reset();
+		}
 	}
 
 	void freeExtension() override
@@ -70,11 +138,240 @@ public:
 	}
 };
 
-class RecordingsComponent final : public IRecordingsComponent, public PlayerConnectEventHandler
+class RecordingsComponent final : public IRecordingsComponent, public PlayerConnectEventHandler, public CoreEventHandler, public TrackedAllocation<RecordingsComponent>
 {
 private:
 	ICore* core = nullptr;
 
+	/// Shared with every recording, so it's only gone once the last file has been written
+	std::shared_ptr<RecordingWriter> writer = std::make_shared<RecordingWriter>();
+
+	/// Whether recordings are written in the compact format
+	bool compact = false;
+
+	/// Network of the bots connected with `connectBot`
+	RecordingBotNetwork botNetwork;
+
+	/// Network whose handlers are given the bots' packets, found when the first bot connects
+	Network* coreNetwork = nullptr;
+
+	/// Bots connected with `connectBot`
+	FlatPtrHashSet<IPlayer> bots;
+
+	/// Recordings being played, by bot ID
+	FlatHashMap<int, std::unique_ptr<RecordingPlayback>> playbacks;
+
+	/// A start, stop or seek asked for while playbacks were being updated
+	struct PlaybackChange
+	{
+		int id;
+		/// The new playback for a start, null for a stop or seek
+		std::unique_ptr<RecordingPlayback> playback;
+		bool seek = false;
+		Milliseconds time = Milliseconds(0);
+	};
+
+	/// Set while `onTick` updates playbacks.  Updating one calls into scripts, which may start, stop
+	/// or seek playbacks, so those changes wait in `changes` until every playback has been updated.
+	bool updating = false;
+	DynamicArray<PlaybackChange> changes;
+
+	/// IDs of the playbacks being updated this tick
+	DynamicArray<int> updateIDs;
+
+	void applyChange(PlaybackChange& change)
+	{
+		if (change.seek)
+		{
+			auto it = playbacks.find(change.id);
+			if (it != playbacks.end())
+			{
+				it->second->seek(change.time);
+			}
+		}
+		else if (change.playback)
+		{
+			playbacks[change.id] = std::move(change.playback);
+		}
+		else
+		{
+			playbacks.erase(change.id);
+		}
+	}
+
+	void changePlayback(PlaybackChange&& change)
+	{
+		if (updating)
+		{
+			changes.emplace_back(std::move(change));
+		}
+		else
+		{
+			applyChange(change);
+		}
+	}
+
+	/// Finds the network real clients' packets come in on
+	Network* getCoreNetwork()
+	{
+		if (!coreNetwork)
+		{
+			for (INetwork* network : core->getNetworks())
+			{
+				if (network->getNetworkType() == ENetworkType_RakNetLegacy)
+				{
+					coreNetwork = static_cast<Network*>(network);
+					break;
+				}
+			}
+		}
+		return coreNetwork;
+	}
+
+	IPlayer* connectBot(StringView name)
+	{
+		Network* network = getCoreNetwork();
+		if (!network)
+		{
+			return nullptr;
+		}
+
+		PeerNetworkData netData {};
+		netData.network = &botNetwork;
+		netData.networkID.address.ipv6 = false;
+		netData.networkID.address.v4 = 0x0100007F; // 127.0.0.1
+		netData.networkID.port = 0;
+
+		PeerRequestParams params;
+		params.version = ClientVersion::ClientVersion_SAMP_037;
+		params.versionName = "0.3.7";
+		params.name = name;
+		params.bot = true;
+		params.isUsingOfficialClient = false;
+		params.isUsingOmp = false;
+
+		Pair<NewConnectionResult, IPlayer*> result = core->getPlayers().requestPlayer(netData, params);
+		if (result.first != NewConnectionResult_Success)
+		{
+			return nullptr;
+		}
+
+		IPlayer& bot = *result.second;
+		bots.emplace(&bot);
+		network->networkEventDispatcher.dispatch(&NetworkEventHandler::onPeerConnect, bot);
+		if (bot.getKickStatus())
+		{
+			return nullptr;
+		}
+
+		// Bots skip class selection, they only need to say they've spawned.
+		NetworkBitStream bs;
+		const bool res = network->inEventDispatcher.stopAtFalse([&bot, &bs](NetworkInEventHandler* handler)
+			{
+				bs.resetReadPointer();
+				return handler->onReceiveRPC(bot, NetCode::RPC::PlayerSpawn::PacketID, bs);
+			});
+		if (res)
+		{
+			network->rpcInEventDispatcher.stopAtFalse(NetCode::RPC::PlayerSpawn::PacketID, [&bot, &bs](SingleNetworkInEventHandler* handler)
+				{
+					bs.resetReadPointer();
+					return handler->onReceive(bot, bs);
+				});
+		}
+		return &bot;
+	}
+
+	bool startPlayback(IPlayer& bot, StringView file, bool loop)
+	{
+		if (bots.find(&bot) == bots.end() || !coreNetwork)
+		{
+			return false;
+		}
+
+		auto filePath = ghc::filesystem::absolute("scriptfiles") / ghc::filesystem::path(std::string(file) + ".rec");
+		auto playback = std::make_unique<RecordingPlayback>(bot, *coreNetwork);
+		if (!playback->open(filePath.string(), loop))
+		{
+			core->logLn(LogLevel::Error, "[recordings] Can't play %s, it isn't a recording or is empty", filePath.string().c_str());
+			return false;
+		}
+		changePlayback(PlaybackChange { bot.getID(), std::move(playback) });
+		return true;
+	}
+
+	bool stopPlayback(IPlayer& bot)
+	{
+		if (playbacks.find(bot.getID()) == playbacks.end())
+		{
+			return false;
+		}
+		changePlayback(PlaybackChange { bot.getID(), nullptr });
+		return true;
+	}
+
+	bool seekPlayback(IPlayer& bot, Milliseconds time)
+	{
+		if (playbacks.find(bot.getID()) == playbacks.end())
+		{
+			return false;
+		}
+		changePlayback(PlaybackChange { bot.getID(), nullptr, true, time });
+		return true;
+	}
+
+	/// Exposes the features that don't fit the SDK interfaces
+	struct Extension final : public IRecordingsExtension
+	{
+		RecordingsComponent& self;
+
+		Extension(RecordingsComponent& self)
+			: self(self)
+		{
+		}
+
+		bool getBufferStats(IPlayer& player, RecordingBufferStats& stats) override
+		{
+			PlayerRecordingData* data = queryExtension<PlayerRecordingData>(player);
+			if (!data || !data->stream_)
+			{
+				return false;
+			}
+			stats = data->stream_->getStats();
+			return true;
+		}
+
+		size_t getBufferHighWaterMark() const override
+		{
+			return self.writer->getHighWaterMark();
+		}
+
+		IPlayer* connectBot(StringView name) override
+		{
+			return self.connectBot(name);
+		}
+
+		bool startPlayback(IPlayer& bot, StringView file, bool loop) override
+		{
+			return self.startPlayback(bot, file, loop);
+		}
+
+		bool stopPlayback(IPlayer& bot) override
+		{
+			return self.stopPlayback(bot);
+		}
+
+		bool seekPlayback(IPlayer& bot, Milliseconds time) override
+		{
+			return self.seekPlayback(bot, time);
+		}
+
+		bool isPlaying(IPlayer& bot) const override
+		{
+			return self.playbacks.find(bot.getID()) != self.playbacks.end();
+		}
+	} extension;
+
 	struct OnFootRecordingHandler : public SingleNetworkInEventHandler
 	{
 		RecordingsComponent& self;
@@ -98,27 +395,9 @@ private:
 			}
 
 			// Write on foot recording data
-			if (data->type_ == PlayerRecordingType_OnFoot && data->file_.good())
+			if (data->recording(PlayerRecordingType_OnFoot))
 			{
-				const uint32_t timeSinceRecordStart = duration_cast<Milliseconds>(Time::now() - data->start_).count();
-				data->file_.write(reinterpret_cast<const char*>(&timeSinceRecordStart), sizeof(uint32_t));
-
-				uint8_t health = static_cast<uint8_t>(footSync.HealthArmour.x);
-				uint8_t armour = static_cast<uint8_t>(footSync.HealthArmour.y);
-				data->file_.write(reinterpret_cast<const char*>(&footSync.LeftRight), sizeof(uint16_t));
-				data->file_.write(reinterpret_cast<const char*>(&footSync.UpDown), sizeof(uint16_t));
-				data->file_.write(reinterpret_cast<const char*>(&footSync.Keys), sizeof(uint16_t));
-				data->file_.write(reinterpret_cast<const char*>(&footSync.Position), sizeof(float) * 3);
-				data->file_.write(reinterpret_cast<const char*>(&footSync.Rotation), sizeof(float) * 4);
-				data->file_.write(reinterpret_cast<const char*>(&health), sizeof(uint8_t));
-				data->file_.write(reinterpret_cast<const char*>(&armour), sizeof(uint8_t));
-				data->file_.write(reinterpret_cast<const char*>(&footSync.WeaponAdditionalKey), sizeof(uint8_t));
-				data->file_.write(reinterpret_cast<const char*>(&footSync.SpecialAction), sizeof(uint8_t));
-				data->file_.write(reinterpret_cast<const char*>(&footSync.Velocity), sizeof(float) * 3);
-				data->file_.write(reinterpret_cast<const char*>(&footSync.SurfingData.offset), sizeof(float) * 3);
-				data->file_.write(reinterpret_cast<const char*>(&footSync.SurfingData.ID), sizeof(uint16_t));
-				data->file_.write(reinterpret_cast<const char*>(&footSync.AnimationID), sizeof(uint16_t));
-				data->file_.write(reinterpret_cast<const char*>(&footSync.AnimationFlags), sizeof(uint16_t));
+				data->write(RecordingFormat::OnFootRecord(data->time(), footSync));
 			}
 
 			return true;
@@ -148,28 +427,9 @@ private:
 			}
 
 			// Write driver recording data
-			if (data->type_ == PlayerRecordingType_Driver && data->file_.good())
+			if (data->recording(PlayerRecordingType_Driver))
 			{
-				const uint32_t timeSinceRecordStart = duration_cast<Milliseconds>(Time::now() - data->start_).count();
-				data->file_.write(reinterpret_cast<const char*>(&timeSinceRecordStart), sizeof(uint32_t));
-
-				uint8_t playerHealth = static_cast<uint8_t>(vehicleSync.PlayerHealthArmour.x);
-				uint8_t playerArmour = static_cast<uint8_t>(vehicleSync.PlayerHealthArmour.y);
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.VehicleID), sizeof(uint16_t));
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.LeftRight), sizeof(uint16_t));
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.UpDown), sizeof(uint16_t));
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.Keys), sizeof(uint16_t));
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.Rotation), sizeof(float) * 4);
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.Position), sizeof(float) * 3);
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.Velocity), sizeof(float) * 3);
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.Health), sizeof(float));
-				data->file_.write(reinterpret_cast<const char*>(&playerHealth), sizeof(uint8_t));
-				data->file_.write(reinterpret_cast<const char*>(&playerArmour), sizeof(uint8_t));
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.AdditionalKeyWeapon), sizeof(uint8_t));
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.Siren), sizeof(uint8_t));
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.LandingGear), sizeof(uint8_t));
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.TrailerID), sizeof(uint16_t));
-				data->file_.write(reinterpret_cast<const char*>(&vehicleSync.HydraThrustAngle), sizeof(uint32_t));
+				data->write(RecordingFormat::DriverRecord(data->time(), vehicleSync));
 			}
 
 			return true;
@@ -179,7 +439,48 @@ private:
 public:
 	void onPlayerConnect(IPlayer& player) override
 	{
-		player.addExtension(new PlayerRecordingData(), true);
+		player.addExtension(new PlayerRecordingData(*core, writer, compact), true);
+	}
+
+	void onPlayerDisconnect(IPlayer& player, PeerDisconnectReason reason) override
+	{
+		if (bots.erase(&player))
+		{
+			changePlayback(PlaybackChange { player.getID(), nullptr });
+		}
+	}
+
+	void onTick(Microseconds elapsed, TimePoint now) override
+	{
+		// Scripts run while sending, so each playback is looked up again in case one was stopped.
+		updateIDs.clear();
+		for (auto& playback : playbacks)
+		{
+			updateIDs.push_back(playback.first);
+		}
+
+		updating = true;
+		for (int id : updateIDs)
+		{
+			auto it = playbacks.find(id);
+			if (it == playbacks.end())
+			{
+				continue;
+			}
+			const size_t asked = changes.size();
+			if (!it->second->update(now))
+			{
+				// Ended, which goes before whatever scripts asked for while it sent its last record.
+				changes.insert(changes.begin() + asked, PlaybackChange { id, nullptr });
+			}
+		}
+		updating = false;
+
+		for (PlaybackChange& change : changes)
+		{
+			applyChange(change);
+		}
+		changes.clear();
 	}
 
 	StringView componentName() const override
@@ -193,15 +494,35 @@ public:
 	}
 
 	RecordingsComponent()
-		: onFootRecordingHandler(*this)
+		: extension(*this)
+		, onFootRecordingHandler(*this)
 		, driverRecordingHandler(*this)
 	{
 	}
 
+	IExtension* getExtension(UID id) override
+	{
+		if (id == IRecordingsExtension::ExtensionIID)
+		{
+			return &extension;
+		}
+		return nullptr;
+	}
+
+	void provideConfiguration(ILogger& logger, IEarlyConfig& config, bool defaults) override
+	{
+		if (defaults || config.getType("recording.compact") == ConfigOptionType_None)
+		{
+			config.setBool("recording.compact", false);
+		}
+	}
+
 	void onLoad(ICore* c) override
 	{
 		core = c;
+		compact = *core->getConfig().getBool("recording.compact");
 		core->getPlayers().getPlayerConnectDispatcher().addEventHandler(this);
+		core->getEventDispatcher().addEventHandler(this);
 		NetCode::Packet::PlayerFootSync::addEventHandler(*core, &onFootRecordingHandler);
 		NetCode::Packet::PlayerVehicleSync::addEventHandler(*core, &driverRecordingHandler);
 	}
@@ -219,6 +540,22 @@ public:
 				}
 			}
 		}
+
+		if (updating)
+		{
+			for (auto& playback : playbacks)
+			{
+				changes.emplace_back(PlaybackChange { playback.first, nullptr });
+			}
+		}
+		else
+		{
+			playbacks.clear();
+		}
+		for (IPlayer* bot : bots)
+		{
+			bot->kick();
+		}
 	}
 
 	void free() override
@@ -231,12 +568,15 @@ public:
 		if (core)
 		{
 			core->getPlayers().getPlayerConnectDispatcher().removeEventHandler(this);
+			core->getEventDispatcher().removeEventHandler(this);
 			NetCode::Packet::PlayerFootSync::removeEventHandler(*core, &onFootRecordingHandler);
 			NetCode::Packet::PlayerVehicleSync::removeEventHandler(*core, &driverRecordingHandler);
 		}
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new RecordingsComponent();
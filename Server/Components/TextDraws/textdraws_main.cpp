@@ -9,10 +9,11 @@
 #include "textdraw.hpp"
 #include <Impl/pool_impl.hpp>
 #include <netcode.hpp>
+#include <allocations.hpp>
 
 using namespace Impl;
 
-class PlayerTextDrawData final : public IPlayerTextDrawData
+class PlayerTextDrawData final : public IPlayerTextDrawData, public TrackedAllocation<PlayerTextDrawData>
 {
 private:
 	IPlayer& player;
@@ -117,7 +118,7 @@ public:
 	}
 };
 
-class TextDrawsComponent final : public ITextDrawsComponent, public PlayerConnectEventHandler, public PoolEventHandler<IPlayer>
+class TextDrawsComponent final : public ITextDrawsComponent, public PlayerConnectEventHandler, public PoolEventHandler<IPlayer>, public TrackedAllocation<TextDrawsComponent>
 {
 private:
 	ICore* core = nullptr;
@@ -294,6 +295,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new TextDrawsComponent();
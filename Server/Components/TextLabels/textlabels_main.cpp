@@ -10,10 +10,11 @@
 #include <Impl/pool_impl.hpp>
 #include <Server/Components/Vehicles/vehicles.hpp>
 #include <netcode.hpp>
+#include <allocations.hpp>
 
 using namespace Impl;
 
-class PlayerTextLabelData final : public IPlayerTextLabelData
+class PlayerTextLabelData final : public IPlayerTextLabelData, public TrackedAllocation<PlayerTextLabelData>
 {
 private:
 	IPlayer& player;
@@ -112,7 +113,7 @@ public:
 	}
 };
 
-class TextLabelsComponent final : public ITextLabelsComponent, public PlayerConnectEventHandler, public PlayerUpdateEventHandler, public PoolEventHandler<IPlayer>
+class TextLabelsComponent final : public ITextLabelsComponent, public PlayerConnectEventHandler, public PlayerUpdateEventHandler, public PoolEventHandler<IPlayer>, public TrackedAllocation<TextLabelsComponent>
 {
 private:
 	ICore* core = nullptr;
@@ -332,6 +333,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new TextLabelsComponent();
@@ -8,6 +8,8 @@
 
 #include <Server/Components/Timers/timers.hpp>
 
+class TimersComponent;
+
 class Timer final : public ITimer
 {
 private:
@@ -16,8 +18,26 @@ private:
 	const Milliseconds interval_;
 	TimePoint timeout_;
 	TimerTimeOutHandler* const handler_;
+	TimersComponent& owner_;
+	const uint64_t sequence_; ///< Creation order, breaks ties between timers due at the same time
 
 public:
+	static constexpr size_t NotQueued = SIZE_MAX;
+
+	/// Where the timer is in the component's heap, `NotQueued` while it is being fired or once killed.
+	size_t heapIndex = NotQueued;
+
+	inline uint64_t sequence() const
+	{
+		return sequence_;
+	}
+
+	/// The order timers are fired in: earliest timeout first, then oldest first.
+	inline bool before(const Timer& other) const
+	{
+		return timeout_ < other.timeout_ || (timeout_ == other.timeout_ && sequence_ < other.sequence_);
+	}
+
 	inline TimePoint getTimeout() const
 	{
 		return timeout_;
@@ -28,12 +48,14 @@ public:
 		timeout_ = timeout;
 	}
 
-	Timer(TimerTimeOutHandler* handler, Milliseconds initial, Milliseconds interval, unsigned int count)
+	Timer(TimersComponent& owner, uint64_t sequence, TimerTimeOutHandler* handler, TimePoint now, Milliseconds initial, Milliseconds interval, unsigned int count)
 		: running_(true)
 		, count_(count)
 		, interval_(interval)
-		, timeout_(Time::now() + initial)
+		, timeout_(now + initial)
 		, handler_(handler)
+		, owner_(owner)
+		, sequence_(sequence)
 	{
 	}
 
@@ -62,11 +84,11 @@ public:
 		return handler_;
 	}
 
-	void kill() override
-	{
-		running_ = false;
-	}
+	/// Defined with the component, which takes the timer out of its heap.
+	void kill() override;
 
+	/// Count a call, killing the timer once it has made all of them, so it is freed like any other
+	/// killed timer wherever this is called from.
 	bool trigger() override
 	{
 		if (running_ == false)
@@ -81,7 +103,7 @@ public:
 		--count_;
 		if (count_ == 0)
 		{
-			running_ = false;
+			kill();
 		}
 		return running_;
 	}
@@ -8,13 +8,97 @@
 
 #include "timer.hpp"
 #include <sdk.hpp>
-#include <list>
+#include <algorithm>
 
 class TimersComponent final : public ITimersComponent, public CoreEventHandler
 {
 private:
 	ICore* core = nullptr;
-	std::list<Timer*> timers;
+	/// Running timers as a binary min-heap on their next timeout, each knowing its own index so it
+	/// can be taken out directly when killed.  Only the timers that are due are looked at each tick.
+	DynamicArray<Timer*> heap;
+	/// Timers that are due this tick, fired in creation order like they always have been.
+	DynamicArray<Timer*> due;
+	/// Killed timers, deleted at the end of the tick as code killing them may still use them.
+	DynamicArray<Timer*> killed;
+	uint64_t nextSequence = 0;
+	size_t running = 0;
+
+	void place(Timer* timer, size_t index)
+	{
+		heap[index] = timer;
+		timer->heapIndex = index;
+	}
+
+	void siftUp(size_t index)
+	{
+		Timer* const timer = heap[index];
+		while (index != 0)
+		{
+			const size_t parent = (index - 1) / 2;
+			if (!timer->before(*heap[parent]))
+			{
+				break;
+			}
+			place(heap[parent], index);
+			index = parent;
+		}
+		place(timer, index);
+	}
+
+	void siftDown(size_t index)
+	{
+		Timer* const timer = heap[index];
+		const size_t size = heap.size();
+		for (;;)
+		{
+			size_t child = index * 2 + 1;
+			if (child >= size)
+			{
+				break;
+			}
+			if (child + 1 < size && heap[child + 1]->before(*heap[child]))
+			{
+				++child;
+			}
+			if (!heap[child]->before(*timer))
+			{
+				break;
+			}
+			place(heap[child], index);
+			index = child;
+		}
+		place(timer, index);
+	}
+
+	void push(Timer* timer)
+	{
+		heap.push_back(timer);
+		siftUp(heap.size() - 1);
+	}
+
+	void remove(Timer* timer)
+	{
+		const size_t index = timer->heapIndex;
+		timer->heapIndex = Timer::NotQueued;
+		Timer* const last = heap.back();
+		heap.pop_back();
+		if (last != timer)
+		{
+			place(last, index);
+			// The replacement may belong above or below the removed timer's slot.
+			siftUp(index);
+			siftDown(last->heapIndex);
+		}
+	}
+
+	Timer* add(TimerTimeOutHandler* handler, Milliseconds initial, Milliseconds interval, unsigned int count)
+	{
+		Timer* timer = new Timer(*this, nextSequence++, handler, Time::now(), initial, interval, count);
+		push(timer);
+		++running;
+		return timer;
+	}
 
 public:
 	StringView componentName() const override
@@ -40,64 +124,81 @@ public:
 			core->getEventDispatcher().removeEventHandler(this);
 		}
 
-		for (auto timer : timers)
+		for (auto timer : heap)
+		{
+			delete timer;
+		}
+		heap.clear();
+		for (auto timer : killed)
 		{
 			delete timer;
 		}
-		timers.clear();
+		killed.clear();
 	}
 
 	ITimer* create(TimerTimeOutHandler* handler, Milliseconds interval, bool repeating) override
 	{
-		Timer* timer = new Timer(handler, interval, interval, repeating ? 0 : 1);
-		timers.push_back(timer);
-		return timer;
+		return add(handler, interval, interval, repeating ? 0 : 1);
 	}
 
 	ITimer* create(TimerTimeOutHandler* handler, Milliseconds initial, Milliseconds interval, unsigned int count) override
 	{
-		Timer* timer = new Timer(handler, initial, interval, count);
-		timers.push_back(timer);
-		return timer;
+		return add(handler, initial, interval, count);
+	}
+
+	/// Called by `Timer::kill` for a timer that was still running, including from `Timer::trigger`
+	/// once it has made its last call.
+	void onKill(Timer* timer)
+	{
+		if (timer->heapIndex != Timer::NotQueued)
+		{
+			remove(timer);
+		}
+		--running;
+		killed.push_back(timer);
 	}
 
 	void onTick(Microseconds elapsed, TimePoint now) override
 	{
-		for (auto it = timers.begin(); it != timers.end();)
+		while (!heap.empty() && heap.front()->getTimeout() <= now)
 		{
-			Timer* timer = *it;
-			bool deleteTimer = false;
-			if (!timer->running())
+			Timer* timer = heap.front();
+			remove(timer);
+			due.push_back(timer);
+		}
+		std::sort(due.begin(), due.end(), [](Timer* a, Timer* b)
 			{
-				deleteTimer = true;
-			}
-			else
+				return a->sequence() < b->sequence();
+			});
+
+		for (Timer* timer : due)
+		{
+			// Killed by a timer fired before it, it's already in `killed`.
+			if (!timer->running())
 			{
-				const TimePoint now = Time::now();
-				const Milliseconds diff = duration_cast<Milliseconds>(now - timer->getTimeout());
-				if (diff.count() >= 0)
-				{
-					timer->handler()->timeout(*timer);
-					if (timer->trigger())
-					{
-						timer->setTimeout(now + timer->interval() - diff);
-					}
-					else
-					{
-						deleteTimer = true;
-					}
-				}
+				continue;
 			}
-			if (deleteTimer)
+			const Milliseconds diff = duration_cast<Milliseconds>(now - timer->getTimeout());
+			timer->handler()->timeout(*timer);
+			if (!timer->running())
 			{
-				delete timer;
-				it = timers.erase(it);
+				// Killed itself.
+				continue;
 			}
-			else
+			// Otherwise it made its last call and killed itself.
+			if (timer->trigger())
 			{
-				++it;
+				timer->setTimeout(now + timer->interval() - diff);
+				push(timer);
 			}
 		}
+		due.clear();
+
+		for (Timer* timer : killed)
+		{
+			delete timer;
+		}
+		killed.clear();
 	}
 
 	void free() override
@@ -113,14 +214,19 @@ public:
 
 	const size_t count() const override
 	{
-		return std::count_if(timers.begin(), timers.end(),
-			[](Timer* timer)
-			{
-				return timer->running();
-			});
+		return running;
 	}
 };
 
+void Timer::kill()
+{
+	if (running_)
+	{
+		running_ = false;
+		owner_.onKill(this);
+	}
+}
+
 COMPONENT_ENTRY_POINT()
 {
 	return new TimersComponent();
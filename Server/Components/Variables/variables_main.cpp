@@ -8,6 +8,7 @@
 
 #include <Server/Components/Variables/variables.hpp>
 #include <sdk.hpp>
+#include <allocations.hpp>
 #include <variant>
 
 using namespace Impl;
@@ -157,7 +158,7 @@ public:
 	}
 };
 
-class PlayerVariableData final : public VariableStorageBase<IPlayerVariableData>
+class PlayerVariableData final : public VariableStorageBase<IPlayerVariableData>, public TrackedAllocation<PlayerVariableData>
 {
 public:
 	void freeExtension() override
@@ -171,7 +172,7 @@ public:
 	}
 };
 
-class VariablesComponent final : public VariableStorageBase<IVariablesComponent>, public PlayerConnectEventHandler
+class VariablesComponent final : public VariableStorageBase<IVariablesComponent>, public PlayerConnectEventHandler, public TrackedAllocation<VariablesComponent>
 {
 private:
 	ICore* core = nullptr;
@@ -217,6 +218,8 @@ public:
 	}
 };
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new VariablesComponent();
@@ -13,6 +13,7 @@
 #include <Server/Components/Vehicles/vehicles.hpp>
 #include <chrono>
 #include <netcode.hpp>
+#include <allocations.hpp>
 
 using namespace Impl;
 
@@ -422,7 +423,7 @@ public:
 	}
 };
 
-class PlayerVehicleData final : public IPlayerVehicleData
+class PlayerVehicleData final : public IPlayerVehicleData, public TrackedAllocation<PlayerVehicleData>
 {
 private:
 	IPlayer& player;
@@ -8,6 +8,8 @@
 
 #include "vehicles_impl.hpp"
 
+COMPONENT_ALLOCATION_STATS()
+
 COMPONENT_ENTRY_POINT()
 {
 	return new VehiclesComponent();
@@ -9,14 +9,24 @@
 #pragma once
 
 #include "player_pool.hpp"
+#include "trace_recorder.hpp"
 #include "util.hpp"
+#include "watchdog.hpp"
 #include <Impl/network_impl.hpp>
+#include <Server/Components/Actors/actors.hpp>
 #include <Server/Components/Classes/classes.hpp>
 #include <Server/Components/Console/console.hpp>
+#include <Server/Components/GangZones/gangzones.hpp>
+#include <Server/Components/Menus/menus.hpp>
+#include <Server/Components/Objects/objects.hpp>
+#include <Server/Components/Pickups/pickups.hpp>
+#include <Server/Components/TextDraws/textdraws.hpp>
+#include <Server/Components/TextLabels/textlabels.hpp>
 #include <Server/Components/Unicode/unicode.hpp>
 #include <Server/Components/Vehicles/vehicles.hpp>
 #include <Server/Components/LegacyConfig/legacyconfig.hpp>
 #include <Server/Components/CustomModels/custommodels.hpp>
+#include <algorithm>
 #include <cstdarg>
 #include <cxxopts.hpp>
 #include <events.hpp>
@@ -26,6 +36,8 @@
 #include <pool.hpp>
 #include <sstream>
 #include <thread>
+#include <allocations.hpp>
+#include <typeinfo>
 #include <variant>
 #include <utils.hpp>
 
@@ -134,6 +146,8 @@ static const std::map<String, ConfigStorage> Defaults {
 	{ "logo", String("") },
 	// discord
 	{ "discord.invite", String("") },
+	// watchdog
+	{ "watchdog.threshold", 0 }, // Milliseconds a single tick may take before it is reported, 0 to disable
 };
 
 // Provide automatic Defaults → JSON conversion in Config
@@ -276,6 +290,34 @@ public:
 			});
 	}
 
+	void provideTraceRecorder(ITraceRecorder* recorder)
+	{
+		std::for_each(components.begin(), components.end(),
+			[recorder](const robin_hood::pair<UID, IComponent*>& pair)
+			{
+				ITraceConsumer* consumer = queryExtension<ITraceConsumer>(pair.second);
+				if (consumer)
+				{
+					consumer->setTraceRecorder(recorder);
+				}
+			});
+	}
+
+	DynamicArray<ITraceTimingSink*> timingSinks()
+	{
+		DynamicArray<ITraceTimingSink*> sinks;
+		std::for_each(components.begin(), components.end(),
+			[&sinks](const robin_hood::pair<UID, IComponent*>& pair)
+			{
+				ITraceTimingSink* sink = queryExtension<ITraceTimingSink>(pair.second);
+				if (sink)
+				{
+					sinks.push_back(sink);
+				}
+			});
+		return sinks;
+	}
+
 	void free()
 	{
 		for (auto it = components.begin(); it != components.end();)
@@ -306,6 +348,35 @@ private:
 
 static constexpr const char* TimeFormat = "%Y-%m-%dT%H:%M:%S%z";
 
+/// Longest window the `trace` command captures, and the most events it keeps from that window.
+static constexpr int MaxTraceSeconds = 60;
+static constexpr size_t MaxTraceEvents = 1 << 20;
+
+/// How many tick periods the scheduler may fall behind before it stops catching up and
+/// schedules from the current time again.
+static constexpr int MaxTickCatchUp = 4;
+
+/// Per-second tick timings, reported by the `tickstats` command.
+struct TickStats
+{
+	Microseconds workTotal { 0 };
+	Microseconds workMax { 0 };
+	Microseconds jitterTotal { 0 };
+	Microseconds jitterMax { 0 };
+	unsigned ticks = 0;
+	unsigned late = 0; ///< Ticks that finished after the next one was due
+	unsigned skipped = 0; ///< Tick periods dropped because catching up would take too long
+
+	void record(Microseconds work, Microseconds jitter)
+	{
+		++ticks;
+		workTotal += work;
+		workMax = std::max(workMax, work);
+		jitterTotal += jitter;
+		jitterMax = std::max(jitterMax, jitter);
+	}
+};
+
 class Config final : public IEarlyConfig
 {
 private:
@@ -973,7 +1044,10 @@ private:
 	DefaultEventDispatcher<CoreEventHandler> eventDispatcher;
 	PlayerPool players;
 	Microseconds sleepTimer;
-	Microseconds sleepDuration;
+	TimePoint nextTick;
+	Microseconds oversleep;
+	TickStats tickStats;
+	TickStats lastTickStats;
 	bool _useDynTicks;
 	FlatPtrHashSet<INetwork> networks;
 	ComponentList components;
@@ -986,6 +1060,9 @@ private:
 	unsigned ticksThisSecond;
 	TimePoint ticksPerSecondLastUpdate;
 	std::set<HTTPAsyncIO*> httpFutures;
+	TraceRecorder trace;
+	DynamicArray<Pair<IComponent*, ComponentAllocationStats_t>> allocationStats;
+	TickWatchdog watchdog;
 
 	bool* EnableZoneNames;
 	bool* UsePlayerPedAnims;
@@ -1066,6 +1143,11 @@ private:
 			LIBRARY_FREE(componentLib);
 			return nullptr;
 		}
+		ComponentAllocationStats_t allocations = reinterpret_cast<ComponentAllocationStats_t>(LIBRARY_GET_ADDR(componentLib, "ComponentAllocationStats"));
+		if (allocations)
+		{
+			allocationStats.emplace_back(component, allocations);
+		}
 		SemanticVersion ver = component->componentVersion();
 		printLn(
 			"\tSuccessfully loaded component %.*s (%u.%u.%u.%u) with UID %016llx",
@@ -1474,17 +1556,20 @@ public:
 		sleepTimer = Microseconds(static_cast<long long>(*config.getFloat("sleep") * 1000.0f));
 		_useDynTicks = *config.getBool("use_dyn_ticks");
 		TimePoint prev = Time::now();
-		sleepDuration = sleepTimer;
+		nextTick = prev;
+		oversleep = Microseconds(0);
+		if (watchdog.start(Milliseconds(*config.getInt("watchdog.threshold"))))
+		{
+			trace.setWatched(true);
+			updateTraceRecorder();
+		}
 
 		while (run_)
 		{
 			const TimePoint now = Time::now();
 			const Microseconds us = duration_cast<Microseconds>(now - prev);
-
-			if (_useDynTicks)
-			{
-				sleepDuration += sleepTimer - us;
-			}
+			const Microseconds jitter = duration_cast<Microseconds>(now > nextTick ? now - nextTick : nextTick - now);
+			watchdog.beat(now);
 
 			prev = now;
 
@@ -1493,26 +1578,91 @@ public:
 				ticksPerSecondLastUpdate = now;
 				ticksPerSecond = ticksThisSecond;
 				ticksThisSecond = 0u;
+				lastTickStats = tickStats;
+				tickStats = TickStats();
 			}
 			++ticksThisSecond;
 
-			eventDispatcher.dispatch(&CoreEventHandler::onTick, us, now);
+			if (trace.finished(now))
+			{
+				finishTrace();
+			}
 
-			for (auto it = httpFutures.begin(); it != httpFutures.end();)
+			// Handlers get a scope each while tracing, while the watchdog needs them to attribute stalls, or
+			// while a timing sink wants to know how long they take.
+			if (OMP_TRACE_ENABLED && trace.enabled())
 			{
-				HTTPAsyncIO* httpIO = *it;
-				if (httpIO->tryExec())
-				{
-					delete httpIO;
-					it = httpFutures.erase(it);
-				}
-				else
+				OMP_TRACE_SCOPE(&trace, TraceCategory::Tick, "Tick");
+				eventDispatcher.stopAtFalse([this, us, now](CoreEventHandler* handler)
+					{
+						OMP_TRACE_SCOPE(&trace, TraceCategory::Handler, typeid(*handler).name());
+						handler->onTick(us, now);
+						return true;
+					});
+			}
+			else
+			{
+				eventDispatcher.dispatch(&CoreEventHandler::onTick, us, now);
+			}
+
+			{
+				OMP_TRACE_SCOPE(getTraceRecorder(), TraceCategory::Tick, "HTTP");
+				for (auto it = httpFutures.begin(); it != httpFutures.end();)
 				{
-					++it;
+					HTTPAsyncIO* httpIO = *it;
+					if (httpIO->tryExec())
+					{
+						delete httpIO;
+						it = httpFutures.erase(it);
+					}
+					else
+					{
+						++it;
+					}
 				}
 			}
 
-			std::this_thread::sleep_until(now + sleepDuration);
+			const TimePoint done = Time::now();
+			tickStats.record(duration_cast<Microseconds>(done - now), jitter);
+			scheduleNextTick(now, done);
+
+			if (nextTick > done)
+			{
+				// Wake up early by however much the OS usually oversleeps, rather than spinning.
+				const TimePoint wake = nextTick - oversleep;
+				std::this_thread::sleep_until(wake);
+				const Microseconds late = duration_cast<Microseconds>(Time::now() - wake);
+				oversleep = std::clamp((oversleep * 7 + late) / 8, Microseconds(0), sleepTimer / 2);
+			}
+		}
+
+		watchdog.stop();
+		trace.setWatched(false);
+		updateTraceRecorder();
+	}
+
+	/// With dynamic ticks the server runs on a fixed timestep: every tick is due one period after the
+	/// previous one was due, so a long tick is made up for by running the following ones back to back
+	/// instead of stretching every later period.  Falling more than `MaxTickCatchUp` periods behind
+	/// drops the backlog.  Without dynamic ticks each tick is due one period after the last one started.
+	void scheduleNextTick(TimePoint start, TimePoint done)
+	{
+		if (!_useDynTicks)
+		{
+			nextTick = start + sleepTimer;
+			return;
+		}
+
+		nextTick += sleepTimer;
+		if (nextTick < done)
+		{
+			++tickStats.late;
+			const TimePoint::duration behind = done - nextTick;
+			if (behind > sleepTimer * MaxTickCatchUp)
+			{
+				tickStats.skipped += unsigned(behind / sleepTimer);
+				nextTick = done;
+			}
 		}
 	}
 
@@ -1524,11 +1674,6 @@ public:
 	void useDynTicks(const bool enable) override
 	{
 		_useDynTicks = enable;
-
-		if (!enable)
-		{
-			sleepDuration = sleepTimer;
-		}
 	}
 
 	void resetAll() override
@@ -1575,6 +1720,7 @@ public:
 		, run_(true)
 		, ticksPerSecond(0u)
 		, ticksThisSecond(0u)
+		, watchdog(*this, trace)
 		, EnableLogTimestamp(false)
 	{
 		// Initialize start time
@@ -1731,6 +1877,8 @@ public:
 		}
 
 		models = components.queryComponent<ICustomModelsComponent>();
+		trace.setTimingSinks(components.timingSinks());
+		updateTraceRecorder();
 		components.ready();
 	}
 
@@ -1746,6 +1894,9 @@ public:
 
 		players.free();
 		networks.clear();
+		// The sinks are components too, don't time anything they'd get told about after being freed.
+		trace.setTimingSinks({});
+		updateTraceRecorder();
 		components.free();
 
 		if (logFile)
@@ -2140,6 +2291,12 @@ public:
 		commands.emplace("reloadlog");
 		commands.emplace("config");
 		commands.emplace("varlist");
+		commands.emplace("memstats");
+		commands.emplace("tickstats");
+		if (OMP_TRACE_ENABLED)
+		{
+			commands.emplace("trace");
+		}
 	}
 
 	bool onConsoleText(StringView command, StringView parameters, const ConsoleCommandSenderData& sender) override
@@ -2178,6 +2335,21 @@ public:
 			config.enumOptions(cb);
 			return true;
 		}
+		else if (command == "memstats")
+		{
+			printMemoryStats(sender);
+			return true;
+		}
+		else if (command == "tickstats")
+		{
+			printTickStats(sender);
+			return true;
+		}
+		else if (OMP_TRACE_ENABLED && command == "trace")
+		{
+			startTrace(parameters, sender);
+			return true;
+		}
 		else // Process potential variable set
 		{
 			const auto alias = config.getNameFromAlias(command);
@@ -2200,6 +2372,143 @@ public:
 		return false;
 	}
 
+	static String formatBytes(size_t bytes)
+	{
+		char buf[32];
+		if (bytes >= 1024 * 1024)
+		{
+			snprintf(buf, sizeof(buf), "%.1f MiB", bytes / (1024.0 * 1024.0));
+		}
+		else
+		{
+			snprintf(buf, sizeof(buf), "%.1f KiB", bytes / 1024.0);
+		}
+		return buf;
+	}
+
+	void printTickStats(const ConsoleCommandSenderData& sender)
+	{
+		const TickStats& stats = lastTickStats;
+		const unsigned ticks = std::max(stats.ticks, 1u);
+		char buf[256];
+		snprintf(buf, sizeof(buf), "Ticks in the last second: %u (target %.0f, dynamic ticks %s)", stats.ticks, 1000000.0 / std::max<long long>(sleepTimer.count(), 1), _useDynTicks ? "on" : "off");
+		console->sendMessage(sender, buf);
+		snprintf(buf, sizeof(buf), "  work: %.3fms avg, %.3fms max", stats.workTotal.count() / 1000.0 / ticks, stats.workMax.count() / 1000.0);
+		console->sendMessage(sender, buf);
+		snprintf(buf, sizeof(buf), "  jitter: %.3fms avg, %.3fms max", stats.jitterTotal.count() / 1000.0 / ticks, stats.jitterMax.count() / 1000.0);
+		console->sendMessage(sender, buf);
+		snprintf(buf, sizeof(buf), "  late: %u, skipped: %u, sleep compensation: %.3fms", stats.late, stats.skipped, oversleep.count() / 1000.0);
+		console->sendMessage(sender, buf);
+	}
+
+	template <class Pool>
+	void printPoolStats(const ConsoleCommandSenderData& sender, StringView name, Pool* pool)
+	{
+		if (pool)
+		{
+			const Pair<size_t, size_t> bounds = pool->bounds();
+			console->sendMessage(sender, "  " + String(name) + ": " + std::to_string(pool->count()) + "/" + std::to_string(bounds.second - bounds.first));
+		}
+	}
+
+	void printMemoryStats(const ConsoleCommandSenderData& sender)
+	{
+		console->sendMessage(sender, "Pool occupancy (used/capacity):");
+		const Pair<size_t, size_t> playerBounds = players.bounds();
+		console->sendMessage(sender, "  players: " + std::to_string(players.entries().size()) + "/" + std::to_string(playerBounds.second - playerBounds.first));
+		printPoolStats(sender, "actors", components.queryComponent<IActorsComponent>());
+		printPoolStats(sender, "classes", components.queryComponent<IClassesComponent>());
+		printPoolStats(sender, "gangzones", components.queryComponent<IGangZonesComponent>());
+		printPoolStats(sender, "menus", components.queryComponent<IMenusComponent>());
+		printPoolStats(sender, "objects", components.queryComponent<IObjectsComponent>());
+		printPoolStats(sender, "pickups", components.queryComponent<IPickupsComponent>());
+		printPoolStats(sender, "textdraws", components.queryComponent<ITextDrawsComponent>());
+		printPoolStats(sender, "textlabels", components.queryComponent<ITextLabelsComponent>());
+		printPoolStats(sender, "vehicles", components.queryComponent<IVehiclesComponent>());
+
+		console->sendMessage(sender, "Allocations (live, peak, created since start):");
+		size_t totalBytes = 0;
+		for (const Pair<IComponent*, ComponentAllocationStats_t>& component : allocationStats)
+		{
+			const String prefix = "  [" + String(component.first->componentName()) + "] ";
+			for (const AllocationStats* stats = component.second(); stats; stats = stats->next)
+			{
+				totalBytes += stats->liveBytes;
+				console->sendMessage(sender,
+					prefix + TraceRecorder::demangle(stats->name)
+						+ ": " + std::to_string(stats->live) + " (" + formatBytes(stats->liveBytes) + ")"
+						+ ", peak " + std::to_string(stats->peak) + " (" + formatBytes(stats->peakBytes) + ")"
+						+ ", " + std::to_string(stats->total) + " created");
+			}
+		}
+		console->sendMessage(sender, "Total tracked: " + formatBytes(totalBytes));
+	}
+
+	/// The recorder to enter scopes on, null when nothing is interested in them.
+	ITraceRecorder* getTraceRecorder()
+	{
+		return trace.enabled() ? &trace : nullptr;
+	}
+
+	/// Tell components whether to enter scopes, whenever capturing, watching or timing starts or stops.
+	void updateTraceRecorder()
+	{
+		components.provideTraceRecorder(getTraceRecorder());
+	}
+
+	void startTrace(StringView parameters, const ConsoleCommandSenderData& sender)
+	{
+		if (trace.active())
+		{
+			console->sendMessage(sender, "A trace is already being captured.");
+			return;
+		}
+
+		// Accept `10`, `10s` and `500ms`, defaulting to seconds.
+		char* end = nullptr;
+		const String param(trim(parameters));
+		const long value = std::strtol(param.c_str(), &end, 10);
+		Milliseconds window;
+		if (end == param.c_str() || value <= 0)
+		{
+			console->sendMessage(sender, "Usage: trace <duration>, e.g. `trace 10s` or `trace 500ms`.");
+			return;
+		}
+		else if (StringView(end) == "ms")
+		{
+			window = Milliseconds(value);
+		}
+		else if (*end == '\0' || StringView(end) == "s")
+		{
+			window = duration_cast<Milliseconds>(Seconds(value));
+		}
+		else
+		{
+			console->sendMessage(sender, "Usage: trace <duration>, e.g. `trace 10s` or `trace 500ms`.");
+			return;
+		}
+
+		window = std::min(window, duration_cast<Milliseconds>(Seconds(MaxTraceSeconds)));
+		trace.start(window, MaxTraceEvents);
+		updateTraceRecorder();
+		console->sendMessage(sender, "Capturing a trace for " + std::to_string(window.count()) + "ms.");
+	}
+
+	void finishTrace()
+	{
+		const String path = "trace_" + std::to_string(duration_cast<Seconds>(WorldTime::now().time_since_epoch()).count()) + ".json";
+		const int events = trace.stop(path);
+		updateTraceRecorder();
+		if (events < 0)
+		{
+			logLn(LogLevel::Error, "Could not write trace file \"%s\".", path.c_str());
+		}
+		else
+		{
+			logLn(LogLevel::Message, "Wrote %d trace events to \"%s\".", events, path.c_str());
+		}
+	}
+
 	void requestHTTP4(HTTPResponseHandler* handler, HTTPRequestType type, StringView url, StringView data) override
 	{
 		HTTPAsyncIO* httpIO = new HTTPAsyncIO(handler, type, url, data, true, config.getString("network.bind"));
@@ -0,0 +1,317 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+#include <trace.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+/// Records begin/end pairs of named scopes into a bounded ring buffer and writes them out in the
+/// Chrome trace-event format (chrome://tracing, ui.perfetto.dev).  Only ever touched from the main
+/// thread, so there's no locking.
+///
+/// While the tick watchdog runs the recorder also keeps the stack of scopes currently open on the
+/// main thread, capturing or not, which other threads can read to find out what a stalled tick is
+/// busy with.  Timing sinks, if there are any, are told how long each named scope took.  When none
+/// of those are on nothing should be entering scopes at all, see `enabled()`.
+class TraceRecorder final : public ITraceRecorder
+{
+public:
+	static constexpr size_t MaxActiveScopes = 32;
+
+	struct ActiveScope
+	{
+		TraceCategory category;
+		const char* name;
+		const void* context;
+		int index;
+	};
+
+private:
+	struct AtomicScope
+	{
+		std::atomic<TraceCategory> category { TraceCategory::End };
+		std::atomic<const char*> name { nullptr };
+		std::atomic<const void*> context { nullptr };
+		std::atomic<int> index { 0 };
+	};
+
+	/// A scope that hasn't been left yet, as far as the capture is concerned
+	struct OpenScope
+	{
+		TraceCategory category;
+		bool captured; ///< Its begin event was recorded, so its end event has to be as well
+		const char* name; ///< Only set for timing sinks
+		TimePoint start; ///< Only set for timing sinks
+	};
+
+	struct Event
+	{
+		uint64_t time; ///< Nanoseconds since the capture started
+		uint32_t name; ///< Index into `names_`
+		char phase; ///< 'B' or 'E'
+		TraceCategory category;
+	};
+
+	bool active_ = false;
+	bool watched_ = false;
+	TimePoint start_;
+	TimePoint end_;
+	DynamicArray<Event> events_;
+	size_t head_ = 0;
+	bool wrapped_ = false;
+	DynamicArray<String> names_;
+	FlatHashMap<String, uint32_t> nameIds_;
+	TraceNameResolver resolver_ = nullptr;
+	DynamicArray<OpenScope> open_;
+	DynamicArray<ITraceTimingSink*> sinks_;
+	StaticArray<AtomicScope, MaxActiveScopes> scopes_;
+	std::atomic<size_t> depth_ { 0 };
+
+	uint32_t intern(StringView name)
+	{
+		auto it = nameIds_.find(String(name));
+		if (it != nameIds_.end())
+		{
+			return it->second;
+		}
+		const uint32_t id = names_.size();
+		names_.emplace_back(name);
+		nameIds_.emplace(String(name), id);
+		return id;
+	}
+
+	void push(char phase, TraceCategory category, uint32_t name)
+	{
+		Event& event = events_[head_];
+		event.time = duration_cast<std::chrono::nanoseconds>(Time::now() - start_).count();
+		event.name = name;
+		event.phase = phase;
+		event.category = category;
+		if (++head_ == events_.size())
+		{
+			head_ = 0;
+			wrapped_ = true;
+		}
+	}
+
+	static void writeEscaped(FILE* file, StringView str)
+	{
+		for (char c : str)
+		{
+			if (c == '"' || c == '\\')
+			{
+				fputc('\\', file);
+			}
+			else if (static_cast<unsigned char>(c) < 0x20)
+			{
+				continue;
+			}
+			fputc(c, file);
+		}
+	}
+
+public:
+	static const char* categoryName(TraceCategory category)
+	{
+		static const char* const names[] = { "tick", "handler", "plugin", "public", "native" };
+		return category < TraceCategory::End ? names[size_t(category)] : "";
+	}
+
+	/// Turn a `typeid().name()` into something readable for scope names.
+	static String demangle(const char* name)
+	{
+		return demangleTraceName(name);
+	}
+
+	bool active() const
+	{
+		return active_;
+	}
+
+	bool capturing() const override
+	{
+		return active_;
+	}
+
+	/// Whether scopes need entering, for a capture, the watchdog or timing sinks.  Scopes are only
+	/// worth their cost while this is true, so nobody is handed the recorder otherwise.
+	bool enabled() const
+	{
+		return active_ || watched_ || !sinks_.empty();
+	}
+
+	/// Replace the timing sinks.  Only call this with no scopes open.
+	void setTimingSinks(DynamicArray<ITraceTimingSink*> sinks)
+	{
+		sinks_ = std::move(sinks);
+	}
+
+	/// Set while the watchdog thread is running and reading the active stack.
+	void setWatched(bool watched)
+	{
+		watched_ = watched;
+	}
+
+	/// Start a capture of `window` length, keeping at most the last `capacity` events.
+	void start(Milliseconds window, size_t capacity)
+	{
+		events_.clear();
+		events_.resize(capacity);
+		names_.clear();
+		nameIds_.clear();
+		head_ = 0;
+		wrapped_ = false;
+		start_ = Time::now();
+		end_ = start_ + window;
+		active_ = true;
+	}
+
+	/// True once a running capture has covered its whole window.
+	bool finished(TimePoint now) const
+	{
+		return active_ && now >= end_;
+	}
+
+	void setNameResolver(TraceNameResolver resolver) override
+	{
+		resolver_ = resolver;
+	}
+
+	/// The name of a scope, resolving it if it was recorded without one.
+	const char* resolve(TraceCategory category, const char* name, const void* context, int index) const
+	{
+		if (!name && resolver_)
+		{
+			name = resolver_(category, context, index);
+		}
+		return name ? name : "";
+	}
+
+	void enter(TraceCategory category, const char* name, const void* context, int index) override
+	{
+		const size_t depth = depth_.load(std::memory_order_relaxed);
+		if (depth < MaxActiveScopes)
+		{
+			AtomicScope& scope = scopes_[depth];
+			scope.category.store(category, std::memory_order_relaxed);
+			scope.name.store(name, std::memory_order_relaxed);
+			scope.context.store(context, std::memory_order_relaxed);
+			scope.index.store(index, std::memory_order_relaxed);
+		}
+		depth_.store(depth + 1, std::memory_order_release);
+
+		if (sinks_.empty())
+		{
+			open_.push_back(OpenScope { category, active_, nullptr, TimePoint() });
+		}
+		else
+		{
+			open_.push_back(OpenScope { category, active_, name, Time::now() });
+		}
+		if (active_)
+		{
+			push('B', category, intern(resolve(category, name, context, index)));
+		}
+	}
+
+	void leave() override
+	{
+		depth_.store(depth_.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+
+		const OpenScope scope = open_.back();
+		open_.pop_back();
+		// A capture stopped in the middle of the scope has nowhere to record the end.
+		if (scope.captured && active_)
+		{
+			push('E', scope.category, 0);
+		}
+		// Unnamed scopes are natives, far too many of them to report one by one.
+		if (scope.name)
+		{
+			const Microseconds duration = duration_cast<Microseconds>(Time::now() - scope.start);
+			for (ITraceTimingSink* sink : sinks_)
+			{
+				sink->onScopeTimed(scope.category, scope.name, duration);
+			}
+		}
+	}
+
+	/// Copy the active stack, outermost scope first.  Safe to call from any thread; if the main thread
+	/// is still running the copy is only a best guess.
+	/// @returns The number of scopes copied
+	size_t activeScopes(StaticArray<ActiveScope, MaxActiveScopes>& out) const
+	{
+		const size_t depth = std::min(depth_.load(std::memory_order_acquire), MaxActiveScopes);
+		for (size_t i = 0; i != depth; ++i)
+		{
+			const AtomicScope& scope = scopes_[i];
+			out[i] = ActiveScope {
+				scope.category.load(std::memory_order_relaxed),
+				scope.name.load(std::memory_order_relaxed),
+				scope.context.load(std::memory_order_relaxed),
+				scope.index.load(std::memory_order_relaxed)
+			};
+		}
+		return depth;
+	}
+
+	/// Stop the capture and write it to `path`, releasing the buffer.
+	/// @returns The number of events written, or -1 if the file couldn't be opened
+	int stop(StringView path)
+	{
+		active_ = false;
+		FILE* file = ::fopen(String(path).c_str(), "w");
+		int written = -1;
+		if (file)
+		{
+			written = 0;
+			fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+			const size_t first = wrapped_ ? head_ : 0;
+			const size_t count = wrapped_ ? events_.size() : head_;
+			// Scopes nest, so an end with nothing open is one whose begin the ring buffer overwrote.
+			size_t depth = 0;
+			for (size_t i = 0; i != count; ++i)
+			{
+				const Event& event = events_[(first + i) % events_.size()];
+				if (event.phase == 'B')
+				{
+					++depth;
+				}
+				else if (depth == 0)
+				{
+					continue;
+				}
+				else
+				{
+					--depth;
+				}
+				fputs(written ? ",\n{" : "\n{", file);
+				if (event.phase == 'B')
+				{
+					fputs("\"name\":\"", file);
+					// Handlers are recorded by their mangled type name, which is cheap to get hold of.
+					writeEscaped(file, event.category == TraceCategory::Handler ? demangle(names_[event.name].c_str()) : names_[event.name]);
+					fputs("\",", file);
+				}
+				fprintf(file, "\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":1}", categoryName(event.category), event.phase, event.time / 1000.0);
+				++written;
+			}
+			fputs("\n]}\n", file);
+			fclose(file);
+		}
+		events_.clear();
+		events_.shrink_to_fit();
+		names_.clear();
+		nameIds_.clear();
+		return written;
+	}
+};
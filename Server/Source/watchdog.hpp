@@ -0,0 +1,195 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+#include "trace_recorder.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+#include <csignal>
+#include <cstdlib>
+#include <execinfo.h>
+#include <pthread.h>
+#endif
+
+/// Watches the main loop from a thread of its own and, when a single tick runs for longer than the
+/// threshold, logs which scopes (handlers, plugins, publics, natives) are open on the main thread.
+/// On Linux a stack sample of the main thread is logged as well.  Each stall is reported once.
+class TickWatchdog
+{
+private:
+	static constexpr size_t MaxFrames = 64;
+
+#if defined(__linux__)
+	// Filled in by the signal handler on the main thread, so it has to be static.
+	inline static void* frames_[MaxFrames];
+	inline static std::atomic<int> frameCount_ { -1 };
+
+	static int sampleSignal()
+	{
+		return SIGRTMIN + 7;
+	}
+
+	static void onSampleSignal(int)
+	{
+		frameCount_.store(::backtrace(frames_, MaxFrames), std::memory_order_release);
+	}
+
+	pthread_t mainThread_;
+#endif
+
+	ILogger& logger_;
+	TraceRecorder& trace_;
+	Milliseconds threshold_ { 0 };
+	std::atomic<TimePoint::rep> lastBeat_ { 0 };
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	bool running_ = false;
+
+	void report(Milliseconds stalled)
+	{
+		logger_.logLn(LogLevel::Warning, "[watchdog] The current server tick has been running for %lldms.", static_cast<long long>(stalled.count()));
+
+		StaticArray<TraceRecorder::ActiveScope, TraceRecorder::MaxActiveScopes> scopes;
+		const size_t depth = trace_.activeScopes(scopes);
+		if (depth == 0)
+		{
+			logger_.logLn(LogLevel::Warning, "[watchdog] No scopes are open, the main loop itself is busy.");
+		}
+		for (size_t i = 0; i != depth; ++i)
+		{
+			const TraceRecorder::ActiveScope& scope = scopes[i];
+			const char* name = trace_.resolve(scope.category, scope.name, scope.context, scope.index);
+			// Handlers are recorded by their mangled type name, which is cheap to get hold of.
+			const String readable = scope.category == TraceCategory::Handler ? TraceRecorder::demangle(name) : String(name);
+			logger_.logLn(LogLevel::Warning, "[watchdog]   %*s%s: %s", int(i * 2), "", TraceRecorder::categoryName(scope.category), readable.c_str());
+		}
+
+#if defined(__linux__)
+		frameCount_.store(-1, std::memory_order_relaxed);
+		if (pthread_kill(mainThread_, sampleSignal()) != 0)
+		{
+			return;
+		}
+		int count = -1;
+		for (int i = 0; i != 100 && (count = frameCount_.load(std::memory_order_acquire)) < 0; ++i)
+		{
+			std::this_thread::sleep_for(Milliseconds(1));
+		}
+		if (count <= 0)
+		{
+			logger_.logLn(LogLevel::Warning, "[watchdog] The main thread did not respond to the stack sample request.");
+			return;
+		}
+		logger_.logLn(LogLevel::Warning, "[watchdog] Main thread stack:");
+		char** symbols = ::backtrace_symbols(frames_, count);
+		// Skip the signal handler and the frame it interrupted into.
+		for (int i = 2; i < count; ++i)
+		{
+			logger_.logLn(LogLevel::Warning, "[watchdog]   #%d %s", i - 2, symbols ? symbols[i] : "?");
+		}
+		std::free(symbols);
+#endif
+	}
+
+	void watch()
+	{
+		const Milliseconds interval = std::max(Milliseconds(10), threshold_ / 4);
+		TimePoint::rep stalledBeat = 0;
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (!wake_.wait_for(lock, interval, [this]()
+			{
+				return !running_;
+			}))
+		{
+			const TimePoint::rep beat = lastBeat_.load(std::memory_order_acquire);
+			const Milliseconds stalled = duration_cast<Milliseconds>(Time::now() - TimePoint(TimePoint::duration(beat)));
+			if (beat == stalledBeat)
+			{
+				continue;
+			}
+			if (stalled >= threshold_)
+			{
+				stalledBeat = beat;
+				lock.unlock();
+				report(stalled);
+				lock.lock();
+			}
+		}
+	}
+
+public:
+	TickWatchdog(ILogger& logger, TraceRecorder& trace)
+		: logger_(logger)
+		, trace_(trace)
+	{
+	}
+
+	~TickWatchdog()
+	{
+		stop();
+	}
+
+	/// Start watching, must be called from the main thread.  A zero threshold leaves it disabled.
+	/// @returns "true" if the watchdog thread is running
+	bool start(Milliseconds threshold)
+	{
+		if (thread_.joinable())
+		{
+			return true;
+		}
+		if (threshold.count() <= 0)
+		{
+			return false;
+		}
+		threshold_ = threshold;
+		beat(Time::now());
+
+#if defined(__linux__)
+		mainThread_ = pthread_self();
+		struct sigaction action = {};
+		action.sa_handler = &onSampleSignal;
+		action.sa_flags = SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		sigaction(sampleSignal(), &action, nullptr);
+		// The first call to `backtrace` loads libgcc, which isn't safe to do inside a signal handler.
+		void* warmup[1];
+		::backtrace(warmup, 1);
+#endif
+
+		running_ = true;
+		thread_ = std::thread(&TickWatchdog::watch, this);
+		return true;
+	}
+
+	void stop()
+	{
+		if (!thread_.joinable())
+		{
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			running_ = false;
+		}
+		wake_.notify_all();
+		thread_.join();
+	}
+
+	/// Mark the start of a new tick.
+	void beat(TimePoint now)
+	{
+		lastBeat_.store(now.time_since_epoch().count(), std::memory_order_release);
+	}
+};
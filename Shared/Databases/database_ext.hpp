@@ -0,0 +1,128 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+#include <Server/Components/Databases/databases.hpp>
+
+/// Receives the result of a query started with `IDatabasesExtension::executeQueryAsync`.
+struct IDatabaseQueryHandler
+{
+	/// Called on the main thread, at the start of a tick after the query has finished.  The handler
+	/// owns `result` from here on and must free it with `IDatabasesComponent::freeResultSet`.  Queries
+	/// still undelivered when the databases component is freed are failed, so their handlers can free
+	/// themselves; other components may already be gone by then.
+	/// @param result Result set, or "nullptr" if the query failed
+	virtual void onQueryResult(IDatabaseResultSet* result) = 0;
+};
+
+/// A statement compiled once and run any number of times with different parameters, see
+/// `IDatabasesExtension::prepare`.  Parameters are numbered from 1 and columns from 0, as in SQLite.
+struct IDatabaseStatement : public IIDProvider
+{
+	/// Binds a parameter, keeping it until it's bound again or the statement is freed
+	/// @returns "true" if the parameter exists, otherwise "false"
+	virtual bool bindInt(int index, int64_t value) = 0;
+	virtual bool bindFloat(int index, double value) = 0;
+	virtual bool bindText(int index, StringView value) = 0;
+	virtual bool bindBlob(int index, Span<const char> value) = 0;
+	virtual bool bindNull(int index) = 0;
+
+	/// Runs the statement up to the next row, whose columns can then be read
+	/// @returns 1 if there is a row, 0 once the statement is done, -1 on error
+	virtual int step() = 0;
+
+	/// Rewinds the statement so it can be stepped again, bound parameters are kept
+	virtual bool reset() = 0;
+
+	/// Steps the statement to the end, collecting every row, and resets it
+	/// @returns Result set, or "nullptr" on error
+	virtual IDatabaseResultSet* execute() = 0;
+
+	virtual int getColumnCount() const = 0;
+	virtual StringView getColumnName(int column) const = 0;
+	virtual int64_t getColumnInt(int column) const = 0;
+	virtual double getColumnFloat(int column) const = 0;
+	virtual StringView getColumnText(int column) const = 0;
+};
+
+/// How a connection talks to its file, see `IDatabasesExtension::configure`.  New connections get
+/// the settings from the `sqlite` section of the config.
+struct DatabaseSettings
+{
+	/// Journal mode such as "wal", empty keeps the current one
+	StringView journalMode;
+
+	/// "off", "normal", "full" or "extra", empty keeps the current level
+	StringView synchronous;
+
+	/// Page cache size as in `PRAGMA cache_size`, negative for KiB, zero keeps the current size
+	int cacheSize = 0;
+
+	/// Largest part of the file accessed through memory mapping in bytes, negative keeps the current size
+	int64_t mmapSize = -1;
+
+	/// Collect every write made during a tick into one transaction, committed once per tick, so
+	/// there's one sync per tick instead of one per statement.  Explicit transactions still work:
+	/// `BEGIN`, `COMMIT`, `END` and `ROLLBACK` commit the collected writes first, so a `ROLLBACK`
+	/// can't discard them.  Only the first statement of a query is looked at for this.  Asynchronous
+	/// queries run inside the collecting transaction, so ones starting with these are refused.
+	bool groupCommit = false;
+
+	/// In WAL mode, checkpoint from a background thread this often instead of letting the commit
+	/// that fills the log do it on the main thread.  Zero leaves checkpoints to SQLite.
+	Milliseconds checkpointInterval = Milliseconds(0);
+};
+
+/// Extra database features, queried from the databases component with `queryExtension`.
+struct IDatabasesExtension : public IExtension
+{
+	PROVIDE_EXT_UID(0x7a41d6e03b9c2f58);
+
+	/// Runs a query on a worker thread belonging to the connection, so slow queries don't stall the
+	/// server.  Queries on one connection run one at a time, in the order they were issued.  Closing
+	/// the connection waits for its outstanding queries, their handlers are still called.  The
+	/// connection's handle is shared with the main thread, so a synchronous query on it blocks until
+	/// the asynchronous one running at the time is done, however long that takes.
+	/// @param connection Database connection
+	/// @param query Query to execute
+	/// @param handler Gets the result, must stay alive until it has
+	/// @returns "true" if the query has been queued, otherwise "false" and the handler is never called
+	virtual bool executeQueryAsync(IDatabaseConnection& connection, StringView query, IDatabaseQueryHandler& handler) = 0;
+
+	/// Compiles a statement, or takes it from the connection's cache of recently freed statements
+	/// with the same SQL, so a query that is run again and again is only parsed and planned once.
+	/// @param connection Database connection
+	/// @param sql A single SQL statement, with `?` or `?NNN` for parameters
+	/// @returns Statement, or "nullptr" if it didn't compile
+	virtual IDatabaseStatement* prepare(IDatabaseConnection& connection, StringView sql) = 0;
+
+	/// Gets a statement by ID
+	/// @returns Statement, or "nullptr" if the ID is not valid
+	virtual IDatabaseStatement* getStatement(int id) = 0;
+
+	/// Frees a statement, putting it back in the connection's cache
+	/// @returns "true" if the statement has been successfully freed, otherwise "false"
+	virtual bool freeStatement(IDatabaseStatement& statement) = 0;
+
+	/// Runs a query as a cursor: the result set holds only the selected row and reads the next one
+	/// from SQLite when it moves on, so memory use doesn't depend on the size of the result.  Its
+	/// row count is the number of rows read so far.  A cursor keeps its statement until it reaches
+	/// the end or is freed, closing the connection frees its unfinished cursors.
+	/// @param connection Database connection
+	/// @param sql A single SQL statement
+	/// @returns Result set with the first row selected, or "nullptr" on error
+	virtual IDatabaseResultSet* executeQueryCursor(IDatabaseConnection& connection, StringView sql) = 0;
+
+	/// Changes how a connection talks to its file
+	/// @param connection Database connection
+	/// @param settings New settings
+	/// @returns "true" if every setting has been applied, otherwise "false"
+	virtual bool configure(IDatabaseConnection& connection, const DatabaseSettings& settings) = 0;
+};
@@ -0,0 +1,73 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+#include <Server/Components/Recordings/recordings.hpp>
+
+/// How a recording's buffer is coping.  Records are packed into a buffer on the main thread and
+/// written to disk in large blocks by a background thread.
+struct RecordingBufferStats
+{
+	/// Size of the buffer in bytes
+	size_t capacity = 0;
+
+	/// Bytes waiting to be written
+	size_t used = 0;
+
+	/// Most bytes ever waiting at once
+	size_t highWaterMark = 0;
+
+	/// Times the main thread had to wait because the buffer was full
+	size_t stalls = 0;
+
+	/// Bytes written to the file so far
+	uint64_t written = 0;
+};
+
+/// Extra recording features, queried from the recordings component with `queryExtension`.
+struct IRecordingsExtension : public IExtension
+{
+	PROVIDE_EXT_UID(0x3f6b8e2a91c4d705);
+
+	/// Gets how the buffer of a player's recording is coping
+	/// @param player Player being recorded
+	/// @param[out] stats Buffer statistics
+	/// @returns "true" if the player is being recorded, otherwise "false"
+	virtual bool getBufferStats(IPlayer& player, RecordingBufferStats& stats) = 0;
+
+	/// Gets the most bytes that have been waiting in any recording's buffer at once
+	virtual size_t getBufferHighWaterMark() const = 0;
+
+	/// Connects a bot run by the server itself, with no client, which recordings can be played on.
+	/// It is spawned straight away and removed again with `kick`.
+	/// @param name Name of the bot
+	/// @returns The bot, or "nullptr" if there is no bot slot or the name can't be used
+	virtual IPlayer* connectBot(StringView name) = 0;
+
+	/// Plays a recording on a bot connected with `connectBot`, replacing whatever it was playing.
+	/// Driver recordings need the bot put in the vehicle first.
+	/// @param bot Bot to play the recording on
+	/// @param file Recording in scriptfiles, without the ".rec"
+	/// @param loop Whether to start again from the beginning once it has ended
+	/// @returns "true" if the recording has been started, otherwise "false"
+	virtual bool startPlayback(IPlayer& bot, StringView file, bool loop) = 0;
+
+	/// Stops playing a recording, the bot stays where it is
+	/// @returns "true" if the bot was playing a recording, otherwise "false"
+	virtual bool stopPlayback(IPlayer& bot) = 0;
+
+	/// Jumps to a point in the recording a bot is playing
+	/// @param time Time since the start of the recording
+	/// @returns "true" if the bot is playing a recording, otherwise "false"
+	virtual bool seekPlayback(IPlayer& bot, Milliseconds time) = 0;
+
+	/// Gets whether a bot is playing a recording
+	virtual bool isPlaying(IPlayer& bot) const = 0;
+};
@@ -0,0 +1,97 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <typeinfo>
+
+#if defined(_WIN32)
+#define OMP_ALLOCATION_STATS_EXPORT __declspec(dllexport)
+#else
+#define OMP_ALLOCATION_STATS_EXPORT __attribute__((visibility("default")))
+#endif
+
+/// Live and peak allocation counts for one type.  There is one instance per tracked type per
+/// binary, all linked together so the binary can hand the whole list over in one go.  Tracked types
+/// are only created and destroyed on the main thread, so the counters aren't atomic.
+struct AllocationStats
+{
+	const char* const name; ///< `typeid().name()` of the tracked type
+	size_t live = 0;
+	size_t liveBytes = 0;
+	size_t peak = 0;
+	size_t peakBytes = 0;
+	size_t total = 0;
+	AllocationStats* const next;
+
+	AllocationStats(const char* name)
+		: name(name)
+		, next(head())
+	{
+		head() = this;
+	}
+
+	/// The list of every tracked type in this binary.
+	static AllocationStats*& head()
+	{
+		static AllocationStats* list = nullptr;
+		return list;
+	}
+
+	void allocated(size_t bytes)
+	{
+		++live;
+		++total;
+		liveBytes += bytes;
+		if (live > peak)
+		{
+			peak = live;
+		}
+		if (liveBytes > peakBytes)
+		{
+			peakBytes = liveBytes;
+		}
+	}
+
+	void freed(size_t bytes)
+	{
+		--live;
+		liveBytes -= bytes;
+	}
+};
+
+/// Derive from this to have every `new`/`delete` of `T` counted.  The sizes come from the compiler,
+/// so any storage a type holds inline (pools, arrays) is included.
+template <class T>
+struct TrackedAllocation
+{
+	inline static AllocationStats allocationStats { typeid(T).name() };
+
+	static void* operator new(std::size_t size)
+	{
+		allocationStats.allocated(size);
+		return ::operator new(size);
+	}
+
+	static void operator delete(void* ptr, std::size_t size)
+	{
+		allocationStats.freed(size);
+		::operator delete(ptr);
+	}
+};
+
+typedef AllocationStats* (*ComponentAllocationStats_t)();
+
+/// Exposes this binary's allocation list to the server, put it next to `COMPONENT_ENTRY_POINT()`.
+#define COMPONENT_ALLOCATION_STATS()                                                      \
+	extern "C" OMP_ALLOCATION_STATS_EXPORT AllocationStats* ComponentAllocationStats() \
+	{                                                                                     \
+		return AllocationStats::head();                                                   \
+	}
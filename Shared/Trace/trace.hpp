@@ -0,0 +1,124 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+#include <sdk.hpp>
+
+#if !defined(_MSC_VER)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+enum class TraceCategory : uint8_t
+{
+	Tick,
+	Handler,
+	Plugin,
+	Public,
+	Native,
+
+	End
+};
+
+/// Maps a scope recorded without a name (natives, where looking the name up is a linear scan) back
+/// to one.  May be called from any thread.
+typedef const char* (*TraceNameResolver)(TraceCategory category, const void* context, int index);
+
+/// Turn a `typeid().name()`, which is what handler scopes are named by, into something readable.
+inline String demangleTraceName(const char* name)
+{
+#if !defined(_MSC_VER)
+	int status = 0;
+	// Types with internal linkage get a leading `*` that the demangler doesn't understand.
+	char* demangled = abi::__cxa_demangle(name[0] == '*' ? name + 1 : name, nullptr, nullptr, &status);
+	if (status == 0 && demangled)
+	{
+		String ret(demangled);
+		std::free(demangled);
+		return ret;
+	}
+#endif
+	return name;
+}
+
+/// The server's trace recorder, as components see it.  The core owns and implements it; only plain
+/// values cross over, so components never touch its buffers.
+struct ITraceRecorder
+{
+	/// Set the function that names scopes entered without a name.
+	virtual void setNameResolver(TraceNameResolver resolver) = 0;
+
+	/// Open a scope on the main thread.  A non-null `name` must outlive the scope, a null one is
+	/// looked up through the resolver with `context` and `index`, and only when something needs it.
+	virtual void enter(TraceCategory category, const char* name, const void* context, int index) = 0;
+
+	/// Close the innermost open scope.
+	virtual void leave() = 0;
+
+	/// Whether a capture is running, rather than only the tick watchdog.  Scopes too frequent to be
+	/// worth it for the watchdog, such as Pawn's natives, are only entered while this is true.
+	virtual bool capturing() const = 0;
+};
+
+/// RAII enter/leave pair, use through `OMP_TRACE_SCOPE`.
+class TraceScope
+{
+private:
+	ITraceRecorder* recorder_;
+
+public:
+	TraceScope(ITraceRecorder* recorder, TraceCategory category, const char* name, const void* context = nullptr, int index = 0)
+		: recorder_(recorder)
+	{
+		if (recorder_)
+		{
+			recorder_->enter(category, name, context, index);
+		}
+	}
+
+	~TraceScope()
+	{
+		if (recorder_)
+		{
+			recorder_->leave();
+		}
+	}
+};
+
+/// Implemented by components that want to add their own scopes to server traces.  The core hands
+/// its recorder over when a capture starts, the tick watchdog is running or a timing sink is
+/// registered, and null when none of those are, so components don't enter scopes nobody reads.
+struct ITraceConsumer : public IExtension
+{
+	PROVIDE_EXT_UID(0x5c3e9a1d27f0b846);
+
+	virtual void setTraceRecorder(ITraceRecorder* recorder) = 0;
+};
+
+/// Implemented by components that want to know how long named scopes take, without a capture
+/// running.  The core collects these once components are initialised and, while there are any,
+/// keeps its recorder handed out so that handlers and publics are always scoped.
+struct ITraceTimingSink : public IExtension
+{
+	PROVIDE_EXT_UID(0x8d1f4b62e07a39c5);
+
+	/// Called on the main thread as a scope with a name is left.  `name` is only valid for the call;
+	/// handlers are named by their mangled type name, see `demangleTraceName()`.
+	virtual void onScopeTimed(TraceCategory category, const char* name, Microseconds duration) = 0;
+};
+
+#if defined(OMP_DISABLE_TRACE)
+#define OMP_TRACE_ENABLED false
+#define OMP_TRACE_SCOPE(recorder, category, name, ...)
+#else
+#define OMP_TRACE_ENABLED true
+#define OMP_TRACE_CONCAT_(a, b) a##b
+#define OMP_TRACE_CONCAT(a, b) OMP_TRACE_CONCAT_(a, b)
+#define OMP_TRACE_SCOPE(recorder, category, ...) TraceScope OMP_TRACE_CONCAT(traceScope_, __LINE__)((recorder), (category), __VA_ARGS__)
+#endif
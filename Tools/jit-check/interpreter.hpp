@@ -0,0 +1,802 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+// The interpreter the JIT is compared with: `amx_Exec` from pawn 3.2's amx.c, opcode for opcode,
+// but running the unrelocated image the JIT is given, so the same memory can be handed to both
+// without `amx_Init`.  Natives are always called through `amx->callback` and never patched to
+// SYSREQ.D, as in the server.
+
+#define REF_CELL(a) (*(cell*)(data + (int)(a)))
+#define REF_PARAM(v) \
+	do \
+	{ \
+		v = *(cell*)(code + cip); \
+		cip += sizeof(cell); \
+	} while (0)
+#define REF_PUSH(v) \
+	do \
+	{ \
+		stk -= sizeof(cell); \
+		REF_CELL(stk) = (v); \
+	} while (0)
+#define REF_POP(v) \
+	do \
+	{ \
+		v = REF_CELL(stk); \
+		stk += sizeof(cell); \
+	} while (0)
+#define REF_ABORT(v) \
+	do \
+	{ \
+		amx->stk = reset_stk; \
+		amx->hea = reset_hea; \
+		return (v); \
+	} while (0)
+#define REF_CHKMARGIN() \
+	if (hea + 16 * (cell)sizeof(cell) > stk) \
+	{ \
+		return AMX_ERR_STACKERR; \
+	}
+#define REF_CHKSTACK() \
+	if (stk > amx->stp) \
+	{ \
+		return AMX_ERR_STACKLOW; \
+	}
+#define REF_CHKHEAP() \
+	if (hea < amx->hlw) \
+	{ \
+		return AMX_ERR_HEAPLOW; \
+	}
+#define REF_VERIFY(a) \
+	if (((a) >= hea && (a) < stk) || (ucell)(a) >= (ucell)amx->stp) \
+	{ \
+		REF_ABORT(AMX_ERR_MEMACCESS); \
+	}
+#define REF_VERIFYEND(a) \
+	if (((a) > hea && (a) < stk) || (ucell)(a) > (ucell)amx->stp) \
+	{ \
+		REF_ABORT(AMX_ERR_MEMACCESS); \
+	}
+#define REF_JUMPIF(o, c) \
+	case Op::o: \
+		if (c) \
+		{ \
+			cip = *(cell*)(code + cip); \
+		} \
+		else \
+		{ \
+			cip += sizeof(cell); \
+		} \
+		break;
+
+int AMXAPI amx_Exec(AMX* amx, cell* retval, int index)
+{
+	AMX_HEADER* hdr = reinterpret_cast<AMX_HEADER*>(amx->base);
+	unsigned char* code = amx->base + hdr->cod;
+	unsigned char* data = amx->data ? amx->data : amx->base + hdr->dat;
+	const ucell codesize = hdr->dat - hdr->cod;
+	cell pri = 0, alt = 0, frm = 0, hea = amx->hea, stk = amx->stk, cip, offs, val;
+	cell reset_stk = stk, reset_hea = hea;
+	int num;
+
+	if ((amx->flags & AMX_FLAG_NTVREG) == 0)
+	{
+		return AMX_ERR_NOTFOUND;
+	}
+	if (index == AMX_EXEC_MAIN)
+	{
+		if (hdr->cip < 0)
+		{
+			return AMX_ERR_INDEX;
+		}
+		cip = hdr->cip;
+	}
+	else if (index == AMX_EXEC_CONT)
+	{
+		frm = amx->frm;
+		stk = amx->stk;
+		hea = amx->hea;
+		pri = amx->pri;
+		alt = amx->alt;
+		reset_stk = amx->reset_stk;
+		reset_hea = amx->reset_hea;
+		cip = amx->cip;
+	}
+	else if (index < 0 || index >= (long)NUMENTRIES(hdr, publics, natives))
+	{
+		return AMX_ERR_INDEX;
+	}
+	else
+	{
+		AMX_FUNCSTUB* func = GETENTRY(hdr, publics, index);
+		cip = func->address;
+	}
+
+	REF_CHKSTACK();
+	REF_CHKHEAP();
+	if (index != AMX_EXEC_CONT)
+	{
+		reset_stk += amx->paramcount * sizeof(cell);
+		REF_PUSH(amx->paramcount * sizeof(cell));
+		amx->paramcount = 0;
+		REF_PUSH(0);
+	}
+	REF_CHKMARGIN();
+
+	for (;;)
+	{
+		const Op op = static_cast<Op>(*(cell*)(code + cip));
+		cip += sizeof(cell);
+		switch (op)
+		{
+		case Op::LOAD_PRI:
+			REF_PARAM(offs);
+			pri = REF_CELL(offs);
+			break;
+		case Op::LOAD_ALT:
+			REF_PARAM(offs);
+			alt = REF_CELL(offs);
+			break;
+		case Op::LOAD_S_PRI:
+			REF_PARAM(offs);
+			pri = REF_CELL(frm + offs);
+			break;
+		case Op::LOAD_S_ALT:
+			REF_PARAM(offs);
+			alt = REF_CELL(frm + offs);
+			break;
+		case Op::LREF_PRI:
+			REF_PARAM(offs);
+			offs = REF_CELL(offs);
+			pri = REF_CELL(offs);
+			break;
+		case Op::LREF_ALT:
+			REF_PARAM(offs);
+			offs = REF_CELL(offs);
+			alt = REF_CELL(offs);
+			break;
+		case Op::LREF_S_PRI:
+			REF_PARAM(offs);
+			offs = REF_CELL(frm + offs);
+			pri = REF_CELL(offs);
+			break;
+		case Op::LREF_S_ALT:
+			REF_PARAM(offs);
+			offs = REF_CELL(frm + offs);
+			alt = REF_CELL(offs);
+			break;
+		case Op::LOAD_I:
+			REF_VERIFY(pri);
+			pri = REF_CELL(pri);
+			break;
+		case Op::LODB_I:
+			REF_PARAM(offs);
+			REF_VERIFY(pri);
+			switch (offs)
+			{
+			case 1:
+				pri = *(data + pri);
+				break;
+			case 2:
+				pri = *(uint16_t*)(data + pri);
+				break;
+			case 4:
+				pri = REF_CELL(pri);
+				break;
+			}
+			break;
+		case Op::CONST_PRI:
+			REF_PARAM(pri);
+			break;
+		case Op::CONST_ALT:
+			REF_PARAM(alt);
+			break;
+		case Op::ADDR_PRI:
+			REF_PARAM(pri);
+			pri += frm;
+			break;
+		case Op::ADDR_ALT:
+			REF_PARAM(alt);
+			alt += frm;
+			break;
+		case Op::STOR_PRI:
+			REF_PARAM(offs);
+			REF_CELL(offs) = pri;
+			break;
+		case Op::STOR_ALT:
+			REF_PARAM(offs);
+			REF_CELL(offs) = alt;
+			break;
+		case Op::STOR_S_PRI:
+			REF_PARAM(offs);
+			REF_CELL(frm + offs) = pri;
+			break;
+		case Op::STOR_S_ALT:
+			REF_PARAM(offs);
+			REF_CELL(frm + offs) = alt;
+			break;
+		case Op::SREF_PRI:
+			REF_PARAM(offs);
+			offs = REF_CELL(offs);
+			REF_CELL(offs) = pri;
+			break;
+		case Op::SREF_ALT:
+			REF_PARAM(offs);
+			offs = REF_CELL(offs);
+			REF_CELL(offs) = alt;
+			break;
+		case Op::SREF_S_PRI:
+			REF_PARAM(offs);
+			offs = REF_CELL(frm + offs);
+			REF_CELL(offs) = pri;
+			break;
+		case Op::SREF_S_ALT:
+			REF_PARAM(offs);
+			offs = REF_CELL(frm + offs);
+			REF_CELL(offs) = alt;
+			break;
+		case Op::STOR_I:
+			REF_VERIFY(alt);
+			REF_CELL(alt) = pri;
+			break;
+		case Op::STRB_I:
+			REF_PARAM(offs);
+			REF_VERIFY(alt);
+			switch (offs)
+			{
+			case 1:
+				*(data + alt) = (unsigned char)pri;
+				break;
+			case 2:
+				*(uint16_t*)(data + alt) = (uint16_t)pri;
+				break;
+			case 4:
+				REF_CELL(alt) = pri;
+				break;
+			}
+			break;
+		case Op::LIDX:
+			offs = (cell)((ucell)alt + (ucell)pri * sizeof(cell));
+			REF_VERIFY(offs);
+			pri = REF_CELL(offs);
+			break;
+		case Op::LIDX_B:
+			REF_PARAM(offs);
+			offs = (cell)((ucell)alt + ((ucell)pri << offs));
+			REF_VERIFY(offs);
+			pri = REF_CELL(offs);
+			break;
+		case Op::IDXADDR:
+			pri = (cell)((ucell)pri * sizeof(cell) + (ucell)alt);
+			break;
+		case Op::IDXADDR_B:
+			REF_PARAM(offs);
+			pri = (cell)(((ucell)pri << offs) + (ucell)alt);
+			break;
+		case Op::ALIGN_PRI:
+			REF_PARAM(offs);
+			if (offs < (cell)sizeof(cell))
+			{
+				pri ^= sizeof(cell) - offs;
+			}
+			break;
+		case Op::ALIGN_ALT:
+			REF_PARAM(offs);
+			if (offs < (cell)sizeof(cell))
+			{
+				alt ^= sizeof(cell) - offs;
+			}
+			break;
+		case Op::LCTRL:
+			REF_PARAM(offs);
+			switch (offs)
+			{
+			case 0:
+				pri = hdr->cod;
+				break;
+			case 1:
+				pri = hdr->dat;
+				break;
+			case 2:
+				pri = hea;
+				break;
+			case 3:
+				pri = amx->stp;
+				break;
+			case 4:
+				pri = stk;
+				break;
+			case 5:
+				pri = frm;
+				break;
+			case 6:
+				pri = cip;
+				break;
+			default:
+				REF_ABORT(AMX_ERR_INVINSTR);
+			}
+			break;
+		case Op::SCTRL:
+			REF_PARAM(offs);
+			switch (offs)
+			{
+			case 0:
+			case 1:
+			case 3:
+				break;
+			case 2:
+				hea = pri;
+				break;
+			case 4:
+				stk = pri;
+				break;
+			case 5:
+				frm = pri;
+				break;
+			case 6:
+				cip = pri;
+				break;
+			default:
+				REF_ABORT(AMX_ERR_INVINSTR);
+			}
+			break;
+		case Op::MOVE_PRI:
+			pri = alt;
+			break;
+		case Op::MOVE_ALT:
+			alt = pri;
+			break;
+		case Op::XCHG:
+			offs = pri;
+			pri = alt;
+			alt = offs;
+			break;
+		case Op::PUSH_PRI:
+			REF_PUSH(pri);
+			break;
+		case Op::PUSH_ALT:
+			REF_PUSH(alt);
+			break;
+		case Op::PUSH_C:
+			REF_PARAM(offs);
+			REF_PUSH(offs);
+			break;
+		case Op::PUSH:
+			REF_PARAM(offs);
+			REF_PUSH(REF_CELL(offs));
+			break;
+		case Op::PUSH_S:
+			REF_PARAM(offs);
+			REF_PUSH(REF_CELL(frm + offs));
+			break;
+		case Op::POP_PRI:
+			REF_POP(pri);
+			break;
+		case Op::POP_ALT:
+			REF_POP(alt);
+			break;
+		case Op::STACK:
+			REF_PARAM(offs);
+			alt = stk;
+			stk += offs;
+			REF_CHKMARGIN();
+			REF_CHKSTACK();
+			break;
+		case Op::HEAP:
+			REF_PARAM(offs);
+			alt = hea;
+			hea += offs;
+			REF_CHKMARGIN();
+			REF_CHKHEAP();
+			break;
+		case Op::PROC:
+			REF_PUSH(frm);
+			frm = stk;
+			REF_CHKMARGIN();
+			break;
+		case Op::RET:
+		case Op::RETN:
+			REF_POP(frm);
+			REF_POP(offs);
+			if ((ucell)offs >= codesize || offs % sizeof(cell) != 0)
+			{
+				REF_ABORT(AMX_ERR_MEMACCESS);
+			}
+			cip = offs;
+			if (op == Op::RETN)
+			{
+				stk += REF_CELL(stk) + sizeof(cell);
+			}
+			break;
+		case Op::CALL:
+			REF_PUSH(cip + (cell)sizeof(cell));
+			cip = *(cell*)(code + cip);
+			break;
+		case Op::JUMP:
+			cip = *(cell*)(code + cip);
+			break;
+			REF_JUMPIF(JZER, pri == 0)
+			REF_JUMPIF(JNZ, pri != 0)
+			REF_JUMPIF(JEQ, pri == alt)
+			REF_JUMPIF(JNEQ, pri != alt)
+			REF_JUMPIF(JLESS, (ucell)pri < (ucell)alt)
+			REF_JUMPIF(JLEQ, (ucell)pri <= (ucell)alt)
+			REF_JUMPIF(JGRTR, (ucell)pri > (ucell)alt)
+			REF_JUMPIF(JGEQ, (ucell)pri >= (ucell)alt)
+			REF_JUMPIF(JSLESS, pri < alt)
+			REF_JUMPIF(JSLEQ, pri <= alt)
+			REF_JUMPIF(JSGRTR, pri > alt)
+			REF_JUMPIF(JSGEQ, pri >= alt)
+		case Op::SHL:
+			pri = (cell)((ucell)pri << (alt & 31));
+			break;
+		case Op::SHR:
+			pri = (cell)((ucell)pri >> (alt & 31));
+			break;
+		case Op::SSHR:
+			pri >>= (alt & 31);
+			break;
+		case Op::SHL_C_PRI:
+			REF_PARAM(offs);
+			pri = (cell)((ucell)pri << (offs & 31));
+			break;
+		case Op::SHL_C_ALT:
+			REF_PARAM(offs);
+			alt = (cell)((ucell)alt << (offs & 31));
+			break;
+		case Op::SHR_C_PRI:
+			REF_PARAM(offs);
+			pri = (cell)((ucell)pri >> (offs & 31));
+			break;
+		case Op::SHR_C_ALT:
+			REF_PARAM(offs);
+			alt = (cell)((ucell)alt >> (offs & 31));
+			break;
+		case Op::SMUL:
+		case Op::UMUL:
+			pri = (cell)((ucell)pri * (ucell)alt);
+			break;
+		case Op::SDIV:
+		case Op::SDIV_ALT:
+		{
+			// Floored division, as amx.c
+			const cell dividend = op == Op::SDIV ? pri : alt, divisor = op == Op::SDIV ? alt : pri;
+			if (divisor == 0)
+			{
+				REF_ABORT(AMX_ERR_DIVIDE);
+			}
+			if (divisor == -1)
+			{
+				pri = (cell)(0u - (ucell)dividend);
+				alt = 0;
+			}
+			else
+			{
+				pri = dividend / divisor;
+				alt = dividend % divisor;
+				if (alt != 0 && (alt ^ divisor) < 0)
+				{
+					pri--;
+					alt += divisor;
+				}
+			}
+			break;
+		}
+		case Op::UDIV:
+		case Op::UDIV_ALT:
+		{
+			const ucell dividend = op == Op::UDIV ? pri : alt, divisor = op == Op::UDIV ? alt : pri;
+			if (divisor == 0)
+			{
+				REF_ABORT(AMX_ERR_DIVIDE);
+			}
+			pri = dividend / divisor;
+			alt = dividend % divisor;
+			break;
+		}
+		case Op::ADD:
+			pri = (cell)((ucell)pri + (ucell)alt);
+			break;
+		case Op::SUB:
+			pri = (cell)((ucell)pri - (ucell)alt);
+			break;
+		case Op::SUB_ALT:
+			pri = (cell)((ucell)alt - (ucell)pri);
+			break;
+		case Op::AND:
+			pri &= alt;
+			break;
+		case Op::OR:
+			pri |= alt;
+			break;
+		case Op::XOR:
+			pri ^= alt;
+			break;
+		case Op::NOT:
+			pri = !pri;
+			break;
+		case Op::NEG:
+			pri = (cell)(0u - (ucell)pri);
+			break;
+		case Op::INVERT:
+			pri = ~pri;
+			break;
+		case Op::ADD_C:
+			REF_PARAM(offs);
+			pri = (cell)((ucell)pri + (ucell)offs);
+			break;
+		case Op::SMUL_C:
+			REF_PARAM(offs);
+			pri = (cell)((ucell)pri * (ucell)offs);
+			break;
+		case Op::ZERO_PRI:
+			pri = 0;
+			break;
+		case Op::ZERO_ALT:
+			alt = 0;
+			break;
+		case Op::ZERO:
+			REF_PARAM(offs);
+			REF_CELL(offs) = 0;
+			break;
+		case Op::ZERO_S:
+			REF_PARAM(offs);
+			REF_CELL(frm + offs) = 0;
+			break;
+		case Op::SIGN_PRI:
+			if ((pri & 0xff) >= 0x80)
+			{
+				pri |= ~(ucell)0xff;
+			}
+			break;
+		case Op::SIGN_ALT:
+			if ((alt & 0xff) >= 0x80)
+			{
+				alt |= ~(ucell)0xff;
+			}
+			break;
+		case Op::EQ:
+			pri = pri == alt;
+			break;
+		case Op::NEQ:
+			pri = pri != alt;
+			break;
+		case Op::LESS:
+			pri = (ucell)pri < (ucell)alt;
+			break;
+		case Op::LEQ:
+			pri = (ucell)pri <= (ucell)alt;
+			break;
+		case Op::GRTR:
+			pri = (ucell)pri > (ucell)alt;
+			break;
+		case Op::GEQ:
+			pri = (ucell)pri >= (ucell)alt;
+			break;
+		case Op::SLESS:
+			pri = pri < alt;
+			break;
+		case Op::SLEQ:
+			pri = pri <= alt;
+			break;
+		case Op::SGRTR:
+			pri = pri > alt;
+			break;
+		case Op::SGEQ:
+			pri = pri >= alt;
+			break;
+		case Op::EQ_C_PRI:
+			REF_PARAM(offs);
+			pri = pri == offs;
+			break;
+		case Op::EQ_C_ALT:
+			REF_PARAM(offs);
+			pri = alt == offs;
+			break;
+		case Op::INC_PRI:
+			pri = (cell)((ucell)pri + 1);
+			break;
+		case Op::INC_ALT:
+			alt = (cell)((ucell)alt + 1);
+			break;
+		case Op::INC:
+			REF_PARAM(offs);
+			REF_CELL(offs) = (cell)((ucell)REF_CELL(offs) + 1);
+			break;
+		case Op::INC_S:
+			REF_PARAM(offs);
+			REF_CELL(frm + offs) = (cell)((ucell)REF_CELL(frm + offs) + 1);
+			break;
+		case Op::INC_I:
+			REF_CELL(pri) = (cell)((ucell)REF_CELL(pri) + 1);
+			break;
+		case Op::DEC_PRI:
+			pri = (cell)((ucell)pri - 1);
+			break;
+		case Op::DEC_ALT:
+			alt = (cell)((ucell)alt - 1);
+			break;
+		case Op::DEC:
+			REF_PARAM(offs);
+			REF_CELL(offs) = (cell)((ucell)REF_CELL(offs) - 1);
+			break;
+		case Op::DEC_S:
+			REF_PARAM(offs);
+			REF_CELL(frm + offs) = (cell)((ucell)REF_CELL(frm + offs) - 1);
+			break;
+		case Op::DEC_I:
+			REF_CELL(pri) = (cell)((ucell)REF_CELL(pri) - 1);
+			break;
+		case Op::MOVS:
+			REF_PARAM(offs);
+			REF_VERIFY(pri);
+			REF_VERIFYEND(pri + offs);
+			REF_VERIFY(alt);
+			REF_VERIFYEND(alt + offs);
+			memmove(data + alt, data + pri, offs);
+			break;
+		case Op::CMPS:
+			REF_PARAM(offs);
+			REF_VERIFY(pri);
+			REF_VERIFYEND(pri + offs);
+			REF_VERIFY(alt);
+			REF_VERIFYEND(alt + offs);
+			pri = memcmp(data + alt, data + pri, offs);
+			break;
+		case Op::FILL:
+			REF_PARAM(offs);
+			REF_VERIFY(alt);
+			REF_VERIFYEND(alt + offs);
+			for (cell i = alt; offs >= (cell)sizeof(cell); i += sizeof(cell), offs -= sizeof(cell))
+			{
+				REF_CELL(i) = pri;
+			}
+			break;
+		case Op::HALT:
+			REF_PARAM(offs);
+			if (retval)
+			{
+				*retval = pri;
+			}
+			amx->frm = frm;
+			amx->pri = pri;
+			amx->alt = alt;
+			amx->cip = cip;
+			if (offs == AMX_ERR_SLEEP)
+			{
+				amx->stk = stk;
+				amx->hea = hea;
+				amx->reset_stk = reset_stk;
+				amx->reset_hea = reset_hea;
+				return offs;
+			}
+			REF_ABORT(offs);
+		case Op::BOUNDS:
+			REF_PARAM(offs);
+			if ((ucell)pri > (ucell)offs)
+			{
+				REF_ABORT(AMX_ERR_BOUNDS);
+			}
+			break;
+		case Op::SYSREQ_PRI:
+		case Op::SYSREQ_C:
+		case Op::SYSREQ_N:
+			if (op == Op::SYSREQ_PRI)
+			{
+				offs = pri;
+			}
+			else
+			{
+				REF_PARAM(offs);
+			}
+			if (op == Op::SYSREQ_N)
+			{
+				REF_PARAM(val);
+				REF_PUSH(val);
+			}
+			amx->cip = cip;
+			amx->hea = hea;
+			amx->frm = frm;
+			amx->stk = stk;
+			num = amx->callback(amx, offs, &pri, (cell*)(data + stk));
+			if (op == Op::SYSREQ_N)
+			{
+				stk += val + sizeof(cell);
+			}
+			if (num == AMX_ERR_SLEEP)
+			{
+				amx->pri = pri;
+				amx->alt = alt;
+				amx->stk = stk;
+				amx->reset_stk = reset_stk;
+				amx->reset_hea = reset_hea;
+				return num;
+			}
+			if (num != AMX_ERR_NONE)
+			{
+				REF_ABORT(num);
+			}
+			break;
+		case Op::LINE:
+		case Op::SRANGE:
+			cip += 2 * sizeof(cell);
+			break;
+		case Op::SYMTAG:
+			cip += sizeof(cell);
+			break;
+		case Op::SWITCH:
+		{
+			cell table = *(cell*)(code + cip) + sizeof(cell);
+			cip = *(cell*)(code + table + sizeof(cell));
+			for (num = *(cell*)(code + table), table += 2 * sizeof(cell); num > 0; num--, table += 2 * sizeof(cell))
+			{
+				if (*(cell*)(code + table) == pri)
+				{
+					cip = *(cell*)(code + table + sizeof(cell));
+					break;
+				}
+			}
+			break;
+		}
+		case Op::SWAP_PRI:
+			offs = REF_CELL(stk);
+			REF_CELL(stk) = pri;
+			pri = offs;
+			break;
+		case Op::SWAP_ALT:
+			offs = REF_CELL(stk);
+			REF_CELL(stk) = alt;
+			alt = offs;
+			break;
+		case Op::PUSH_ADR:
+			REF_PARAM(offs);
+			REF_PUSH(frm + offs);
+			break;
+		case Op::NOP:
+			break;
+		case Op::BREAK:
+			if (amx->debug)
+			{
+				amx->frm = frm;
+				amx->stk = stk;
+				amx->hea = hea;
+				amx->cip = cip;
+				num = amx->debug(amx);
+				if (num == AMX_ERR_SLEEP)
+				{
+					amx->pri = pri;
+					amx->alt = alt;
+					amx->reset_stk = reset_stk;
+					amx->reset_hea = reset_hea;
+					return num;
+				}
+				if (num != AMX_ERR_NONE)
+				{
+					REF_ABORT(num);
+				}
+			}
+			break;
+		default:
+			REF_ABORT(AMX_ERR_INVINSTR);
+		}
+	}
+}
+
+#undef REF_CELL
+#undef REF_PARAM
+#undef REF_PUSH
+#undef REF_POP
+#undef REF_ABORT
+#undef REF_CHKMARGIN
+#undef REF_CHKSTACK
+#undef REF_CHKHEAP
+#undef REF_VERIFY
+#undef REF_VERIFYEND
+#undef REF_JUMPIF
@@ -0,0 +1,491 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+// Runs AMX programs under the interpreter and the JIT and compares everything a script or the
+// server could see: error codes, return values, the registers stored back in the `AMX`, every
+// native and debug hook call with the registers at the time, and all of memory afterwards.  Each
+// program also runs switching between the two on every `sleep`.
+//
+//   jit-check [seed] [count]
+//
+// runs the hand-written programs, then `count` random ones from `seed`.  Exits with 1 on any
+// difference.  Build it for x86 as well as x86-64, the 32-bit code is only enabled in the server
+// once it passes there.
+
+#include "JIT.cpp"
+#include "interpreter.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <type_traits>
+
+/// An AMX program being put together, with labels for jumps and publics
+struct Program
+{
+	DynamicArray<cell> code { static_cast<cell>(Op::HALT), 0 };
+	DynamicArray<cell> data;
+	std::map<int, cell> labels;
+	DynamicArray<std::pair<size_t, int>> fixups;
+	DynamicArray<int> publics;
+	cell stack = 4096;
+	bool compact = false;
+
+	void op(Op o)
+	{
+		code.push_back(static_cast<cell>(o));
+	}
+
+	void op(Op o, cell a)
+	{
+		op(o);
+		code.push_back(a);
+	}
+
+	void op(Op o, cell a, cell b)
+	{
+		op(o, a);
+		code.push_back(b);
+	}
+
+	/// An instruction whose operand is the address of a label
+	void jump(Op o, int label)
+	{
+		op(o);
+		ref(label);
+	}
+
+	/// A cell holding the address of a label
+	void ref(int label)
+	{
+		fixups.emplace_back(code.size(), label);
+		code.push_back(0);
+	}
+
+	void bind(int label)
+	{
+		labels[label] = code.size() * sizeof(cell);
+	}
+
+	/// Bind a label and export it as the next public
+	void pub(int label)
+	{
+		bind(label);
+		publics.push_back(label);
+	}
+};
+
+/// A program written out as a .amx file, and its memory as `aux_LoadProgram` would leave it
+struct Image
+{
+	AMX_HEADER hdr;
+	DynamicArray<unsigned char> memory;
+	std::string path;
+};
+
+static void appendCompact(DynamicArray<unsigned char>& out, cell value)
+{
+	DynamicArray<unsigned char> bytes;
+	unsigned char byte;
+	do
+	{
+		byte = value & 0x7f;
+		value >>= 7;
+		bytes.push_back(byte);
+	} while (!((value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40))));
+	for (size_t i = bytes.size(); i-- > 0;)
+	{
+		out.push_back(bytes[i] | (i ? 0x80 : 0));
+	}
+}
+
+static Image build(Program& p)
+{
+	static int files = 0;
+
+	for (auto& fixup : p.fixups)
+	{
+		p.code[fixup.first] = p.labels.at(fixup.second);
+	}
+
+	Image image;
+	AMX_HEADER& hdr = image.hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = AMX_MAGIC;
+	hdr.defsize = 2 * sizeof(cell);
+	hdr.flags = p.compact ? AMX_FLAG_COMPACT : 0;
+	hdr.publics = sizeof(hdr);
+	hdr.natives = hdr.publics + hdr.defsize * p.publics.size();
+	hdr.libraries = hdr.pubvars = hdr.tags = hdr.nametable = hdr.natives;
+	hdr.cod = hdr.nametable + 2 * sizeof(cell);
+	hdr.dat = hdr.cod + p.code.size() * sizeof(cell);
+	hdr.hea = hdr.dat + p.data.size() * sizeof(cell);
+	hdr.stp = hdr.hea + p.stack;
+	hdr.cip = -1;
+
+	DynamicArray<unsigned char> file(hdr.cod);
+	for (size_t i = 0; i < p.publics.size(); ++i)
+	{
+		// Address and name offset, the names aren't needed
+		const cell entry[2] = { p.labels.at(p.publics[i]), 0 };
+		memcpy(file.data() + hdr.publics + hdr.defsize * i, entry, sizeof(entry));
+	}
+	if (p.compact)
+	{
+		for (cell value : p.code)
+		{
+			appendCompact(file, value);
+		}
+		for (cell value : p.data)
+		{
+			appendCompact(file, value);
+		}
+	}
+	else
+	{
+		file.resize(hdr.hea);
+		memcpy(file.data() + hdr.cod, p.code.data(), p.code.size() * sizeof(cell));
+		if (!p.data.empty())
+		{
+			memcpy(file.data() + hdr.dat, p.data.data(), p.data.size() * sizeof(cell));
+		}
+	}
+	hdr.size = file.size();
+	memcpy(file.data(), &hdr, sizeof(hdr));
+
+	image.path = (std::filesystem::temp_directory_path() / ("jit-check-" + std::to_string(files++ % 4) + ".amx")).string();
+	FILE* out = fopen(image.path.c_str(), "wb");
+	if (!out)
+	{
+		printf("Can't write %s\n", image.path.c_str());
+		exit(1);
+	}
+	fwrite(file.data(), 1, file.size(), out);
+	fclose(out);
+
+	// Loaded, the code is expanded and the header says so
+	image.memory.assign(hdr.stp, 0);
+	memcpy(image.memory.data(), file.data(), hdr.cod);
+	memcpy(image.memory.data() + hdr.cod, p.code.data(), p.code.size() * sizeof(cell));
+	if (!p.data.empty())
+	{
+		memcpy(image.memory.data() + hdr.dat, p.data.data(), p.data.size() * sizeof(cell));
+	}
+	reinterpret_cast<AMX_HEADER*>(image.memory.data())->flags = 0;
+	return image;
+}
+
+/// Every native and debug hook call of the current run
+static DynamicArray<std::string> calls;
+
+static std::string registers(AMX const& amx)
+{
+	char buf[128];
+	snprintf(buf, sizeof(buf), "stk=%d hea=%d frm=%d cip=%d", amx.stk, amx.hea, amx.frm, amx.cip);
+	return buf;
+}
+
+/// Natives: 0 sums its arguments, 1 sleeps returning 77, 2 fails and 3 writes to a reference
+static int AMXAPI callback(AMX* amx, cell index, cell* result, const cell* params)
+{
+	std::string call = "native " + std::to_string(index) + "(";
+	for (cell i = 1; i <= params[0] / cell(sizeof(cell)); ++i)
+	{
+		call += std::to_string(params[i]) + ",";
+	}
+	calls.push_back(call + ") " + registers(*amx));
+
+	switch (index)
+	{
+	case 0:
+		*result = 0;
+		for (cell i = 1; i <= params[0] / cell(sizeof(cell)); ++i)
+		{
+			*result += params[i];
+		}
+		return AMX_ERR_NONE;
+	case 1:
+		*result = 77;
+		return AMX_ERR_SLEEP;
+	case 2:
+		return AMX_ERR_NATIVE;
+	case 3:
+	{
+		unsigned char* data = amx->data ? amx->data : amx->base + reinterpret_cast<AMX_HEADER*>(amx->base)->dat;
+		*reinterpret_cast<cell*>(data + params[1]) = 1234;
+		*result = 1;
+		return AMX_ERR_NONE;
+	}
+	}
+	return AMX_ERR_CALLBACK;
+}
+
+enum class DebugMode
+{
+	Continue,
+	ExitOnThird,
+	SleepOnSecond
+};
+
+static DebugMode debugMode = DebugMode::Continue;
+static int debugCalls = 0;
+
+static int AMXAPI debugHook(AMX* amx)
+{
+	++debugCalls;
+	calls.push_back("debug " + registers(*amx));
+	if (debugMode == DebugMode::ExitOnThird && debugCalls == 3)
+	{
+		return AMX_ERR_EXIT;
+	}
+	if (debugMode == DebugMode::SleepOnSecond && debugCalls == 2)
+	{
+		return AMX_ERR_SLEEP;
+	}
+	return AMX_ERR_NONE;
+}
+
+static void setup(AMX& amx, Image const& image, DynamicArray<unsigned char>& memory, bool debug)
+{
+	memory = image.memory;
+	memset(&amx, 0, sizeof(amx));
+	amx.base = memory.data();
+	amx.callback = callback;
+	amx.debug = debug ? debugHook : nullptr;
+	amx.flags = AMX_FLAG_NTVREG;
+	amx.hea = amx.hlw = image.hdr.hea - image.hdr.dat;
+	amx.stk = amx.stp = image.hdr.stp - image.hdr.dat;
+}
+
+/// Everything one run left behind
+struct Run
+{
+	DynamicArray<int> codes;
+	DynamicArray<cell> rets;
+	DynamicArray<std::string> states;
+	DynamicArray<std::string> calls;
+	DynamicArray<unsigned char> memory;
+};
+
+enum class Engine
+{
+	Interpreter,
+	JIT,
+	/// The JIT, then the interpreter after each sleep and so on
+	JITFirst,
+	/// The interpreter, then the JIT after each sleep and so on
+	InterpreterFirst
+};
+
+static Run run(Image const& image, PawnJIT const* jit, Engine engine, int index, DynamicArray<cell> const& params, bool debug)
+{
+	Run result;
+	AMX amx;
+	setup(amx, image, result.memory, debug);
+	calls.clear();
+	debugCalls = 0;
+	for (size_t i = params.size(); i-- > 0;)
+	{
+		amx.stk -= sizeof(cell);
+		*reinterpret_cast<cell*>(result.memory.data() + image.hdr.dat + amx.stk) = params[i];
+		++amx.paramcount;
+	}
+
+	for (int n = 0; n < 6; ++n)
+	{
+		const bool useJIT = engine == Engine::JIT || (engine == Engine::JITFirst && n % 2 == 0) || (engine == Engine::InterpreterFirst && n % 2 == 1);
+		cell ret = -999;
+		const int code = useJIT ? jit->exec(&amx, &ret, index) : amx_Exec(&amx, &ret, index);
+		result.codes.push_back(code);
+		result.rets.push_back(ret);
+
+		char buf[160];
+		if (code == AMX_ERR_SLEEP)
+		{
+			snprintf(buf, sizeof(buf), "%s pri=%d alt=%d reset_stk=%d reset_hea=%d", registers(amx).c_str(), amx.pri, amx.alt, amx.reset_stk, amx.reset_hea);
+		}
+		else
+		{
+			snprintf(buf, sizeof(buf), "stk=%d hea=%d", amx.stk, amx.hea);
+		}
+		result.states.push_back(buf);
+
+		if (code != AMX_ERR_SLEEP)
+		{
+			break;
+		}
+		index = AMX_EXEC_CONT;
+	}
+	result.calls = calls;
+	return result;
+}
+
+static int tests = 0;
+static int failures = 0;
+static std::map<int, int> outcomes;
+
+template <typename T>
+static std::string at(DynamicArray<T> const& list, size_t i)
+{
+	if (i >= list.size())
+	{
+		return "-";
+	}
+	if constexpr (std::is_same_v<T, std::string>)
+	{
+		return list[i];
+	}
+	else
+	{
+		return std::to_string(list[i]);
+	}
+}
+
+/// Compare the JIT with the interpreter on a public, printing any difference
+static bool check(const char* name, Program& p, int index = 0, DynamicArray<cell> const& params = {}, bool debug = false, bool quiet = false)
+{
+	++tests;
+	const Image image = build(p);
+	AMX amx;
+	DynamicArray<unsigned char> memory;
+	setup(amx, image, memory, debug);
+	String error;
+	const auto jit = PawnJIT::compile(amx, image.path, error);
+	if (!jit)
+	{
+		printf("%s: not translated, %s\n", name, error.c_str());
+		++failures;
+		return false;
+	}
+
+	const Run expected = run(image, nullptr, Engine::Interpreter, index, params, debug);
+	for (Engine engine : { Engine::JIT, Engine::JITFirst, Engine::InterpreterFirst })
+	{
+		const Run actual = run(image, jit.get(), engine, index, params, debug);
+		std::string difference;
+		if (expected.codes != actual.codes)
+		{
+			difference = "error codes";
+		}
+		else if (expected.rets != actual.rets)
+		{
+			difference = "return values";
+		}
+		else if (expected.states != actual.states)
+		{
+			difference = "registers";
+		}
+		else if (expected.calls != actual.calls)
+		{
+			difference = "calls";
+		}
+		else if (expected.memory != actual.memory)
+		{
+			const auto mismatch = std::mismatch(expected.memory.begin(), expected.memory.end(), actual.memory.begin());
+			difference = "memory at " + std::to_string(mismatch.first - expected.memory.begin());
+		}
+		if (difference.empty())
+		{
+			continue;
+		}
+
+		printf("%s, engine %d: %s differ\n", name, static_cast<int>(engine), difference.c_str());
+		for (size_t i = 0; i < std::max(expected.codes.size(), actual.codes.size()); ++i)
+		{
+			printf("  interpreter %s %s %s | jit %s %s %s\n", at(expected.codes, i).c_str(), at(expected.rets, i).c_str(), at(expected.states, i).c_str(), at(actual.codes, i).c_str(), at(actual.rets, i).c_str(), at(actual.states, i).c_str());
+		}
+		for (size_t i = 0; i < std::max(expected.calls.size(), actual.calls.size()) && i < 10; ++i)
+		{
+			printf("  interpreter %s | jit %s\n", at(expected.calls, i).c_str(), at(actual.calls, i).c_str());
+		}
+		++failures;
+		return false;
+	}
+
+	++outcomes[expected.codes.back()];
+	if (!quiet)
+	{
+		printf("%s: ok, error %d, returned %d, %zu bytes\n", name, expected.codes.back(), expected.rets.back(), jit->size());
+	}
+	return true;
+}
+
+/// Check the JIT refuses a program, with an error containing `expected`
+static bool refuses(const char* name, Program& p, const char* expected)
+{
+	++tests;
+	const Image image = build(p);
+	AMX amx;
+	DynamicArray<unsigned char> memory;
+	setup(amx, image, memory, false);
+	String error;
+	if (PawnJIT::compile(amx, image.path, error) || error.find(expected) == String::npos)
+	{
+		printf("%s: expected a refusal with \"%s\", got \"%s\"\n", name, expected, error.c_str());
+		++failures;
+		return false;
+	}
+	printf("%s: refused, %s\n", name, error.c_str());
+	return true;
+}
+
+#include "programs.hpp"
+
+/// How long recursive fib(27) takes under each, as a sanity check that the JIT is worth it
+static void benchmark()
+{
+	Program p = fib(false);
+	const Image image = build(p);
+	AMX amx;
+	DynamicArray<unsigned char> memory;
+	setup(amx, image, memory, false);
+	String error;
+	const auto jit = PawnJIT::compile(amx, image.path, error);
+	if (!jit)
+	{
+		return;
+	}
+	for (bool useJIT : { false, true })
+	{
+		setup(amx, image, memory, false);
+		amx.stk -= sizeof(cell);
+		*reinterpret_cast<cell*>(memory.data() + image.hdr.dat + amx.stk) = 27;
+		amx.paramcount = 1;
+		cell ret = 0;
+		const auto start = std::chrono::steady_clock::now();
+		const int code = useJIT ? jit->exec(&amx, &ret, 0) : amx_Exec(&amx, &ret, 0);
+		const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+		printf("fib(27) = %d, error %d, %s: %.1f ms\n", ret, code, useJIT ? "jit" : "interpreter", time.count() / 1000.0);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (!PawnJIT::supported())
+	{
+		printf("This build has no JIT\n");
+		return 1;
+	}
+
+	const unsigned seed = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1;
+	const int count = argc > 2 ? atoi(argv[2]) : 2000;
+
+	handWritten();
+	refusals();
+	fuzz(seed, count);
+	benchmark();
+
+	for (auto const& outcome : outcomes)
+	{
+		printf("error %d: %d programs\n", outcome.first, outcome.second);
+	}
+	printf("%d of %d failed\n", failures, tests);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,666 @@
+/*
+ *  This Source Code Form is subject to the terms of the Mozilla Public License,
+ *  v. 2.0. If a copy of the MPL was not distributed with this file, You can
+ *  obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *  The original code is copyright (c) 2022, open.mp team and contributors.
+ */
+
+#pragma once
+
+/// Recursive Fibonacci as the compiler would write it, with a `BREAK` on every call
+static Program fib(bool compact)
+{
+	Program p;
+	p.compact = compact;
+	p.pub(0);
+	p.op(Op::PROC);
+	p.op(Op::BREAK);
+	p.op(Op::LOAD_S_PRI, 12);
+	p.op(Op::CONST_ALT, 2);
+	p.jump(Op::JSLESS, 1);
+	p.op(Op::LOAD_S_PRI, 12);
+	p.op(Op::ADD_C, -1);
+	p.op(Op::PUSH_PRI);
+	p.op(Op::PUSH_C, 4);
+	p.jump(Op::CALL, 0);
+	p.op(Op::PUSH_PRI);
+	p.op(Op::LOAD_S_PRI, 12);
+	p.op(Op::ADD_C, -2);
+	p.op(Op::PUSH_PRI);
+	p.op(Op::PUSH_C, 4);
+	p.jump(Op::CALL, 0);
+	p.op(Op::POP_ALT);
+	p.op(Op::ADD);
+	p.op(Op::RETN);
+	p.bind(1);
+	p.op(Op::RETN);
+	return p;
+}
+
+static void handWritten()
+{
+	{
+		Program p = fib(false);
+		check("fib", p, 0, { 15 });
+		check("fib deep", p, 0, { 2000 });
+		for (auto mode : { DebugMode::Continue, DebugMode::ExitOnThird, DebugMode::SleepOnSecond })
+		{
+			debugMode = mode;
+			check(("fib debug " + std::to_string(static_cast<int>(mode))).c_str(), p, 0, { 5 }, true);
+		}
+		debugMode = DebugMode::Continue;
+	}
+	{
+		Program p = fib(true);
+		check("fib compact", p, 0, { 12 });
+	}
+	{
+		// Recursion without end runs out of stack
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::PUSH_C, 0);
+		p.jump(Op::CALL, 0);
+		p.op(Op::RETN);
+		check("stack overflow", p);
+	}
+	{
+		// Sum of 1 to n in a global, counting in a local
+		Program p;
+		p.data = { 0, 0 };
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::PUSH_C, 0);
+		p.bind(1);
+		p.op(Op::LOAD_S_PRI, -4);
+		p.op(Op::LOAD_S_ALT, 12);
+		p.jump(Op::JSGRTR, 2);
+		p.op(Op::LOAD_PRI, 0);
+		p.op(Op::LOAD_S_ALT, -4);
+		p.op(Op::ADD);
+		p.op(Op::STOR_PRI, 0);
+		p.op(Op::INC_S, -4);
+		p.op(Op::INC, 4);
+		p.jump(Op::JUMP, 1);
+		p.bind(2);
+		p.op(Op::STACK, 4);
+		p.op(Op::LOAD_PRI, 0);
+		p.op(Op::RETN);
+		check("loop", p, 0, { 1000 });
+	}
+	for (cell value : { -5, 0, 1, 2, 3, 7, 100, 0x7fffffff })
+	{
+		// Duplicate and unsorted cases, the first match wins
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::LOAD_S_PRI, 12);
+		p.jump(Op::SWITCH, 9);
+		p.bind(1);
+		p.op(Op::CONST_PRI, 100);
+		p.jump(Op::JUMP, 8);
+		p.bind(2);
+		p.op(Op::CONST_PRI, 200);
+		p.jump(Op::JUMP, 8);
+		p.bind(3);
+		p.op(Op::CONST_PRI, 300);
+		p.jump(Op::JUMP, 8);
+		p.bind(4);
+		p.op(Op::CONST_PRI, -1);
+		p.bind(8);
+		p.op(Op::RETN);
+		p.bind(9);
+		p.op(Op::CASETBL, 4);
+		p.ref(4);
+		for (auto const& entry : { std::make_pair(3, 1), std::make_pair(1, 2), std::make_pair(7, 3), std::make_pair(3, 2) })
+		{
+			p.code.push_back(entry.first);
+			p.ref(entry.second);
+		}
+		check(("switch " + std::to_string(value)).c_str(), p, 0, { value });
+	}
+	{
+		// An empty table only has the default
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::CONST_PRI, 3);
+		p.jump(Op::SWITCH, 9);
+		p.bind(4);
+		p.op(Op::CONST_PRI, -1);
+		p.op(Op::RETN);
+		p.bind(9);
+		p.op(Op::CASETBL, 0);
+		p.ref(4);
+		check("switch empty", p);
+	}
+	{
+		// Every way of calling a native, sleeping in one and halting with a sleep
+		Program p;
+		p.data = { 0, 0, 0, 0 };
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::PUSH_C, 5);
+		p.op(Op::PUSH_C, 6);
+		p.op(Op::PUSH_C, 8);
+		p.op(Op::SYSREQ_C, 0);
+		p.op(Op::STACK, 12);
+		p.op(Op::STOR_PRI, 0);
+		p.op(Op::PUSH_C, 1);
+		p.op(Op::PUSH_C, 2);
+		p.op(Op::PUSH_C, 3);
+		p.op(Op::SYSREQ_N, 0, 12);
+		p.op(Op::STOR_PRI, 4);
+		p.op(Op::CONST_PRI, 0);
+		p.op(Op::PUSH_C, 40);
+		p.op(Op::PUSH_C, 4);
+		p.op(Op::SYSREQ_PRI);
+		p.op(Op::STACK, 8);
+		p.op(Op::STOR_PRI, 8);
+		p.op(Op::PUSH_C, 0);
+		p.op(Op::PUSH_ADR, -4);
+		p.op(Op::SYSREQ_N, 3, 4);
+		p.op(Op::POP_ALT);
+		p.op(Op::CONST_PRI, 11);
+		p.op(Op::CONST_ALT, 22);
+		p.op(Op::SYSREQ_N, 1, 0);
+		p.op(Op::ADD);
+		p.op(Op::STOR_PRI, 12);
+		p.op(Op::PUSH_C, 9);
+		p.op(Op::SYSREQ_N, 1, 4);
+		p.op(Op::HALT, AMX_ERR_SLEEP);
+		p.op(Op::MOVE_PRI);
+		p.op(Op::RETN);
+		check("natives", p);
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::HEAP, 16);
+		p.op(Op::PUSH_C, 1);
+		p.op(Op::SYSREQ_N, 2, 4);
+		p.op(Op::RETN);
+		check("native error", p);
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::SYSREQ_N, 9, 0);
+		p.op(Op::RETN);
+		check("native missing", p);
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::HEAP, 8);
+		p.op(Op::CONST_PRI, 11);
+		p.op(Op::BOUNDS, 10);
+		p.op(Op::RETN);
+		check("bounds", p);
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::HEAP, 8);
+		p.op(Op::CONST_PRI, 10);
+		p.op(Op::BOUNDS, 10);
+		p.op(Op::ZERO_ALT);
+		p.op(Op::SDIV);
+		p.op(Op::RETN);
+		check("divide by zero", p);
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::CONST_PRI, 1 << 20);
+		p.op(Op::LOAD_I);
+		p.op(Op::RETN);
+		check("load outside", p);
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::HEAP, 1 << 20);
+		p.op(Op::RETN);
+		check("heap overflow", p);
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::HEAP, -4);
+		p.op(Op::RETN);
+		check("heap underflow", p);
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::STACK, 64);
+		p.op(Op::RETN);
+		check("stack underflow", p);
+	}
+	for (cell address : { 6, 1 << 20, 4 })
+	{
+		// Returning to an unaligned address, outside the code and into the middle of an instruction
+		Program p;
+		p.pub(0);
+		p.op(Op::PUSH_C, address);
+		p.op(Op::PUSH_C, 0);
+		p.op(Op::RET);
+		check(("return to " + std::to_string(address)).c_str(), p);
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::HALT, 5);
+		p.op(Op::RETN);
+		check("halt with an error", p);
+	}
+	{
+		// Memory blocks, overlapping too
+		Program p;
+		p.data = { 1, 2, 3, 4, 5, 6, 7, 8, 0, 0, 0, 0, 0, 0, 0, 0 };
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::CONST_PRI, 0);
+		p.op(Op::CONST_ALT, 32);
+		p.op(Op::MOVS, 16);
+		p.op(Op::CONST_PRI, 0);
+		p.op(Op::CONST_ALT, 32);
+		p.op(Op::CMPS, 16);
+		p.op(Op::PUSH_PRI);
+		p.op(Op::CONST_PRI, 0);
+		p.op(Op::CONST_ALT, 4);
+		p.op(Op::CMPS, 8);
+		p.op(Op::PUSH_PRI);
+		p.op(Op::CONST_PRI, -7);
+		p.op(Op::CONST_ALT, 48);
+		p.op(Op::FILL, 16);
+		p.op(Op::CONST_PRI, 5);
+		p.op(Op::CONST_ALT, 2);
+		p.op(Op::MOVS, 7);
+		p.op(Op::POP_PRI);
+		p.op(Op::POP_ALT);
+		p.op(Op::RETN);
+		check("blocks", p);
+	}
+	{
+		Program p;
+		p.data = { 1, 2 };
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::CONST_PRI, 0);
+		p.op(Op::CONST_ALT, 4);
+		p.op(Op::MOVS, 8);
+		p.op(Op::RETN);
+		check("move into the heap", p);
+	}
+	{
+		Program p;
+		p.data = { 1, 2 };
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::CONST_PRI, 0);
+		p.op(Op::CONST_ALT, 1 << 20);
+		p.op(Op::FILL, 8);
+		p.op(Op::RETN);
+		check("fill outside", p);
+	}
+	{
+		// Arrays, bytes, references and the registers
+		Program p;
+		p.data = { 10, 20, 30, 40, 0x11223344, 0, 8, 0 };
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::CONST_ALT, 0);
+		p.op(Op::CONST_PRI, 2);
+		p.op(Op::LIDX);
+		p.op(Op::PUSH_PRI);
+		p.op(Op::CONST_PRI, 3);
+		p.op(Op::LIDX_B, 2);
+		p.op(Op::PUSH_PRI);
+		p.op(Op::CONST_PRI, 1);
+		p.op(Op::IDXADDR);
+		p.op(Op::PUSH_PRI);
+		p.op(Op::CONST_PRI, 5);
+		p.op(Op::IDXADDR_B, 3);
+		p.op(Op::PUSH_PRI);
+		for (cell size : { 1, 2, 4 })
+		{
+			p.op(Op::CONST_PRI, 16 + (size == 4 ? 0 : size));
+			p.op(Op::LODB_I, size);
+			p.op(Op::PUSH_PRI);
+		}
+		p.op(Op::CONST_ALT, 20);
+		p.op(Op::CONST_PRI, -2);
+		p.op(Op::STRB_I, 1);
+		p.op(Op::CONST_ALT, 22);
+		p.op(Op::STRB_I, 2);
+		p.op(Op::CONST_ALT, 28);
+		p.op(Op::STOR_I);
+		p.op(Op::CONST_PRI, 0xABCDEF);
+		p.op(Op::SREF_PRI, 24);
+		p.op(Op::LREF_ALT, 24);
+		p.op(Op::PUSH_ALT);
+		p.op(Op::PUSH_C, 24);
+		p.op(Op::CONST_PRI, 5);
+		p.op(Op::SREF_S_PRI, -4);
+		p.op(Op::LREF_S_PRI, -4);
+		p.op(Op::PUSH_PRI);
+		p.op(Op::CONST_PRI, 8);
+		p.op(Op::INC_I);
+		p.op(Op::DEC_I);
+		p.op(Op::INC_I);
+		p.op(Op::DEC, 0);
+		p.op(Op::DEC_S, -4);
+		p.op(Op::ZERO, 4);
+		p.op(Op::ZERO_S, -8);
+		p.op(Op::SWAP_PRI);
+		p.op(Op::SWAP_ALT);
+		p.op(Op::ALIGN_PRI, 1);
+		p.op(Op::ALIGN_ALT, 2);
+		for (cell reg : { 2, 3, 4, 5, 6 })
+		{
+			p.op(Op::LCTRL, reg);
+			p.op(Op::PUSH_PRI);
+		}
+		p.op(Op::LCTRL, 2);
+		p.op(Op::ADD_C, 8);
+		p.op(Op::SCTRL, 2);
+		p.op(Op::LCTRL, 4);
+		p.op(Op::ADD_C, -8);
+		p.op(Op::SCTRL, 4);
+		p.op(Op::HALT, AMX_ERR_SLEEP);
+		p.op(Op::LCTRL, 5);
+		p.op(Op::SCTRL, 5);
+		p.op(Op::SCTRL, 0);
+		p.op(Op::SCTRL, 3);
+		p.op(Op::HEAP, -8);
+		p.op(Op::LCTRL, 5);
+		p.op(Op::SCTRL, 4);
+		p.op(Op::LINE, 1, 2);
+		p.op(Op::SYMTAG, 3);
+		p.op(Op::SRANGE, 1, 2);
+		p.op(Op::NOP);
+		p.op(Op::RETN);
+		check("memory", p);
+	}
+	{
+		// Two publics sharing a function, and one that doesn't exist
+		Program p;
+		p.data = { 0 };
+		p.pub(0);
+		p.op(Op::PROC);
+		p.op(Op::PUSH_C, 0);
+		p.jump(Op::CALL, 5);
+		p.op(Op::STACK, 4);
+		p.op(Op::RETN);
+		p.pub(1);
+		p.op(Op::PROC);
+		p.op(Op::LOAD_S_PRI, 12);
+		p.op(Op::PUSH_PRI);
+		p.op(Op::LOAD_S_PRI, 16);
+		p.op(Op::PUSH_PRI);
+		p.op(Op::PUSH_C, 8);
+		p.jump(Op::CALL, 6);
+		p.op(Op::RETN);
+		p.bind(5);
+		p.op(Op::PROC);
+		p.op(Op::LOAD_S_PRI, 8);
+		p.op(Op::SMUL_C, 3);
+		p.op(Op::INC, 0);
+		p.op(Op::SYSREQ_N, 1, 0);
+		p.op(Op::RET);
+		p.bind(6);
+		p.op(Op::PROC);
+		p.op(Op::LOAD_S_PRI, 12);
+		p.op(Op::LOAD_S_ALT, 16);
+		p.op(Op::SUB);
+		p.op(Op::SYSREQ_N, 1, 0);
+		p.op(Op::RETN);
+		check("public 0", p, 0);
+		check("public 1", p, 1, { 3, 4 });
+		check("public 2", p, 2);
+	}
+}
+
+static void refusals()
+{
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::JUMP_PRI);
+		refuses("jump.pri", p, "JUMP.pri");
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::LCTRL, 0);
+		p.op(Op::RETN);
+		refuses("lctrl cod", p, "LCTRL");
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::SCTRL, 6);
+		p.op(Op::RETN);
+		refuses("sctrl cip", p, "SCTRL");
+	}
+	for (cell opcode : { 500, -3 })
+	{
+		Program p;
+		p.pub(0);
+		p.op(static_cast<Op>(opcode));
+		refuses(("opcode " + std::to_string(opcode)).c_str(), p, "unknown");
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::JUMP, 4);
+		refuses("jump into an instruction", p, "");
+	}
+	{
+		Program p;
+		p.pub(0);
+		p.op(Op::CONST_PRI);
+		refuses("cut short", p, "middle");
+	}
+	{
+		// The file was changed after the script was loaded
+		++tests;
+		Program p = fib(false);
+		p.data = { 1 };
+		const Image image = build(p);
+		AMX amx;
+		DynamicArray<unsigned char> memory;
+		setup(amx, image, memory, false);
+		*reinterpret_cast<cell*>(memory.data() + image.hdr.dat) = 2;
+		String error;
+		if (PawnJIT::compile(amx, image.path, error))
+		{
+			printf("changed file: not refused\n");
+			++failures;
+		}
+		else
+		{
+			printf("changed file: refused, %s\n", error.c_str());
+		}
+	}
+}
+
+static cell interesting(std::mt19937& rng)
+{
+	static const cell values[] = { 0, 1, -1, 2, -2, 3, 4, 7, 8, 31, 32, 33, 255, 256, 0x7f, 0x80, 0xff, 0x7fffffff, static_cast<cell>(0x80000000), static_cast<cell>(0x80000001), 0xffff, 0x10000 };
+	if (rng() % 3 == 0)
+	{
+		return static_cast<cell>(rng());
+	}
+	return values[rng() % std::size(values)];
+}
+
+/// Random straight-line programs with forward jumps, checked memory access, natives and sleeps
+static void fuzz(unsigned seed, int count)
+{
+	static const Op noOperand[] = { Op::ADD, Op::SUB, Op::SUB_ALT, Op::AND, Op::OR, Op::XOR, Op::NOT, Op::NEG, Op::INVERT, Op::SMUL, Op::UMUL,
+		Op::SDIV, Op::SDIV_ALT, Op::UDIV, Op::UDIV_ALT, Op::SHL, Op::SHR, Op::SSHR, Op::SIGN_PRI, Op::SIGN_ALT, Op::EQ, Op::NEQ, Op::LESS, Op::LEQ,
+		Op::GRTR, Op::GEQ, Op::SLESS, Op::SLEQ, Op::SGRTR, Op::SGEQ, Op::INC_PRI, Op::INC_ALT, Op::DEC_PRI, Op::DEC_ALT, Op::MOVE_PRI, Op::MOVE_ALT,
+		Op::XCHG, Op::ZERO_PRI, Op::ZERO_ALT, Op::IDXADDR, Op::SWAP_PRI, Op::SWAP_ALT };
+	static const Op withConstant[] = { Op::CONST_PRI, Op::CONST_ALT, Op::ADD_C, Op::SMUL_C, Op::SHL_C_PRI, Op::SHL_C_ALT, Op::SHR_C_PRI, Op::SHR_C_ALT,
+		Op::EQ_C_PRI, Op::EQ_C_ALT, Op::ALIGN_PRI, Op::ALIGN_ALT, Op::IDXADDR_B };
+	static const Op withGlobal[] = { Op::LOAD_PRI, Op::LOAD_ALT, Op::STOR_PRI, Op::STOR_ALT, Op::INC, Op::DEC, Op::ZERO, Op::PUSH };
+	static const Op withLocal[] = { Op::LOAD_S_PRI, Op::LOAD_S_ALT, Op::STOR_S_PRI, Op::STOR_S_ALT, Op::INC_S, Op::DEC_S, Op::ZERO_S, Op::PUSH_S, Op::ADDR_PRI, Op::ADDR_ALT, Op::PUSH_ADR };
+	static const Op jumps[] = { Op::JUMP, Op::JZER, Op::JNZ, Op::JEQ, Op::JNEQ, Op::JLESS, Op::JLEQ, Op::JGRTR, Op::JGEQ, Op::JSLESS, Op::JSLEQ, Op::JSGRTR, Op::JSGEQ };
+	static const Op checked[] = { Op::LOAD_I, Op::STOR_I, Op::LIDX, Op::BOUNDS, Op::LODB_I, Op::STRB_I, Op::LIDX_B };
+
+	std::mt19937 rng(seed);
+	const int before = failures;
+	for (int n = 0; n < count; ++n)
+	{
+		Program p;
+		for (int i = 0; i < 16; ++i)
+		{
+			p.data.push_back(interesting(rng));
+		}
+		p.pub(0);
+		p.op(Op::PROC);
+		for (int i = 0; i < 8; ++i)
+		{
+			p.op(Op::PUSH_C, interesting(rng));
+		}
+
+		int labels = 10, pending = 0;
+		const int length = 10 + rng() % 60;
+		for (int i = 0; i < length; ++i)
+		{
+			const int kind = rng() % 100;
+			if (kind < 40)
+			{
+				p.op(noOperand[rng() % std::size(noOperand)]);
+			}
+			else if (kind < 60)
+			{
+				const Op o = withConstant[rng() % std::size(withConstant)];
+				cell value = interesting(rng);
+				if (o == Op::ALIGN_PRI || o == Op::ALIGN_ALT)
+				{
+					value = 1 + rng() % 4;
+				}
+				else if (o == Op::IDXADDR_B)
+				{
+					value = rng() % 32;
+				}
+				p.op(o, value);
+			}
+			else if (kind < 70)
+			{
+				const Op o = withGlobal[rng() % std::size(withGlobal)];
+				p.op(o, 4 * (rng() % 16));
+				if (o == Op::PUSH)
+				{
+					p.op(Op::POP_ALT);
+				}
+			}
+			else if (kind < 80)
+			{
+				const Op o = withLocal[rng() % std::size(withLocal)];
+				p.op(o, -4 * (1 + rng() % 8));
+				if (o == Op::PUSH_S || o == Op::PUSH_ADR)
+				{
+					p.op(Op::POP_PRI);
+				}
+			}
+			else if (kind < 88)
+			{
+				// A forward jump over whatever comes next
+				if (pending)
+				{
+					p.bind(pending);
+				}
+				pending = ++labels;
+				p.jump(jumps[rng() % std::size(jumps)], pending);
+			}
+			else if (kind < 93)
+			{
+				// Near the data, sometimes unaligned, or anywhere
+				const Op o = checked[rng() % std::size(checked)];
+				const cell address = rng() % 2 ? 4 * (rng() % 16) + (rng() % 4 == 0 ? rng() % 4 : 0) : interesting(rng);
+				if (o == Op::LOAD_I || o == Op::LODB_I)
+				{
+					p.op(Op::CONST_PRI, address);
+				}
+				else if (o == Op::STOR_I || o == Op::STRB_I)
+				{
+					p.op(Op::CONST_ALT, address);
+				}
+				else if (o == Op::LIDX || o == Op::LIDX_B)
+				{
+					p.op(Op::CONST_ALT, address & ~3);
+					p.op(Op::CONST_PRI, rng() % 8);
+				}
+
+				if (o == Op::LODB_I || o == Op::STRB_I)
+				{
+					p.op(o, 1 << (rng() % 3));
+				}
+				else if (o == Op::LIDX_B)
+				{
+					p.op(o, rng() % 4);
+				}
+				else if (o == Op::BOUNDS)
+				{
+					p.op(o, interesting(rng));
+				}
+				else
+				{
+					p.op(o);
+				}
+			}
+			else if (kind < 96)
+			{
+				p.op(Op::PUSH_PRI);
+				p.op(Op::PUSH_ALT);
+				p.op(Op::SYSREQ_N, 0, 8);
+			}
+			else if (kind < 98)
+			{
+				p.op(Op::SYSREQ_N, 1, 0);
+			}
+			else
+			{
+				const cell size = 4 * (rng() % 4);
+				const Op o = rng() % 3 == 0 ? Op::MOVS : rng() % 2 ? Op::CMPS : Op::FILL;
+				p.op(Op::CONST_PRI, 4 * (rng() % 12));
+				p.op(Op::CONST_ALT, 4 * (rng() % 12));
+				if (rng() % 4 == 0)
+				{
+					p.op(Op::CONST_ALT, interesting(rng));
+				}
+				p.op(o, size ? size : 4);
+			}
+		}
+		if (pending)
+		{
+			p.bind(pending);
+		}
+		p.op(Op::PUSH_ALT);
+		p.op(Op::SYSREQ_N, 0, 4);
+		p.op(Op::STACK, 32);
+		p.op(Op::RETN);
+		p.compact = rng() % 4 == 0;
+
+		const std::string name = "fuzz " + std::to_string(seed) + "/" + std::to_string(n);
+		if (!check(name.c_str(), p, 0, {}, false, true) && failures - before > 5)
+		{
+			break;
+		}
+	}
+}